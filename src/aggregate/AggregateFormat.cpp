@@ -0,0 +1,224 @@
+#include "AggregateFormat.hpp"
+#include "Crc32c.hpp"
+#include "codec/ByteOrder.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+    constexpr char kHeaderMagic[8] = {'T', 'A', 'G', 'G', 'H', 'D', 'R', '1'};
+    constexpr char kTrailerMagic[8] = {'T', 'A', 'G', 'G', 'I', 'D', 'X', '1'};
+    constexpr uint16_t kVersion = 1;
+
+    // Header 字段偏移
+    constexpr size_t kVersionOffset = 8;
+    constexpr size_t kAlignmentOffset = 12;
+    constexpr size_t kAggregateIdOffset = 16;
+    constexpr size_t kMemberCountOffset = 24;
+    constexpr size_t kDataOffset = 32;
+    constexpr size_t kIndexOffset = 40;
+    constexpr size_t kIndexLengthOffset = 48;
+    constexpr size_t kHeaderChecksumOffset = 60;
+
+    // 成员索引：成员数之后是 Entry 数组
+    constexpr size_t kIndexPrefix = 8;
+
+    // Entry 字段偏移
+    constexpr size_t kEntryOffset = 0;
+    constexpr size_t kEntryLength = 8;
+    constexpr size_t kEntryChecksum = 16;
+    constexpr size_t kEntryFlags = 20;
+    constexpr size_t kEntryKeyLength = 22;
+    constexpr size_t kEntryStringOffset = 24;
+    constexpr size_t kEntryJobLength = 28;
+
+    constexpr uint16_t kHasChecksum = 1;    ///< kEntryFlags：checksum 有效
+
+    // Trailer 字段偏移
+    constexpr size_t kTrailerIndexOffset = 8;
+    constexpr size_t kTrailerIndexLength = 16;
+    constexpr size_t kTrailerChecksum = 24;
+
+    uint64_t alignUp(uint64_t value, uint32_t alignment) {
+        return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+
+}
+
+uint64_t AggregateFormat::dataOffset(uint32_t alignment)
+{
+    return alignUp(kHeaderSize, alignment);
+}
+
+uint64_t AggregateFormat::padding(uint64_t size, uint32_t alignment)
+{
+    return alignUp(size, alignment) - size;
+}
+
+void AggregateFormat::begin(std::vector<uint8_t>& image, uint32_t alignment)
+{
+    image.assign(dataOffset(alignment), 0);
+}
+
+uint64_t AggregateFormat::append(std::vector<uint8_t>& image, uint32_t alignment, const uint8_t* data, size_t length)
+{
+    image.resize(alignUp(image.size(), alignment), 0);
+    const uint64_t offset = image.size();
+    image.insert(image.end(), data, data + length);
+    return offset;
+}
+
+void AggregateFormat::finish(std::vector<uint8_t>& image, uint64_t aggregate_id, uint32_t alignment,
+                             const std::vector<AggregateMember>& members)
+{
+    size_t strings = 0;
+    for (const auto& member : members) {
+        // 长度字段宽度有限，截断会使索引指向错误的字符串，在修改镜像之前拒绝
+        if (member.object_key.size() > kMaxKeyLength) {
+            throw std::length_error("aggregate member key too long: " + std::to_string(member.object_key.size()));
+        }
+        strings += member.object_key.size() + member.job_id.size();
+    }
+    if (strings > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("aggregate member index strings too long: " + std::to_string(strings));
+    }
+
+    // 成员索引
+    image.resize(alignUp(image.size(), alignment), 0);
+    const uint64_t index_offset = image.size();
+    const size_t entries = kIndexPrefix + members.size() * kEntrySize;
+    image.resize(index_offset + entries + strings, 0);
+    uint8_t* index = image.data() + index_offset;
+    byte_order::store<uint32_t>(index, static_cast<uint32_t>(members.size()));
+    uint32_t string_offset = 0;
+    for (size_t i = 0; i < members.size(); ++i) {
+        const AggregateMember& member = members[i];
+        uint8_t* entry = index + kIndexPrefix + i * kEntrySize;
+        byte_order::store<uint64_t>(entry + kEntryOffset, member.offset);
+        byte_order::store<uint64_t>(entry + kEntryLength, member.length);
+        byte_order::store<uint32_t>(entry + kEntryChecksum, member.checksum.value_or(0));
+        byte_order::store<uint16_t>(entry + kEntryFlags, member.checksum ? kHasChecksum : 0);
+        byte_order::store<uint16_t>(entry + kEntryKeyLength, static_cast<uint16_t>(member.object_key.size()));
+        byte_order::store<uint32_t>(entry + kEntryStringOffset, string_offset);
+        byte_order::store<uint32_t>(entry + kEntryJobLength, static_cast<uint32_t>(member.job_id.size()));
+        uint8_t* text = index + entries + string_offset;
+        memcpy(text, member.object_key.data(), member.object_key.size());
+        memcpy(text + member.object_key.size(), member.job_id.data(), member.job_id.size());
+        string_offset += static_cast<uint32_t>(member.object_key.size() + member.job_id.size());
+    }
+    const uint64_t index_length = entries + strings;
+    const uint32_t index_checksum = crc32c::value(index, index_length);
+
+    // Trailer
+    uint8_t trailer[kTrailerSize] = {};
+    memcpy(trailer, kTrailerMagic, sizeof(kTrailerMagic));
+    byte_order::store<uint64_t>(trailer + kTrailerIndexOffset, index_offset);
+    byte_order::store<uint64_t>(trailer + kTrailerIndexLength, index_length);
+    byte_order::store<uint32_t>(trailer + kTrailerChecksum, index_checksum);
+    image.insert(image.end(), trailer, trailer + kTrailerSize);
+
+    // 回填 Header
+    uint8_t* header = image.data();
+    memset(header, 0, kHeaderSize);
+    memcpy(header, kHeaderMagic, sizeof(kHeaderMagic));
+    byte_order::store<uint16_t>(header + kVersionOffset, kVersion);
+    byte_order::store<uint32_t>(header + kAlignmentOffset, alignment);
+    byte_order::store<uint64_t>(header + kAggregateIdOffset, aggregate_id);
+    byte_order::store<uint32_t>(header + kMemberCountOffset, static_cast<uint32_t>(members.size()));
+    byte_order::store<uint64_t>(header + kDataOffset, dataOffset(alignment));
+    byte_order::store<uint64_t>(header + kIndexOffset, index_offset);
+    byte_order::store<uint64_t>(header + kIndexLengthOffset, index_length);
+    byte_order::store<uint32_t>(header + kHeaderChecksumOffset, crc32c::value(header, kHeaderChecksumOffset));
+}
+
+bool AggregateFormat::parseHeader(const uint8_t* data, size_t length, Header& header)
+{
+    if (length < kHeaderSize || memcmp(data, kHeaderMagic, sizeof(kHeaderMagic)) != 0 ||
+        byte_order::load<uint16_t>(data + kVersionOffset) != kVersion ||
+        byte_order::load<uint32_t>(data + kHeaderChecksumOffset) != crc32c::value(data, kHeaderChecksumOffset)) {
+        return false;
+    }
+    header.alignment = byte_order::load<uint32_t>(data + kAlignmentOffset);
+    header.aggregate_id = byte_order::load<uint64_t>(data + kAggregateIdOffset);
+    header.member_count = byte_order::load<uint32_t>(data + kMemberCountOffset);
+    header.data_offset = byte_order::load<uint64_t>(data + kDataOffset);
+    header.index_offset = byte_order::load<uint64_t>(data + kIndexOffset);
+    header.index_length = byte_order::load<uint64_t>(data + kIndexLengthOffset);
+    return true;
+}
+
+bool AggregateFormat::parseTrailer(const uint8_t* tail, size_t length, uint64_t& index_offset,
+                                   uint64_t& index_length, uint32_t& index_checksum)
+{
+    if (length < kTrailerSize) {
+        return false;
+    }
+    const uint8_t* trailer = tail + length - kTrailerSize;
+    if (memcmp(trailer, kTrailerMagic, sizeof(kTrailerMagic)) != 0) {
+        return false;
+    }
+    index_offset = byte_order::load<uint64_t>(trailer + kTrailerIndexOffset);
+    index_length = byte_order::load<uint64_t>(trailer + kTrailerIndexLength);
+    index_checksum = byte_order::load<uint32_t>(trailer + kTrailerChecksum);
+    return true;
+}
+
+bool AggregateFormat::parseIndex(const uint8_t* index, size_t length, uint32_t checksum,
+                                 std::vector<AggregateMember>& members)
+{
+    if (length < kIndexPrefix || crc32c::value(index, length) != checksum) {
+        return false;
+    }
+    const uint64_t count = byte_order::load<uint32_t>(index);
+    const uint64_t entries = kIndexPrefix + count * kEntrySize;
+    if (entries > length) {
+        return false;
+    }
+    const char* strings = reinterpret_cast<const char*>(index + entries);
+    const uint64_t strings_size = length - entries;
+    members.clear();
+    members.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        const uint8_t* entry = index + kIndexPrefix + i * kEntrySize;
+        const uint64_t key_length = byte_order::load<uint16_t>(entry + kEntryKeyLength);
+        const uint64_t string_offset = byte_order::load<uint32_t>(entry + kEntryStringOffset);
+        const uint64_t job_length = byte_order::load<uint32_t>(entry + kEntryJobLength);
+        if (string_offset + key_length + job_length > strings_size) {
+            return false;
+        }
+        AggregateMember member;
+        member.object_key.assign(strings + string_offset, key_length);
+        member.job_id.assign(strings + string_offset + key_length, job_length);
+        member.offset = byte_order::load<uint64_t>(entry + kEntryOffset);
+        member.length = byte_order::load<uint64_t>(entry + kEntryLength);
+        if (byte_order::load<uint16_t>(entry + kEntryFlags) & kHasChecksum) {
+            member.checksum = byte_order::load<uint32_t>(entry + kEntryChecksum);
+        }
+        members.push_back(std::move(member));
+    }
+    return true;
+}
+
+bool AggregateFormat::parse(const uint8_t* image, size_t length, Header& header,
+                            std::vector<AggregateMember>& members)
+{
+    uint64_t index_offset = 0;
+    uint64_t index_length = 0;
+    uint32_t index_checksum = 0;
+    if (!parseHeader(image, length, header) ||
+        !parseTrailer(image, length, index_offset, index_length, index_checksum) ||
+        index_offset != header.index_offset || index_length != header.index_length ||
+        index_offset > length || index_length > length - index_offset ||
+        !parseIndex(image + index_offset, index_length, index_checksum, members)) {
+        return false;
+    }
+    for (const auto& member : members) {
+        if (member.offset > index_offset || member.length > index_offset - member.offset) {
+            return false;
+        }
+    }
+    return members.size() == header.member_count;
+}
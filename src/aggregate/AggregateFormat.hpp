@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Aggregate.hpp"
+
+/**
+ * @brief 聚合的磁带格式：自描述的聚合数据，读取单个成员时可以直接定位到其所在的块。
+ *
+ * 布局（小端序，聚合从磁带块边界开始存放）：
+ * @code
+ * | Header (64 字节，补齐到 alignment) | 成员 0 | 填充 | 成员 1 | 填充 | ... | 填充 | 成员索引 | Trailer (32 字节) |
+ * @endcode
+ * - Header：magic "TAGGHDR1"、版本、对齐、aggregate_id、成员数、数据起点、索引的偏移和长度，最后 4 字节是
+ *   前 60 字节的 CRC32C；
+ * - 成员：按 alignment 对齐存放，AggregateMember::offset 即成员在聚合中的偏移。alignment 取磁带块大小时
+ *   每个成员都从块边界开始，取 4096 时可以直接用 O_DIRECT 读取；
+ * - 成员索引（从 alignment 边界开始）：成员数（4 字节）、保留（4 字节）、Entry[0..count)、字符串区。
+ *   Entry（32 字节）：偏移、长度、CRC32C、标志（bit 0：有校验和）、对象键长度（2 字节，因此键最长 kMaxKeyLength）、
+ *   键在字符串区的偏移、任务 ID 长度（紧跟在键之后）；
+ * - Trailer：magic "TAGGIDX1"、索引的偏移和长度、索引的 CRC32C。位于聚合末尾，
+ *   只知道聚合长度时读最后一块即可找到索引。
+ *
+ * 成员偏移、长度和校验和同时记录在目录（CatalogEntry）中；磁带上的索引使聚合脱离目录也能解析，
+ * 例如目录损坏后重建、回收空间时枚举聚合中的成员。压缩的聚合（BlockFrame）压缩的是整个镜像，
+ * 解压后仍是这一格式。
+ */
+class AggregateFormat
+{
+public:
+    static constexpr size_t kHeaderSize = 64;
+    static constexpr size_t kEntrySize = 32;
+    static constexpr size_t kTrailerSize = 32;
+    static constexpr size_t kMaxKeyLength = 0xFFFF;    ///< 对象键的最大长度（Entry 中为 2 字节）
+
+    /**
+     * @brief 聚合头。
+     */
+    struct Header {
+        uint64_t aggregate_id = 0;
+        uint32_t alignment = 0;         ///< 成员对齐（字节）
+        uint32_t member_count = 0;
+        uint64_t data_offset = 0;       ///< 第一个成员的偏移
+        uint64_t index_offset = 0;      ///< 成员索引的偏移
+        uint64_t index_length = 0;      ///< 成员索引的长度（不含 Trailer）
+    };
+
+    /**
+     * @brief 第一个成员的偏移：Header 补齐到 alignment。
+     */
+    static uint64_t dataOffset(uint32_t alignment);
+
+    /**
+     * @brief 长度为 size 的镜像追加下一个成员前需要的填充字节数。
+     */
+    static uint64_t padding(uint64_t size, uint32_t alignment);
+
+    /**
+     * @brief 开始一个镜像：写入 dataOffset(alignment) 字节的占位 Header。
+     */
+    static void begin(std::vector<uint8_t>& image, uint32_t alignment);
+
+    /**
+     * @brief 追加一个成员：先补齐到 alignment。
+     *
+     * @return uint64_t 成员在镜像中的偏移。
+     */
+    static uint64_t append(std::vector<uint8_t>& image, uint32_t alignment, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 封口镜像：追加填充、成员索引和 Trailer，回填 Header。
+     *
+     * @param image 由 begin()/append() 构造的镜像。
+     * @param aggregate_id 聚合 ID。
+     * @param alignment 与 begin() 相同的对齐。
+     * @param members 成员索引，偏移必须是 append() 的返回值。
+     * @throws std::length_error 对象键超过 kMaxKeyLength 或字符串区超过 4 GiB，此时镜像不变。
+     */
+    static void finish(std::vector<uint8_t>& image, uint64_t aggregate_id, uint32_t alignment,
+                       const std::vector<AggregateMember>& members);
+
+    /**
+     * @brief 解析聚合开头的 Header。
+     *
+     * @return bool magic、版本或 CRC 不符时返回 false。
+     */
+    static bool parseHeader(const uint8_t* data, size_t length, Header& header);
+
+    /**
+     * @brief 解析聚合末尾的 Trailer。
+     *
+     * @param tail 聚合的最后 length 字节（length 不小于 kTrailerSize）。
+     * @param index_offset 成员索引在聚合中的偏移。
+     * @param index_length 成员索引的长度。
+     * @param index_checksum 成员索引的 CRC32C。
+     */
+    static bool parseTrailer(const uint8_t* tail, size_t length, uint64_t& index_offset, uint64_t& index_length,
+                             uint32_t& index_checksum);
+
+    /**
+     * @brief 解析成员索引。
+     *
+     * @param index 索引数据（不含 Trailer）。
+     * @param checksum 索引的 CRC32C（来自 Trailer）。
+     * @param members 输出的成员，按偏移升序。
+     * @return bool 校验和不符或格式错误时返回 false。
+     */
+    static bool parseIndex(const uint8_t* index, size_t length, uint32_t checksum,
+                           std::vector<AggregateMember>& members);
+
+    /**
+     * @brief 解析完整的聚合镜像。
+     */
+    static bool parse(const uint8_t* image, size_t length, Header& header, std::vector<AggregateMember>& members);
+};
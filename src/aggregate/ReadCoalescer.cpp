@@ -0,0 +1,387 @@
+#include "ReadCoalescer.hpp"
+#include "BlockFrame.hpp"
+#include "Crc32c.hpp"
+#include "StagingCache.hpp"
+#include "TapeDrivesQueue.hpp"
+
+#include <algorithm>
+
+ReadCoalescer::ReadCoalescer(const Config& config, Sink sink)
+: config_(config)
+, sink_(std::move(sink))
+, cond_(mutex_)
+, next_id_(config.first_operation_id)
+, running_(true)
+, timer_([this] { run(); })
+{
+    timer_.start();
+}
+
+ReadCoalescer::~ReadCoalescer()
+{
+    {
+        MutexLockGuard autoLock(mutex_);
+        running_ = false;
+        cond_.notify();
+    }
+    timer_.join();
+    flush();
+}
+
+void ReadCoalescer::read(const std::string& job_id, const AggregateLocation& aggregate,
+                         uint64_t offset, uint64_t length, Delivery done,
+                         std::optional<uint32_t> checksum)
+{
+    // 压缩聚合的长度是帧长，区间在解压时检查
+    if (!aggregate.compressed && (offset > aggregate.length || length > aggregate.length - offset)) {
+        done(false, nullptr, 0);
+        return;
+    }
+    if (config_.staging && !aggregate.compressed && readStaged(aggregate, offset, length, done, checksum)) {
+        return;
+    }
+    std::optional<uint64_t> frame;
+    if (aggregate.compressed) {
+        frame = 0;
+    }
+    MutexLockGuard autoLock(mutex_);
+    ++stats_.requests;
+    // 聚合已在读取中且读取覆盖了该成员：直接挂到该读上
+    auto it = inflight_index_.find(std::make_pair(aggregate.tape_id, aggregate.aggregate_id));
+    if (it != inflight_index_.end()) {
+        const InflightAggregate& inflight = it->second;
+        const uint64_t base = aggregate.block_position * config_.block_size;
+        const bool covered = inflight.whole || (base + offset >= inflight.begin &&
+                                                base + offset + length <= inflight.end &&
+                                                (checksum || !aggregate.checksum));
+        if (covered) {
+            Waiter waiter{job_id, offset, length, std::move(done), checksum, frame};
+            if (waiter.frame) {
+                *waiter.frame += base - inflight.read_start;
+            } else {
+                waiter.offset = base + offset - inflight.read_start;
+            }
+            inflight_[inflight.operation_id].waiters.push_back(std::move(waiter));
+            ++stats_.attached_inflight;
+            return;
+        }
+    }
+    auto& tape = pending_[aggregate.tape_id];
+    if (pending_.size() == 1 && tape.empty()) {
+        oldest_ = std::chrono::steady_clock::now();
+        cond_.notify(); // 窗口线程开始计时
+    }
+    auto& entry = tape[AggregateKey(aggregate.block_position, aggregate.aggregate_id)];
+    if (entry.waiters.empty()) {
+        entry.location = aggregate;
+    }
+    entry.waiters.push_back(Waiter{job_id, offset, length, std::move(done), checksum, frame});
+}
+
+void ReadCoalescer::flush()
+{
+    std::vector<TapeDrivesOperation> ops;
+    {
+        MutexLockGuard autoLock(mutex_);
+        ops = sealLocked();
+    }
+    for (const auto& op : ops) {
+        emit(op);
+    }
+}
+
+bool ReadCoalescer::complete(uint64_t operation_id, const uint8_t* data, size_t length)
+{
+    InflightRead read;
+    if (!takeInflight(operation_id, read)) {
+        return false;
+    }
+    auto inside = [](const Waiter& waiter, const AggregateCheck& check) {
+        return waiter.offset >= check.offset && waiter.offset + waiter.length <= check.offset + check.length;
+    };
+    uint64_t verified = 0;
+    uint64_t errors = 0;
+
+    // 聚合级校验：只在有请求不带成员校验和时才需要扫描整个聚合
+    std::vector<const AggregateCheck*> passed;
+    std::vector<const AggregateCheck*> failed;
+    for (const auto& check : read.checks) {
+        const bool needed = std::any_of(read.waiters.begin(), read.waiters.end(), [&](const Waiter& waiter) {
+            return !waiter.checksum && !waiter.frame && inside(waiter, check);
+        });
+        if (!needed || check.offset > length || check.length > length - check.offset) {
+            continue;
+        }
+        verified += check.length;
+        if (crc32c::value(data + check.offset, check.length) == check.checksum) {
+            passed.push_back(&check);
+        } else {
+            failed.push_back(&check);
+            ++errors;
+        }
+    }
+
+    std::vector<uint8_t> extracted;
+    for (auto& waiter : read.waiters) {
+        if (waiter.frame) {
+            // 只解压与请求相交的块，块校验和在解压前检查
+            bool ok = *waiter.frame <= length &&
+                      BlockFrame::extract(data + *waiter.frame, length - *waiter.frame, waiter.offset,
+                                          waiter.length, extracted);
+            if (ok && waiter.checksum) {
+                verified += waiter.length;
+                ok = crc32c::value(extracted.data(), extracted.size()) == *waiter.checksum;
+            }
+            errors += ok ? 0 : 1;
+            if (ok) {
+                waiter.done(true, extracted.data(), waiter.length);
+            } else {
+                waiter.done(false, nullptr, 0);
+            }
+            continue;
+        }
+        bool ok = waiter.offset <= length && waiter.length <= length - waiter.offset;
+        auto covered = [&](const std::vector<const AggregateCheck*>& checks) {
+            return std::any_of(checks.begin(), checks.end(),
+                               [&](const AggregateCheck* check) { return inside(waiter, *check); });
+        };
+        if (ok && covered(failed)) {
+            ok = false;
+        } else if (ok && waiter.checksum && !covered(passed)) {
+            verified += waiter.length;
+            if (crc32c::value(data + waiter.offset, waiter.length) != *waiter.checksum) {
+                ok = false;
+                ++errors;
+            }
+        }
+        if (ok) {
+            waiter.done(true, data + waiter.offset, waiter.length);
+        } else {
+            waiter.done(false, nullptr, 0);
+        }
+    }
+
+    // 分发之后再写暂存盘，不增加本次召回的延迟
+    if (!read.staged.empty()) {
+        stage(read, data, length, passed);
+    }
+
+    MutexLockGuard autoLock(mutex_);
+    stats_.bytes_verified += verified;
+    stats_.checksum_errors += errors;
+    return true;
+}
+
+bool ReadCoalescer::readStaged(const AggregateLocation& aggregate, uint64_t offset, uint64_t length,
+                               const Delivery& done, const std::optional<uint32_t>& checksum)
+{
+    const std::string key = StagingCache::aggregateKey(aggregate.aggregate_id);
+    std::vector<uint8_t> data;
+    if (!config_.staging->read(key, offset, length, data) || data.size() != length) {
+        return false;
+    }
+    if (checksum && crc32c::value(data.data(), data.size()) != *checksum) {
+        config_.staging->erase(key); // 暂存的数据已损坏，改从磁带读取
+        MutexLockGuard autoLock(mutex_);
+        ++stats_.checksum_errors;
+        return false;
+    }
+    {
+        MutexLockGuard autoLock(mutex_);
+        ++stats_.requests;
+        ++stats_.staged_hits;
+    }
+    done(true, data.data(), data.size());
+    return true;
+}
+
+void ReadCoalescer::stage(const InflightRead& read, const uint8_t* data, size_t length,
+                          const std::vector<const AggregateCheck*>& passed)
+{
+    uint64_t staged = 0;
+    uint64_t verified = 0;
+    uint64_t errors = 0;
+    for (const auto& aggregate : read.staged) {
+        if (aggregate.offset > length || aggregate.length > length - aggregate.offset) {
+            continue;
+        }
+        const uint8_t* begin = data + aggregate.offset;
+        // 分发时已校验过的聚合不再重复计算
+        if (aggregate.checksum && std::none_of(passed.begin(), passed.end(), [&](const AggregateCheck* check) {
+                return check->offset == aggregate.offset; })) {
+            verified += aggregate.length;
+            if (crc32c::value(begin, aggregate.length) != *aggregate.checksum) {
+                ++errors;
+                continue;
+            }
+        }
+        if (config_.staging->put(StagingCache::aggregateKey(aggregate.aggregate_id), begin, aggregate.length,
+                                 config_.recall_cost_seconds)) {
+            ++staged;
+        }
+    }
+    MutexLockGuard autoLock(mutex_);
+    stats_.staged_aggregates += staged;
+    stats_.bytes_verified += verified;
+    stats_.checksum_errors += errors;
+}
+
+bool ReadCoalescer::fail(uint64_t operation_id)
+{
+    InflightRead read;
+    if (!takeInflight(operation_id, read)) {
+        return false;
+    }
+    for (auto& waiter : read.waiters) {
+        waiter.done(false, nullptr, 0);
+    }
+    return true;
+}
+
+ReadCoalescer::Stats ReadCoalescer::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return stats_;
+}
+
+std::vector<TapeDrivesOperation> ReadCoalescer::sealLocked()
+{
+    std::vector<TapeDrivesOperation> ops;
+    const uint64_t block_size = config_.block_size;
+    for (auto& tape : pending_) {
+        auto it = tape.second.begin();
+        while (it != tape.second.end()) {
+            // 以当前聚合开始一次读，向后吸收相邻的聚合
+            uint64_t start, end;
+            span(it->second, start, end);
+            auto last = it;
+            for (++last; last != tape.second.end(); ++last) {
+                uint64_t begin, finish;
+                span(last->second, begin, finish);
+                const uint64_t aligned_end = (end + block_size - 1) / block_size * block_size;
+                if (begin > aligned_end + config_.max_gap_blocks * block_size) {
+                    break;
+                }
+                if (std::max(end, finish) - start > config_.max_read_length) {
+                    break;
+                }
+                end = std::max(end, finish);
+            }
+
+            const uint64_t operation_id = next_id_++;
+            InflightRead& read = inflight_[operation_id];
+            for (; it != last; ++it) {
+                const auto& location = it->second.location;
+                const uint64_t base = location.block_position * block_size;
+                uint64_t begin, finish;
+                const bool whole = span(it->second, begin, finish);
+                for (auto& waiter : it->second.waiters) {
+                    if (waiter.frame) {
+                        *waiter.frame += base - start;
+                    } else {
+                        waiter.offset = base + waiter.offset - start;
+                    }
+                    read.waiters.push_back(std::move(waiter));
+                }
+                auto key = std::make_pair(tape.first, location.aggregate_id);
+                inflight_index_[key] = InflightAggregate{operation_id, start, begin, finish, whole};
+                if (whole && location.checksum && !location.compressed) {
+                    read.checks.push_back(AggregateCheck{base - start, location.length, *location.checksum});
+                }
+                if (whole && config_.staging && !location.compressed) {
+                    read.staged.push_back(StagedAggregate{location.aggregate_id, base - start, location.length,
+                                                          location.checksum});
+                }
+                read.aggregates.push_back(std::move(key));
+                ++stats_.aggregates_read;
+            }
+
+            TapeDrivesOperation op(TypeOperation::READ_AGGR, tape.first);
+            op.setPosition(start / block_size);
+            op.setLength(end - start);
+            op.setOperationId(operation_id);
+            ops.push_back(std::move(op));
+            ++stats_.reads_issued;
+            stats_.bytes_read += end - start;
+        }
+    }
+    pending_.clear();
+    return ops;
+}
+
+bool ReadCoalescer::span(const PendingAggregate& aggregate, uint64_t& begin, uint64_t& end) const
+{
+    const AggregateLocation& location = aggregate.location;
+    begin = location.block_position * config_.block_size;
+    end = begin + location.length;
+    const bool whole = !config_.member_reads || location.compressed ||
+                       (location.checksum && std::any_of(aggregate.waiters.begin(), aggregate.waiters.end(),
+                                                         [](const Waiter& waiter) { return !waiter.checksum; }));
+    if (whole || aggregate.waiters.empty()) {
+        return true;
+    }
+    uint64_t first = location.length;
+    uint64_t last = 0;
+    for (const auto& waiter : aggregate.waiters) {
+        first = std::min(first, waiter.offset);
+        last = std::max(last, waiter.offset + waiter.length);
+    }
+    // 从第一个成员所在的块开始读
+    end = begin + last;
+    begin += first / config_.block_size * config_.block_size;
+    return begin == location.block_position * config_.block_size && last == location.length;
+}
+
+bool ReadCoalescer::takeInflight(uint64_t operation_id, InflightRead& read)
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = inflight_.find(operation_id);
+    if (it == inflight_.end()) {
+        return false;
+    }
+    read = std::move(it->second);
+    inflight_.erase(it);
+    for (const auto& key : read.aggregates) {
+        auto index = inflight_index_.find(key);
+        if (index != inflight_index_.end() && index->second.operation_id == operation_id) {
+            inflight_index_.erase(index);
+        }
+    }
+    return true;
+}
+
+void ReadCoalescer::run()
+{
+    const double window = std::chrono::duration<double>(config_.window).count();
+    while (true) {
+        std::vector<TapeDrivesOperation> ops;
+        {
+            MutexLockGuard autoLock(mutex_);
+            if (!running_) {
+                break;
+            }
+            if (pending_.empty()) {
+                cond_.wait();
+                continue;
+            }
+            double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - oldest_).count();
+            if (waited < window) {
+                cond_.waitForSeconds(window - waited);
+                continue;
+            }
+            ops = sealLocked();
+        }
+        for (const auto& op : ops) {
+            emit(op);
+        }
+    }
+}
+
+void ReadCoalescer::emit(const TapeDrivesOperation& op)
+{
+    if (sink_) {
+        sink_(op);
+    } else {
+        TapeDrivesQueue::getInstance().push_back(op);
+    }
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "shared/thread/Thread.hpp"
+#include "TapeDrivesOperation.hpp"
+
+class StagingCache;
+
+/**
+ * @brief 聚合在磁带上的位置。聚合总是从块边界开始存放。
+ */
+struct AggregateLocation {
+    std::string tape_id;      ///< 所在磁带
+    uint64_t aggregate_id;    ///< 聚合 ID
+    uint64_t block_position;  ///< 起始块号
+    uint64_t length;          ///< 聚合长度（字节）
+    std::optional<uint32_t> checksum; ///< 整个聚合的 CRC32C，为空时不做聚合级校验
+    bool compressed = false;  ///< 聚合以分块压缩帧存储（length 为帧长），成员偏移指未压缩数据
+};
+
+/**
+ * @brief 读聚合合并器：把并发的成员读取请求合并成尽量少的 READ_AGGR 顺序读。
+ *
+ * 多个任务读取同一聚合中的不同成员时，逐个发出读操作会让驱动器反复定位同一段磁带。
+ * ReadCoalescer 在一个合并窗口内收集请求：
+ * - 同一聚合的请求只读一次；
+ * - 同一磁带上相邻（间隔不超过 max_gap_blocks 个块）的聚合合并成一次连续读，总长度不超过 max_read_length；
+ * - 对已经发出、尚未完成的读，新请求直接挂到该读上，不再产生新的操作。
+ *
+ * 每次读生成一个带 operation_id 的 READ_AGGR 操作（block_position 为起始块，length 为读取字节数）交给 sink。
+ * 执行方读完后调用 complete()（或 fail()），合并器把各成员在读取数据中的区间分发给等待的任务。
+ * 分发回调在锁外调用，data 只在回调期间有效。
+ *
+ * 分发前校验 CRC32C：带成员校验和的请求只校验自己的区间；聚合中有请求不带校验和、且聚合位置带校验和时，
+ * 校验整个聚合。校验失败的请求以失败回调。
+ *
+ * 压缩的聚合（AggregateLocation::compressed）读回的是 BlockFrame 帧：每个请求只解压与自己相交的块，
+ * 块自带校验和，因此不做聚合级校验。
+ *
+ * 配置 member_reads 时，只读取聚合中被请求的成员覆盖的区间：从第一个成员所在的块开始，
+ * 到最后一个成员结束为止（AggregateFormat 的成员按块或 4 KiB 对齐，定位后几乎没有多读的数据）。
+ * 需要聚合级校验的聚合（有请求不带成员校验和）和压缩的聚合仍读取整个聚合。
+ *
+ * 配置 staging 时，完整读到的未压缩聚合在分发后写入暂存盘（StagingCache::aggregateKey()），
+ * 之后对该聚合中成员的请求直接从暂存盘交付，不再产生 READ_AGGR。写入暂存盘前校验聚合的 CRC32C（若有）。
+ */
+class ReadCoalescer
+: NonCopyable
+{
+public:
+    using Sink = std::function<void(const TapeDrivesOperation& op)>;
+
+    /**
+     * @brief 成员数据分发回调。
+     *
+     * @param ok 读取是否成功。
+     * @param data 成员数据，失败时为 nullptr。
+     * @param length 成员长度，失败时为 0。
+     */
+    using Delivery = std::function<void(bool ok, const uint8_t* data, size_t length)>;
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        uint64_t block_size = 256 * 1024;                                 ///< 磁带块大小（字节）
+        uint64_t max_gap_blocks = 0;                                      ///< 合并时允许跳过的最大空隙（块）
+        uint64_t max_read_length = 4ULL << 30;                            ///< 单次读取的最大长度（字节）
+        std::chrono::milliseconds window = std::chrono::milliseconds(20); ///< 合并窗口
+        uint64_t first_operation_id = 1;                                  ///< 第一个读操作的 ID
+        bool member_reads = false;                                        ///< 只读取被请求成员覆盖的块
+        StagingCache* staging = nullptr;                                  ///< 召回暂存盘，为空时不使用
+        double recall_cost_seconds = 60.0;                                ///< 暂存的聚合被淘汰后重新召回的代价（秒）
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t requests = 0;          ///< 成员读取请求数
+        uint64_t reads_issued = 0;      ///< 发出的 READ_AGGR 操作数
+        uint64_t aggregates_read = 0;   ///< 被读取的聚合数（同一聚合每次读计一次）
+        uint64_t attached_inflight = 0; ///< 挂到已发出读上的请求数
+        uint64_t bytes_read = 0;        ///< 发出的读取总字节数
+        uint64_t bytes_verified = 0;    ///< 校验过 CRC32C 的字节数
+        uint64_t checksum_errors = 0;   ///< 校验失败的聚合数和成员数
+        uint64_t staged_hits = 0;       ///< 直接从暂存盘交付的请求数
+        uint64_t staged_aggregates = 0; ///< 写入暂存盘的聚合数
+    };
+
+    /**
+     * @brief 构造函数，启动合并窗口线程。
+     *
+     * @param config 配置项。
+     * @param sink 发出 READ_AGGR 操作的回调，为空时放入 TapeDrivesQueue::getInstance()。
+     */
+    explicit ReadCoalescer(const Config& config, Sink sink = Sink());
+
+    /**
+     * @brief 析构函数，发出窗口内剩余的请求并停止窗口线程。未完成的读不会再回调。
+     */
+    ~ReadCoalescer();
+
+    /**
+     * @brief 请求读取聚合中的一个成员。
+     *
+     * 区间超出聚合长度时立即以失败回调。
+     *
+     * @param job_id 请求的任务 ID。
+     * @param aggregate 聚合位置。
+     * @param offset 成员在聚合中的偏移。
+     * @param length 成员长度。
+     * @param done 数据分发回调。
+     * @param checksum 成员数据的 CRC32C（见 AggregateMember::checksum），为空时不校验成员。
+     */
+    void read(const std::string& job_id, const AggregateLocation& aggregate,
+              uint64_t offset, uint64_t length, Delivery done,
+              std::optional<uint32_t> checksum = std::nullopt);
+
+    /**
+     * @brief 立即发出窗口内的所有请求。
+     */
+    void flush();
+
+    /**
+     * @brief 读操作完成，把数据分发给等待的任务。
+     *
+     * @param operation_id READ_AGGR 操作的 ID。
+     * @param data 从 block_position 开始读到的数据。
+     * @param length 数据长度，短于成员区间的成员以失败回调。
+     * @return true 找到该读操作。
+     * @return false 未知的操作 ID。
+     */
+    bool complete(uint64_t operation_id, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 读操作失败，所有等待的任务以失败回调。
+     *
+     * @param operation_id READ_AGGR 操作的 ID。
+     * @return true 找到该读操作。
+     * @return false 未知的操作 ID。
+     */
+    bool fail(uint64_t operation_id);
+
+    /**
+     * @brief 获取统计信息。
+     */
+    Stats stats() const;
+
+private:
+    /**
+     * @brief 等待成员数据的任务。
+     */
+    struct Waiter {
+        std::string job_id;
+        uint64_t offset;   ///< 窗口内为聚合内偏移，发出后为读取数据内偏移（压缩聚合始终为未压缩数据内的偏移）
+        uint64_t length;
+        Delivery done;
+        std::optional<uint32_t> checksum;
+        std::optional<uint64_t> frame;  ///< 压缩聚合：帧在读取数据中的偏移
+    };
+
+    /**
+     * @brief 窗口内某个聚合的请求。
+     */
+    struct PendingAggregate {
+        AggregateLocation location;
+        std::vector<Waiter> waiters;
+    };
+
+    /**
+     * @brief 读取数据中一个带校验和的聚合。
+     */
+    struct AggregateCheck {
+        uint64_t offset;    ///< 聚合在读取数据中的偏移
+        uint64_t length;
+        uint32_t checksum;
+    };
+
+    /**
+     * @brief 已发出的读中的一个聚合（位置均为磁带上的字节位置）。
+     */
+    struct InflightAggregate {
+        uint64_t operation_id;
+        uint64_t read_start;    ///< 读取的起点
+        uint64_t begin;         ///< 读取覆盖的聚合区间 [begin, end)
+        uint64_t end;
+        bool whole;             ///< 读取了整个聚合
+    };
+
+    /**
+     * @brief 读取数据中一个完整的未压缩聚合，读完后写入暂存盘。
+     */
+    struct StagedAggregate {
+        uint64_t aggregate_id;
+        uint64_t offset;    ///< 聚合在读取数据中的偏移
+        uint64_t length;
+        std::optional<uint32_t> checksum;
+    };
+
+    /**
+     * @brief 已发出、尚未完成的读。
+     */
+    struct InflightRead {
+        std::vector<Waiter> waiters;
+        std::vector<std::pair<std::string, uint64_t>> aggregates; ///< (tape_id, aggregate_id)
+        std::vector<AggregateCheck> checks;
+        std::vector<StagedAggregate> staged;
+    };
+
+    /**
+     * @brief 在持锁状态下把窗口内的请求合并成读操作。
+     */
+    std::vector<TapeDrivesOperation> sealLocked();
+
+    /**
+     * @brief 一个聚合需要读取的磁带字节区间 [begin, end)。
+     *
+     * @return bool 是否读取整个聚合。
+     */
+    bool span(const PendingAggregate& aggregate, uint64_t& begin, uint64_t& end) const;
+
+    /**
+     * @brief 从暂存盘交付请求。
+     *
+     * @return bool 未命中或校验失败时返回 false，请求照常从磁带读取。
+     */
+    bool readStaged(const AggregateLocation& aggregate, uint64_t offset, uint64_t length,
+                    const Delivery& done, const std::optional<uint32_t>& checksum);
+
+    /**
+     * @brief 把读到的完整聚合写入暂存盘。
+     */
+    void stage(const InflightRead& read, const uint8_t* data, size_t length,
+               const std::vector<const AggregateCheck*>& passed);
+
+    /**
+     * @brief 取出一个已发出的读。
+     */
+    bool takeInflight(uint64_t operation_id, InflightRead& read);
+
+    /**
+     * @brief 合并窗口线程主循环。
+     */
+    void run();
+
+    void emit(const TapeDrivesOperation& op);
+
+    using AggregateKey = std::pair<uint64_t, uint64_t>; ///< (block_position, aggregate_id)
+
+    const Config config_;
+    Sink sink_;
+    mutable MutexLock mutex_;
+    Condition cond_;
+    std::map<std::string, std::map<AggregateKey, PendingAggregate>> pending_; ///< 按磁带、块号排序的窗口内请求
+    std::chrono::steady_clock::time_point oldest_;                           ///< 窗口内最早请求的时间
+    std::map<uint64_t, InflightRead> inflight_;                              ///< operation_id -> 已发出的读
+    std::map<std::pair<std::string, uint64_t>, InflightAggregate> inflight_index_; ///< (tape_id, aggregate_id) -> 正在读取该聚合的读
+    uint64_t next_id_;          ///< 下一个读操作 ID
+    Stats stats_;
+    bool running_;              ///< 窗口线程是否运行中
+    Thread timer_;              ///< 合并窗口线程
+};
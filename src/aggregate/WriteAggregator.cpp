@@ -0,0 +1,176 @@
+#include "WriteAggregator.hpp"
+#include "AggregateFormat.hpp"
+#include "Crc32c.hpp"
+#include "TapeDrivesQueue.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+WriteAggregator::WriteAggregator(const Config& config, Sink sink)
+: config_(config)
+, sink_(std::move(sink))
+, cond_(mutex_)
+, draining_(false)
+, next_id_(config.first_aggregate_id)
+, emitted_(0)
+, running_(true)
+, timer_([this] { run(); })
+{
+    timer_.start();
+}
+
+WriteAggregator::~WriteAggregator()
+{
+    {
+        MutexLockGuard autoLock(mutex_);
+        running_ = false;
+        cond_.notify();
+    }
+    timer_.join();
+    flush();
+}
+
+void WriteAggregator::add(const std::string& job_id, const std::string& object_key,
+                          const uint8_t* data, size_t length)
+{
+    if (config_.self_describing && object_key.size() > AggregateFormat::kMaxKeyLength) {
+        // 在调用方线程拒绝，否则要到封口（可能在定时线程中）时才由 AggregateFormat::finish 发现
+        throw std::length_error("object key too long for aggregate index: " + std::to_string(object_key.size()));
+    }
+    bool sealed = false;
+    // 成员校验和在锁外计算，聚合的校验和由成员校验和拼接得到，数据只需扫描一遍
+    const uint32_t checksum = crc32c::value(data, length);
+    {
+        MutexLockGuard autoLock(mutex_);
+        // 放不下时先封口当前聚合；超大对象在封口后单独成为一个聚合
+        if (!open_.members.empty() && open_.payload->size() + length > config_.target_size) {
+            sealed = sealLocked();
+        }
+        if (open_.members.empty()) {
+            open_.payload = std::make_shared<std::vector<uint8_t>>();
+            open_.payload->reserve(std::min<uint64_t>(config_.target_size, std::max<uint64_t>(length, 1 << 20)));
+            if (config_.self_describing) {
+                AggregateFormat::begin(*open_.payload, config_.alignment);
+            }
+            open_.checksum = 0;
+            open_.oldest = std::chrono::steady_clock::now();
+            cond_.notify(); // 定时线程开始为新聚合计时
+        }
+        uint64_t offset = open_.payload->size();
+        if (config_.self_describing) {
+            const uint64_t end = offset;
+            offset = AggregateFormat::append(*open_.payload, config_.alignment, data, length);
+            open_.checksum = crc32c::extend(open_.checksum, open_.payload->data() + end, offset - end); // 对齐填充
+        } else {
+            open_.payload->insert(open_.payload->end(), data, data + length);
+        }
+        open_.members.push_back(AggregateMember{object_key, job_id, offset, length, checksum});
+        open_.checksum = crc32c::combine(open_.checksum, checksum, length);
+        if (open_.payload->size() >= config_.target_size) {
+            sealed = sealLocked() || sealed;
+        }
+    }
+    if (sealed) {
+        drain();
+    }
+}
+
+void WriteAggregator::flush()
+{
+    {
+        MutexLockGuard autoLock(mutex_);
+        sealLocked();
+    }
+    drain();
+}
+
+uint64_t WriteAggregator::aggregatesEmitted() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return emitted_;
+}
+
+bool WriteAggregator::sealLocked()
+{
+    if (open_.members.empty()) {
+        return false;
+    }
+    auto aggregate = std::make_shared<AggregateInfo>();
+    aggregate->aggregate_id = next_id_++;
+    if (config_.self_describing) {
+        // 追加成员索引并回填聚合头，聚合头的校验和在最后拼接到前面
+        std::vector<uint8_t>& image = *open_.payload;
+        const uint64_t end = image.size();
+        AggregateFormat::finish(image, aggregate->aggregate_id, config_.alignment, open_.members);
+        open_.checksum = crc32c::extend(open_.checksum, image.data() + end, image.size() - end);
+        const uint64_t data_offset = AggregateFormat::dataOffset(config_.alignment);
+        open_.checksum = crc32c::combine(crc32c::value(image.data(), data_offset), open_.checksum,
+                                         image.size() - data_offset);
+    }
+    aggregate->members = std::move(open_.members);
+    aggregate->payload = std::move(open_.payload);
+    aggregate->checksum = open_.checksum;
+    open_.members.clear();
+    open_.payload.reset();
+
+    TapeDrivesOperation op(TypeOperation::WRITE_AGGR, config_.tape_id);
+    op.setAggregate(std::move(aggregate));
+    sealed_.push_back(std::move(op));
+    ++emitted_;
+    return true;
+}
+
+void WriteAggregator::drain()
+{
+    mutex_.lock();
+    if (draining_) {
+        mutex_.unlock();
+        return;
+    }
+    draining_ = true;
+    while (!sealed_.empty()) {
+        TapeDrivesOperation op = std::move(sealed_.front());
+        sealed_.pop_front();
+        mutex_.unlock();
+        emit(op);
+        mutex_.lock();
+    }
+    draining_ = false;
+    mutex_.unlock();
+}
+
+void WriteAggregator::run()
+{
+    const double latency = std::chrono::duration<double>(config_.max_latency).count();
+    while (true) {
+        bool sealed = false;
+        {
+            MutexLockGuard autoLock(mutex_);
+            if (!running_) {
+                break;
+            }
+            if (open_.members.empty()) {
+                cond_.wait();
+                continue;
+            }
+            double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - open_.oldest).count();
+            if (waited < latency) {
+                cond_.waitForSeconds(latency - waited);
+                continue;
+            }
+            sealed = sealLocked();
+        }
+        if (sealed) {
+            drain();
+        }
+    }
+}
+
+void WriteAggregator::emit(const TapeDrivesOperation& op)
+{
+    if (sink_) {
+        sink_(op);
+    } else {
+        TapeDrivesQueue::getInstance().push_back(op);
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "shared/thread/Thread.hpp"
+#include "TapeDrivesOperation.hpp"
+
+/**
+ * @brief 写聚合引擎：把来自多个任务的小对象打包成大聚合，每个聚合生成一个 WRITE_AGGR 操作。
+ *
+ * 逐个写入小文件会让磁带无法保持流式写入。WriteAggregator 将对象数据依次追加到当前打开的聚合中，
+ * 并记录每个成员的偏移和长度（成员索引随 WRITE_AGGR 操作一起下发），在以下情况下封口并发出：
+ * - 聚合大小达到 target_size；
+ * - 聚合中最早的对象已等待超过 max_latency（由后台定时线程检查）；
+ * - 显式调用 flush() 或析构。
+ * 大于 target_size 的对象单独成为一个聚合。
+ *
+ * 每个成员和整个聚合都带 CRC32C 校验和（AggregateMember::checksum、AggregateInfo::checksum），
+ * 读取时可以只校验读到的成员。
+ *
+ * 配置 self_describing 时聚合数据按 AggregateFormat 组织：开头是聚合头，成员按 alignment 对齐，
+ * 末尾是成员索引，成员偏移即在该镜像中的偏移。否则成员紧密相连，没有头和索引。
+ *
+ * 发出的操作交给 sink 处理，默认放入 TapeDrivesQueue::getInstance()。sink 在锁外调用。
+ * 封口的操作先按聚合 ID 顺序放入发出队列，同一时刻只有一个线程从队首依次发出（与 CompressionPipeline 相同），
+ * 多个线程同时封口时 sink 收到的 WRITE_AGGR 仍按聚合 ID 递增，磁带上的布局和目录依赖这一顺序。
+ * 其他线程正在发出时，本线程封口的操作由该线程发出，add()/flush() 可能在其发出之前返回。
+ */
+class WriteAggregator
+: NonCopyable
+{
+public:
+    using Sink = std::function<void(const TapeDrivesOperation& op)>;
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        uint64_t target_size = 1ULL << 30;                            ///< 聚合目标大小（字节）
+        std::chrono::milliseconds max_latency = std::chrono::seconds(60); ///< 对象在聚合中的最长等待时间
+        std::string tape_id;                                          ///< WRITE_AGGR 的目标磁带，为空时由调度器决定
+        uint64_t first_aggregate_id = 1;                              ///< 第一个聚合的 ID
+        bool self_describing = false;                                 ///< 按 AggregateFormat 生成带头和成员索引的聚合
+        uint32_t alignment = 4096;                                    ///< self_describing 时成员的对齐（字节）
+    };
+
+    /**
+     * @brief 构造函数，启动定时刷新线程。
+     *
+     * @param config 配置项。
+     * @param sink 发出 WRITE_AGGR 操作的回调，为空时放入 TapeDrivesQueue::getInstance()。
+     */
+    explicit WriteAggregator(const Config& config, Sink sink = Sink());
+
+    /**
+     * @brief 析构函数，发出未封口的聚合并停止定时线程。
+     */
+    ~WriteAggregator();
+
+    /**
+     * @brief 添加一个对象。
+     *
+     * @param job_id 提交该对象的任务 ID。
+     * @param object_key 对象键。
+     * @param data 对象数据。
+     * @param length 数据长度。
+     * @throws std::length_error self_describing 时对象键超过 AggregateFormat::kMaxKeyLength，对象不会加入聚合。
+     */
+    void add(const std::string& job_id, const std::string& object_key, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 立即封口并发出当前聚合（为空时不做任何操作）。
+     */
+    void flush();
+
+    /**
+     * @brief 已发出的聚合数。
+     */
+    uint64_t aggregatesEmitted() const;
+
+private:
+    /**
+     * @brief 正在打包的聚合。
+     */
+    struct OpenAggregate {
+        std::vector<AggregateMember> members;
+        std::shared_ptr<std::vector<uint8_t>> payload;
+        uint32_t checksum = 0;                         ///< 已加入数据的 CRC32C（self_describing 时不含聚合头）
+        std::chrono::steady_clock::time_point oldest;  ///< 第一个成员加入的时间
+    };
+
+    /**
+     * @brief 在持锁状态下封口当前聚合，操作放入发出队列（聚合为空时返回 false）。
+     */
+    bool sealLocked();
+
+    /**
+     * @brief 按顺序发出队列中的操作。同一时刻只有一个线程执行，其余调用直接返回。
+     */
+    void drain();
+
+    /**
+     * @brief 定时线程主循环。
+     */
+    void run();
+
+    void emit(const TapeDrivesOperation& op);
+
+    const Config config_;
+    Sink sink_;
+    mutable MutexLock mutex_;
+    Condition cond_;
+    OpenAggregate open_;        ///< 当前打开的聚合
+    std::deque<TapeDrivesOperation> sealed_; ///< 已封口、待发出的操作（按聚合 ID 排列）
+    bool draining_;             ///< 有线程正在发出操作
+    uint64_t next_id_;          ///< 下一个聚合 ID
+    uint64_t emitted_;          ///< 已发出的聚合数
+    bool running_;              ///< 定时线程是否运行中
+    Thread timer_;              ///< 定时刷新线程
+};
@@ -0,0 +1,307 @@
+#include "CatalogIndex.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    constexpr char kSegmentPrefix[] = "catalog-";
+    constexpr char kSegmentSuffix[] = ".seg";
+
+    bool hasSuffix(const std::string& name, const std::string& suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+}
+
+CatalogIndex::CatalogIndex(const std::string& directory)
+: CatalogIndex(directory, Config())
+{
+}
+
+CatalogIndex::CatalogIndex(const std::string& directory, const Config& config)
+: directory_(directory)
+, config_(config)
+, next_sequence_(1)
+{
+    if (mkdir(directory_.c_str(), 0755) < 0 && errno != EEXIST) {
+        throw std::runtime_error("mkdir failed: " + directory_);
+    }
+    DIR* dir = opendir(directory_.c_str());
+    if (!dir) {
+        throw std::runtime_error("opendir failed: " + directory_);
+    }
+    std::vector<std::string> names;
+    while (struct dirent* ent = readdir(dir)) {
+        names.emplace_back(ent->d_name);
+    }
+    closedir(dir);
+
+    for (const auto& name : names) {
+        const std::string path = directory_ + "/" + name;
+        if (hasSuffix(name, std::string(kSegmentSuffix) + ".tmp")) {
+            ::unlink(path.c_str()); // 写了一半的段
+        } else if (name.rfind(kSegmentPrefix, 0) == 0 && hasSuffix(name, kSegmentSuffix)) {
+            segments_.push_back(std::make_shared<const CatalogSegment>(path));
+        }
+    }
+    std::sort(segments_.begin(), segments_.end(),
+              [](const SegmentPtr& a, const SegmentPtr& b) { return a->sequence() > b->sequence(); });
+    if (!segments_.empty()) {
+        next_sequence_ = segments_.front()->sequence() + 1;
+    }
+}
+
+CatalogIndex::~CatalogIndex()
+{
+    MutexLockGuard autoLock(mutex_);
+    try {
+        flushLocked();
+    } catch (const std::exception&) {
+        // 析构时无法报告错误，未写出的记录丢失
+    }
+}
+
+void CatalogIndex::insert(const std::string& object_key, const CatalogEntry& entry)
+{
+    MutexLockGuard autoLock(mutex_);
+    memtable_[object_key] = entry;
+    ++stats_.inserts;
+    if (memtable_.size() >= config_.memtable_limit) {
+        flushLocked();
+    }
+}
+
+void CatalogIndex::insertAggregate(const std::string& tape_id, uint64_t block_position, const AggregateInfo& aggregate)
+{
+    uint64_t aggregate_length = aggregate.payload ? aggregate.payload->size() : 0;
+    // 压缩聚合在磁带上的长度就是帧长，成员偏移指未压缩数据
+    if (!aggregate.compressed) {
+        for (const auto& member : aggregate.members) {
+            aggregate_length = std::max(aggregate_length, member.offset + member.length);
+        }
+    }
+
+    MutexLockGuard autoLock(mutex_);
+    for (const auto& member : aggregate.members) {
+        CatalogEntry& entry = memtable_[member.object_key];
+        entry.tape_id = tape_id;
+        entry.aggregate_id = aggregate.aggregate_id;
+        entry.block_position = block_position;
+        entry.aggregate_length = aggregate_length;
+        entry.offset = member.offset;
+        entry.length = member.length;
+        entry.checksum = member.checksum;
+        entry.compressed = aggregate.compressed;
+    }
+    stats_.inserts += aggregate.members.size();
+    if (memtable_.size() >= config_.memtable_limit) {
+        flushLocked();
+    }
+}
+
+void CatalogIndex::erase(const std::string& object_key)
+{
+    MutexLockGuard autoLock(mutex_);
+    CatalogEntry& entry = memtable_[object_key];
+    entry = CatalogEntry();
+    entry.deleted = true;
+    ++stats_.erases;
+    if (memtable_.size() >= config_.memtable_limit) {
+        flushLocked();
+    }
+}
+
+std::optional<CatalogEntry> CatalogIndex::lookup(const std::string& object_key) const
+{
+    std::vector<SegmentPtr> segments;
+    {
+        MutexLockGuard autoLock(mutex_);
+        ++stats_.point_lookups;
+        ++stats_.keys_looked_up;
+        auto it = memtable_.find(object_key);
+        if (it != memtable_.end()) {
+            if (it->second.deleted) {
+                return std::nullopt;
+            }
+            ++stats_.hits;
+            return it->second;
+        }
+        segments = segments_;
+    }
+
+    // 段是只读的，在锁外查找；最新的记录是删除标记时不再查更旧的段
+    CatalogEntry entry;
+    for (const auto& segment : segments) {
+        if (segment->find(object_key, entry)) {
+            if (entry.deleted) {
+                return std::nullopt;
+            }
+            MutexLockGuard autoLock(mutex_);
+            ++stats_.hits;
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::optional<CatalogEntry>> CatalogIndex::lookupBatch(const std::vector<std::string>& keys) const
+{
+    std::vector<std::optional<CatalogEntry>> results(keys.size());
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::vector<SegmentPtr> segments;
+    std::vector<size_t> pending; // 按键升序排列、尚未找到的键
+    {
+        MutexLockGuard autoLock(mutex_);
+        for (size_t index : order) {
+            auto it = memtable_.find(keys[index]);
+            if (it != memtable_.end()) {
+                results[index] = it->second;
+            } else {
+                pending.push_back(index);
+            }
+        }
+        segments = segments_;
+    }
+
+    for (const auto& segment : segments) {
+        if (pending.empty()) {
+            break;
+        }
+        std::vector<size_t> missing;
+        size_t cursor = 0;
+        for (size_t index : pending) {
+            cursor = segment->lowerBound(keys[index], cursor);
+            if (cursor < segment->size() && segment->keyAt(cursor) == keys[index]) {
+                results[index] = segment->entryAt(cursor);
+            } else {
+                missing.push_back(index);
+            }
+        }
+        pending.swap(missing);
+    }
+
+    // 删除标记已经遮盖了更旧的段，查找结束后再去掉
+    for (auto& result : results) {
+        if (result && result->deleted) {
+            result.reset();
+        }
+    }
+    const size_t hits = std::count_if(results.begin(), results.end(),
+                                      [](const std::optional<CatalogEntry>& result) { return result.has_value(); });
+
+    MutexLockGuard autoLock(mutex_);
+    ++stats_.batch_lookups;
+    stats_.keys_looked_up += keys.size();
+    stats_.hits += hits;
+    return results;
+}
+
+void CatalogIndex::flush()
+{
+    MutexLockGuard autoLock(mutex_);
+    flushLocked();
+}
+
+void CatalogIndex::compact()
+{
+    MutexLockGuard autoLock(mutex_);
+    flushLocked();
+    compactLocked();
+}
+
+CatalogIndex::Stats CatalogIndex::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    Stats stats = stats_;
+    stats.segments = segments_.size();
+    stats.memtable_entries = memtable_.size();
+    return stats;
+}
+
+void CatalogIndex::flushLocked()
+{
+    if (memtable_.empty()) {
+        return;
+    }
+    std::vector<std::pair<std::string, CatalogEntry>> entries(memtable_.begin(), memtable_.end());
+    const uint64_t sequence = next_sequence_++;
+    const std::string path = segmentPath(sequence);
+    CatalogSegment::write(path, sequence, entries);
+    segments_.insert(segments_.begin(), std::make_shared<const CatalogSegment>(path));
+    memtable_.clear();
+    ++stats_.flushes;
+    if (segments_.size() > config_.max_segments) {
+        compactLocked();
+    }
+}
+
+void CatalogIndex::compactLocked()
+{
+    if (segments_.size() <= 1) {
+        return;
+    }
+    // 多路归并：各段的游标按键推进，同一个键取最新段中的记录
+    std::vector<size_t> cursors(segments_.size(), 0);
+    std::vector<std::pair<std::string, CatalogEntry>> merged;
+    while (true) {
+        std::string_view smallest;
+        bool found = false;
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            if (cursors[i] < segments_[i]->size()) {
+                std::string_view key = segments_[i]->keyAt(cursors[i]);
+                if (!found || key < smallest) {
+                    smallest = key;
+                    found = true;
+                }
+            }
+        }
+        if (!found) {
+            break;
+        }
+        bool taken = false;
+        for (size_t i = 0; i < segments_.size(); ++i) { // segments_ 从新到旧
+            if (cursors[i] < segments_[i]->size() && segments_[i]->keyAt(cursors[i]) == smallest) {
+                if (!taken) {
+                    // 所有段归并为一个，删除标记遮盖的记录已不存在，标记本身也可以丢弃
+                    CatalogEntry entry = segments_[i]->entryAt(cursors[i]);
+                    if (!entry.deleted) {
+                        merged.emplace_back(std::string(smallest), std::move(entry));
+                    }
+                    taken = true;
+                }
+                ++cursors[i];
+            }
+        }
+    }
+
+    const uint64_t sequence = next_sequence_++;
+    const std::string path = segmentPath(sequence);
+    CatalogSegment::write(path, sequence, merged);
+    std::vector<SegmentPtr> old;
+    old.swap(segments_);
+    segments_.push_back(std::make_shared<const CatalogSegment>(path));
+    for (const auto& segment : old) {
+        // 正在查找的线程仍持有映射，删除文件不影响它们
+        ::unlink(segment->path().c_str());
+    }
+    ++stats_.compactions;
+}
+
+std::string CatalogIndex::segmentPath(uint64_t sequence) const
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s%016" PRIu64 "%s", kSegmentPrefix, sequence, kSegmentSuffix);
+    return directory_ + "/" + name;
+}
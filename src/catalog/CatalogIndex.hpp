@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "Aggregate.hpp"
+#include "CatalogSegment.hpp"
+
+/**
+ * @brief 磁带目录索引：对象键 -> (磁带 ID, 聚合 ID, 块位置, 偏移, 长度)，用于把召回任务翻译成 READ_AGGR。
+ *
+ * 采用 LSM 结构：
+ * - 新写入的记录先进入内存表（按键有序），达到 memtable_limit 或调用 flush() 时写成一个新的只读段文件；
+ * - 段文件按键排序、通过 mmap 访问（见 CatalogSegment），查找时按内存表、新段到旧段的顺序，先找到的为准，
+ *   因此对象被重写（如重新打包到另一盘磁带）后，新位置自动覆盖旧位置；
+ * - 段数超过 max_segments 时把所有段归并为一个，保证单点查找最多访问 max_segments + 1 个有序结构；
+ * - 删除写入一条删除标记（CatalogEntry::deleted），遮盖更旧段中的记录，所有段归并为一个时才真正丢弃。
+ *
+ * 批量查找先对键排序，再在每个段上从上一次的位置向后做指数探测，相邻键只需访问少量页面，
+ * 一个召回任务的成千上万个对象比逐个单点查找快得多。
+ *
+ * 尚未 flush() 的记录只在内存中，进程崩溃会丢失；调用方应在一批 WRITE_AGGR 完成后调用 flush()。
+ * 所有方法都是线程安全的。
+ */
+class CatalogIndex
+: NonCopyable
+{
+public:
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        size_t memtable_limit = 1 << 20;    ///< 内存表记录数上限，达到后自动写成段文件
+        size_t max_segments = 8;            ///< 段数上限，超过后归并
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t inserts = 0;           ///< 插入的记录数
+        uint64_t erases = 0;            ///< 删除的记录数
+        uint64_t point_lookups = 0;     ///< 单点查找次数
+        uint64_t batch_lookups = 0;     ///< 批量查找次数
+        uint64_t keys_looked_up = 0;    ///< 查找的键总数（单点 + 批量）
+        uint64_t hits = 0;              ///< 找到的键数
+        uint64_t flushes = 0;           ///< 写出的段数
+        uint64_t compactions = 0;       ///< 归并次数
+        size_t segments = 0;            ///< 当前段数
+        size_t memtable_entries = 0;    ///< 当前内存表中的记录数
+    };
+
+    explicit CatalogIndex(const std::string& directory);
+
+    /**
+     * @brief 打开目录中已有的段文件（目录不存在时创建），失败时抛出 std::runtime_error。
+     *
+     * @param directory 段文件所在目录。
+     * @param config 配置项。
+     */
+    CatalogIndex(const std::string& directory, const Config& config);
+
+    /**
+     * @brief 析构函数，把内存表写成段文件。
+     */
+    ~CatalogIndex();
+
+    /**
+     * @brief 插入或覆盖一条记录。
+     */
+    void insert(const std::string& object_key, const CatalogEntry& entry);
+
+    /**
+     * @brief WRITE_AGGR 完成后批量插入聚合中的所有成员。
+     *
+     * @param tape_id 聚合写入的磁带。
+     * @param block_position 聚合在磁带上的起始块号。
+     * @param aggregate 聚合（成员的偏移和长度）。
+     */
+    void insertAggregate(const std::string& tape_id, uint64_t block_position, const AggregateInfo& aggregate);
+
+    /**
+     * @brief 删除一条记录（对象被删除）。键不存在时也写入删除标记。
+     */
+    void erase(const std::string& object_key);
+
+    /**
+     * @brief 单点查找。
+     */
+    std::optional<CatalogEntry> lookup(const std::string& object_key) const;
+
+    /**
+     * @brief 批量查找，结果与 keys 一一对应，不存在的键为 std::nullopt。
+     */
+    std::vector<std::optional<CatalogEntry>> lookupBatch(const std::vector<std::string>& keys) const;
+
+    /**
+     * @brief 把内存表写成一个新的段文件（内存表为空时什么也不做）。
+     */
+    void flush();
+
+    /**
+     * @brief 把内存表和所有段归并为一个段。
+     */
+    void compact();
+
+    Stats stats() const;
+
+private:
+    using SegmentPtr = std::shared_ptr<const CatalogSegment>;
+
+    void flushLocked();
+    void compactLocked();
+    std::string segmentPath(uint64_t sequence) const;
+
+    const std::string directory_;
+    const Config config_;
+    mutable MutexLock mutex_;
+    std::map<std::string, CatalogEntry> memtable_;  ///< 尚未写出的记录
+    std::vector<SegmentPtr> segments_;              ///< 段，按序号从新到旧
+    uint64_t next_sequence_;                        ///< 下一个段序号
+    mutable Stats stats_;
+};
@@ -0,0 +1,258 @@
+#include "CatalogSegment.hpp"
+#include "codec/ByteOrder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    constexpr char kMagic[8] = {'T', 'C', 'A', 'T', 'S', 'E', 'G', '1'};
+    constexpr uint32_t kVersion = 2;
+    constexpr size_t kEntrySizeV1 = 64;     ///< 版本 1 的记录没有校验和
+
+    // Header 字段偏移
+    constexpr size_t kVersionOffset = 8;
+    constexpr size_t kCountOffset = 16;
+    constexpr size_t kEntriesOffset = 24;
+    constexpr size_t kStringsOffset = 32;
+    constexpr size_t kStringsSizeOffset = 40;
+    constexpr size_t kSequenceOffset = 48;
+
+    // Entry 字段偏移
+    constexpr size_t kKeyOffset = 0;
+    constexpr size_t kKeyLength = 8;
+    constexpr size_t kTapeLength = 12;
+    constexpr size_t kTapeOffset = 16;
+    constexpr size_t kAggregateId = 24;
+    constexpr size_t kBlockPosition = 32;
+    constexpr size_t kAggregateLength = 40;
+    constexpr size_t kObjectOffset = 48;
+    constexpr size_t kObjectLength = 56;
+    constexpr size_t kChecksum = 64;
+    constexpr size_t kFlags = 68;
+
+    constexpr uint32_t kHasChecksum = 1;    ///< kFlags：checksum 有效
+    constexpr uint32_t kCompressed = 2;     ///< kFlags：聚合以分块压缩帧存储
+    constexpr uint32_t kDeleted = 4;        ///< kFlags：删除标记
+
+    void writeAll(int fd, const uint8_t* data, size_t length, const std::string& path) {
+        while (length > 0) {
+            ssize_t n = ::write(fd, data, length);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("write failed: " + path);
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+    }
+
+}
+
+CatalogSegment::CatalogSegment(const std::string& path)
+: path_(path)
+, base_(nullptr)
+, length_(0)
+, sequence_(0)
+, count_(0)
+, entry_size_(kEntrySize)
+, entries_(nullptr)
+, strings_(nullptr)
+, strings_size_(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("open failed: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+        ::close(fd);
+        throw std::runtime_error("catalog segment too short: " + path);
+    }
+    length_ = static_cast<size_t>(st.st_size);
+    base_ = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        throw std::runtime_error("mmap failed: " + path);
+    }
+
+    const uint8_t* header = static_cast<const uint8_t*>(base_);
+    const uint64_t count = byte_order::load<uint64_t>(header + kCountOffset);
+    const uint64_t entries = byte_order::load<uint64_t>(header + kEntriesOffset);
+    const uint64_t strings = byte_order::load<uint64_t>(header + kStringsOffset);
+    strings_size_ = byte_order::load<uint64_t>(header + kStringsSizeOffset);
+    const uint32_t version = byte_order::load<uint32_t>(header + kVersionOffset);
+    entry_size_ = version == 1 ? kEntrySizeV1 : kEntrySize;
+    if (memcmp(header, kMagic, sizeof(kMagic)) != 0 || version < 1 || version > kVersion ||
+        entries != kHeaderSize || count > (length_ - kHeaderSize) / entry_size_ ||
+        strings != entries + count * entry_size_ || strings_size_ > length_ - strings) {
+        munmap(base_, length_);
+        base_ = nullptr;
+        throw std::runtime_error("catalog segment corrupt or incompatible: " + path);
+    }
+    sequence_ = byte_order::load<uint64_t>(header + kSequenceOffset);
+    count_ = static_cast<size_t>(count);
+    entries_ = header + entries;
+    strings_ = reinterpret_cast<const char*>(header + strings);
+}
+
+CatalogSegment::~CatalogSegment()
+{
+    if (base_) {
+        munmap(base_, length_);
+    }
+}
+
+void CatalogSegment::write(const std::string& path, uint64_t sequence,
+                           const std::vector<std::pair<std::string, CatalogEntry>>& entries)
+{
+    // 字符串区：键依次存放，磁带 ID 去重
+    std::string strings;
+    std::unordered_map<std::string, uint64_t> tape_offsets;
+    std::vector<uint8_t> records(entries.size() * kEntrySize);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const std::string& key = entries[i].first;
+        const CatalogEntry& entry = entries[i].second;
+        uint8_t* p = records.data() + i * kEntrySize;
+        byte_order::store<uint64_t>(p + kKeyOffset, strings.size());
+        byte_order::store<uint32_t>(p + kKeyLength, static_cast<uint32_t>(key.size()));
+        strings += key;
+        auto tape = tape_offsets.find(entry.tape_id);
+        if (tape == tape_offsets.end()) {
+            tape = tape_offsets.emplace(entry.tape_id, strings.size()).first;
+            strings += entry.tape_id;
+        }
+        byte_order::store<uint32_t>(p + kTapeLength, static_cast<uint32_t>(entry.tape_id.size()));
+        byte_order::store<uint64_t>(p + kTapeOffset, tape->second);
+        byte_order::store<uint64_t>(p + kAggregateId, entry.aggregate_id);
+        byte_order::store<uint64_t>(p + kBlockPosition, entry.block_position);
+        byte_order::store<uint64_t>(p + kAggregateLength, entry.aggregate_length);
+        byte_order::store<uint64_t>(p + kObjectOffset, entry.offset);
+        byte_order::store<uint64_t>(p + kObjectLength, entry.length);
+        byte_order::store<uint32_t>(p + kChecksum, entry.checksum.value_or(0));
+        byte_order::store<uint32_t>(p + kFlags, (entry.checksum ? kHasChecksum : 0) |
+                                                (entry.compressed ? kCompressed : 0) |
+                                                (entry.deleted ? kDeleted : 0));
+    }
+
+    uint8_t header[kHeaderSize] = {};
+    memcpy(header, kMagic, sizeof(kMagic));
+    byte_order::store<uint32_t>(header + kVersionOffset, kVersion);
+    byte_order::store<uint64_t>(header + kCountOffset, entries.size());
+    byte_order::store<uint64_t>(header + kEntriesOffset, kHeaderSize);
+    byte_order::store<uint64_t>(header + kStringsOffset, kHeaderSize + records.size());
+    byte_order::store<uint64_t>(header + kStringsSizeOffset, strings.size());
+    byte_order::store<uint64_t>(header + kSequenceOffset, sequence);
+
+    const std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("open failed: " + tmp);
+    }
+    try {
+        writeAll(fd, header, sizeof(header), tmp);
+        writeAll(fd, records.data(), records.size(), tmp);
+        writeAll(fd, reinterpret_cast<const uint8_t*>(strings.data()), strings.size(), tmp);
+        if (fsync(fd) < 0) {
+            throw std::runtime_error("fsync failed: " + tmp);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(tmp.c_str(), path.c_str()) < 0) {
+        ::unlink(tmp.c_str());
+        throw std::runtime_error("rename failed: " + path);
+    }
+}
+
+std::string_view CatalogSegment::stringAt(uint64_t offset, uint32_t length) const
+{
+    if (offset > strings_size_ || length > strings_size_ - offset) {
+        throw std::runtime_error("catalog segment corrupt: " + path_);
+    }
+    return std::string_view(strings_ + offset, length);
+}
+
+std::string_view CatalogSegment::keyAt(size_t index) const
+{
+    const uint8_t* p = entryPtr(index);
+    return stringAt(byte_order::load<uint64_t>(p + kKeyOffset), byte_order::load<uint32_t>(p + kKeyLength));
+}
+
+CatalogEntry CatalogSegment::entryAt(size_t index) const
+{
+    const uint8_t* p = entryPtr(index);
+    CatalogEntry entry;
+    entry.tape_id = std::string(stringAt(byte_order::load<uint64_t>(p + kTapeOffset),
+                                         byte_order::load<uint32_t>(p + kTapeLength)));
+    entry.aggregate_id = byte_order::load<uint64_t>(p + kAggregateId);
+    entry.block_position = byte_order::load<uint64_t>(p + kBlockPosition);
+    entry.aggregate_length = byte_order::load<uint64_t>(p + kAggregateLength);
+    entry.offset = byte_order::load<uint64_t>(p + kObjectOffset);
+    entry.length = byte_order::load<uint64_t>(p + kObjectLength);
+    if (entry_size_ >= kEntrySize) {
+        const uint32_t flags = byte_order::load<uint32_t>(p + kFlags);
+        if (flags & kHasChecksum) {
+            entry.checksum = byte_order::load<uint32_t>(p + kChecksum);
+        }
+        entry.compressed = flags & kCompressed;
+        entry.deleted = flags & kDeleted;
+    }
+    return entry;
+}
+
+size_t CatalogSegment::lowerBound(std::string_view key, size_t first) const
+{
+    // 指数探测：找到第一个 keyAt(first + step - 1) >= key 的步长，缩小二分范围
+    size_t lo = first;
+    size_t hi = count_;
+    size_t step = 1;
+    while (lo + step <= count_ && keyAt(lo + step - 1) < key) {
+        lo += step;
+        step *= 2;
+    }
+    hi = std::min(count_, lo + step);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (keyAt(mid) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool CatalogSegment::find(std::string_view key, CatalogEntry& entry) const
+{
+    // 单点查找直接二分整个段
+    size_t lo = 0;
+    size_t hi = count_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (keyAt(mid) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == count_ || keyAt(lo) != key) {
+        return false;
+    }
+    entry = entryAt(lo);
+    return true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "shared/mutex/NonCopyable.hpp"
+
+/**
+ * @brief 对象在磁带上的位置：对象键 -> (磁带, 聚合, 偏移)。
+ */
+struct CatalogEntry {
+    std::string tape_id;            ///< 磁带 ID
+    uint64_t aggregate_id = 0;      ///< 聚合 ID
+    uint64_t block_position = 0;    ///< 聚合在磁带上的起始块号
+    uint64_t aggregate_length = 0;  ///< 聚合长度（字节）
+    uint64_t offset = 0;            ///< 对象在聚合数据中的偏移（字节）
+    uint64_t length = 0;            ///< 对象长度（字节）
+    std::optional<uint32_t> checksum; ///< 对象数据的 CRC32C（见 AggregateMember::checksum）
+    bool compressed = false;        ///< 聚合以分块压缩帧存储，offset/length 指未压缩数据
+    bool deleted = false;           ///< 删除标记：遮盖更旧段中的同键记录，查找时视为不存在
+};
+
+/**
+ * @brief 目录索引的一个只读段文件：按对象键排序的定长记录数组，通过 mmap 访问。
+ *
+ * 文件布局（小端序）：
+ * @code
+ * | Header (64 字节) | Entry[0] | Entry[1] | ... | Entry[count - 1] | 字符串区 |
+ * @endcode
+ * - Header：magic "TCATSEG1"、版本、记录数、记录区和字符串区的偏移与长度、段序号；
+ * - Entry（72 字节）：键在字符串区的偏移和长度、磁带 ID 的偏移和长度、aggregate_id、block_position、
+ *   aggregate_length、offset、length、checksum 和标志（checksum 有效、聚合已压缩、删除标记）。版本 1 的段没有最后 8 字节（64 字节），仍可读取；
+ * - 字符串区：对象键依次存放，磁带 ID 去重后只存一份。
+ *
+ * 记录定长，查找时直接在映射的内存上二分，无需反序列化整个文件；页面由内核按需换入，
+ * 段可以远大于内存。段一旦写入就不再修改，因此可以被多个线程同时读取。
+ */
+class CatalogSegment
+: NonCopyable
+{
+public:
+    static constexpr size_t kHeaderSize = 64;
+    static constexpr size_t kEntrySize = 72;    ///< 当前版本（2）的记录长度
+
+    /**
+     * @brief 映射已有的段文件，文件不存在或格式不正确时抛出 std::runtime_error。
+     *
+     * @param path 段文件路径。
+     */
+    explicit CatalogSegment(const std::string& path);
+
+    /**
+     * @brief 析构函数，解除映射（不会删除文件）。
+     */
+    ~CatalogSegment();
+
+    /**
+     * @brief 将按键升序、键不重复的记录写成段文件。
+     *
+     * 先写入临时文件并 fsync，再原子地重命名为 path，崩溃时不会留下写了一半的段。
+     * 失败时抛出 std::runtime_error。
+     *
+     * @param path 段文件路径。
+     * @param sequence 段序号，序号大的段更新。
+     * @param entries 记录（键，位置），必须按键升序。
+     */
+    static void write(const std::string& path, uint64_t sequence,
+                      const std::vector<std::pair<std::string, CatalogEntry>>& entries);
+
+    const std::string& path() const { return path_; }
+    uint64_t sequence() const { return sequence_; }
+    size_t size() const { return count_; }
+
+    /**
+     * @brief 第 index 条记录的键（指向映射内存，段存活期间有效）。
+     */
+    std::string_view keyAt(size_t index) const;
+
+    /**
+     * @brief 第 index 条记录的位置。
+     */
+    CatalogEntry entryAt(size_t index) const;
+
+    /**
+     * @brief 第一个键不小于 key 的记录下标，范围限定在 [first, size())。
+     *
+     * 从 first 开始按 1、2、4…… 的步长向后探测再二分，适合按升序批量查找：
+     * 相邻两次查找的结果很近时只需访问少量页面。
+     */
+    size_t lowerBound(std::string_view key, size_t first = 0) const;
+
+    /**
+     * @brief 查找键对应的记录。
+     *
+     * @return bool 找到时返回 true 并填充 entry。
+     */
+    bool find(std::string_view key, CatalogEntry& entry) const;
+
+private:
+    const uint8_t* entryPtr(size_t index) const { return entries_ + index * entry_size_; }
+    std::string_view stringAt(uint64_t offset, uint32_t length) const;
+
+    std::string path_;
+    void* base_;                ///< 映射起始地址
+    size_t length_;             ///< 映射长度
+    uint64_t sequence_;         ///< 段序号
+    size_t count_;              ///< 记录数
+    size_t entry_size_;         ///< 记录长度（随版本不同）
+    const uint8_t* entries_;    ///< 记录区
+    const char* strings_;       ///< 字符串区
+    uint64_t strings_size_;     ///< 字符串区长度
+};
@@ -0,0 +1,206 @@
+#include "JobIndexer.hpp"
+#include "JobQueue.hpp"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_set>
+
+std::vector<TapeDrivesOperation> JobIndexer::TapePlan::toOperations() const
+{
+    std::vector<TapeDrivesOperation> ops;
+    std::unordered_set<uint64_t> seen;
+    for (const auto& read : reads) {
+        if (!seen.insert(read.location.aggregate_id).second) {
+            continue;
+        }
+        TapeDrivesOperation op(TypeOperation::READ_AGGR, tape_id);
+        op.setPosition(read.location.block_position);
+        op.setLength(read.location.aggregate_length);
+        ops.push_back(op);
+    }
+    return ops;
+}
+
+JobIndexer::JobIndexer(CatalogIndex& catalog)
+: JobIndexer(catalog, Config())
+{
+}
+
+JobIndexer::JobIndexer(CatalogIndex& catalog, const Config& config)
+: catalog_(catalog)
+, config_(config)
+, cond_(mutex_)
+, idle_cond_(mutex_)
+, active_jobs_(0)
+, running_(true)
+{
+    const size_t workers = std::max<size_t>(1, config_.workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads_.push_back(std::make_unique<Thread>([this] { run(); }));
+        threads_.back()->start();
+    }
+}
+
+JobIndexer::~JobIndexer()
+{
+    {
+        MutexLockGuard autoLock(mutex_);
+        running_ = false;
+        cond_.notifyAll();
+    }
+    for (auto& thread : threads_) {
+        thread->join();
+    }
+}
+
+void JobIndexer::submit(const std::string& job_id, std::vector<std::string> object_keys, Completion done)
+{
+    JobQueue::getInstance().updateStatus(job_id, JobStatus::Indexing);
+
+    auto job = std::make_shared<Job>();
+    job->job_id = job_id;
+    job->keys = std::move(object_keys);
+    job->results.resize(job->keys.size());
+    job->done = std::move(done);
+    const size_t batch_size = std::max<size_t>(1, config_.batch_size);
+    job->remaining = (job->keys.size() + batch_size - 1) / batch_size;
+    if (job->remaining == 0) {
+        {
+            MutexLockGuard autoLock(mutex_);
+            ++active_jobs_;
+        }
+        finish(*job); // 空对象列表：直接生成空计划
+        return;
+    }
+
+    MutexLockGuard autoLock(mutex_);
+    ++active_jobs_;
+    for (size_t first = 0; first < job->keys.size(); first += batch_size) {
+        batches_.push_back(Batch{job, first, std::min(job->keys.size(), first + batch_size)});
+    }
+    cond_.notifyAll();
+}
+
+std::optional<JobIndexer::Plan> JobIndexer::takePlan(const std::string& job_id)
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = plans_.find(job_id);
+    if (it == plans_.end()) {
+        return std::nullopt;
+    }
+    Plan plan = std::move(it->second);
+    plans_.erase(it);
+    return plan;
+}
+
+void JobIndexer::waitIdle()
+{
+    MutexLockGuard autoLock(mutex_);
+    while (active_jobs_ > 0) {
+        idle_cond_.wait();
+    }
+}
+
+JobIndexer::Stats JobIndexer::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return stats_;
+}
+
+void JobIndexer::run()
+{
+    while (true) {
+        Batch batch;
+        {
+            MutexLockGuard autoLock(mutex_);
+            while (batches_.empty() && running_) {
+                cond_.wait();
+            }
+            if (batches_.empty()) {
+                return; // 已停止且没有剩余批次
+            }
+            batch = batches_.front();
+            batches_.pop_front();
+        }
+
+        Job& job = *batch.job;
+        std::vector<std::string> keys(job.keys.begin() + batch.first, job.keys.begin() + batch.last);
+        auto results = catalog_.lookupBatch(keys);
+        std::move(results.begin(), results.end(), job.results.begin() + batch.first);
+
+        bool last = false;
+        {
+            MutexLockGuard autoLock(mutex_);
+            ++stats_.batches;
+            last = --job.remaining == 0;
+        }
+        if (last) {
+            finish(job);
+        }
+    }
+}
+
+JobIndexer::Plan JobIndexer::buildPlan(Job& job) const
+{
+    Plan plan;
+    plan.job_id = job.job_id;
+    std::map<std::string, TapePlan> tapes;
+    for (size_t i = 0; i < job.keys.size(); ++i) {
+        if (!job.results[i]) {
+            plan.missing.push_back(job.keys[i]);
+            continue;
+        }
+        CatalogEntry& location = *job.results[i];
+        TapePlan& tape = tapes[location.tape_id];
+        tape.bytes += location.length;
+        plan.bytes += location.length;
+        ++plan.objects;
+        tape.reads.push_back(ObjectRead{std::move(job.keys[i]), std::move(location)});
+    }
+
+    for (auto& entry : tapes) {
+        TapePlan& tape = entry.second;
+        tape.tape_id = entry.first;
+        std::sort(tape.reads.begin(), tape.reads.end(), [](const ObjectRead& a, const ObjectRead& b) {
+            return std::tie(a.location.block_position, a.location.aggregate_id, a.location.offset) <
+                   std::tie(b.location.block_position, b.location.aggregate_id, b.location.offset);
+        });
+        for (size_t i = 0; i < tape.reads.size(); ++i) {
+            if (i == 0 || tape.reads[i].location.aggregate_id != tape.reads[i - 1].location.aggregate_id) {
+                ++tape.aggregates;
+            }
+        }
+        plan.tapes.push_back(std::move(tape));
+    }
+
+    plan.status = plan.missing.empty() || !config_.fail_on_missing ? JobStatus::Queuing : JobStatus::Failed;
+    return plan;
+}
+
+void JobIndexer::finish(Job& job)
+{
+    Plan plan = buildPlan(job);
+    JobQueue::getInstance().updateStatus(plan.job_id, plan.status);
+
+    {
+        MutexLockGuard autoLock(mutex_);
+        ++stats_.jobs;
+        stats_.objects += plan.objects;
+        stats_.missing += plan.missing.size();
+        if (plan.status == JobStatus::Failed) {
+            ++stats_.failed;
+        }
+    }
+    if (job.done) {
+        job.done(plan);
+    } else {
+        MutexLockGuard autoLock(mutex_);
+        plans_[plan.job_id] = std::move(plan);
+    }
+
+    MutexLockGuard autoLock(mutex_);
+    if (--active_jobs_ == 0) {
+        idle_cond_.notifyAll();
+    }
+}
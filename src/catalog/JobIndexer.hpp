@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "shared/thread/Thread.hpp"
+#include "JobManager.hpp"
+#include "TapeDrivesOperation.hpp"
+#include "CatalogIndex.hpp"
+
+/**
+ * @brief 召回任务的索引阶段：把处于 JobStatus::Indexing 的任务的对象列表解析成按磁带分组的工作计划。
+ *
+ * 大型召回任务可能列出数百万个对象。submit() 把对象列表按 batch_size 切分，由固定数量的工作线程
+ * 并行地对 CatalogIndex 做批量查找；最后一批完成的线程汇总结果：
+ * - 按磁带分组，组内按 (block_position, offset) 排序，驱动器可以沿磁带顺序读取；
+ * - 所有对象都找到时任务转为 JobStatus::Queuing，否则（fail_on_missing 时）转为 JobStatus::Failed。
+ *
+ * 状态变化通过 JobQueue::updateStatus 写入 JobQueue::getInstance() 中的任务并由其发布（任务不在队列中时跳过）。
+ * 计划保存在索引器中，由排队阶段通过 takePlan() 取走；也可以在 submit() 时传入回调直接接收。
+ * 回调在工作线程中、锁外调用。
+ */
+class JobIndexer
+: NonCopyable
+{
+public:
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        size_t workers = 4;             ///< 工作线程数
+        size_t batch_size = 4096;       ///< 每批查找的对象数
+        bool fail_on_missing = true;    ///< 有对象不在目录中时任务失败
+    };
+
+    /**
+     * @brief 计划中的一个对象读取。
+     */
+    struct ObjectRead {
+        std::string object_key;
+        CatalogEntry location;
+    };
+
+    /**
+     * @brief 一盘磁带上的工作：按磁带顺序排列的对象读取。
+     */
+    struct TapePlan {
+        std::string tape_id;
+        std::vector<ObjectRead> reads;  ///< 按 (block_position, offset) 升序
+        uint64_t bytes = 0;             ///< 对象总字节数
+        size_t aggregates = 0;          ///< 涉及的聚合数
+
+        /**
+         * @brief 为每个涉及的聚合生成一个 READ_AGGR（起始块为聚合位置，长度为聚合长度），按磁带顺序排列。
+         */
+        std::vector<TapeDrivesOperation> toOperations() const;
+    };
+
+    /**
+     * @brief 一个任务的工作计划。
+     */
+    struct Plan {
+        std::string job_id;
+        JobStatus status = JobStatus::Indexing;   ///< 索引结束后的状态（Queuing 或 Failed）
+        std::vector<TapePlan> tapes;              ///< 按磁带 ID 排序
+        std::vector<std::string> missing;         ///< 目录中不存在的对象
+        uint64_t objects = 0;                     ///< 找到的对象数
+        uint64_t bytes = 0;                       ///< 找到的对象总字节数
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t jobs = 0;          ///< 完成索引的任务数
+        uint64_t failed = 0;        ///< 因对象缺失而失败的任务数
+        uint64_t batches = 0;       ///< 执行的批量查找次数
+        uint64_t objects = 0;       ///< 解析的对象数
+        uint64_t missing = 0;       ///< 缺失的对象数
+    };
+
+    /**
+     * @brief 计划完成回调。
+     */
+    using Completion = std::function<void(const Plan& plan)>;
+
+    explicit JobIndexer(CatalogIndex& catalog);
+
+    /**
+     * @brief 构造函数，启动工作线程。
+     *
+     * @param catalog 目录索引。
+     * @param config 配置项。
+     */
+    JobIndexer(CatalogIndex& catalog, const Config& config);
+
+    /**
+     * @brief 析构函数，等待已提交的任务索引完毕后停止工作线程。
+     */
+    ~JobIndexer();
+
+    /**
+     * @brief 提交一个任务的对象列表，任务状态置为 Indexing。
+     *
+     * @param job_id 任务 ID。
+     * @param object_keys 任务要召回的对象。
+     * @param done 计划完成回调，可为空；为空时计划保存在索引器中，由 takePlan() 取走。
+     */
+    void submit(const std::string& job_id, std::vector<std::string> object_keys, Completion done = Completion());
+
+    /**
+     * @brief 取走已完成的计划。
+     *
+     * @return std::optional<Plan> 任务尚未索引完毕或计划已被取走时返回 std::nullopt。
+     */
+    std::optional<Plan> takePlan(const std::string& job_id);
+
+    /**
+     * @brief 等待所有已提交的任务索引完毕。
+     */
+    void waitIdle();
+
+    Stats stats() const;
+
+private:
+    /**
+     * @brief 正在索引的任务。
+     */
+    struct Job {
+        std::string job_id;
+        std::vector<std::string> keys;
+        std::vector<std::optional<CatalogEntry>> results;  ///< 与 keys 一一对应，各批写入不相交的区间
+        size_t remaining = 0;                               ///< 尚未完成的批数
+        Completion done;
+    };
+
+    /**
+     * @brief 一批查找：keys[first, last)。
+     */
+    struct Batch {
+        std::shared_ptr<Job> job;
+        size_t first;
+        size_t last;
+    };
+
+    void run();
+
+    /**
+     * @brief 汇总查找结果，生成计划。
+     */
+    Plan buildPlan(Job& job) const;
+
+    void finish(Job& job);
+
+    CatalogIndex& catalog_;
+    const Config config_;
+    mutable MutexLock mutex_;
+    Condition cond_;                                    ///< 有新批次或停止时唤醒工作线程
+    Condition idle_cond_;                               ///< 任务索引完毕时唤醒 waitIdle()
+    std::deque<Batch> batches_;                         ///< 待执行的批次
+    size_t active_jobs_;                                ///< 尚未索引完毕的任务数
+    std::unordered_map<std::string, Plan> plans_;       ///< 已完成、等待取走的计划
+    bool running_;
+    std::vector<std::unique_ptr<Thread>> threads_;
+    Stats stats_;
+};
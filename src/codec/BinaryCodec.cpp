@@ -0,0 +1,165 @@
+#include "BinaryCodec.hpp"
+
+namespace binary_codec {
+
+    namespace {
+
+        constexpr size_t kJobIdOffset = 12;
+        constexpr size_t kContentKeyOffset = kJobIdOffset + kJobIdCapacity;
+        constexpr size_t kTapeIdOffset = 8;
+        constexpr size_t kBlockPositionOffset = kTapeIdOffset + kTapeIdCapacity;
+        constexpr size_t kOperationIdOffset = kBlockPositionOffset + 8;
+        constexpr size_t kLengthOffset = kOperationIdOffset + 8;
+        constexpr size_t kFlagsOffset = kLengthOffset + 8;
+
+        void putRecordHeader(uint8_t* out, uint16_t version, size_t size) {
+            byte_order::store<uint16_t>(out, version);
+            byte_order::store<uint16_t>(out + 2, static_cast<uint16_t>(size));
+        }
+
+        bool checkRecordHeader(const uint8_t* data, uint16_t version, size_t size) {
+            return byte_order::load<uint16_t>(data) == version &&
+                   byte_order::load<uint16_t>(data + 2) == size;
+        }
+
+        void putBatchHeader(uint8_t* out, RecordType type, uint16_t version, size_t size, size_t count) {
+            byte_order::store<uint32_t>(out, kBatchMagic);
+            byte_order::store<uint16_t>(out + 4, static_cast<uint16_t>(type));
+            byte_order::store<uint16_t>(out + 6, version);
+            byte_order::store<uint32_t>(out + 8, static_cast<uint32_t>(size));
+            byte_order::store<uint32_t>(out + 12, static_cast<uint32_t>(count));
+        }
+
+        template<typename T, typename View>
+        bool encodeBatch(const T* items, size_t count, std::vector<uint8_t>& out) {
+            const size_t begin = out.size();
+            out.resize(begin + kBatchHeaderSize + count * View::kRecordSize);
+            uint8_t* p = out.data() + begin;
+            putBatchHeader(p, View::kType, View::kVersion, View::kRecordSize, count);
+            p += kBatchHeaderSize;
+            for (size_t i = 0; i < count; ++i, p += View::kRecordSize) {
+                if (!encode(items[i], p)) {
+                    out.resize(begin);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename View, typename T, typename Convert>
+        bool decodeBatch(const uint8_t* data, size_t length, std::vector<T>& items, Convert convert) {
+            auto array = RecordArrayView<View>::parse(data, length);
+            if (!array) {
+                return false;
+            }
+            items.reserve(items.size() + array->size());
+            for (size_t i = 0; i < array->size(); ++i) {
+                View view = (*array)[i];
+                if (!view.valid()) {
+                    return false;
+                }
+                items.push_back(convert(view));
+            }
+            return true;
+        }
+
+    }
+
+    bool encode(const JobInfo& job, uint8_t* out) {
+        if (job.job_id.size() > kJobIdCapacity || job.content_key.size() > kContentKeyCapacity) {
+            return false;
+        }
+        // 每个字节只写一次：字段写入后只清零字符串尾部的未使用部分，不对整条记录预先 memset
+        putRecordHeader(out, kJobInfoVersion, kJobInfoRecordSize);
+        out[4] = static_cast<uint8_t>(job.status);
+        out[5] = 0;
+        byte_order::store<uint16_t>(out + 6, static_cast<uint16_t>(job.job_id.size()));
+        byte_order::store<uint16_t>(out + 8, static_cast<uint16_t>(job.content_key.size()));
+        byte_order::store<uint16_t>(out + 10, 0);
+        memcpy(out + kJobIdOffset, job.job_id.data(), job.job_id.size());
+        memset(out + kJobIdOffset + job.job_id.size(), 0, kJobIdCapacity - job.job_id.size());
+        memcpy(out + kContentKeyOffset, job.content_key.data(), job.content_key.size());
+        memset(out + kContentKeyOffset + job.content_key.size(), 0, kContentKeyCapacity - job.content_key.size());
+        return true;
+    }
+
+    bool encode(const TapeDrivesOperation& op, uint8_t* out) {
+        const std::string& tape_id = op.getTapeId();
+        if (tape_id.size() > kTapeIdCapacity) {
+            return false;
+        }
+        memset(out, 0, kTapeOperationRecordSize);
+        putRecordHeader(out, kTapeOperationVersion, kTapeOperationRecordSize);
+        out[4] = static_cast<uint8_t>(op.getTypeOperation());
+        out[5] = static_cast<uint8_t>(tape_id.size());
+        byte_order::store<uint16_t>(out + 6, static_cast<uint16_t>(static_cast<int16_t>(op.getWrap())));
+        memcpy(out + kTapeIdOffset, tape_id.data(), tape_id.size());
+        byte_order::store<uint64_t>(out + kBlockPositionOffset, op.getBlockPosition());
+        byte_order::store<uint64_t>(out + kOperationIdOffset, op.getOperationId());
+        byte_order::store<uint64_t>(out + kLengthOffset, op.getLength());
+        out[kFlagsOffset] = op.isBackground() ? kTapeOperationBackground : 0;
+        return true;
+    }
+
+    bool JobInfoView::valid() const {
+        return checkRecordHeader(data_, kJobInfoVersion, kJobInfoRecordSize) &&
+               byte_order::load<uint16_t>(data_ + 6) <= kJobIdCapacity &&
+               byte_order::load<uint16_t>(data_ + 8) <= kContentKeyCapacity;
+    }
+
+    std::string_view JobInfoView::jobId() const {
+        return std::string_view(reinterpret_cast<const char*>(data_ + kJobIdOffset),
+                                byte_order::load<uint16_t>(data_ + 6));
+    }
+
+    std::string_view JobInfoView::contentKey() const {
+        return std::string_view(reinterpret_cast<const char*>(data_ + kContentKeyOffset),
+                                byte_order::load<uint16_t>(data_ + 8));
+    }
+
+    JobInfo JobInfoView::toJobInfo() const {
+        JobInfo job;
+        job.status = status();
+        std::string_view id = jobId();
+        std::string_view key = contentKey();
+        job.job_id.assign(id.data(), id.size());
+        job.content_key.assign(key.data(), key.size());
+        return job;
+    }
+
+    bool TapeOperationView::valid() const {
+        return checkRecordHeader(data_, kTapeOperationVersion, kTapeOperationRecordSize) &&
+               data_[5] <= kTapeIdCapacity;
+    }
+
+    std::string_view TapeOperationView::tapeId() const {
+        return std::string_view(reinterpret_cast<const char*>(data_ + kTapeIdOffset), data_[5]);
+    }
+
+    TapeDrivesOperation TapeOperationView::toOperation() const {
+        TapeDrivesOperation op(type(), std::string(tapeId()));
+        op.setPosition(blockPosition(), wrap());
+        op.setOperationId(operationId());
+        op.setLength(length());
+        op.setBackground(background());
+        return op;
+    }
+
+    bool encodeJobInfos(const JobInfo* jobs, size_t count, std::vector<uint8_t>& out) {
+        return encodeBatch<JobInfo, JobInfoView>(jobs, count, out);
+    }
+
+    bool encodeTapeOperations(const TapeDrivesOperation* ops, size_t count, std::vector<uint8_t>& out) {
+        return encodeBatch<TapeDrivesOperation, TapeOperationView>(ops, count, out);
+    }
+
+    bool decodeJobInfos(const uint8_t* data, size_t length, std::vector<JobInfo>& jobs) {
+        return decodeBatch<JobInfoView>(data, length, jobs, [](const JobInfoView& v) { return v.toJobInfo(); });
+    }
+
+    bool decodeTapeOperations(const uint8_t* data, size_t length, std::vector<TapeDrivesOperation>& ops) {
+        return decodeBatch<TapeOperationView>(data, length, ops,
+                                              [](const TapeOperationView& v) { return v.toOperation(); });
+    }
+
+}
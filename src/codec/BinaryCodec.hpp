@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "JobManager.hpp"
+#include "TapeDrivesOperation.hpp"
+#include "ByteOrder.hpp"
+
+/**
+ * @brief JobInfo 与 TapeDrivesOperation 的紧凑二进制编码。
+ *
+ * 用于日志、进程间通信和快照等热路径，取代文本格式：
+ * - 每种记录定长、小端序，记录开头是 2 字节版本号和 2 字节记录长度，格式演进时递增版本号；
+ * - 定长记录可以按下标随机访问，View 类直接在字节缓冲区上读取字段，不做拷贝和内存分配；
+ * - 批量编码在记录数组前加 16 字节批次头：
+ *
+ * | 偏移 | 长度 | 字段                               |
+ * |------|------|------------------------------------|
+ * | 0    | 4    | magic（"SBC1"）                    |
+ * | 4    | 2    | record_type（RecordType）          |
+ * | 6    | 2    | record_version                     |
+ * | 8    | 4    | record_size                        |
+ * | 12   | 4    | count                              |
+ *
+ * JobInfo 记录（v1，256 字节）：
+ * version(2) + size(2) + status(1) + reserved(1) + id_len(2) + key_len(2) + reserved(2)
+ * + job_id[64] + content_key[180]，未使用的字节填 0。
+ *
+ * TapeDrivesOperation 记录（v5，56 字节）：
+ * version(2) + size(2) + type(1) + tape_id_len(1) + wrap(2，有符号，-1 表示未知) + tape_id[16] + block_position(8)
+ * + operation_id(8) + length(8) + flags(1，bit 0：后台操作) + reserved(7)。
+ * 聚合数据和运行时字段（提交时间、估算定位时间）不编码。
+ * v1~v4 缺少 tape_id、位置、operation_id/length 或标志字段，已不再支持。
+ */
+namespace binary_codec {
+
+    constexpr uint32_t kBatchMagic = 0x31434253;  ///< "SBC1"
+    constexpr size_t kBatchHeaderSize = 16;
+
+    /**
+     * @brief 批次中的记录类型。
+     */
+    enum class RecordType : uint16_t {
+        JobInfo = 1,
+        TapeOperation = 2
+    };
+
+    constexpr uint16_t kJobInfoVersion = 1;
+    constexpr size_t kJobInfoRecordSize = 256;
+    constexpr size_t kJobIdCapacity = 64;
+    constexpr size_t kContentKeyCapacity = 180;
+
+    constexpr uint16_t kTapeOperationVersion = 5;
+    constexpr size_t kTapeOperationRecordSize = 56;
+    constexpr size_t kTapeIdCapacity = 16;
+    constexpr uint8_t kTapeOperationBackground = 0x01;  ///< flags：后台操作（TapeDrivesOperation::isBackground()）
+
+    /**
+     * @brief 将 JobInfo 编码为一条定长记录。
+     *
+     * @param job 任务信息。
+     * @param out 至少 kJobInfoRecordSize 字节的输出缓冲区。
+     * @return bool job_id 或 content_key 超长时返回 false。
+     */
+    bool encode(const JobInfo& job, uint8_t* out);
+
+    /**
+     * @brief 将 TapeDrivesOperation 编码为一条定长记录。
+     *
+     * @param op 磁带操作。
+     * @param out 至少 kTapeOperationRecordSize 字节的输出缓冲区。
+     * @return bool tape_id 超长时返回 false。
+     */
+    bool encode(const TapeDrivesOperation& op, uint8_t* out);
+
+    /**
+     * @brief 字节缓冲区上的 JobInfo 只读视图（零拷贝）。
+     *
+     * 视图不拥有缓冲区，调用方需保证缓冲区在视图使用期间有效。
+     */
+    class JobInfoView {
+    public:
+        static constexpr RecordType kType = RecordType::JobInfo;
+        static constexpr uint16_t kVersion = kJobInfoVersion;
+        static constexpr size_t kRecordSize = kJobInfoRecordSize;
+
+        explicit JobInfoView(const uint8_t* data) : data_(data) {}
+
+        /**
+         * @brief 校验记录头中的版本号、长度和字符串长度。
+         */
+        bool valid() const;
+
+        JobStatus status() const { return static_cast<JobStatus>(data_[4]); }
+        std::string_view jobId() const;
+        std::string_view contentKey() const;
+
+        /**
+         * @brief 拷贝出一个 JobInfo。
+         */
+        JobInfo toJobInfo() const;
+
+    private:
+        const uint8_t* data_;
+    };
+
+    /**
+     * @brief 字节缓冲区上的 TapeDrivesOperation 只读视图（零拷贝）。
+     */
+    class TapeOperationView {
+    public:
+        static constexpr RecordType kType = RecordType::TapeOperation;
+        static constexpr uint16_t kVersion = kTapeOperationVersion;
+        static constexpr size_t kRecordSize = kTapeOperationRecordSize;
+
+        explicit TapeOperationView(const uint8_t* data) : data_(data) {}
+
+        bool valid() const;
+
+        TypeOperation type() const { return static_cast<TypeOperation>(data_[4]); }
+        std::string_view tapeId() const;
+        int wrap() const { return static_cast<int16_t>(byte_order::load<uint16_t>(data_ + 6)); }
+        uint64_t blockPosition() const { return byte_order::load<uint64_t>(data_ + 24); }
+        uint64_t operationId() const { return byte_order::load<uint64_t>(data_ + 32); }
+        uint64_t length() const { return byte_order::load<uint64_t>(data_ + 40); }
+        bool background() const { return (data_[48] & kTapeOperationBackground) != 0; }
+
+        /**
+         * @brief 拷贝出一个 TapeDrivesOperation。
+         */
+        TapeDrivesOperation toOperation() const;
+
+    private:
+        const uint8_t* data_;
+    };
+
+    /**
+     * @brief 批次（批次头 + 定长记录数组）上的只读视图。
+     *
+     * @tparam View JobInfoView 或 TapeOperationView。
+     */
+    template<typename View>
+    class RecordArrayView {
+    public:
+        /**
+         * @brief 解析并校验批次头。
+         *
+         * @param data 批次起始地址。
+         * @param length 缓冲区长度。
+         * @return std::optional<RecordArrayView> 格式不符时返回 std::nullopt。
+         */
+        static std::optional<RecordArrayView> parse(const uint8_t* data, size_t length) {
+            if (length < kBatchHeaderSize ||
+                byte_order::load<uint32_t>(data) != kBatchMagic ||
+                byte_order::load<uint16_t>(data + 4) != static_cast<uint16_t>(View::kType) ||
+                byte_order::load<uint16_t>(data + 6) != View::kVersion ||
+                byte_order::load<uint32_t>(data + 8) != View::kRecordSize) {
+                return std::nullopt;
+            }
+            const size_t count = byte_order::load<uint32_t>(data + 12);
+            if ((length - kBatchHeaderSize) / View::kRecordSize < count) {
+                return std::nullopt;
+            }
+            return RecordArrayView(data + kBatchHeaderSize, count);
+        }
+
+        size_t size() const { return count_; }
+
+        View operator[](size_t index) const { return View(records_ + index * View::kRecordSize); }
+
+        /**
+         * @brief 批次占用的总字节数。
+         */
+        size_t byteSize() const { return kBatchHeaderSize + count_ * View::kRecordSize; }
+
+    private:
+        RecordArrayView(const uint8_t* records, size_t count) : records_(records), count_(count) {}
+
+        const uint8_t* records_;
+        size_t count_;
+    };
+
+    using JobInfoArrayView = RecordArrayView<JobInfoView>;
+    using TapeOperationArrayView = RecordArrayView<TapeOperationView>;
+
+    /**
+     * @brief 批量编码 JobInfo，结果追加到 out。
+     *
+     * 输出缓冲区一次性扩容，记录直接写入，避免逐字段 push_back。
+     *
+     * @return bool 任一记录编码失败时返回 false，out 恢复原长度。
+     */
+    bool encodeJobInfos(const JobInfo* jobs, size_t count, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 批量编码 TapeDrivesOperation，结果追加到 out。
+     */
+    bool encodeTapeOperations(const TapeDrivesOperation* ops, size_t count, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 批量解码 JobInfo，结果追加到 jobs。
+     *
+     * @return bool 批次头或任一记录校验失败时返回 false。
+     */
+    bool decodeJobInfos(const uint8_t* data, size_t length, std::vector<JobInfo>& jobs);
+
+    /**
+     * @brief 批量解码 TapeDrivesOperation，结果追加到 ops。
+     */
+    bool decodeTapeOperations(const uint8_t* data, size_t length, std::vector<TapeDrivesOperation>& ops);
+
+}
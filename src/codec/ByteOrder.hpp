@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief 小端序读写辅助函数。
+ *
+ * 二进制格式统一使用小端序。在小端主机上直接 memcpy（编译器会优化为单条 load/store），
+ * 在大端主机上额外做一次字节交换。
+ */
+namespace byte_order {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr bool kHostIsLittleEndian = false;
+#else
+    constexpr bool kHostIsLittleEndian = true;
+#endif
+
+    inline uint16_t toLittle(uint16_t v) { return kHostIsLittleEndian ? v : __builtin_bswap16(v); }
+    inline uint32_t toLittle(uint32_t v) { return kHostIsLittleEndian ? v : __builtin_bswap32(v); }
+    inline uint64_t toLittle(uint64_t v) { return kHostIsLittleEndian ? v : __builtin_bswap64(v); }
+
+    template<typename T>
+    inline void store(uint8_t* p, T v) {
+        v = toLittle(v);
+        memcpy(p, &v, sizeof(v));
+    }
+
+    template<typename T>
+    inline T load(const uint8_t* p) {
+        T v;
+        memcpy(&v, p, sizeof(v));
+        return toLittle(v);
+    }
+
+}
@@ -0,0 +1,189 @@
+#include "Crc32c.hpp"
+#include "ByteOrder.hpp"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define CRC32C_HAVE_SSE42 1
+#endif
+
+namespace crc32c {
+
+    namespace {
+
+        constexpr uint32_t kPoly = 0x82F63B78;     ///< 0x1EDC6F41 的位反转形式
+
+        /**
+         * @brief slicing-by-8 查找表：table[k][b] 是字节 b 后面再跟 k 个零字节的校验和贡献。
+         */
+        struct Tables {
+            uint32_t table[8][256];
+
+            Tables() {
+                for (uint32_t b = 0; b < 256; ++b) {
+                    uint32_t crc = b;
+                    for (int i = 0; i < 8; ++i) {
+                        crc = crc & 1 ? (crc >> 1) ^ kPoly : crc >> 1;
+                    }
+                    table[0][b] = crc;
+                }
+                for (uint32_t b = 0; b < 256; ++b) {
+                    for (int k = 1; k < 8; ++k) {
+                        table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+                    }
+                }
+            }
+        };
+
+        const Tables& tables() {
+            static const Tables instance;
+            return instance;
+        }
+
+        /**
+         * @brief GF(2) 上模 P 的多项式乘法（位反转表示，最高次在最低位）。
+         */
+        uint32_t multiplyModP(uint32_t a, uint32_t b) {
+            uint32_t product = 0;
+            for (uint32_t m = 1U << 31; m != 0; m >>= 1) {
+                if (a & m) {
+                    product ^= b;
+                    if ((a & (m - 1)) == 0) {
+                        break;
+                    }
+                }
+                b = b & 1 ? (b >> 1) ^ kPoly : b >> 1;
+            }
+            return product;
+        }
+
+        /**
+         * @brief x^(8 * bytes) mod P：在寄存器后追加 bytes 个零字节相当于乘以它。
+         */
+        uint32_t zeroBytesOperator(uint64_t bytes) {
+            // powers[k] = x^(2^k) mod P
+            struct Powers {
+                uint32_t value[64];
+                Powers() {
+                    value[0] = 1U << 30; // x^1
+                    for (int k = 1; k < 64; ++k) {
+                        value[k] = multiplyModP(value[k - 1], value[k - 1]);
+                    }
+                }
+            };
+            static const Powers powers;
+            uint32_t p = 1U << 31; // x^0
+            for (int k = 3; bytes != 0; bytes >>= 1, ++k) {
+                if (bytes & 1) {
+                    p = multiplyModP(powers.value[k & 63], p);
+                }
+            }
+            return p;
+        }
+
+        /**
+         * @brief 可移植实现，crc 为未取反的寄存器值。
+         */
+        uint32_t updatePortable(uint32_t crc, const uint8_t* p, size_t length) {
+            const Tables& t = tables();
+            while (length > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+                crc = (crc >> 8) ^ t.table[0][(crc ^ *p++) & 0xFF];
+                --length;
+            }
+            while (length >= 8) {
+                const uint32_t lo = byte_order::load<uint32_t>(p) ^ crc;
+                const uint32_t hi = byte_order::load<uint32_t>(p + 4);
+                crc = t.table[7][lo & 0xFF] ^ t.table[6][(lo >> 8) & 0xFF] ^
+                      t.table[5][(lo >> 16) & 0xFF] ^ t.table[4][lo >> 24] ^
+                      t.table[3][hi & 0xFF] ^ t.table[2][(hi >> 8) & 0xFF] ^
+                      t.table[1][(hi >> 16) & 0xFF] ^ t.table[0][hi >> 24];
+                p += 8;
+                length -= 8;
+            }
+            while (length-- > 0) {
+                crc = (crc >> 8) ^ t.table[0][(crc ^ *p++) & 0xFF];
+            }
+            return crc;
+        }
+
+#if CRC32C_HAVE_SSE42
+        constexpr size_t kStride = 4096; ///< 三路交错时每路的长度
+
+        /**
+         * @brief SSE4.2 实现，crc 为未取反的寄存器值。
+         *
+         * crc32 指令延迟 3 个周期、吞吐 1 个周期：三路独立的数据流交错执行才能跑满。
+         * 寄存器更新对初始值是线性的：f(s, A + B) = f(s, A) · x^(8|B|) ^ f(0, B)，
+         * 因此第二、三路从 0 开始计算，最后用 kStride 个零字节的算子拼接。
+         */
+        __attribute__((target("sse4.2")))
+        uint32_t updateSse42(uint32_t crc, const uint8_t* p, size_t length) {
+            static const uint32_t shift = zeroBytesOperator(kStride);
+            uint64_t c0 = crc;
+            while (length > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+                c0 = _mm_crc32_u8(static_cast<uint32_t>(c0), *p++);
+                --length;
+            }
+            while (length >= 3 * kStride) {
+                uint64_t c1 = 0;
+                uint64_t c2 = 0;
+                for (size_t i = 0; i < kStride; i += 8) {
+                    c0 = _mm_crc32_u64(c0, byte_order::load<uint64_t>(p + i));
+                    c1 = _mm_crc32_u64(c1, byte_order::load<uint64_t>(p + kStride + i));
+                    c2 = _mm_crc32_u64(c2, byte_order::load<uint64_t>(p + 2 * kStride + i));
+                }
+                c0 = multiplyModP(shift, static_cast<uint32_t>(c0)) ^ static_cast<uint32_t>(c1);
+                c0 = multiplyModP(shift, static_cast<uint32_t>(c0)) ^ static_cast<uint32_t>(c2);
+                p += 3 * kStride;
+                length -= 3 * kStride;
+            }
+            while (length >= 8) {
+                c0 = _mm_crc32_u64(c0, byte_order::load<uint64_t>(p));
+                p += 8;
+                length -= 8;
+            }
+            while (length-- > 0) {
+                c0 = _mm_crc32_u8(static_cast<uint32_t>(c0), *p++);
+            }
+            return static_cast<uint32_t>(c0);
+        }
+#endif
+
+        using UpdateFunction = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+        UpdateFunction selectUpdate() {
+#if CRC32C_HAVE_SSE42
+            if (__builtin_cpu_supports("sse4.2")) {
+                return updateSse42;
+            }
+#endif
+            return updatePortable;
+        }
+
+        UpdateFunction update() {
+            static const UpdateFunction selected = selectUpdate();
+            return selected;
+        }
+
+    }
+
+    uint32_t extend(uint32_t crc, const uint8_t* data, size_t length) {
+        return ~update()(~crc, data, length);
+    }
+
+    uint32_t extendPortable(uint32_t crc, const uint8_t* data, size_t length) {
+        return ~updatePortable(~crc, data, length);
+    }
+
+    uint32_t combine(uint32_t crc1, uint32_t crc2, uint64_t length2) {
+        return multiplyModP(zeroBytesOperator(length2), crc1) ^ crc2;
+    }
+
+    bool hardwareAccelerated() {
+        return update() != updatePortable;
+    }
+
+    const char* implementation() {
+        return hardwareAccelerated() ? "sse4.2" : "portable";
+    }
+
+}
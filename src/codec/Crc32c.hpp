@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC32C（Castagnoli 多项式 0x1EDC6F41）校验和，用于聚合及其成员的端到端校验。
+ *
+ * x86-64 上运行时检测 SSE4.2：可用时使用 crc32 指令并把长缓冲区分成三路交错计算，
+ * 隐藏指令延迟；否则使用查表（slicing-by-8）的可移植实现。两种实现的结果完全相同。
+ *
+ * 校验和可以分段计算：extend(extend(0, a), b) == value(a + b)；
+ * 已知两段各自的校验和时，combine() 不读取数据即可得到拼接后的校验和。
+ */
+namespace crc32c {
+
+    /**
+     * @brief 在已有校验和 crc 后追加 data 的校验和，crc 为 0 表示从头开始。
+     */
+    uint32_t extend(uint32_t crc, const uint8_t* data, size_t length);
+
+    /**
+     * @brief data 的校验和。
+     */
+    inline uint32_t value(const uint8_t* data, size_t length) { return extend(0, data, length); }
+
+    /**
+     * @brief 拼接校验和：crc1 是 A 的校验和，crc2 是长度为 length2 的 B 的校验和，返回 A + B 的校验和。
+     *
+     * 计算量与 log(length2) 成正比，与数据量无关。
+     */
+    uint32_t combine(uint32_t crc1, uint32_t crc2, uint64_t length2);
+
+    /**
+     * @brief 可移植实现（不使用硬件指令），用于校验和对比测试。
+     */
+    uint32_t extendPortable(uint32_t crc, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 当前 CPU 是否使用硬件指令计算。
+     */
+    bool hardwareAccelerated();
+
+    /**
+     * @brief 当前使用的实现名称（"sse4.2" 或 "portable"）。
+     */
+    const char* implementation();
+
+}
@@ -0,0 +1,225 @@
+#include "BlockFrame.hpp"
+#include "Crc32c.hpp"
+#include "Lz.hpp"
+#include "codec/ByteOrder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    constexpr char kMagic[4] = {'T', 'C', 'Z', 'F'};
+    constexpr uint16_t kVersion = 1;
+
+    // Header 字段偏移
+    constexpr size_t kVersionOffset = 4;
+    constexpr size_t kBlockSizeOffset = 8;
+    constexpr size_t kCountOffset = 12;
+    constexpr size_t kRawLengthOffset = 16;
+
+    // BlockEntry 字段偏移
+    constexpr size_t kStoredLength = 0;
+    constexpr size_t kFlags = 4;
+    constexpr size_t kChecksum = 8;
+
+    constexpr uint32_t kRawBlock = 1;       ///< kFlags：按原样存储
+
+    constexpr size_t kSampleThreshold = 64 * 1024;  ///< 不小于这个长度的块先抽样
+    constexpr size_t kSampleSize = 4096;
+
+    struct Header {
+        uint32_t block_size = 0;
+        uint32_t count = 0;
+        uint64_t raw_length = 0;
+        size_t index_size = 0;
+    };
+
+    bool parseHeader(const uint8_t* frame, size_t length, Header& header) {
+        if (length < BlockFrame::kHeaderSize || memcmp(frame, kMagic, sizeof(kMagic)) != 0 ||
+            byte_order::load<uint16_t>(frame + kVersionOffset) != kVersion) {
+            return false;
+        }
+        header.block_size = byte_order::load<uint32_t>(frame + kBlockSizeOffset);
+        header.count = byte_order::load<uint32_t>(frame + kCountOffset);
+        header.raw_length = byte_order::load<uint64_t>(frame + kRawLengthOffset);
+        if (header.block_size == 0 ||
+            header.count != (header.raw_length + header.block_size - 1) / header.block_size) {
+            return false;
+        }
+        header.index_size = BlockFrame::kHeaderSize + size_t(header.count) * BlockFrame::kEntrySize;
+        return header.index_size <= length;
+    }
+
+    const uint8_t* entryAt(const uint8_t* frame, size_t index) {
+        return frame + BlockFrame::kHeaderSize + index * BlockFrame::kEntrySize;
+    }
+
+    uint32_t storedLength(const uint8_t* frame, size_t index) {
+        return byte_order::load<uint32_t>(entryAt(frame, index) + kStoredLength);
+    }
+
+    /**
+     * @brief 原始区间覆盖的块 [first, last]，以及块 first 在帧中的偏移。
+     */
+    bool locate(const uint8_t* frame, const Header& header, uint64_t offset, uint64_t size,
+                size_t& first, size_t& last, uint64_t& position) {
+        if (offset > header.raw_length || size > header.raw_length - offset) {
+            return false;
+        }
+        first = static_cast<size_t>(offset / header.block_size);
+        last = size == 0 ? first : static_cast<size_t>((offset + size - 1) / header.block_size);
+        position = header.index_size;
+        for (size_t i = 0; i < first && i < header.count; ++i) {
+            position += storedLength(frame, i);
+        }
+        return true;
+    }
+
+}
+
+BlockFrame::Block BlockFrame::encodeBlock(const uint8_t* data, size_t length, double max_ratio)
+{
+    Block block;
+    bool compressible = true;
+    if (length >= kSampleThreshold) {
+        uint8_t sample_out[lz::bound(kSampleSize)];
+        size_t compressed = 0;
+        for (size_t start : {size_t(0), length / 2, length - kSampleSize}) {
+            size_t n = lz::compress(data + start, kSampleSize, sample_out, sizeof(sample_out));
+            compressed += n == 0 ? kSampleSize : n;
+        }
+        if (compressed > 3 * kSampleSize * max_ratio) {
+            compressible = false;
+            block.sampled = true;
+        }
+    }
+    if (compressible) {
+        block.data.resize(lz::bound(length));
+        size_t n = lz::compress(data, length, block.data.data(), block.data.size());
+        if (n > 0 && n <= length * max_ratio) {
+            block.data.resize(n);
+        } else {
+            compressible = false;
+        }
+    }
+    if (!compressible) {
+        block.data.assign(data, data + length);
+        block.raw = true;
+    }
+    block.checksum = crc32c::value(block.data.data(), block.data.size());
+    return block;
+}
+
+std::vector<uint8_t> BlockFrame::assemble(uint64_t raw_length, uint32_t block_size, const std::vector<Block>& blocks)
+{
+    size_t total = kHeaderSize + blocks.size() * kEntrySize;
+    for (const auto& block : blocks) {
+        total += block.data.size();
+    }
+    std::vector<uint8_t> frame(total);
+    memcpy(frame.data(), kMagic, sizeof(kMagic));
+    byte_order::store<uint16_t>(frame.data() + kVersionOffset, kVersion);
+    byte_order::store<uint32_t>(frame.data() + kBlockSizeOffset, block_size);
+    byte_order::store<uint32_t>(frame.data() + kCountOffset, static_cast<uint32_t>(blocks.size()));
+    byte_order::store<uint64_t>(frame.data() + kRawLengthOffset, raw_length);
+    uint8_t* out = frame.data() + kHeaderSize + blocks.size() * kEntrySize;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        uint8_t* entry = frame.data() + kHeaderSize + i * kEntrySize;
+        byte_order::store<uint32_t>(entry + kStoredLength, static_cast<uint32_t>(blocks[i].data.size()));
+        byte_order::store<uint32_t>(entry + kFlags, blocks[i].raw ? kRawBlock : 0);
+        byte_order::store<uint32_t>(entry + kChecksum, blocks[i].checksum);
+        memcpy(out, blocks[i].data.data(), blocks[i].data.size());
+        out += blocks[i].data.size();
+    }
+    return frame;
+}
+
+bool BlockFrame::isFrame(const uint8_t* frame, size_t length)
+{
+    Header header;
+    return parseHeader(frame, length, header);
+}
+
+bool BlockFrame::rawLength(const uint8_t* frame, size_t length, uint64_t& raw_length)
+{
+    Header header;
+    if (!parseHeader(frame, length, header)) {
+        return false;
+    }
+    raw_length = header.raw_length;
+    return true;
+}
+
+size_t BlockFrame::indexSize(const uint8_t* frame, size_t length)
+{
+    if (length < kHeaderSize || memcmp(frame, kMagic, sizeof(kMagic)) != 0) {
+        return 0;
+    }
+    return kHeaderSize + size_t(byte_order::load<uint32_t>(frame + kCountOffset)) * kEntrySize;
+}
+
+bool BlockFrame::storedRange(const uint8_t* frame, size_t length, uint64_t offset, uint64_t size,
+                             uint64_t& begin, uint64_t& end)
+{
+    Header header;
+    size_t first, last;
+    if (!parseHeader(frame, length, header) || !locate(frame, header, offset, size, first, last, begin)) {
+        return false;
+    }
+    end = begin;
+    for (size_t i = first; size > 0 && i <= last; ++i) {
+        end += storedLength(frame, i);
+    }
+    return true;
+}
+
+bool BlockFrame::extract(const uint8_t* frame, size_t length, uint64_t offset, uint64_t size,
+                         std::vector<uint8_t>& out)
+{
+    Header header;
+    size_t first, last;
+    uint64_t position;
+    if (!parseHeader(frame, length, header) || !locate(frame, header, offset, size, first, last, position)) {
+        return false;
+    }
+    out.resize(size);
+    std::vector<uint8_t> scratch;
+    for (size_t i = first; size > 0 && i <= last; ++i) {
+        const uint8_t* entry = entryAt(frame, i);
+        const uint32_t stored = byte_order::load<uint32_t>(entry + kStoredLength);
+        if (position > length || stored > length - position) {
+            return false;
+        }
+        const uint8_t* data = frame + position;
+        if (crc32c::value(data, stored) != byte_order::load<uint32_t>(entry + kChecksum)) {
+            return false;
+        }
+        const uint64_t block_begin = uint64_t(i) * header.block_size;
+        const size_t raw_size = static_cast<size_t>(std::min<uint64_t>(header.block_size,
+                                                                      header.raw_length - block_begin));
+        const uint8_t* raw = data;
+        if (byte_order::load<uint32_t>(entry + kFlags) & kRawBlock) {
+            if (stored != raw_size) {
+                return false;
+            }
+        } else {
+            scratch.resize(raw_size);
+            if (!lz::decompress(data, stored, scratch.data(), raw_size)) {
+                return false;
+            }
+            raw = scratch.data();
+        }
+        // 复制块与请求区间的交集
+        const uint64_t from = std::max(offset, block_begin);
+        const uint64_t to = std::min(offset + size, block_begin + raw_size);
+        memcpy(out.data() + (from - offset), raw + (from - block_begin), static_cast<size_t>(to - from));
+        position += stored;
+    }
+    return true;
+}
+
+bool BlockFrame::decode(const uint8_t* frame, size_t length, std::vector<uint8_t>& out)
+{
+    uint64_t raw_length;
+    return rawLength(frame, length, raw_length) && extract(frame, length, 0, raw_length, out);
+}
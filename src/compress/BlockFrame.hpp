@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 分块压缩帧：聚合数据按固定大小切块、逐块压缩后的存储格式。
+ *
+ * 帧布局（小端序）：
+ * @code
+ * | Header (32 字节) | BlockEntry[0] ... BlockEntry[count - 1] | 块 0 | 块 1 | ... |
+ * @endcode
+ * - Header：magic "TCZF"、版本、块大小、块数、原始长度；
+ * - BlockEntry（12 字节）：存储长度、标志（bit 0：按原样存储）、存储内容的 CRC32C；
+ * - 块 i 对应原始数据 [i * block_size, min((i + 1) * block_size, raw_length))。
+ *
+ * 块之间互不依赖：写入时可以并行压缩，读取时只需解压与请求区间相交的块（extract()），
+ * 不必解压整个聚合；每块自带校验和，解压前即可发现磁带上的损坏。
+ */
+class BlockFrame
+{
+public:
+    static constexpr size_t kHeaderSize = 32;
+    static constexpr size_t kEntrySize = 12;
+
+    /**
+     * @brief 编码后的一个块。
+     */
+    struct Block {
+        std::vector<uint8_t> data;      ///< 存储内容（压缩数据或原始数据）
+        bool raw = false;               ///< 按原样存储
+        uint32_t checksum = 0;          ///< data 的 CRC32C
+        bool sampled = false;           ///< 由抽样判定为不可压缩，没有完整压缩
+    };
+
+    /**
+     * @brief 压缩一个块。压缩后长度超过原长 × max_ratio 时按原样存储。
+     *
+     * 较大的块先压缩开头、中间和结尾三段样本，样本都压不下来时直接按原样存储，
+     * 已压缩或加密的数据因此只花抽样的时间。
+     *
+     * @param data 原始数据。
+     * @param length 原始长度。
+     * @param max_ratio 值得压缩的最大压缩比（压缩后 / 压缩前）。
+     */
+    static Block encodeBlock(const uint8_t* data, size_t length, double max_ratio);
+
+    /**
+     * @brief 把编码后的块组装成帧。
+     *
+     * @param raw_length 原始数据总长。
+     * @param block_size 块大小。
+     * @param blocks 各块，数量必须为 ceil(raw_length / block_size)。
+     */
+    static std::vector<uint8_t> assemble(uint64_t raw_length, uint32_t block_size, const std::vector<Block>& blocks);
+
+    /**
+     * @brief 数据是否以帧头开始。
+     */
+    static bool isFrame(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief 帧头中记录的原始长度，不是合法帧时返回 false。
+     */
+    static bool rawLength(const uint8_t* frame, size_t length, uint64_t& raw_length);
+
+    /**
+     * @brief 帧头和块表的长度：读取部分数据前需要先读这么多字节。
+     *
+     * @param frame 至少 kHeaderSize 字节的帧开头。
+     * @return size_t 帧头加块表的长度，不是合法帧时返回 0。
+     */
+    static size_t indexSize(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief 读取原始区间 [offset, offset + length) 需要的帧内字节区间 [begin, end)。
+     *
+     * @param frame 帧开头，至少包含 indexSize() 字节。
+     * @return bool 区间越界或帧头损坏时返回 false。
+     */
+    static bool storedRange(const uint8_t* frame, size_t length, uint64_t offset, uint64_t size,
+                            uint64_t& begin, uint64_t& end);
+
+    /**
+     * @brief 解压原始区间 [offset, offset + size)，只处理与之相交的块。
+     *
+     * @param frame 帧数据。
+     * @param length 帧长度。
+     * @param out 输出，长度为 size。
+     * @return bool 区间越界、校验和不符或数据损坏时返回 false。
+     */
+    static bool extract(const uint8_t* frame, size_t length, uint64_t offset, uint64_t size,
+                        std::vector<uint8_t>& out);
+
+    /**
+     * @brief 解压整个帧。
+     */
+    static bool decode(const uint8_t* frame, size_t length, std::vector<uint8_t>& out);
+};
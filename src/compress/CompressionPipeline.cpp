@@ -0,0 +1,167 @@
+#include "CompressionPipeline.hpp"
+#include "TapeDrivesQueue.hpp"
+
+#include <algorithm>
+
+CompressionPipeline::CompressionPipeline()
+: CompressionPipeline(Config())
+{
+}
+
+CompressionPipeline::CompressionPipeline(const Config& config, Sink sink)
+: config_(config)
+, sink_(std::move(sink))
+, work_cond_(mutex_)
+, done_cond_(mutex_)
+, next_sequence_(0)
+, draining_(false)
+, running_(true)
+{
+    for (size_t i = 0; i < std::max<size_t>(1, config_.workers); ++i) {
+        workers_.push_back(std::make_unique<Thread>([this] { workerLoop(); }));
+        workers_.back()->start();
+    }
+}
+
+CompressionPipeline::~CompressionPipeline()
+{
+    flush();
+    {
+        MutexLockGuard autoLock(mutex_);
+        running_ = false;
+        work_cond_.notifyAll();
+    }
+    for (auto& worker : workers_) {
+        worker->join();
+    }
+}
+
+void CompressionPipeline::submit(const TapeDrivesOperation& op)
+{
+    auto aggregate = op.getAggregate();
+    const bool compress = config_.enabled && config_.block_size > 0 &&
+                          op.getTypeOperation() == TypeOperation::WRITE_AGGR && aggregate &&
+                          aggregate->payload && !aggregate->payload->empty() && !aggregate->compressed;
+    {
+        MutexLockGuard autoLock(mutex_);
+        while (jobs_.size() >= std::max<size_t>(1, config_.max_pending)) {
+            done_cond_.wait();
+        }
+        auto job = std::make_unique<Job>(op);
+        if (compress) {
+            const size_t count = (aggregate->payload->size() + config_.block_size - 1) / config_.block_size;
+            job->blocks.resize(count);
+            job->remaining = count;
+            for (size_t i = 0; i < count; ++i) {
+                tasks_.push_back(Task{job.get(), i});
+            }
+            work_cond_.notifyAll();
+        }
+        jobs_.emplace(next_sequence_++, std::move(job));
+    }
+    drain(); // 原样转发的操作可能已经可以发出
+}
+
+void CompressionPipeline::flush()
+{
+    MutexLockGuard autoLock(mutex_);
+    while (!jobs_.empty() || draining_) {
+        done_cond_.wait();
+    }
+}
+
+CompressionPipeline::Stats CompressionPipeline::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return stats_;
+}
+
+void CompressionPipeline::workerLoop()
+{
+    while (true) {
+        Task task;
+        {
+            MutexLockGuard autoLock(mutex_);
+            while (tasks_.empty() && running_) {
+                work_cond_.wait();
+            }
+            if (tasks_.empty()) {
+                return;
+            }
+            task = tasks_.front();
+            tasks_.pop_front();
+        }
+        const auto& payload = *task.job->op.getAggregate()->payload;
+        const size_t begin = task.block * config_.block_size;
+        const size_t length = std::min<size_t>(config_.block_size, payload.size() - begin);
+        BlockFrame::Block block = BlockFrame::encodeBlock(payload.data() + begin, length, config_.max_ratio);
+        bool last;
+        {
+            MutexLockGuard autoLock(mutex_);
+            ++stats_.blocks;
+            stats_.raw_blocks += block.raw ? 1 : 0;
+            stats_.sampled_blocks += block.sampled ? 1 : 0;
+            task.job->blocks[task.block] = std::move(block);
+            last = --task.job->remaining == 0;
+        }
+        if (last) {
+            drain();
+        }
+    }
+}
+
+void CompressionPipeline::drain()
+{
+    mutex_.lock();
+    if (draining_) {
+        mutex_.unlock();
+        return;
+    }
+    draining_ = true;
+    while (!jobs_.empty() && jobs_.begin()->second->remaining == 0) {
+        std::unique_ptr<Job> job = std::move(jobs_.begin()->second);
+        jobs_.erase(jobs_.begin());
+        mutex_.unlock();
+
+        const bool compressed = !job->blocks.empty();
+        const uint64_t bytes_in = compressed ? job->op.getAggregate()->payload->size() : 0;
+        TapeDrivesOperation op = compressed ? finish(*job) : job->op;
+        const uint64_t bytes_out = compressed ? op.getAggregate()->payload->size() : 0;
+        job.reset();
+        emit(op);
+
+        mutex_.lock();
+        if (compressed) {
+            ++stats_.aggregates;
+            stats_.bytes_in += bytes_in;
+            stats_.bytes_out += bytes_out;
+        } else {
+            ++stats_.passed_through;
+        }
+        done_cond_.notifyAll();
+    }
+    draining_ = false;
+    done_cond_.notifyAll();
+    mutex_.unlock();
+}
+
+TapeDrivesOperation CompressionPipeline::finish(Job& job)
+{
+    auto source = job.op.getAggregate();
+    auto aggregate = std::make_shared<AggregateInfo>(*source);
+    aggregate->payload = std::make_shared<const std::vector<uint8_t>>(
+        BlockFrame::assemble(source->payload->size(), config_.block_size, job.blocks));
+    aggregate->compressed = true;
+    TapeDrivesOperation op = job.op;
+    op.setAggregate(std::move(aggregate));
+    return op;
+}
+
+void CompressionPipeline::emit(const TapeDrivesOperation& op)
+{
+    if (sink_) {
+        sink_(op);
+    } else {
+        TapeDrivesQueue::getInstance().push_back(op);
+    }
+}
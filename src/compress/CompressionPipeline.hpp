@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "shared/thread/Thread.hpp"
+#include "BlockFrame.hpp"
+#include "TapeDrivesOperation.hpp"
+
+/**
+ * @brief 并行压缩阶段：位于写聚合与驱动器缓冲之间，把 WRITE_AGGR 的聚合数据按块并行压缩。
+ *
+ * 在单一写路径上内联压缩会让驱动器等数据。CompressionPipeline 把每个聚合切成 block_size 的块，
+ * 交给 workers 个工作线程并行压缩（BlockFrame::encodeBlock()，不可压缩的块经抽样后直接原样存储），
+ * 全部块完成后组装成 BlockFrame 帧，替换聚合的 payload 并置 AggregateInfo::compressed，再交给 sink。
+ *
+ * - 发出顺序与 submit() 顺序一致，磁带上的写入顺序不变；
+ * - 在途聚合数超过 max_pending 时 submit() 阻塞，限制内存占用并向上游施加背压；
+ * - 成员偏移和校验和仍然指向未压缩数据，READ_AGGR 读回后用 BlockFrame::extract() 只解压请求的成员；
+ * - enabled 为 false、非 WRITE_AGGR 或没有数据的操作原样（按顺序）转发。
+ *
+ * 典型用法是把它作为 WriteAggregator 的 sink：
+ * @code
+ * CompressionPipeline pipeline(config);
+ * WriteAggregator aggregator(aggregator_config, [&](const TapeDrivesOperation& op) { pipeline.submit(op); });
+ * @endcode
+ * sink 在锁外、由完成最后一块的工作线程（或 submit() 的调用线程）调用，同一时刻只有一个线程在调用 sink。
+ */
+class CompressionPipeline
+: NonCopyable
+{
+public:
+    using Sink = std::function<void(const TapeDrivesOperation& op)>;
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        bool enabled = true;                ///< 为 false 时只转发
+        size_t workers = 4;                 ///< 压缩线程数
+        uint32_t block_size = 256 * 1024;   ///< 压缩块大小（字节）
+        double max_ratio = 0.95;            ///< 压缩后 / 压缩前超过这个比例的块按原样存储
+        size_t max_pending = 8;             ///< 在途聚合数上限
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t aggregates = 0;        ///< 压缩的聚合数
+        uint64_t passed_through = 0;    ///< 原样转发的操作数
+        uint64_t blocks = 0;            ///< 处理的块数
+        uint64_t raw_blocks = 0;        ///< 按原样存储的块数
+        uint64_t sampled_blocks = 0;    ///< 经抽样判定不可压缩、跳过完整压缩的块数
+        uint64_t bytes_in = 0;          ///< 压缩前字节数
+        uint64_t bytes_out = 0;         ///< 压缩后（帧）字节数
+    };
+
+    CompressionPipeline();
+
+    /**
+     * @brief 构造函数，启动压缩线程。
+     *
+     * @param config 配置项。
+     * @param sink 发出操作的回调，为空时放入 TapeDrivesQueue::getInstance()。
+     */
+    explicit CompressionPipeline(const Config& config, Sink sink = Sink());
+
+    /**
+     * @brief 析构函数，等待在途聚合全部发出后停止压缩线程。
+     */
+    ~CompressionPipeline();
+
+    /**
+     * @brief 提交一个操作。
+     */
+    void submit(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 等待已提交的操作全部发出。
+     */
+    void flush();
+
+    Stats stats() const;
+
+private:
+    /**
+     * @brief 一个在途的操作。
+     */
+    struct Job {
+        explicit Job(const TapeDrivesOperation& op) : op(op) {}
+
+        TapeDrivesOperation op;
+        std::vector<BlockFrame::Block> blocks;
+        size_t remaining = 0;           ///< 尚未压缩完成的块数
+    };
+
+    /**
+     * @brief 压缩任务：某个操作的一个块。
+     */
+    struct Task {
+        Job* job;
+        size_t block;
+    };
+
+    void workerLoop();
+
+    /**
+     * @brief 按顺序发出已完成的操作。同一时刻只有一个线程执行，其余调用直接返回。
+     */
+    void drain();
+
+    /**
+     * @brief 组装压缩后的操作。
+     */
+    TapeDrivesOperation finish(Job& job);
+
+    void emit(const TapeDrivesOperation& op);
+
+    const Config config_;
+    Sink sink_;
+    mutable MutexLock mutex_;
+    Condition work_cond_;                           ///< 有新任务或停止时唤醒压缩线程
+    Condition done_cond_;                           ///< 有操作发出时唤醒 submit()/flush()
+    std::deque<Task> tasks_;
+    std::map<uint64_t, std::unique_ptr<Job>> jobs_; ///< 序号 -> 在途操作
+    uint64_t next_sequence_;                        ///< 下一个提交的序号
+    bool draining_;                                 ///< 有线程正在发出操作
+    bool running_;
+    Stats stats_;
+    std::vector<std::unique_ptr<Thread>> workers_;
+};
@@ -0,0 +1,188 @@
+#include "Lz.hpp"
+#include "codec/ByteOrder.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace lz {
+
+    namespace {
+
+        constexpr size_t kMinMatch = 4;
+        constexpr size_t kMaxOffset = 65535;
+        constexpr int kHashLog = 14;
+        constexpr size_t kLastLiterals = 5;     ///< 块末尾必须是字面量的字节数
+        constexpr size_t kMatchLimit = 12;      ///< 距块末尾不足这么多字节时不再找匹配
+        constexpr int kSkipTrigger = 6;         ///< 每连续 2^6 次未命中，探测步长加 1
+
+        uint32_t hash(uint32_t sequence) {
+            return (sequence * 2654435761U) >> (32 - kHashLog);
+        }
+
+        /**
+         * @brief 写长度扩展字节，返回新的输出位置；空间不足返回 nullptr。
+         */
+        uint8_t* putLength(uint8_t* op, const uint8_t* end, size_t length) {
+            while (length >= 255) {
+                if (op >= end) {
+                    return nullptr;
+                }
+                *op++ = 255;
+                length -= 255;
+            }
+            if (op >= end) {
+                return nullptr;
+            }
+            *op++ = static_cast<uint8_t>(length);
+            return op;
+        }
+
+        /**
+         * @brief 写一个序列（match_length 为 0 表示只有字面量的最后一个序列）。
+         */
+        uint8_t* putSequence(uint8_t* op, const uint8_t* end, const uint8_t* literals, size_t literal_length,
+                             size_t offset, size_t match_length) {
+            if (op >= end) {
+                return nullptr;
+            }
+            uint8_t* token = op++;
+            *token = static_cast<uint8_t>((literal_length >= 15 ? 15 : literal_length) << 4);
+            if (literal_length >= 15 && !(op = putLength(op, end, literal_length - 15))) {
+                return nullptr;
+            }
+            if (static_cast<size_t>(end - op) < literal_length) {
+                return nullptr;
+            }
+            memcpy(op, literals, literal_length);
+            op += literal_length;
+            if (match_length == 0) {
+                return op;
+            }
+            if (end - op < 2) {
+                return nullptr;
+            }
+            byte_order::store<uint16_t>(op, static_cast<uint16_t>(offset));
+            op += 2;
+            const size_t code = match_length - kMinMatch;
+            *token |= static_cast<uint8_t>(code >= 15 ? 15 : code);
+            if (code >= 15 && !(op = putLength(op, end, code - 15))) {
+                return nullptr;
+            }
+            return op;
+        }
+
+        /**
+         * @brief 读长度扩展字节，失败返回 false。
+         */
+        bool getLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+            uint8_t byte;
+            do {
+                if (ip >= end) {
+                    return false;
+                }
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+    }
+
+    size_t compress(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity) {
+        const uint8_t* const end = dst + capacity;
+        uint8_t* op = dst;
+        const uint8_t* anchor = src;            // 尚未输出的字面量起点
+        if (length >= kMatchLimit + 1) {
+            std::vector<uint32_t> table(size_t(1) << kHashLog, 0);
+            const uint8_t* ip = src + 1;
+            const uint8_t* const match_limit = src + length - kMatchLimit;
+            const uint8_t* const match_end = src + length - kLastLiterals;
+            uint32_t misses = 0;
+            while (ip < match_limit) {
+                const uint32_t sequence = byte_order::load<uint32_t>(ip);
+                uint32_t& slot = table[hash(sequence)];
+                const uint8_t* candidate = src + slot;
+                slot = static_cast<uint32_t>(ip - src);
+                if (candidate >= ip || static_cast<size_t>(ip - candidate) > kMaxOffset ||
+                    byte_order::load<uint32_t>(candidate) != sequence) {
+                    ip += 1 + (misses++ >> kSkipTrigger);
+                    continue;
+                }
+                misses = 0;
+                // 向前扩展匹配
+                while (ip > anchor && candidate > src && ip[-1] == candidate[-1]) {
+                    --ip;
+                    --candidate;
+                }
+                const uint8_t* scan = ip + kMinMatch;
+                const uint8_t* ref = candidate + kMinMatch;
+                while (scan < match_end && *scan == *ref) {
+                    ++scan;
+                    ++ref;
+                }
+                op = putSequence(op, end, anchor, static_cast<size_t>(ip - anchor),
+                                 static_cast<size_t>(ip - candidate), static_cast<size_t>(scan - ip));
+                if (!op) {
+                    return 0;
+                }
+                // 为匹配中间的一个位置补登记哈希，提高下一次命中率
+                if (scan - 2 > src) {
+                    table[hash(byte_order::load<uint32_t>(scan - 2))] = static_cast<uint32_t>(scan - 2 - src);
+                }
+                ip = anchor = scan;
+            }
+        }
+        op = putSequence(op, end, anchor, static_cast<size_t>(src + length - anchor), 0, 0);
+        return op ? static_cast<size_t>(op - dst) : 0;
+    }
+
+    bool decompress(const uint8_t* src, size_t length, uint8_t* dst, size_t raw_length) {
+        const uint8_t* ip = src;
+        const uint8_t* const in_end = src + length;
+        uint8_t* op = dst;
+        uint8_t* const out_end = dst + raw_length;
+        while (ip < in_end) {
+            const uint8_t token = *ip++;
+            size_t literal_length = token >> 4;
+            if (literal_length == 15 && !getLength(ip, in_end, literal_length)) {
+                return false;
+            }
+            if (static_cast<size_t>(in_end - ip) < literal_length ||
+                static_cast<size_t>(out_end - op) < literal_length) {
+                return false;
+            }
+            memcpy(op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+            if (ip == in_end) {
+                break; // 最后一个序列
+            }
+            if (in_end - ip < 2) {
+                return false;
+            }
+            const size_t offset = byte_order::load<uint16_t>(ip);
+            ip += 2;
+            size_t match_length = token & 15;
+            if (match_length == 15 && !getLength(ip, in_end, match_length)) {
+                return false;
+            }
+            match_length += kMinMatch;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst) ||
+                static_cast<size_t>(out_end - op) < match_length) {
+                return false;
+            }
+            // 匹配可能与输出重叠（offset < match_length），逐字节复制
+            const uint8_t* ref = op - offset;
+            if (offset >= match_length) {
+                memcpy(op, ref, match_length);
+                op += match_length;
+            } else {
+                for (size_t i = 0; i < match_length; ++i) {
+                    *op++ = *ref++;
+                }
+            }
+        }
+        return op == out_end;
+    }
+
+}
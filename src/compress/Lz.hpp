@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 内置的 LZ77 类块压缩（格式与 LZ4 的块格式相似），偏重速度而不是压缩率。
+ *
+ * 压缩数据由若干序列组成，每个序列：
+ * @code
+ * | token | [字面量长度扩展] | 字面量 | 匹配偏移（2 字节，小端） | [匹配长度扩展] |
+ * @endcode
+ * token 高 4 位为字面量长度，低 4 位为匹配长度减 4，取值 15 时后面跟扩展字节（每个 255 继续累加）。
+ * 最后一个序列只有字面量。匹配窗口 64 KiB，最短匹配 4 字节。
+ *
+ * 压缩时连续找不到匹配会逐渐加大探测步长，不可压缩的数据很快扫描完毕。
+ */
+namespace lz {
+
+    /**
+     * @brief 压缩结果的最大可能长度（不可压缩数据略有膨胀）。
+     */
+    constexpr size_t bound(size_t length) { return length + length / 255 + 16; }
+
+    /**
+     * @brief 压缩一个块。
+     *
+     * @param src 原始数据。
+     * @param length 原始长度。
+     * @param dst 输出缓冲区。
+     * @param capacity 输出缓冲区大小。
+     * @return size_t 压缩后的长度；输出超过 capacity 时返回 0（调用方应按原样存储）。
+     */
+    size_t compress(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity);
+
+    /**
+     * @brief 解压一个块，输入损坏时返回 false（不会越界读写）。
+     *
+     * @param src 压缩数据。
+     * @param length 压缩数据长度。
+     * @param dst 输出缓冲区。
+     * @param raw_length 原始长度，解压结果必须恰好是这个长度。
+     */
+    bool decompress(const uint8_t* src, size_t length, uint8_t* dst, size_t raw_length);
+
+}
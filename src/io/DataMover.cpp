@@ -0,0 +1,298 @@
+#include "DataMover.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+DataMover::DataMover()
+: DataMover(Config())
+{
+}
+
+DataMover::DataMover(const Config& config)
+: config_(config)
+, engine_(config.engine)
+, next_stream_(0)
+, chunks_(std::max<size_t>(1, config.buffers))
+, ok_(true)
+{
+    engine_.registerBuffers(chunks_.size(), config_.chunk_size);
+    for (size_t i = chunks_.size(); i > 0; --i) {
+        free_buffers_.push_back(i - 1);
+    }
+}
+
+DataMover::Transfer DataMover::forOperation(const TapeDrivesOperation& op, int staging_fd, uint64_t staging_offset,
+                                            int tape_fd, uint64_t tape_offset, bool direct)
+{
+    Transfer transfer;
+    const bool is_write = op.getTypeOperation() == TypeOperation::WRITE_AGGR;
+    auto aggregate = op.getAggregate();
+    transfer.length = is_write && aggregate && aggregate->payload ? aggregate->payload->size() : op.getLength();
+    if (is_write) {
+        transfer.src_fd = staging_fd;
+        transfer.src_offset = staging_offset;
+        transfer.dst_fd = tape_fd;
+        transfer.dst_offset = tape_offset;
+        transfer.dst_direct = direct;
+    } else {
+        transfer.src_fd = tape_fd;
+        transfer.src_offset = tape_offset;
+        transfer.dst_fd = staging_fd;
+        transfer.dst_offset = staging_offset;
+        transfer.src_direct = direct;
+    }
+    return transfer;
+}
+
+void DataMover::add(Transfer transfer)
+{
+    pending_.push_back(std::move(transfer));
+}
+
+bool DataMover::run()
+{
+    ok_ = true;
+    while (!pending_.empty() || !active_.empty()) {
+        while (!pending_.empty()) {
+            auto stream = std::make_unique<Stream>();
+            stream->transfer = std::move(pending_.front());
+            pending_.pop_front();
+            if (activate(*stream)) {
+                active_.push_back(std::move(stream));
+            } else if (!active_.empty()) {
+                // 固定文件表已满：等进行中的搬运结束、释放文件后再开始
+                pending_.push_front(std::move(stream->transfer));
+                break;
+            } else {
+                ok_ = false;
+                ++stats_.failed;
+                if (stream->transfer.done) {
+                    stream->transfer.done(-EBADF);
+                }
+            }
+        }
+        issue();
+        retire();
+        if (engine_.inflight() > 0) {
+            engine_.poll(true);
+            retire();
+        }
+    }
+    return ok_;
+}
+
+bool DataMover::activate(Stream& stream)
+{
+    stream.src = acquireFile(stream.transfer.src_fd);
+    if (stream.src < 0) {
+        return false;
+    }
+    stream.dst = acquireFile(stream.transfer.dst_fd);
+    if (stream.dst < 0) {
+        releaseFile(stream.transfer.src_fd);
+        return false;
+    }
+    // O_DIRECT 描述符打不开（文件系统不支持）或固定文件表已满时，整个搬运都走页缓存
+    if (stream.transfer.src_direct) {
+        openDirect(stream.transfer.src_fd, stream.src_direct_fd, stream.src_direct);
+    }
+    if (stream.transfer.dst_direct) {
+        openDirect(stream.transfer.dst_fd, stream.dst_direct_fd, stream.dst_direct);
+    }
+    return true;
+}
+
+bool DataMover::openDirect(int fd, int& direct_fd, int& direct_file)
+{
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0) {
+        return false;
+    }
+    // 重新打开同一个文件得到独立的文件描述，O_DIRECT 不会影响调用方的 fd
+    const std::string path = "/proc/self/fd/" + std::to_string(fd);
+    direct_fd = ::open(path.c_str(), (flags & O_ACCMODE) | O_DIRECT | O_CLOEXEC);
+    if (direct_fd < 0) {
+        return false;
+    }
+    direct_file = acquireFile(direct_fd);
+    if (direct_file < 0) {
+        close(direct_fd);
+        direct_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void DataMover::release(Stream& stream)
+{
+    releaseFile(stream.transfer.src_fd);
+    releaseFile(stream.transfer.dst_fd);
+    for (int fd : {stream.src_direct_fd, stream.dst_direct_fd}) {
+        if (fd >= 0) {
+            releaseFile(fd);
+            close(fd);
+        }
+    }
+}
+
+int DataMover::acquireFile(int fd)
+{
+    if (fd < 0) {
+        return -1;
+    }
+    auto it = files_.find(fd);
+    if (it != files_.end()) {
+        ++it->second.second;
+        return it->second.first;
+    }
+    const int file = engine_.registerFile(fd);
+    if (file >= 0) {
+        files_.emplace(fd, std::make_pair(file, size_t(1)));
+    }
+    return file;
+}
+
+void DataMover::releaseFile(int fd)
+{
+    auto it = files_.find(fd);
+    if (it != files_.end() && --it->second.second == 0) {
+        engine_.unregisterFile(it->second.first);
+        files_.erase(it);
+    }
+}
+
+void DataMover::issue()
+{
+    while (!deferred_.empty()) {
+        const size_t buffer = deferred_.front();
+        deferred_.pop_front();
+        advance(buffer);
+        if (!deferred_.empty() && deferred_.back() == buffer) {
+            return; // 队列仍然是满的
+        }
+    }
+    if (active_.empty()) {
+        return;
+    }
+
+    // 每轮给每路搬运切出一块，直到缓冲区用完或所有搬运都达到上限
+    const size_t count = active_.size();
+    bool progress = true;
+    while (progress && !free_buffers_.empty()) {
+        progress = false;
+        for (size_t i = 0; i < count && !free_buffers_.empty(); ++i) {
+            Stream& stream = *active_[(next_stream_ + i) % count];
+            if (stream.error != 0 || stream.issued >= stream.transfer.length ||
+                stream.chunks >= config_.chunks_per_stream) {
+                continue;
+            }
+            const size_t buffer = free_buffers_.back();
+            free_buffers_.pop_back();
+            Chunk& chunk = chunks_[buffer];
+            chunk.stream = &stream;
+            chunk.position = stream.issued;
+            chunk.length = static_cast<size_t>(std::min<uint64_t>(config_.chunk_size,
+                                                                  stream.transfer.length - stream.issued));
+            chunk.done = 0;
+            chunk.writing = false;
+            stream.issued += chunk.length;
+            ++stream.chunks;
+            advance(buffer);
+            if (!deferred_.empty()) {
+                return;
+            }
+            progress = true;
+        }
+    }
+    next_stream_ = (next_stream_ + 1) % count;
+}
+
+void DataMover::advance(size_t buffer)
+{
+    Chunk& chunk = chunks_[buffer];
+    const Stream& stream = *chunk.stream;
+    const uint64_t offset = (chunk.writing ? stream.transfer.dst_offset : stream.transfer.src_offset) +
+                            chunk.position + chunk.done;
+    const size_t length = chunk.length - chunk.done;
+    const int direct = chunk.writing ? stream.dst_direct : stream.src_direct;
+    const size_t alignment = config_.direct_alignment;
+    // 缓冲区起点按页对齐，chunk.done 对齐时缓冲区地址也对齐
+    const bool aligned = direct >= 0 && offset % alignment == 0 && length % alignment == 0 &&
+                         chunk.done % alignment == 0;
+    const int file = aligned ? direct : (chunk.writing ? stream.dst : stream.src);
+    if (aligned) {
+        ++stats_.direct_requests;
+    }
+    auto done = [this, buffer](int64_t result) { onComplete(buffer, result); };
+    const bool submitted = chunk.writing ? engine_.write(file, buffer, chunk.done, length, offset, done)
+                                         : engine_.read(file, buffer, chunk.done, length, offset, done);
+    if (!submitted) {
+        if (aligned) {
+            --stats_.direct_requests;
+        }
+        deferred_.push_back(buffer);
+    }
+}
+
+void DataMover::onComplete(size_t buffer, int64_t result)
+{
+    Chunk& chunk = chunks_[buffer];
+    Stream& stream = *chunk.stream;
+    if (result <= 0 || stream.error != 0) {
+        if (stream.error == 0) {
+            stream.error = result < 0 ? result : -EIO; // 读到文件末尾也算失败
+        }
+    } else {
+        chunk.done += static_cast<size_t>(result);
+        if (chunk.done < chunk.length) {
+            advance(buffer); // 短读写：继续剩余部分
+            return;
+        }
+        if (!chunk.writing) {
+            chunk.writing = true;
+            chunk.done = 0;
+            advance(buffer);
+            return;
+        }
+        stream.completed += chunk.length;
+        ++stats_.chunks;
+    }
+    --stream.chunks;
+    chunk.stream = nullptr;
+    free_buffers_.push_back(buffer);
+}
+
+void DataMover::retire()
+{
+    std::vector<std::pair<Completion, int64_t>> finished;
+    for (auto it = active_.begin(); it != active_.end();) {
+        Stream& stream = **it;
+        if (stream.chunks > 0 || (stream.error == 0 && stream.completed < stream.transfer.length)) {
+            ++it;
+            continue;
+        }
+        release(stream);
+        if (stream.error != 0) {
+            ok_ = false;
+            ++stats_.failed;
+        } else {
+            ++stats_.transfers;
+            stats_.bytes += stream.completed;
+        }
+        finished.emplace_back(std::move(stream.transfer.done),
+                              stream.error != 0 ? stream.error : static_cast<int64_t>(stream.completed));
+        it = active_.erase(it);
+    }
+    if (!active_.empty()) {
+        next_stream_ %= active_.size();
+    }
+    for (auto& entry : finished) {
+        if (entry.first) {
+            entry.first(entry.second);
+        }
+    }
+}
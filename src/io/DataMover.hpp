@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/NonCopyable.hpp"
+#include "IoEngine.hpp"
+#include "TapeDrivesOperation.hpp"
+
+/**
+ * @brief 聚合数据搬运：在暂存文件与磁带设备（仿真时为磁带数据文件）之间复制数据。
+ *
+ * 每次搬运（Transfer）被切成 chunk_size 大小的块，每块占用一个注册缓冲区，先读源文件再写目标文件。
+ * 每路搬运最多 chunks_per_stream 个块同时在途，多路搬运轮流发起请求，全部由调用 run() 的一个线程通过
+ * IoEngine 驱动：WRITE_AGGR 从暂存盘读、写磁带，READ_AGGR 从磁带读、写暂存盘，多台驱动器可以同时保持流式读写。
+ *
+ * 搬运的任一端可以使用 O_DIRECT（Transfer::src_direct/dst_direct）：DataMover 通过 /proc/self/fd 另外打开一个
+ * O_DIRECT 的文件描述，不影响调用方的 fd。缓冲区按页对齐，偏移和长度按 direct_alignment 对齐的块绕过页缓存
+ * 直接在注册缓冲区与设备之间 DMA，不对齐的首尾部分仍走页缓存。GiB 级的聚合数据因此不会把暂存盘上的热数据挤出页缓存。
+ *
+ * 该类不是线程安全的。
+ */
+class DataMover
+: NonCopyable
+{
+public:
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        size_t chunk_size = 1 << 20;        ///< 块大小（字节）
+        size_t buffers = 32;                ///< 注册缓冲区数量，即所有搬运同时在途的块数上限
+        size_t chunks_per_stream = 4;       ///< 每路搬运同时在途的块数上限
+        size_t direct_alignment = 4096;     ///< O_DIRECT 要求的偏移和长度对齐（逻辑块大小）
+        IoEngine::Config engine;            ///< I/O 引擎配置
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t transfers = 0;         ///< 完成的搬运数
+        uint64_t failed = 0;            ///< 失败的搬运数
+        uint64_t bytes = 0;             ///< 成功搬运的字节数
+        uint64_t chunks = 0;            ///< 搬运的块数
+        uint64_t direct_requests = 0;   ///< 以 O_DIRECT 发出的读写请求数
+    };
+
+    /**
+     * @brief 搬运完成回调，result 为搬运的字节数，失败时为负的 errno。
+     */
+    using Completion = std::function<void(int64_t result)>;
+
+    /**
+     * @brief 一次搬运：把 src_fd 中 [src_offset, src_offset + length) 复制到 dst_fd 的 dst_offset 处。
+     */
+    struct Transfer {
+        int src_fd = -1;
+        uint64_t src_offset = 0;
+        int dst_fd = -1;
+        uint64_t dst_offset = 0;
+        uint64_t length = 0;
+        Completion done;
+        bool src_direct = false;        ///< 以 O_DIRECT 读源文件
+        bool dst_direct = false;        ///< 以 O_DIRECT 写目标文件
+    };
+
+    DataMover();
+    explicit DataMover(const Config& config);
+
+    /**
+     * @brief 根据 READ_AGGR/WRITE_AGGR 操作生成搬运。
+     *
+     * 长度取聚合数据的长度（WRITE_AGGR 携带聚合时）或操作的 length；WRITE_AGGR 从暂存文件复制到磁带，
+     * READ_AGGR 从磁带复制到暂存文件。
+     *
+     * @param op 磁带操作。
+     * @param staging_fd 暂存文件。
+     * @param staging_offset 数据在暂存文件中的偏移。
+     * @param tape_fd 磁带设备或磁带数据文件。
+     * @param tape_offset 数据在磁带上的字节偏移（起始块号 × 块大小）。
+     * @param direct 磁带一端是否使用 O_DIRECT。
+     */
+    static Transfer forOperation(const TapeDrivesOperation& op, int staging_fd, uint64_t staging_offset,
+                                 int tape_fd, uint64_t tape_offset, bool direct = false);
+
+    /**
+     * @brief 加入一次搬运，在下一次 run() 中执行。
+     */
+    void add(Transfer transfer);
+
+    /**
+     * @brief 执行所有已加入的搬运，直到全部完成。完成回调中可以继续 add()。
+     *
+     * @return bool 所有搬运都成功时返回 true。
+     */
+    bool run();
+
+    IoEngine::Backend backend() const { return engine_.backend(); }
+    IoEngine::Stats engineStats() const { return engine_.stats(); }
+    Stats stats() const { return stats_; }
+
+private:
+    /**
+     * @brief 进行中的搬运。
+     */
+    struct Stream {
+        Transfer transfer;
+        int src = -1;               ///< 源文件的固定文件下标
+        int dst = -1;               ///< 目标文件的固定文件下标
+        int src_direct_fd = -1;     ///< 源文件的 O_DIRECT 描述符
+        int dst_direct_fd = -1;     ///< 目标文件的 O_DIRECT 描述符
+        int src_direct = -1;        ///< 源文件 O_DIRECT 描述符的固定文件下标
+        int dst_direct = -1;        ///< 目标文件 O_DIRECT 描述符的固定文件下标
+        uint64_t issued = 0;        ///< 已切出的字节数
+        uint64_t completed = 0;     ///< 已写入目标的字节数
+        size_t chunks = 0;          ///< 在途块数
+        int64_t error = 0;          ///< 第一个错误（负的 errno）
+    };
+
+    /**
+     * @brief 在途的块，下标与占用的缓冲区相同。
+     */
+    struct Chunk {
+        Stream* stream = nullptr;
+        uint64_t position = 0;      ///< 在搬运中的偏移
+        size_t length = 0;
+        size_t done = 0;            ///< 当前阶段已完成的字节数
+        bool writing = false;       ///< false：读源文件；true：写目标文件
+    };
+
+    bool activate(Stream& stream);
+    bool openDirect(int fd, int& direct_fd, int& direct_file);
+    void release(Stream& stream);
+    int acquireFile(int fd);
+    void releaseFile(int fd);
+    void issue();
+    void advance(size_t buffer);
+    void onComplete(size_t buffer, int64_t result);
+    void retire();
+
+    const Config config_;
+    IoEngine engine_;
+    std::deque<Transfer> pending_;                          ///< 尚未开始的搬运
+    std::vector<std::unique_ptr<Stream>> active_;           ///< 进行中的搬运
+    size_t next_stream_;                                    ///< 轮转发起请求的起点
+    std::vector<Chunk> chunks_;
+    std::vector<size_t> free_buffers_;
+    std::deque<size_t> deferred_;                           ///< 队列已满、等待重新提交的块
+    std::unordered_map<int, std::pair<int, size_t>> files_; ///< fd -> (固定文件下标, 引用数)
+    bool ok_;
+    Stats stats_;
+};
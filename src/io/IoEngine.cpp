@@ -0,0 +1,421 @@
+#include "IoEngine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+    constexpr size_t kBufferAlignment = 4096; // 满足 O_DIRECT 的对齐要求
+
+    int ioUringSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+
+    int64_t transfer(bool write, int fd, uint8_t* data, size_t length, uint64_t offset) {
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = write ? pwrite(fd, data + done, length - done, static_cast<off_t>(offset + done))
+                              : pread(fd, data + done, length - done, static_cast<off_t>(offset + done));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return done > 0 ? static_cast<int64_t>(done) : -errno;
+            }
+            if (n == 0) {
+                break; // 读到文件末尾
+            }
+            done += static_cast<size_t>(n);
+        }
+        return static_cast<int64_t>(done);
+    }
+
+}
+
+/**
+ * @brief io_uring 的提交队列、完成队列及其映射。
+ */
+struct IoEngine::Ring {
+    int fd = -1;
+    void* sq_ptr = MAP_FAILED;
+    size_t sq_length = 0;
+    void* cq_ptr = MAP_FAILED;
+    size_t cq_length = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_length = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned sq_entries = 0;
+    unsigned to_submit = 0;         ///< 已填入提交队列、尚未 io_uring_enter 的请求数
+    bool fixed_buffers = false;     ///< 缓冲区注册成功，使用 READ_FIXED/WRITE_FIXED
+    bool fixed_files = false;       ///< 固定文件表注册成功
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_length);
+        }
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+            munmap(cq_ptr, cq_length);
+        }
+        if (sq_ptr != MAP_FAILED) {
+            munmap(sq_ptr, sq_length);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+void IoEngine::BufferDeleter::operator()(uint8_t* p) const
+{
+    free(p);
+}
+
+IoEngine::IoEngine()
+: IoEngine(Config())
+{
+}
+
+IoEngine::IoEngine(const Config& config)
+: config_(config)
+, backend_(Backend::ThreadPool)
+, buffer_size_(0)
+, files_(config.max_files, -1)
+, inflight_(0)
+, work_cond_(mutex_)
+, done_cond_(mutex_)
+, running_(true)
+{
+    if (config_.backend != Backend::ThreadPool && setupRing()) {
+        backend_ = Backend::IoUring;
+    } else if (config_.backend == Backend::IoUring) {
+        throw std::runtime_error("io_uring not available");
+    } else {
+        for (size_t i = 0; i < std::max<size_t>(1, config_.workers); ++i) {
+            workers_.push_back(std::make_unique<Thread>([this] { workerLoop(); }));
+            workers_.back()->start();
+        }
+    }
+}
+
+IoEngine::~IoEngine()
+{
+    // 在途请求仍可能写入缓冲区，必须等它们完成后才能释放；此时不再调用回调
+    for (auto& slot : slots_) {
+        slot = nullptr;
+    }
+    while (inflight_ > 0) {
+        poll(true);
+    }
+    {
+        MutexLockGuard autoLock(mutex_);
+        running_ = false;
+        work_cond_.notifyAll();
+    }
+    for (auto& worker : workers_) {
+        worker->join();
+    }
+    ring_.reset(); // 先关闭 io_uring，再释放注册过的缓冲区
+}
+
+bool IoEngine::setupRing()
+{
+    auto ring = std::make_unique<Ring>();
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = ioUringSetup(std::max(1u, config_.queue_depth), &params);
+    if (ring->fd < 0) {
+        return false;
+    }
+
+    ring->sq_length = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_length = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        ring->sq_length = ring->cq_length = std::max(ring->sq_length, ring->cq_length);
+    }
+    ring->sq_ptr = mmap(nullptr, ring->sq_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                        IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        return false;
+    }
+    ring->cq_ptr = single_mmap ? ring->sq_ptr
+                               : mmap(nullptr, ring->cq_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      ring->fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ptr == MAP_FAILED) {
+        return false;
+    }
+    ring->sqes_length = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, ring->sqes_length, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES));
+    if (ring->sqes == MAP_FAILED) {
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(ring->sq_ptr);
+    uint8_t* cq = static_cast<uint8_t*>(ring->cq_ptr);
+    ring->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->sq_entries = params.sq_entries;
+
+    // 固定文件表：先注册一张全空（-1）的表，registerFile() 时逐个更新
+    ring->fixed_files = ioUringRegister(ring->fd, IORING_REGISTER_FILES, files_.data(),
+                                        static_cast<unsigned>(files_.size())) == 0;
+    ring_ = std::move(ring);
+    return true;
+}
+
+void IoEngine::registerBuffers(size_t count, size_t size)
+{
+    if (inflight_ > 0) {
+        throw std::runtime_error("registerBuffers with requests in flight");
+    }
+    if (ring_ && ring_->fixed_buffers) {
+        ioUringRegister(ring_->fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        ring_->fixed_buffers = false;
+    }
+    buffers_.clear();
+    buffer_size_ = size;
+    std::vector<iovec> iovecs;
+    for (size_t i = 0; i < count; ++i) {
+        void* p = nullptr;
+        if (posix_memalign(&p, kBufferAlignment, std::max<size_t>(size, 1)) != 0) {
+            buffers_.clear();
+            throw std::runtime_error("buffer allocation failed");
+        }
+        buffers_.emplace_back(static_cast<uint8_t*>(p));
+        iovecs.push_back(iovec{p, size});
+    }
+    if (ring_ && count > 0) {
+        // 注册失败（如超出 RLIMIT_MEMLOCK）时退化为普通的 READ/WRITE，仍然是异步的
+        ring_->fixed_buffers = ioUringRegister(ring_->fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                               static_cast<unsigned>(iovecs.size())) == 0;
+    }
+}
+
+int IoEngine::registerFile(int fd)
+{
+    auto it = std::find(files_.begin(), files_.end(), -1);
+    if (fd < 0 || it == files_.end()) {
+        return -1;
+    }
+    const int file = static_cast<int>(it - files_.begin());
+    if (ring_ && ring_->fixed_files) {
+        io_uring_files_update update;
+        memset(&update, 0, sizeof(update));
+        update.offset = static_cast<unsigned>(file);
+        update.fds = reinterpret_cast<uint64_t>(&fd);
+        if (ioUringRegister(ring_->fd, IORING_REGISTER_FILES_UPDATE, &update, 1) != 1) {
+            return -1;
+        }
+    }
+    *it = fd;
+    return file;
+}
+
+void IoEngine::unregisterFile(int file)
+{
+    if (file < 0 || static_cast<size_t>(file) >= files_.size() || files_[file] < 0) {
+        return;
+    }
+    if (ring_ && ring_->fixed_files) {
+        int empty = -1;
+        io_uring_files_update update;
+        memset(&update, 0, sizeof(update));
+        update.offset = static_cast<unsigned>(file);
+        update.fds = reinterpret_cast<uint64_t>(&empty);
+        ioUringRegister(ring_->fd, IORING_REGISTER_FILES_UPDATE, &update, 1);
+    }
+    files_[file] = -1;
+}
+
+bool IoEngine::read(int file, size_t buffer, size_t buffer_offset, size_t length, uint64_t offset, Completion done)
+{
+    return submit(false, file, buffer, buffer_offset, length, offset, std::move(done));
+}
+
+bool IoEngine::write(int file, size_t buffer, size_t buffer_offset, size_t length, uint64_t offset, Completion done)
+{
+    return submit(true, file, buffer, buffer_offset, length, offset, std::move(done));
+}
+
+bool IoEngine::submit(bool write, int file, size_t buffer, size_t buffer_offset, size_t length, uint64_t offset,
+                      Completion done)
+{
+    if (inflight_ >= config_.queue_depth) {
+        return false;
+    }
+    if (file < 0 || static_cast<size_t>(file) >= files_.size() || files_[file] < 0 ||
+        buffer >= buffers_.size() || buffer_offset + length > buffer_size_) {
+        throw std::invalid_argument("invalid file or buffer");
+    }
+    uint64_t slot;
+    if (free_slots_.empty()) {
+        slot = slots_.size();
+        slots_.emplace_back();
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    slots_[slot] = std::move(done);
+    ++inflight_;
+    ++stats_.submitted;
+    uint8_t* data = buffers_[buffer].get() + buffer_offset;
+
+    if (!ring_) {
+        MutexLockGuard autoLock(mutex_);
+        requests_.push_back(Request{slot, write, files_[file], data, length, offset});
+        work_cond_.notify();
+        return true;
+    }
+
+    // 在途请求数不超过 queue_depth <= sq_entries，提交队列总有空位
+    const unsigned tail = *ring_->sq_tail;
+    const unsigned index = tail & *ring_->sq_mask;
+    io_uring_sqe* sqe = &ring_->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    if (ring_->fixed_buffers) {
+        sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->buf_index = static_cast<uint16_t>(buffer);
+    } else {
+        sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    }
+    if (ring_->fixed_files) {
+        sqe->fd = file;
+        sqe->flags = IOSQE_FIXED_FILE;
+    } else {
+        sqe->fd = files_[file];
+    }
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->off = offset;
+    sqe->user_data = slot;
+    ring_->sq_array[index] = index;
+    __atomic_store_n(ring_->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++ring_->to_submit;
+    return true;
+}
+
+size_t IoEngine::poll(bool wait)
+{
+    std::vector<Event> events;
+    if (!ring_) {
+        MutexLockGuard autoLock(mutex_);
+        while (wait && events_.empty() && inflight_ > 0) {
+            done_cond_.wait();
+        }
+        events.swap(events_);
+    } else {
+        auto ready = [this] {
+            return __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE) != *ring_->cq_head;
+        };
+        const unsigned min_complete = wait && inflight_ > 0 && !ready() ? 1 : 0;
+        while (ring_->to_submit > 0 || min_complete > 0) {
+            int n = ioUringEnter(ring_->fd, ring_->to_submit, min_complete,
+                                 min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+            ++stats_.enter_calls;
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EBUSY) {
+                    if (!ready()) {
+                        continue; // 完成队列暂时没有空间，重试
+                    }
+                    break;
+                }
+                throw std::runtime_error("io_uring_enter failed");
+            }
+            ring_->to_submit -= std::min<unsigned>(ring_->to_submit, static_cast<unsigned>(n));
+            if (min_complete == 0 || ready()) {
+                break;
+            }
+        }
+
+        unsigned head = *ring_->cq_head;
+        const unsigned tail = __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring_->cqes[head & *ring_->cq_mask];
+            events.push_back(Event{cqe.user_data, cqe.res});
+        }
+        __atomic_store_n(ring_->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return deliver(events);
+}
+
+size_t IoEngine::deliver(std::vector<Event>& events)
+{
+    // 先释放所有槽位再调用回调：回调中可以继续提交请求
+    std::vector<std::pair<Completion, int64_t>> callbacks;
+    callbacks.reserve(events.size());
+    for (const Event& event : events) {
+        callbacks.emplace_back(std::move(slots_[event.slot]), event.result);
+        slots_[event.slot] = nullptr;
+        free_slots_.push_back(event.slot);
+        --inflight_;
+        ++stats_.completed;
+        if (event.result < 0) {
+            ++stats_.errors;
+        } else {
+            stats_.bytes += static_cast<uint64_t>(event.result);
+        }
+    }
+    for (auto& callback : callbacks) {
+        if (callback.first) {
+            callback.first(callback.second);
+        }
+    }
+    return callbacks.size();
+}
+
+void IoEngine::workerLoop()
+{
+    while (true) {
+        Request request;
+        {
+            MutexLockGuard autoLock(mutex_);
+            while (requests_.empty() && running_) {
+                work_cond_.wait();
+            }
+            if (requests_.empty()) {
+                return;
+            }
+            request = requests_.front();
+            requests_.pop_front();
+        }
+        const int64_t result = transfer(request.write, request.fd, request.data, request.length, request.offset);
+        MutexLockGuard autoLock(mutex_);
+        events_.push_back(Event{request.slot, result});
+        done_cond_.notify();
+    }
+}
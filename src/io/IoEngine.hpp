@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "shared/thread/Thread.hpp"
+
+/**
+ * @brief 异步 I/O 引擎：一个线程即可同时驱动多路聚合数据的读写。
+ *
+ * 阻塞的 pread/pwrite 需要每路数据流一个线程。IoEngine 基于 io_uring（直接使用系统调用，不依赖 liburing）：
+ * - read()/write() 只把请求填入提交队列，poll() 时一次 io_uring_enter 提交全部请求并收割完成事件；
+ * - 数据缓冲区由引擎分配并注册（registerBuffers()），使用 READ_FIXED/WRITE_FIXED，内核无需每次固定页面；
+ * - 文件注册为固定文件（registerFile()），请求使用下标而不是 fd，省去每次查找文件表的开销。
+ *
+ * 内核不支持 io_uring（或被禁止）时退化为线程池：工作线程执行 pread/pwrite，完成事件同样由 poll() 交付。
+ * 两种后端的接口和回调语义相同：完成回调总是在调用 poll() 的线程中执行，回调中可以继续提交请求。
+ *
+ * 除 poll() 的回调外，IoEngine 不是线程安全的，应由一个 I/O 线程独占使用。
+ */
+class IoEngine
+: NonCopyable
+{
+public:
+    /**
+     * @brief 后端类型。
+     */
+    enum class Backend : int {
+        Auto = 1,       ///< 优先 io_uring，不可用时使用线程池
+        IoUring = 2,
+        ThreadPool = 3
+    };
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        Backend backend = Backend::Auto;
+        unsigned queue_depth = 128;     ///< 同时在途的请求数上限
+        size_t max_files = 64;          ///< 固定文件表大小
+        size_t workers = 4;             ///< 线程池后端的工作线程数
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t submitted = 0;         ///< 提交的请求数
+        uint64_t completed = 0;         ///< 完成的请求数
+        uint64_t errors = 0;            ///< 失败的请求数（结果为负的 errno）
+        uint64_t bytes = 0;             ///< 成功传输的字节数
+        uint64_t enter_calls = 0;       ///< io_uring_enter 调用次数（线程池后端为 0）
+    };
+
+    /**
+     * @brief 完成回调，result 为传输的字节数，失败时为负的 errno。
+     */
+    using Completion = std::function<void(int64_t result)>;
+
+    IoEngine();
+
+    /**
+     * @brief 构造函数。Backend::IoUring 不可用时抛出 std::runtime_error。
+     *
+     * @param config 配置项。
+     */
+    explicit IoEngine(const Config& config);
+
+    /**
+     * @brief 析构函数，等待所有在途请求完成（不再调用回调）后释放资源。
+     */
+    ~IoEngine();
+
+    /**
+     * @brief 实际使用的后端（IoUring 或 ThreadPool）。
+     */
+    Backend backend() const { return backend_; }
+
+    /**
+     * @brief 分配并注册 count 个按页对齐、大小为 size 的缓冲区，替换之前注册的缓冲区。
+     *
+     * 必须在没有在途请求时调用。失败时抛出 std::runtime_error。
+     */
+    void registerBuffers(size_t count, size_t size);
+
+    size_t bufferCount() const { return buffers_.size(); }
+    size_t bufferSize() const { return buffer_size_; }
+    uint8_t* buffer(size_t index) { return buffers_.at(index).get(); }
+
+    /**
+     * @brief 把 fd 注册为固定文件。
+     *
+     * @return int 固定文件下标，表已满或注册失败时返回 -1。
+     */
+    int registerFile(int fd);
+
+    /**
+     * @brief 注销固定文件（不会关闭 fd），必须在该文件没有在途请求时调用。
+     */
+    void unregisterFile(int file);
+
+    /**
+     * @brief 从固定文件读入注册缓冲区。
+     *
+     * @param file 固定文件下标。
+     * @param buffer 注册缓冲区下标。
+     * @param buffer_offset 缓冲区内的起始偏移。
+     * @param length 读取长度，buffer_offset + length 不超过缓冲区大小。
+     * @param offset 文件偏移。
+     * @param done 完成回调。
+     * @return bool 在途请求已达 queue_depth 时返回 false，调用方应先 poll()。
+     */
+    bool read(int file, size_t buffer, size_t buffer_offset, size_t length, uint64_t offset, Completion done);
+
+    /**
+     * @brief 把注册缓冲区写入固定文件，参数同 read()。
+     */
+    bool write(int file, size_t buffer, size_t buffer_offset, size_t length, uint64_t offset, Completion done);
+
+    /**
+     * @brief 提交尚未提交的请求并交付已完成的请求。
+     *
+     * @param wait 为 true 且有在途请求时，至少等到一个请求完成。
+     * @return size_t 交付的完成事件数。
+     */
+    size_t poll(bool wait);
+
+    /**
+     * @brief 在途（已提交或待提交、尚未交付）的请求数。
+     */
+    size_t inflight() const { return inflight_; }
+
+    Stats stats() const { return stats_; }
+
+private:
+    struct Ring;
+
+    /**
+     * @brief 线程池后端的请求。
+     */
+    struct Request {
+        uint64_t slot;
+        bool write;
+        int fd;
+        uint8_t* data;
+        size_t length;
+        uint64_t offset;
+    };
+
+    /**
+     * @brief 已完成、等待交付的事件。
+     */
+    struct Event {
+        uint64_t slot;
+        int64_t result;
+    };
+
+    struct BufferDeleter {
+        void operator()(uint8_t* p) const;
+    };
+
+    bool submit(bool write, int file, size_t buffer, size_t buffer_offset, size_t length, uint64_t offset,
+                Completion done);
+    size_t deliver(std::vector<Event>& events);
+    void workerLoop();
+    bool setupRing();
+
+    const Config config_;
+    Backend backend_;
+    std::unique_ptr<Ring> ring_;                            ///< io_uring 后端
+    std::vector<std::unique_ptr<uint8_t, BufferDeleter>> buffers_;
+    size_t buffer_size_;
+    std::vector<int> files_;                                ///< 固定文件下标 -> fd，-1 表示空闲
+    std::vector<Completion> slots_;                         ///< 在途请求的回调，下标即 user_data
+    std::vector<uint64_t> free_slots_;
+    size_t inflight_;
+    Stats stats_;
+
+    // 线程池后端
+    MutexLock mutex_;
+    Condition work_cond_;                                   ///< 有新请求或停止时唤醒工作线程
+    Condition done_cond_;                                   ///< 有完成事件时唤醒 poll()
+    std::deque<Request> requests_;
+    std::vector<Event> events_;
+    bool running_;
+    std::vector<std::unique_ptr<Thread>> workers_;
+};
@@ -0,0 +1,206 @@
+#include "SpliceMover.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    constexpr size_t kCopyChunk = 1 << 20;
+
+    bool isPipe(int fd) {
+        struct stat st;
+        return fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode);
+    }
+
+    ssize_t spliceOnce(int in, int64_t* in_offset, int out, int64_t* out_offset, size_t length) {
+        loff_t in_pos = in_offset ? *in_offset : 0;
+        loff_t out_pos = out_offset ? *out_offset : 0;
+        ssize_t n = splice(in, in_offset ? &in_pos : nullptr, out, out_offset ? &out_pos : nullptr, length,
+                           SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n > 0) {
+            if (in_offset) {
+                *in_offset = in_pos;
+            }
+            if (out_offset) {
+                *out_offset = out_pos;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * @brief 不支持 splice 时的复制：经用户态缓冲区读写。
+     */
+    int64_t copy(int src, int64_t* src_offset, int dst, int64_t* dst_offset, uint64_t length) {
+        std::vector<uint8_t> buffer(static_cast<size_t>(std::min<uint64_t>(kCopyChunk, length)));
+        uint64_t done = 0;
+        while (done < length) {
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), length - done));
+            ssize_t n = src_offset ? pread(src, buffer.data(), want, *src_offset) : read(src, buffer.data(), want);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return -errno;
+            }
+            if (n == 0) {
+                break;
+            }
+            if (src_offset) {
+                *src_offset += n;
+            }
+            for (ssize_t written = 0; written < n;) {
+                ssize_t m = dst_offset ? pwrite(dst, buffer.data() + written, n - written, *dst_offset)
+                                       : write(dst, buffer.data() + written, n - written);
+                if (m < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (m <= 0) {
+                    return m < 0 ? -errno : -EIO;
+                }
+                if (dst_offset) {
+                    *dst_offset += m;
+                }
+                written += m;
+            }
+            done += static_cast<uint64_t>(n);
+        }
+        return static_cast<int64_t>(done);
+    }
+
+}
+
+SpliceMover::SpliceMover()
+: SpliceMover(Config())
+{
+}
+
+SpliceMover::SpliceMover(const Config& config)
+: config_(config)
+, pipe_{-1, -1}
+{
+    resetPipe();
+}
+
+SpliceMover::~SpliceMover()
+{
+    close(pipe_[0]);
+    close(pipe_[1]);
+}
+
+void SpliceMover::resetPipe()
+{
+    if (pipe_[0] >= 0) {
+        close(pipe_[0]);
+        close(pipe_[1]);
+    }
+    if (pipe2(pipe_, O_CLOEXEC) != 0) {
+        throw std::runtime_error("pipe2 failed");
+    }
+    // 扩大管道减少 splice 次数；超过系统上限时保留默认容量
+    fcntl(pipe_[1], F_SETPIPE_SZ, static_cast<int>(config_.pipe_size));
+}
+
+int64_t SpliceMover::transfer(int src, int64_t src_offset, int dst, int64_t dst_offset, uint64_t length)
+{
+    int64_t* src_pos = src_offset >= 0 ? &src_offset : nullptr;
+    int64_t* dst_pos = dst_offset >= 0 ? &dst_offset : nullptr;
+    int64_t result;
+    if (isPipe(src) || isPipe(dst)) {
+        // 一端就是管道，直接 splice
+        uint64_t done = 0;
+        result = 0;
+        while (done < length) {
+            ssize_t n = spliceOnce(src, src_pos, dst, dst_pos,
+                                   static_cast<size_t>(std::min<uint64_t>(length - done, config_.pipe_size)));
+            ++stats_.splice_calls;
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && errno == EINVAL && done == 0) {
+                result = copy(src, src_pos, dst, dst_pos, length);
+                if (result > 0) {
+                    stats_.fallback_bytes += static_cast<uint64_t>(result);
+                }
+                break;
+            }
+            if (n <= 0) {
+                result = n < 0 ? -errno : static_cast<int64_t>(done);
+                break;
+            }
+            done += static_cast<uint64_t>(n);
+            stats_.bytes += static_cast<uint64_t>(n);
+            result = static_cast<int64_t>(done);
+        }
+    } else {
+        result = viaPipe(src, src_pos, dst, dst_pos, length);
+    }
+    if (result < 0) {
+        ++stats_.failed;
+    } else {
+        ++stats_.transfers;
+    }
+    return result;
+}
+
+int64_t SpliceMover::viaPipe(int src, int64_t* src_offset, int dst, int64_t* dst_offset, uint64_t length)
+{
+    uint64_t done = 0;
+    while (done < length) {
+        ssize_t in = spliceOnce(src, src_offset, pipe_[1], nullptr,
+                                static_cast<size_t>(std::min<uint64_t>(length - done, config_.pipe_size)));
+        ++stats_.splice_calls;
+        if (in < 0 && errno == EINTR) {
+            continue;
+        }
+        if (in < 0 && errno == EINVAL && done == 0) {
+            int64_t copied = copy(src, src_offset, dst, dst_offset, length);
+            if (copied > 0) {
+                stats_.fallback_bytes += static_cast<uint64_t>(copied);
+            }
+            return copied;
+        }
+        if (in < 0) {
+            return -errno;
+        }
+        if (in == 0) {
+            break; // 源已结束
+        }
+        // 把本轮进入管道的数据全部写出，保证下一次调用时管道为空
+        for (ssize_t out = 0; out < in;) {
+            ssize_t n = spliceOnce(pipe_[0], nullptr, dst, dst_offset, static_cast<size_t>(in - out));
+            ++stats_.splice_calls;
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                const int64_t error = n < 0 ? -errno : -EIO;
+                resetPipe();
+                return error;
+            }
+            out += n;
+        }
+        done += static_cast<uint64_t>(in);
+        stats_.bytes += static_cast<uint64_t>(in);
+    }
+    return static_cast<int64_t>(done);
+}
+
+int64_t SpliceMover::transfer(const DataMover::Transfer& transfer)
+{
+    int64_t result = this->transfer(transfer.src_fd, static_cast<int64_t>(transfer.src_offset), transfer.dst_fd,
+                                    static_cast<int64_t>(transfer.dst_offset), transfer.length);
+    if (result >= 0 && static_cast<uint64_t>(result) != transfer.length) {
+        result = -EIO; // 源数据不足
+    }
+    if (transfer.done) {
+        transfer.done(result);
+    }
+    return result;
+}
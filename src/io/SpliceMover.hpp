@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "shared/mutex/NonCopyable.hpp"
+#include "DataMover.hpp"
+
+/**
+ * @brief 零拷贝搬运：用 splice 在文件、管道、套接字和磁带设备之间移动数据，数据不经过用户态缓冲区。
+ *
+ * splice 要求一端是管道：源或目标本身是管道（如客户端数据经管道流入暂存盘）时直接 splice；
+ * 两端都是普通文件或设备时经过内部管道中转（文件 -> 管道 -> 文件），内核只移动页面引用。
+ * 文件系统或设备不支持 splice 时（EINVAL），本次搬运退化为 pread/pwrite 复制。
+ *
+ * 与 DataMover 相比，SpliceMover 是同步的（每次调用阻塞到搬运完成），适合数据不需要在用户态检查的场景；
+ * 需要校验或压缩数据时使用 DataMover。该类不是线程安全的，每个线程使用自己的实例。
+ */
+class SpliceMover
+: NonCopyable
+{
+public:
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        size_t pipe_size = 1 << 20;     ///< 内部管道容量（受 /proc/sys/fs/pipe-max-size 限制）
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t transfers = 0;         ///< 完成的搬运数
+        uint64_t failed = 0;            ///< 失败的搬运数
+        uint64_t bytes = 0;             ///< 经 splice 搬运的字节数
+        uint64_t splice_calls = 0;      ///< splice 调用次数
+        uint64_t fallback_bytes = 0;    ///< 退化为 pread/pwrite 复制的字节数
+    };
+
+    SpliceMover();
+
+    /**
+     * @brief 创建内部管道，失败时抛出 std::runtime_error。
+     *
+     * @param config 配置项。
+     */
+    explicit SpliceMover(const Config& config);
+
+    ~SpliceMover();
+
+    /**
+     * @brief 把 src 中 [src_offset, src_offset + length) 搬运到 dst 的 dst_offset 处。
+     *
+     * @param src 源文件描述符。
+     * @param src_offset 源偏移，为负时使用（并推进）文件当前位置，管道和套接字必须为负。
+     * @param dst 目标文件描述符。
+     * @param dst_offset 目标偏移，含义同 src_offset。
+     * @param length 长度。
+     * @return int64_t 搬运的字节数，源提前结束时小于 length，失败时为负的 errno。
+     */
+    int64_t transfer(int src, int64_t src_offset, int dst, int64_t dst_offset, uint64_t length);
+
+    /**
+     * @brief 执行 DataMover::forOperation() 生成的搬运并调用其完成回调（O_DIRECT 标志被忽略）。
+     */
+    int64_t transfer(const DataMover::Transfer& transfer);
+
+    Stats stats() const { return stats_; }
+
+private:
+    /**
+     * @brief 两端都不是管道时经内部管道中转。
+     */
+    int64_t viaPipe(int src, int64_t* src_offset, int dst, int64_t* dst_offset, uint64_t length);
+
+    /**
+     * @brief 丢弃内部管道中残留的数据（中转失败后）并重新创建管道。
+     */
+    void resetPipe();
+
+    const Config config_;
+    int pipe_[2];               ///< 内部管道：[0] 读端，[1] 写端
+    Stats stats_;
+};
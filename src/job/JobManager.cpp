@@ -52,4 +52,17 @@ std::optional<std::string> JobManager::getJobId() const {
         return job_info_->job_id;
     }
     return std::nullopt;
+}
+
+std::optional<std::string> JobManager::getContentKey() const {
+    if (job_info_ && !job_info_->content_key.empty()) {
+        return job_info_->content_key;
+    }
+    return std::nullopt;
+}
+
+void JobManager::setStatus(JobStatus status) {
+    if (job_info_) {
+        job_info_->status = status;
+    }
 }
\ No newline at end of file
@@ -28,6 +28,7 @@ enum class JobStatus : int {
 struct JobInfo {
     JobStatus status;                   // 任务状态：0: 预, 1: Starting, 2: Indexing, 3: queuing, 4: Running, 5: suspended
     std::string job_id;           // 任务 ID
+    std::string content_key;      // 内容键（如目标文件/磁带），用于入队去重；为空表示不按内容去重
 };
 
 /**
@@ -120,4 +121,22 @@ public:
      * @return std::optional<JobInfo> 包含任务信息的可选对象。
      */
     std::optional<std::string> getJobId() const;
+
+    /**
+     * @brief 返回任务的内容键。
+     *
+     * 内容键用于识别“同一对象的重复提交”（例如同一文件/磁带的多次召回），为空时返回 std::nullopt。
+     *
+     * @return std::optional<std::string> 内容键。
+     */
+    std::optional<std::string> getContentKey() const;
+
+    /**
+     * @brief 更新任务状态。
+     *
+     * 如果任务信息不存在，则不做任何操作。
+     *
+     * @param status 新的任务状态。
+     */
+    void setStatus(JobStatus status);
 };
\ No newline at end of file
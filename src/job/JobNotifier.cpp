@@ -0,0 +1,193 @@
+#include "JobNotifier.hpp"
+#include "JobQueue.hpp"
+
+#include <optional>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <stdio.h>
+
+JobNotifier& JobNotifier::getInstance() {
+    static JobNotifier instance; // 静态局部变量，确保唯一性和线程安全
+    return instance;
+}
+
+JobNotifier::JobNotifier()
+: cond_(mutex_)
+, next_id_(1)
+, running_(true)
+, thread_([this] { run(); })
+{
+    // 先构造 JobQueue，保证它晚于通知器析构（通知线程扇出时会访问 JobQueue）
+    JobQueue::getInstance();
+    thread_.start();
+}
+
+JobNotifier::~JobNotifier() {
+    {
+        MutexLockGuard autoLock(mutex_);
+        running_ = false;
+        cond_.notify();
+    }
+    thread_.join();
+}
+
+uint64_t JobNotifier::subscribe(const std::string& job_id, JobCallback callback) {
+    return addSubscriber(job_id, std::move(callback), false);
+}
+
+std::future<JobStatus> JobNotifier::subscribeFuture(const std::string& job_id) {
+    auto promise = std::make_shared<std::promise<JobStatus>>();
+    std::future<JobStatus> future = promise->get_future();
+    addSubscriber(job_id, [promise](const std::string&, JobStatus status) {
+        promise->set_value(status);
+    }, true);
+    return future;
+}
+
+int JobNotifier::subscribeEventFd(const std::string& job_id) {
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    addSubscriber(job_id, [fd](const std::string&, JobStatus status) {
+        // 计数值即为终态的整数值，读方可直接据此得到任务结果
+        uint64_t value = static_cast<uint64_t>(status);
+        if (write(fd, &value, sizeof(value)) != sizeof(value)) {
+            perror("eventfd write");
+        }
+    }, true);
+    return fd;
+}
+
+bool JobNotifier::unsubscribe(uint64_t subscription_id) {
+    MutexLockGuard autoLock(mutex_);
+    auto it = subscription_index_.find(subscription_id);
+    if (it == subscription_index_.end()) {
+        return false;
+    }
+    auto subs = subscribers_.find(it->second);
+    if (subs != subscribers_.end()) {
+        auto& list = subs->second;
+        for (auto sub = list.begin(); sub != list.end(); ++sub) {
+            if (sub->id == subscription_id) {
+                list.erase(sub);
+                break;
+            }
+        }
+        if (list.empty()) {
+            subscribers_.erase(subs);
+        }
+    }
+    subscription_index_.erase(it);
+    return true;
+}
+
+void JobNotifier::publish(const std::string& job_id, JobStatus status) {
+    MutexLockGuard autoLock(mutex_);
+    pending_.push_back(Event{job_id, status});
+    cond_.notify();
+}
+
+bool JobNotifier::isTerminal(JobStatus status) {
+    return status == JobStatus::Succeed ||
+           status == JobStatus::Failed ||
+           status == JobStatus::Cancelled;
+}
+
+uint64_t JobNotifier::addSubscriber(const std::string& job_id, JobCallback callback, bool terminal_only) {
+    std::optional<JobStatus> status;
+    {
+        // 在锁内查询：终态事件要么已经记入 finished_，要么会在注册之后投递，不会漏掉。
+        // JobQueue 在释放自己的锁之后才发布，这里先锁 mutex_ 再锁 JobQueue 不会死锁
+        MutexLockGuard autoLock(mutex_);
+        status = JobQueue::getInstance().queryStatus(job_id);
+        if (!status) {
+            auto finished = finished_.find(job_id);
+            if (finished != finished_.end()) {
+                status = finished->second;
+            }
+        }
+        if (!status || !isTerminal(*status)) {
+            uint64_t id = next_id_++;
+            subscribers_[job_id].push_back(Subscriber{id, std::move(callback), terminal_only});
+            subscription_index_[id] = job_id;
+            return id;
+        }
+    }
+    // 已经处于终态：不会再有事件，直接回调
+    callback(job_id, *status);
+    return 0;
+}
+
+void JobNotifier::recordFinishedLocked(const std::string& job_id, JobStatus status) {
+    if (finished_.insert_or_assign(job_id, status).second) {
+        finished_order_.push_back(job_id);
+    }
+    if (finished_order_.size() > kFinishedHistory) {
+        finished_.erase(finished_order_.front());
+        finished_order_.pop_front();
+    }
+}
+
+void JobNotifier::run() {
+    std::vector<Event> batch;
+    while (true) {
+        {
+            MutexLockGuard autoLock(mutex_);
+            while (running_ && pending_.empty()) {
+                cond_.wait();
+            }
+            if (!running_ && pending_.empty()) {
+                break;
+            }
+            // 一次性取走所有待投递事件，发布方只在交换期间与通知线程竞争锁
+            batch.swap(pending_);
+        }
+        deliver(batch);
+        batch.clear();
+    }
+}
+
+void JobNotifier::deliver(std::vector<Event>& events) {
+    // 终态事件扇出给被合并的重复提交（只扩展原始事件，扇出产生的事件不会再次扇出）
+    const size_t original = events.size();
+    for (size_t i = 0; i < original; ++i) {
+        if (isTerminal(events[i].status)) {
+            for (auto& id : JobQueue::getInstance().takeCoalescedJobIds(events[i].job_id)) {
+                events.push_back(Event{std::move(id), events[i].status});
+            }
+        }
+    }
+
+    // 在锁内挑出需要调用的回调，终态时记录终态并移除该任务的全部订阅
+    std::vector<std::pair<JobCallback, const Event*>> calls;
+    {
+        MutexLockGuard autoLock(mutex_);
+        for (const auto& event : events) {
+            bool terminal = isTerminal(event.status);
+            if (terminal) {
+                recordFinishedLocked(event.job_id, event.status);
+            }
+            auto it = subscribers_.find(event.job_id);
+            if (it == subscribers_.end()) {
+                continue;
+            }
+            for (const auto& sub : it->second) {
+                if (terminal || !sub.terminal_only) {
+                    calls.emplace_back(sub.callback, &event);
+                }
+            }
+            if (terminal) {
+                for (const auto& sub : it->second) {
+                    subscription_index_.erase(sub.id);
+                }
+                subscribers_.erase(it);
+            }
+        }
+    }
+
+    for (auto& call : calls) {
+        call.first(call.second->job_id, call.second->status);
+    }
+}
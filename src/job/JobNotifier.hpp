@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/thread/Thread.hpp"
+#include "JobManager.hpp"
+
+/**
+ * @brief 任务状态变化的回调函数类型。
+ *
+ * @param job_id 发生状态变化的任务 ID。
+ * @param status 任务的新状态。
+ */
+using JobCallback = std::function<void(const std::string& job_id, JobStatus status)>;
+
+/**
+ * @brief 单例模式下的任务完成通知器。
+ *
+ * 客户端不再轮询任务状态，而是按 job_id 订阅状态变化：
+ * - subscribe：注册回调，任务每次状态变化都会被调用，进入终态（Succeed/Failed/Cancelled）后自动退订；
+ * - subscribeFuture：返回 std::future<JobStatus>，任务进入终态时就绪；
+ * - subscribeEventFd：返回 eventfd，任务进入终态时可读，读出的计数值即为终态的整数值，
+ *   便于接入 epoll 等事件循环，由调用方负责 close。
+ *
+ * 排队中任务的状态由 JobQueue::updateStatus 修改并自动发布；已出队执行的任务由执行方调用 publish()。
+ * publish() 只把事件放入待投递列表，由专用的通知线程批量取出并在锁外调用回调，
+ * 因此回调不会阻塞发布方。任务进入终态时，通知线程还会通过 JobQueue::takeCoalescedJobIds
+ * 将通知扇出给被合并到该任务的重复提交。
+ *
+ * 订阅时任务已经处于终态（JobQueue 中的状态，或通知器最近投递过的 kFinishedHistory 个终态），
+ * 则在调用方线程中立即以该终态调用回调，不再注册订阅。
+ */
+class JobNotifier
+: NonCopyable
+{
+public:
+    /**
+     * @brief 获取 JobNotifier 的唯一实例（首次调用时启动通知线程）。
+     *
+     * @return JobNotifier& 返回 JobNotifier 的引用。
+     */
+    static JobNotifier& getInstance();
+
+    /**
+     * @brief 析构函数，停止并回收通知线程。
+     */
+    ~JobNotifier();
+
+    /**
+     * @brief 注册回调，订阅任务的状态变化。
+     *
+     * @param job_id 要订阅的任务 ID。
+     * @param callback 状态变化时在通知线程中调用的回调。
+     * @return uint64_t 订阅 ID，可用于 unsubscribe；任务已处于终态时立即回调并返回 0。
+     */
+    uint64_t subscribe(const std::string& job_id, JobCallback callback);
+
+    /**
+     * @brief 订阅任务终态，返回在任务进入终态时就绪的 future（任务已处于终态时立即就绪）。
+     *
+     * @param job_id 要订阅的任务 ID。
+     * @return std::future<JobStatus> 任务终态。
+     */
+    std::future<JobStatus> subscribeFuture(const std::string& job_id);
+
+    /**
+     * @brief 订阅任务终态，返回在任务进入终态时可读的 eventfd（任务已处于终态时立即可读）。
+     *
+     * @param job_id 要订阅的任务 ID。
+     * @return int eventfd 文件描述符，失败返回 -1。
+     */
+    int subscribeEventFd(const std::string& job_id);
+
+    /**
+     * @brief 取消订阅。
+     *
+     * @param subscription_id subscribe 返回的订阅 ID。
+     * @return bool 找到并取消返回 true。
+     */
+    bool unsubscribe(uint64_t subscription_id);
+
+    /**
+     * @brief 发布任务状态变化。
+     *
+     * 仅将事件加入待投递列表并唤醒通知线程，不会在调用方线程中执行回调。
+     *
+     * @param job_id 任务 ID。
+     * @param status 任务的新状态。
+     */
+    void publish(const std::string& job_id, JobStatus status);
+
+    /**
+     * @brief 判断状态是否为终态（Succeed/Failed/Cancelled）。
+     *
+     * @param status 任务状态。
+     * @return bool 是终态返回 true。
+     */
+    static bool isTerminal(JobStatus status);
+
+private:
+    static constexpr size_t kFinishedHistory = 4096; ///< 记住最近多少个任务的终态
+
+    /**
+     * @brief 订阅者信息。
+     */
+    struct Subscriber {
+        uint64_t id;           ///< 订阅 ID
+        JobCallback callback;  ///< 回调函数
+        bool terminal_only;    ///< 是否只关心终态
+    };
+
+    /**
+     * @brief 待投递的状态变化事件。
+     */
+    struct Event {
+        std::string job_id;
+        JobStatus status;
+    };
+
+    /**
+     * @brief 默认构造函数（私有），启动通知线程。
+     */
+    JobNotifier();
+
+    /**
+     * @brief 注册订阅者；任务已处于终态时直接以终态调用回调，返回 0。
+     */
+    uint64_t addSubscriber(const std::string& job_id, JobCallback callback, bool terminal_only);
+
+    /**
+     * @brief 在持有 mutex_ 的情况下记录任务终态，超过 kFinishedHistory 时淘汰最早的记录。
+     */
+    void recordFinishedLocked(const std::string& job_id, JobStatus status);
+
+    /**
+     * @brief 通知线程主循环：批量取出事件并投递。
+     */
+    void run();
+
+    /**
+     * @brief 投递一批事件（在锁外调用回调）。
+     *
+     * @param events 要投递的事件。
+     */
+    void deliver(std::vector<Event>& events);
+
+    MutexLock mutex_;                 ///< 保护以下成员的互斥锁。
+    Condition cond_;                  ///< 有新事件或停止时唤醒通知线程。
+    std::vector<Event> pending_;      ///< 待投递事件。
+    std::unordered_map<std::string, std::vector<Subscriber>> subscribers_; ///< job_id -> 订阅者列表。
+    std::unordered_map<uint64_t, std::string> subscription_index_;          ///< 订阅 ID -> job_id。
+    std::unordered_map<std::string, JobStatus> finished_; ///< 最近投递过终态的任务 -> 终态。
+    std::deque<std::string> finished_order_;               ///< finished_ 的插入顺序，用于淘汰。
+    uint64_t next_id_;                ///< 下一个订阅 ID。
+    bool running_;                    ///< 通知线程是否运行中。
+    Thread thread_;                   ///< 通知线程。
+};
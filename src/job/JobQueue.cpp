@@ -1,4 +1,7 @@
 #include "JobQueue.hpp"
+#include "JobNotifier.hpp"
+
+#include <algorithm>
 
 /**
  * @brief 获取 JobQueue 的唯一实例。
@@ -21,6 +24,7 @@ JobQueue& JobQueue::getInstance() {
  * @return 包含任务的 std::optional 对象。如果未找到任务，则返回 std::nullopt。
  */
 std::optional<JobManager> JobQueue::dequeue() {
+    MutexLockGuard autoLock(index_mutex_);
     if (!empty()) {
         // 调用基类的 pop_front 方法取出队首任务
         JobManager job = pop_front();
@@ -32,13 +36,22 @@ std::optional<JobManager> JobQueue::dequeue() {
              jobInfo->status == JobStatus::Cancelled)) {
             // 如果状态为 Suspending 或 Cancelling，放回队尾
             push_back(job);
+
+            // 原节点已被释放，哈希表需要指向新的队尾节点
+            job_map_[jobInfo->job_id] = tail_;
+            if (!jobInfo->content_key.empty()) {
+                key_map_[jobInfo->content_key] = tail_;
+            }
         } else if (jobInfo && 
                    (jobInfo->status == JobStatus::Queuing ||
                     jobInfo->status == JobStatus::Retry ||
                     jobInfo->status == JobStatus::Resume)) {
             // 如果状态为 Queuing、Retry 或 Resume，则正常返回任务
-            job_map_.erase(job.getJobId().value()); // 从哈希表中移除任务
+            eraseIndex(job); // 从哈希表中移除任务
             return job;
+        } else {
+            // 其他状态的任务不会再回到队列，同样需要移除索引，避免悬空指针
+            eraseIndex(job);
         }
     }
     // 如果队列为空，或不满足出队条件，返回 std::nullopt
@@ -46,22 +59,68 @@ std::optional<JobManager> JobQueue::dequeue() {
 }
 
 /**
- * @brief 封装基类的 push_back 方法，提供统一的入队接口。
+ * @brief 封装基类的 push_back 方法，提供统一的入队接口，并在入队时去重。
  *
  * @param job 要入队的任务。
+ * @return EnqueueResult 入队结果。
  */
-void JobQueue::enqueue(const JobManager& job) {
+EnqueueResult JobQueue::enqueue(const JobManager& job) {
+    MutexLockGuard autoLock(index_mutex_);
+    const std::string job_id = job.getJobId().value();
+
+    // 相同 job_id 已在队列中，或已被合并到其他任务：客户端重试，直接忽略
+    if (job_map_.count(job_id) || alias_map_.count(job_id)) {
+        return EnqueueResult::DuplicateJobId;
+    }
+
+    // 相同内容键的任务已在队列中：合并到已有任务，完成时扇出通知
+    auto key = job.getContentKey();
+    if (key) {
+        auto it = key_map_.find(*key);
+        if (it != key_map_.end()) {
+            const std::string primary_id = it->second->data_.getJobId().value();
+            coalesced_map_[primary_id].push_back(job_id);
+            alias_map_[job_id] = primary_id;
+            return EnqueueResult::Coalesced;
+        }
+    }
+
     // 调用基类的 push_back 方法
     push_back(job);
 
     // 获取新插入节点的指针
     Node* newNode = tail_;
 
-    // 将 job_id 和节点指针存入哈希表
-    job_map_[job.getJobId().value()] = newNode;
+    // 将 job_id（以及内容键）和节点指针存入哈希表
+    job_map_[job_id] = newNode;
+    if (key) {
+        key_map_[*key] = newNode;
+    }
+    return EnqueueResult::Enqueued;
 }
 
 std::optional<JobManager> JobQueue::dequeueByJobId(const std::string& job_id) {
+    MutexLockGuard autoLock(index_mutex_);
+
+    // 被合并的提交：只解除该 job_id 的合并，主任务和其他提交照常执行
+    auto alias = alias_map_.find(job_id);
+    if (alias != alias_map_.end()) {
+        auto primary = job_map_.find(alias->second);
+        if (primary == job_map_.end()) {
+            return std::nullopt; // 主任务已出队执行，与主任务一样不能再移除
+        }
+        auto& ids = coalesced_map_[alias->second];
+        ids.erase(std::find(ids.begin(), ids.end(), job_id));
+        if (ids.empty()) {
+            coalesced_map_.erase(alias->second);
+        }
+        alias_map_.erase(alias);
+
+        JobInfo info = primary->second->data_.getJobInfo().value();
+        info.job_id = job_id;
+        return JobManager(info);
+    }
+
     // 在哈希表中查找 job_id
     auto it = job_map_.find(job_id);
     if (it == job_map_.end()) {
@@ -71,12 +130,115 @@ std::optional<JobManager> JobQueue::dequeueByJobId(const std::string& job_id) {
     // 获取要移除的节点
     Node* nodeToRemove = it->second;
 
+    // 有被合并的提交时由其接替主任务，节点留在队列中
+    JobManager job = nodeToRemove->data_;
+    if (promoteCoalesced(job_id, nodeToRemove)) {
+        return job;
+    }
+
     // 从队列中移除节点
-    JobManager job = remove(nodeToRemove);
+    job = remove(nodeToRemove);
 
-    // 从哈希表中移除 job_id
-    job_map_.erase(it);
+    // 从哈希表中移除 job_id 和内容键
+    eraseIndex(job);
 
     // 返回移除的任务
     return job;
+}
+
+std::vector<std::string> JobQueue::takeCoalescedJobIds(const std::string& job_id) {
+    MutexLockGuard autoLock(index_mutex_);
+    auto it = coalesced_map_.find(job_id);
+    if (it == coalesced_map_.end()) {
+        return {};
+    }
+    std::vector<std::string> ids = std::move(it->second);
+    coalesced_map_.erase(it);
+    for (const auto& id : ids) {
+        alias_map_.erase(id);
+    }
+    return ids;
+}
+
+std::string JobQueue::resolveJobId(const std::string& job_id) const {
+    MutexLockGuard autoLock(index_mutex_);
+    auto it = alias_map_.find(job_id);
+    return it == alias_map_.end() ? job_id : it->second;
+}
+
+std::optional<JobStatus> JobQueue::queryStatus(const std::string& job_id) const {
+    MutexLockGuard autoLock(index_mutex_);
+    auto alias = alias_map_.find(job_id);
+    auto it = job_map_.find(alias == alias_map_.end() ? job_id : alias->second);
+    if (it == job_map_.end()) {
+        return std::nullopt;
+    }
+    auto info = it->second->data_.getJobInfo();
+    if (!info) {
+        return std::nullopt;
+    }
+    return info->status;
+}
+
+bool JobQueue::updateStatus(const std::string& job_id, JobStatus status) {
+    {
+        MutexLockGuard autoLock(index_mutex_);
+        auto it = job_map_.find(job_id);
+        if (it == job_map_.end()) {
+            return false;
+        }
+        auto info = it->second->data_.getJobInfo();
+        if (info && info->status == status) {
+            return true;
+        }
+        it->second->data_.setStatus(status);
+    }
+    // 释放索引锁后再发布，通知器订阅时会在持有自己的锁时查询队列
+    JobNotifier::getInstance().publish(job_id, status);
+    return true;
+}
+
+bool JobQueue::cancel(const std::string& job_id) {
+    if (!dequeueByJobId(job_id)) {
+        return false;
+    }
+    JobNotifier::getInstance().publish(job_id, JobStatus::Cancelled);
+    return true;
+}
+
+void JobQueue::eraseIndex(const JobManager& job) {
+    job_map_.erase(job.getJobId().value());
+    // 相同内容键的提交都会被合并，队列中同一内容键至多对应一个任务，可以直接移除
+    auto key = job.getContentKey();
+    if (key) {
+        key_map_.erase(*key);
+    }
+}
+
+bool JobQueue::promoteCoalesced(const std::string& job_id, Node* node) {
+    auto it = coalesced_map_.find(job_id);
+    if (it == coalesced_map_.end() || it->second.empty()) {
+        return false;
+    }
+    std::vector<std::string> ids = std::move(it->second);
+    coalesced_map_.erase(it);
+
+    // 新的主任务是独立的提交，状态从排队开始，不继承原主任务的暂停、取消等状态
+    const std::string successor = ids.front();
+    JobInfo info = node->data_.getJobInfo().value();
+    info.job_id = successor;
+    info.status = JobStatus::Queuing;
+    node->data_ = JobManager(info);
+
+    job_map_.erase(job_id);
+    job_map_[successor] = node;
+    alias_map_.erase(successor);
+    if (ids.size() > 1) {
+        ids.erase(ids.begin());
+        for (const auto& id : ids) {
+            alias_map_[id] = successor;
+        }
+        coalesced_map_[successor] = std::move(ids);
+    }
+    return true;
 }
\ No newline at end of file
@@ -1,10 +1,22 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 #include "shared/queue/BaseQueue.hpp"
 #include "JobManager.hpp"
 
+/**
+ * @brief 入队结果。
+ *
+ * 客户端重试会导致同一任务被重复提交，JobQueue 在入队时识别重复并返回对应结果。
+ */
+enum class EnqueueResult : int {
+    Enqueued = 1,       ///< 新任务已入队
+    DuplicateJobId = 2, ///< 相同 job_id 的任务已在队列中，本次提交被忽略
+    Coalesced = 3       ///< 相同内容键的任务已在队列中，本次提交被合并到已有任务
+};
+
 /**
  * @brief 单例模式下的任务管理队列。
  *
@@ -34,16 +46,28 @@ public:
     std::optional<JobManager> dequeue();
  
     /**
-     * @brief 封装基类的 push_back 方法，提供统一的入队接口。
+     * @brief 封装基类的 push_back 方法，提供统一的入队接口，并在入队时去重。
+     *
+     * - 如果 job_id 已在队列中（或已被合并到其他任务），则不重复入队，返回 DuplicateJobId。
+     * - 如果内容键（content_key）与队列中某个任务相同，则将本次提交合并到已有任务，返回 Coalesced；
+     *   已有任务完成时，应通过 takeCoalescedJobIds 取出被合并的 job_id 并向它们扇出完成通知。
+     * - 否则正常入队，返回 Enqueued。
+     *
+     * 去重通过哈希表完成，时间复杂度为 O(1)。
      *
      * @param job 要入队的任务。
+     * @return EnqueueResult 入队结果。
      */
-    void enqueue(const JobManager& job);
+    EnqueueResult enqueue(const JobManager& job);
 
     /**
      * @brief 根据 job_id 移除指定任务。
      *
      * - 如果找到对应的任务，则从队列中移除并返回该任务。
+     *   有提交被合并到该任务时，第一个被合并的 job_id 接替为主任务，留在原位置继续排队，
+     *   其余被合并的 job_id 改为合并到新的主任务；
+     * - 如果 job_id 是被合并的提交且主任务仍在排队，则只解除该 job_id 的合并，返回主任务的副本（job_id 为该 ID），
+     *   主任务和其他提交不受影响；
      * - 如果未找到任务，则返回 std::nullopt。
      *
      * @param job_id 要移除的任务 ID。
@@ -51,6 +75,57 @@ public:
      */
     std::optional<JobManager> dequeueByJobId(const std::string& job_id);
 
+    /**
+     * @brief 取出并清除被合并到指定任务的 job_id 列表。
+     *
+     * 任务完成（或被取消）时调用，用于向所有重复提交的调用方扇出完成通知。
+     * 即使任务已经出队，列表也会保留到本方法被调用为止。
+     *
+     * @param job_id 已有（主）任务的 ID。
+     * @return std::vector<std::string> 被合并的 job_id 列表，可能为空。
+     */
+    std::vector<std::string> takeCoalescedJobIds(const std::string& job_id);
+
+    /**
+     * @brief 将 job_id 解析为实际执行的任务 ID。
+     *
+     * 如果 job_id 的提交被合并到了其他任务，则返回该任务的 ID；否则原样返回。
+     *
+     * @param job_id 要解析的任务 ID。
+     * @return std::string 实际执行的任务 ID。
+     */
+    std::string resolveJobId(const std::string& job_id) const;
+
+    /**
+     * @brief 查询排队中任务的状态。
+     *
+     * 被合并的 job_id 返回其主任务的状态。
+     *
+     * @param job_id 要查询的任务 ID。
+     * @return std::optional<JobStatus> 任务状态；任务不在队列中时返回 std::nullopt。
+     */
+    std::optional<JobStatus> queryStatus(const std::string& job_id) const;
+
+    /**
+     * @brief 更新排队中任务的状态，状态发生变化时通过 JobNotifier 发布。
+     *
+     * @param job_id 要更新的任务 ID。
+     * @param status 新的任务状态。
+     * @return bool 任务在队列中并已更新返回 true。
+     */
+    bool updateStatus(const std::string& job_id, JobStatus status);
+
+    /**
+     * @brief 取消排队中的任务：按 dequeueByJobId 移除，并通过 JobNotifier 发布 Cancelled。
+     *
+     * 取消主任务时被合并的提交接替排队，取消被合并的提交时只解除该 ID，
+     * 因此 Cancelled 事件不会扇出给其他相同内容的提交。
+     *
+     * @param job_id 要取消的任务 ID。
+     * @return bool 找到并移除返回 true。
+     */
+    bool cancel(const std::string& job_id);
+
 private:
     /**
      * @brief 默认构造函数（私有）。
@@ -82,4 +157,45 @@ private:
      * - 值：指向任务节点的指针（BaseQueue<T>::Node*）。
      */
     std::unordered_map<std::string, Node*> job_map_;
+
+    /**
+     * @brief 哈希表，用于存储内容键和对应节点的映射（仅包含内容键非空的任务）。
+     */
+    std::unordered_map<std::string, Node*> key_map_;
+
+    /**
+     * @brief 主任务 ID 到被合并任务 ID 列表的映射，用于扇出完成通知。
+     */
+    std::unordered_map<std::string, std::vector<std::string>> coalesced_map_;
+
+    /**
+     * @brief 被合并任务 ID 到主任务 ID 的映射。
+     */
+    std::unordered_map<std::string, std::string> alias_map_;
+
+    /**
+     * @brief 保护上述哈希表的互斥锁。
+     *
+     * 入队/出队需要同时修改链表和哈希表，因此在整个操作期间持有该锁；
+     * 加锁顺序固定为 index_mutex_ -> BaseQueue::mutex_，避免死锁。
+     */
+    mutable MutexLock index_mutex_;
+
+    /**
+     * @brief 在持有 index_mutex_ 的情况下，将任务从哈希表中移除。
+     *
+     * 只移除 job_id 和内容键：任务出队执行时，被合并的 job_id 仍保留到 takeCoalescedJobIds 被调用为止。
+     *
+     * @param job 要移除索引的任务。
+     */
+    void eraseIndex(const JobManager& job);
+
+    /**
+     * @brief 在持有 index_mutex_ 的情况下，让第一个被合并的 job_id 接替排队中的主任务。
+     *
+     * @param job_id 主任务 ID。
+     * @param node 主任务所在的节点。
+     * @return bool 没有被合并的提交时返回 false，节点不变。
+     */
+    bool promoteCoalesced(const std::string& job_id, Node* node);
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "ShmJobQueue.hpp"
+
+ShmJobQueue::ShmJobQueue(const std::string& name, uint32_t capacity, bool create)
+: queue_(name, capacity, create)
+{
+
+}
+
+bool ShmJobQueue::enqueue(const JobInfo& job) {
+    if (job.job_id.size() > ShmJobRecord::kMaxJobIdLength ||
+        job.content_key.size() > ShmJobRecord::kMaxContentKeyLength) {
+        return false;
+    }
+    ShmJobRecord record;
+    record.status = static_cast<int32_t>(job.status);
+    record.job_id_length = static_cast<uint16_t>(job.job_id.size());
+    record.content_key_length = static_cast<uint16_t>(job.content_key.size());
+    memcpy(record.job_id, job.job_id.data(), job.job_id.size());
+    record.job_id[job.job_id.size()] = '\0';
+    memcpy(record.content_key, job.content_key.data(), job.content_key.size());
+    record.content_key[job.content_key.size()] = '\0';
+    return queue_.push_back(record);
+}
+
+std::optional<JobInfo> ShmJobQueue::dequeue() {
+    auto record = queue_.pop_front();
+    if (!record) {
+        return std::nullopt;
+    }
+    return toJobInfo(*record);
+}
+
+std::optional<JobInfo> ShmJobQueue::dequeueByJobId(const std::string& job_id) {
+    auto record = queue_.remove_if([&job_id](const ShmJobRecord& r) {
+        return r.job_id_length == job_id.size() && memcmp(r.job_id, job_id.data(), job_id.size()) == 0;
+    });
+    if (!record) {
+        return std::nullopt;
+    }
+    return toJobInfo(*record);
+}
+
+JobInfo ShmJobQueue::toJobInfo(const ShmJobRecord& record) {
+    JobInfo info;
+    info.status = static_cast<JobStatus>(record.status);
+    info.job_id.assign(record.job_id, record.job_id_length);
+    info.content_key.assign(record.content_key, record.content_key_length);
+    return info;
+}
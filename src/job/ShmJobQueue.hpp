@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "shared/queue/ShmQueue.hpp"
+#include "JobManager.hpp"
+
+/**
+ * @brief 共享内存中的任务记录（定长、可平凡拷贝）。
+ *
+ * JobInfo 中的 std::string 持有堆内存，无法跨进程共享，因此入队时拷贝到定长字段中。
+ */
+struct ShmJobRecord {
+    static constexpr size_t kMaxJobIdLength = 63;        ///< job_id 的最大长度
+    static constexpr size_t kMaxContentKeyLength = 191;  ///< content_key 的最大长度
+
+    int32_t status;                                 ///< JobStatus 的整数值
+    uint16_t job_id_length;
+    uint16_t content_key_length;
+    char job_id[kMaxJobIdLength + 1];
+    char content_key[kMaxContentKeyLength + 1];
+};
+
+/**
+ * @brief 跨进程的任务队列。
+ *
+ * 同一台机器上的多个生产者/消费者进程通过 POSIX 共享内存段交换 JobInfo 记录，
+ * 无竞争时入队和出队都不需要系统调用。与 JobQueue 不同，这里没有哈希索引：
+ * dequeueByJobId 需要线性扫描，适合作为跨进程的提交通道，由消费者转存到 JobQueue。
+ */
+class ShmJobQueue {
+public:
+    /**
+     * @brief 创建或打开共享内存任务队列。
+     *
+     * @param name 共享内存对象名（如 "/job_queue"）。
+     * @param capacity 最大任务数（仅在创建时使用）。
+     * @param create 是否创建。
+     */
+    ShmJobQueue(const std::string& name, uint32_t capacity, bool create);
+
+    /**
+     * @brief 任务入队。
+     *
+     * @param job 要入队的任务信息。
+     * @return bool 队列已满或 job_id/content_key 超长时返回 false。
+     */
+    bool enqueue(const JobInfo& job);
+
+    /**
+     * @brief 取出队首任务。
+     *
+     * @return std::optional<JobInfo> 队列为空时返回 std::nullopt。
+     */
+    std::optional<JobInfo> dequeue();
+
+    /**
+     * @brief 根据 job_id 移除指定任务。
+     *
+     * @param job_id 要移除的任务 ID。
+     * @return std::optional<JobInfo> 未找到返回 std::nullopt。
+     */
+    std::optional<JobInfo> dequeueByJobId(const std::string& job_id);
+
+    /**
+     * @brief 返回队列中任务的数量。
+     */
+    size_t size() const { return queue_.size(); }
+
+    /**
+     * @brief 删除共享内存对象。
+     *
+     * @param name 共享内存对象名。
+     */
+    static void unlink(const std::string& name) { ShmQueue<ShmJobRecord>::unlink(name); }
+
+private:
+    static JobInfo toJobInfo(const ShmJobRecord& record);
+
+    ShmQueue<ShmJobRecord> queue_; ///< 共享内存中的链表队列
+};
@@ -0,0 +1,101 @@
+#include "JobClient.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace job_protocol;
+
+JobClient::JobClient()
+: fd_(-1)
+, in_offset_(0)
+{
+
+}
+
+JobClient::~JobClient() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool JobClient::connect(const std::string& socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        perror("socket");
+        return false;
+    }
+    if (::connect(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("connect");
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void JobClient::send(const Request& request) {
+    encodeRequest(request, out_);
+}
+
+bool JobClient::flush() {
+    size_t offset = 0;
+    while (offset < out_.size()) {
+        ssize_t n = write(fd_, out_.data() + offset, out_.size() - offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            return false;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    out_.clear();
+    return true;
+}
+
+bool JobClient::receive(Response& response) {
+    while (true) {
+        size_t available = in_.size() - in_offset_;
+        if (available >= kHeaderSize) {
+            FrameHeader header = decodeHeader(in_.data() + in_offset_);
+            if (header.body_length > kMaxBodySize) {
+                return false;
+            }
+            if (available >= kHeaderSize + header.body_length) {
+                bool ok = decodeResponse(header, in_.data() + in_offset_ + kHeaderSize, response);
+                in_offset_ += kHeaderSize + header.body_length;
+                return ok;
+            }
+        }
+
+        // 压缩缓冲区后继续读取
+        in_.erase(in_.begin(), in_.begin() + static_cast<std::ptrdiff_t>(in_offset_));
+        in_offset_ = 0;
+        size_t old_size = in_.size();
+        in_.resize(old_size + 64 * 1024);
+        ssize_t n = read(fd_, in_.data() + old_size, 64 * 1024);
+        if (n <= 0) {
+            in_.resize(old_size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        in_.resize(old_size + static_cast<size_t>(n));
+    }
+}
+
+bool JobClient::call(const Request& request, Response& response) {
+    send(request);
+    return flush() && receive(response);
+}
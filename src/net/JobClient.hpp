@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "shared/mutex/NonCopyable.hpp"
+#include "JobProtocol.hpp"
+
+/**
+ * @brief JobServer 的阻塞式客户端。
+ *
+ * 支持两种用法：
+ * - 流水线：多次调用 send() 缓存请求，flush() 一次性写出，再依次调用 receive() 读取响应；
+ * - 同步：call() 发送单个请求并等待其响应。
+ */
+class JobClient
+: NonCopyable
+{
+public:
+    JobClient();
+
+    /**
+     * @brief 析构函数，关闭连接。
+     */
+    ~JobClient();
+
+    /**
+     * @brief 连接到服务端。
+     *
+     * @param socket_path Unix 域套接字路径。
+     * @return bool 成功返回 true。
+     */
+    bool connect(const std::string& socket_path);
+
+    /**
+     * @brief 将请求编码到发送缓冲区（不会立即写出）。
+     *
+     * @param request 请求。
+     */
+    void send(const job_protocol::Request& request);
+
+    /**
+     * @brief 写出发送缓冲区中的所有请求。
+     *
+     * @return bool 成功返回 true。
+     */
+    bool flush();
+
+    /**
+     * @brief 阻塞读取下一个响应。
+     *
+     * @param response 输出的响应。
+     * @return bool 成功返回 true，连接关闭或协议错误返回 false。
+     */
+    bool receive(job_protocol::Response& response);
+
+    /**
+     * @brief 发送单个请求并等待响应。
+     *
+     * @param request 请求。
+     * @param response 输出的响应。
+     * @return bool 成功返回 true。
+     */
+    bool call(const job_protocol::Request& request, job_protocol::Response& response);
+
+private:
+    int fd_;                        ///< 连接套接字
+    std::vector<uint8_t> out_;      ///< 发送缓冲区
+    std::vector<uint8_t> in_;       ///< 接收缓冲区
+    size_t in_offset_;              ///< in_ 中已消费的字节数
+};
@@ -0,0 +1,127 @@
+#include "JobProtocol.hpp"
+
+namespace job_protocol {
+
+    namespace {
+
+        void putU16(std::vector<uint8_t>& out, uint16_t v) {
+            out.push_back(static_cast<uint8_t>(v));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+        }
+
+        void putU32(std::vector<uint8_t>& out, uint32_t v) {
+            out.push_back(static_cast<uint8_t>(v));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+            out.push_back(static_cast<uint8_t>(v >> 16));
+            out.push_back(static_cast<uint8_t>(v >> 24));
+        }
+
+        uint16_t getU16(const uint8_t* p) {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        uint32_t getU32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0]) |
+                   (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) |
+                   (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        void putHeader(std::vector<uint8_t>& out, uint32_t body_length, JobOpcode opcode,
+                       ResultCode result, uint32_t request_id) {
+            putU32(out, body_length);
+            out.push_back(static_cast<uint8_t>(opcode));
+            out.push_back(static_cast<uint8_t>(result));
+            putU16(out, 0);
+            putU32(out, request_id);
+        }
+
+    }
+
+    FrameHeader decodeHeader(const uint8_t* data) {
+        FrameHeader header;
+        header.body_length = getU32(data);
+        header.opcode = static_cast<JobOpcode>(data[4]);
+        header.result = static_cast<ResultCode>(data[5]);
+        header.request_id = getU32(data + 8);
+        return header;
+    }
+
+    void encodeRequest(const Request& request, std::vector<uint8_t>& out) {
+        const uint16_t id_len = static_cast<uint16_t>(request.job_id.size());
+        if (request.opcode == JobOpcode::Enqueue) {
+            const uint16_t key_len = static_cast<uint16_t>(request.content_key.size());
+            putHeader(out, 5u + id_len + key_len, request.opcode, ResultCode::Ok, request.request_id);
+            out.push_back(static_cast<uint8_t>(request.status));
+            putU16(out, id_len);
+            putU16(out, key_len);
+            out.insert(out.end(), request.job_id.begin(), request.job_id.begin() + id_len);
+            out.insert(out.end(), request.content_key.begin(), request.content_key.begin() + key_len);
+        } else {
+            putHeader(out, 2u + id_len, request.opcode, ResultCode::Ok, request.request_id);
+            putU16(out, id_len);
+            out.insert(out.end(), request.job_id.begin(), request.job_id.begin() + id_len);
+        }
+    }
+
+    bool decodeRequest(const FrameHeader& header, const uint8_t* body, Request& request) {
+        request.opcode = header.opcode;
+        request.request_id = header.request_id;
+        request.content_key.clear();
+        switch (header.opcode) {
+            case JobOpcode::Enqueue:
+            {
+                if (header.body_length < 5) {
+                    return false;
+                }
+                const uint16_t id_len = getU16(body + 1);
+                const uint16_t key_len = getU16(body + 3);
+                if (header.body_length != 5u + id_len + key_len) {
+                    return false;
+                }
+                request.status = static_cast<JobStatus>(body[0]);
+                request.job_id.assign(reinterpret_cast<const char*>(body + 5), id_len);
+                request.content_key.assign(reinterpret_cast<const char*>(body + 5 + id_len), key_len);
+                return true;
+            }
+            case JobOpcode::DequeueByJobId:
+            case JobOpcode::Status:
+            case JobOpcode::Cancel:
+            {
+                if (header.body_length < 2) {
+                    return false;
+                }
+                const uint16_t id_len = getU16(body);
+                if (header.body_length != 2u + id_len) {
+                    return false;
+                }
+                request.job_id.assign(reinterpret_cast<const char*>(body + 2), id_len);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void encodeResponse(const Response& response, std::vector<uint8_t>& out) {
+        const bool has_value = response.result == ResultCode::Ok &&
+                               (response.opcode == JobOpcode::Enqueue || response.opcode == JobOpcode::Status);
+        putHeader(out, has_value ? 1 : 0, response.opcode, response.result, response.request_id);
+        if (has_value) {
+            out.push_back(response.value);
+        }
+    }
+
+    bool decodeResponse(const FrameHeader& header, const uint8_t* body, Response& response) {
+        response.opcode = header.opcode;
+        response.result = header.result;
+        response.request_id = header.request_id;
+        response.value = 0;
+        if (header.body_length == 1) {
+            response.value = body[0];
+        } else if (header.body_length != 0) {
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "JobManager.hpp"
+
+/**
+ * @brief 任务提交协议（本地 Unix 域套接字）的紧凑二进制帧格式。
+ *
+ * 所有整数均为小端序。请求和响应使用相同的 12 字节帧头：
+ *
+ * | 偏移 | 长度 | 字段                                   |
+ * |------|------|----------------------------------------|
+ * | 0    | 4    | body_length：帧头之后的消息体长度      |
+ * | 4    | 1    | opcode：操作码（JobOpcode）            |
+ * | 5    | 1    | result：响应结果码（请求中为 0）       |
+ * | 6    | 2    | reserved                               |
+ * | 8    | 4    | request_id：由客户端分配，响应原样返回 |
+ *
+ * 客户端可以连续发送多个请求而不等待响应（流水线），服务端按请求顺序返回响应，
+ * 客户端通过 request_id 对应请求与响应。
+ *
+ * 消息体：
+ * - Enqueue 请求：status(1) + id_len(2) + key_len(2) + job_id + content_key；
+ *   响应：enqueue_result(1)。
+ * - DequeueByJobId / Status / Cancel 请求：id_len(2) + job_id；
+ *   Status 响应：status(1)，其余响应无消息体。
+ */
+namespace job_protocol {
+
+    constexpr size_t kHeaderSize = 12;            ///< 帧头长度
+    constexpr size_t kMaxBodySize = 64 * 1024;    ///< 单个消息体的最大长度，超过视为协议错误
+
+    /**
+     * @brief 操作码。
+     */
+    enum class JobOpcode : uint8_t {
+        Enqueue = 1,        ///< 入队（JobQueue::enqueue）
+        DequeueByJobId = 2, ///< 按 ID 移出队列（JobQueue::dequeueByJobId）
+        Status = 3,         ///< 查询状态（JobQueue::queryStatus）
+        Cancel = 4          ///< 取消任务：移出队列并发布 Cancelled 通知
+    };
+
+    /**
+     * @brief 响应结果码。
+     */
+    enum class ResultCode : uint8_t {
+        Ok = 0,             ///< 成功
+        NotFound = 1,       ///< 任务不在队列中
+        BadRequest = 2      ///< 请求格式错误或未知操作码
+    };
+
+    /**
+     * @brief 帧头。
+     */
+    struct FrameHeader {
+        uint32_t body_length;
+        JobOpcode opcode;
+        ResultCode result;
+        uint32_t request_id;
+    };
+
+    /**
+     * @brief 解码后的请求。
+     */
+    struct Request {
+        JobOpcode opcode;
+        uint32_t request_id;
+        JobStatus status;         ///< 仅 Enqueue 使用
+        std::string job_id;
+        std::string content_key;  ///< 仅 Enqueue 使用
+    };
+
+    /**
+     * @brief 解码后的响应。
+     */
+    struct Response {
+        JobOpcode opcode;
+        ResultCode result;
+        uint32_t request_id;
+        uint8_t value;            ///< Enqueue 为 EnqueueResult，Status 为 JobStatus，其余为 0
+    };
+
+    /**
+     * @brief 从缓冲区解析帧头。
+     *
+     * @param data 至少 kHeaderSize 字节的缓冲区。
+     * @return FrameHeader 帧头。
+     */
+    FrameHeader decodeHeader(const uint8_t* data);
+
+    /**
+     * @brief 将请求编码追加到输出缓冲区。
+     *
+     * @param request 请求。
+     * @param out 输出缓冲区。
+     */
+    void encodeRequest(const Request& request, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 解码请求消息体。
+     *
+     * @param header 已解析的帧头。
+     * @param body 消息体（header.body_length 字节）。
+     * @param request 输出的请求。
+     * @return bool 格式正确返回 true。
+     */
+    bool decodeRequest(const FrameHeader& header, const uint8_t* body, Request& request);
+
+    /**
+     * @brief 将响应编码追加到输出缓冲区。
+     *
+     * @param response 响应。
+     * @param out 输出缓冲区。
+     */
+    void encodeResponse(const Response& response, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 解码响应消息体。
+     *
+     * @param header 已解析的帧头。
+     * @param body 消息体（header.body_length 字节）。
+     * @param response 输出的响应。
+     * @return bool 格式正确返回 true。
+     */
+    bool decodeResponse(const FrameHeader& header, const uint8_t* body, Response& response);
+
+}
@@ -0,0 +1,338 @@
+#include "JobServer.hpp"
+#include "JobQueue.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace job_protocol;
+
+namespace {
+
+    constexpr int kMaxEvents = 64;
+    constexpr size_t kReadChunk = 64 * 1024;
+    constexpr size_t kMaxPendingInput = 16 * kReadChunk;
+
+}
+
+JobServer::JobServer(const std::string& socket_path)
+: socket_path_(socket_path)
+, listen_fd_(-1)
+, epoll_fd_(-1)
+, wakeup_fd_(-1)
+, running_(false)
+, served_(0)
+{
+
+}
+
+JobServer::~JobServer() {
+    for (auto& entry : connections_) {
+        close(entry.first);
+    }
+    if (wakeup_fd_ >= 0) {
+        close(wakeup_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+}
+
+bool JobServer::start() {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path_.size() >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "JobServer: socket path too long: %s\n", socket_path_.c_str());
+        return false;
+    }
+    strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        perror("socket");
+        return false;
+    }
+    unlink(socket_path_.c_str());
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("bind");
+        return false;
+    }
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
+        perror("listen");
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+        perror("epoll_create1/eventfd");
+        return false;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wakeup_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+
+    running_ = true;
+    return true;
+}
+
+void JobServer::loop() {
+    struct epoll_event events[kMaxEvents];
+    while (running_) {
+        int n = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                handleAccept();
+                continue;
+            }
+            if (fd == wakeup_fd_) {
+                uint64_t value;
+                ssize_t ignored = read(wakeup_fd_, &value, sizeof(value));
+                (void) ignored;
+                continue;
+            }
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                continue;
+            }
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                if (!flushOutput(fd, it->second)) {
+                    closeConnection(fd);
+                    continue;
+                }
+                // 输出降到上限以下：继续处理暂停期间留在缓冲区中的请求
+                if ((it->second.events & EPOLLIN) && !it->second.in.empty()) {
+                    processInput(fd, it->second, false);
+                    continue;
+                }
+            }
+            if (events[i].events & EPOLLIN) {
+                handleRead(fd, it->second);
+            }
+        }
+    }
+}
+
+void JobServer::stop() {
+    running_ = false;
+    if (wakeup_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+        (void) ignored;
+    }
+}
+
+void JobServer::handleAccept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("accept4");
+            }
+            return;
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl");
+            close(fd);
+            continue;
+        }
+        connections_[fd].events = EPOLLIN;
+    }
+}
+
+void JobServer::handleRead(int fd, Connection& conn) {
+    // 读尽内核缓冲区中的数据
+    bool peer_closed = false;
+    while (true) {
+        size_t old_size = conn.in.size();
+        conn.in.resize(old_size + kReadChunk);
+        ssize_t n = read(fd, conn.in.data() + old_size, kReadChunk);
+        if (n > 0) {
+            conn.in.resize(old_size + static_cast<size_t>(n));
+            // 一次最多读入 kMaxPendingInput，其余留在内核缓冲区（水平触发，处理完后会再次就绪）
+            if (static_cast<size_t>(n) < kReadChunk || conn.in.size() >= kMaxPendingInput) {
+                break;
+            }
+            continue;
+        }
+        conn.in.resize(old_size);
+        if (n == 0) {
+            peer_closed = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            peer_closed = true;
+        }
+        break;
+    }
+
+    processInput(fd, conn, peer_closed);
+}
+
+void JobServer::processInput(int fd, Connection& conn, bool peer_closed) {
+    // 处理所有完整的帧（流水线），响应追加到输出缓冲区；未写出的响应达到上限时暂停，剩余的帧留待写出后处理
+    Request request;
+    while (true) {
+        size_t offset = 0;
+        uint64_t handled = 0;
+        bool paused = false;
+        while (conn.in.size() - offset >= kHeaderSize) {
+            if (conn.out.size() - conn.out_offset >= kMaxPendingOutput) {
+                paused = true;
+                break;
+            }
+            FrameHeader header = decodeHeader(conn.in.data() + offset);
+            if (header.body_length > kMaxBodySize) {
+                closeConnection(fd);
+                return;
+            }
+            if (conn.in.size() - offset < kHeaderSize + header.body_length) {
+                break;
+            }
+            if (decodeRequest(header, conn.in.data() + offset + kHeaderSize, request)) {
+                process(request, conn.out);
+            } else {
+                encodeResponse(Response{header.opcode, ResultCode::BadRequest, header.request_id, 0}, conn.out);
+            }
+            offset += kHeaderSize + header.body_length;
+            ++handled;
+        }
+        conn.in.erase(conn.in.begin(), conn.in.begin() + static_cast<std::ptrdiff_t>(offset));
+        served_.fetch_add(handled, std::memory_order_relaxed);
+
+        if (!flushOutput(fd, conn)) {
+            closeConnection(fd);
+            return;
+        }
+        // 暂停后输出一次写完时不会再有 EPOLLOUT 事件，剩余的帧要在这里继续处理，否则要等到对端发来新数据
+        if (!paused || conn.out_offset < conn.out.size()) {
+            break;
+        }
+    }
+
+    if (peer_closed) {
+        closeConnection(fd);
+    }
+}
+
+bool JobServer::flushOutput(int fd, Connection& conn) {
+    while (conn.out_offset < conn.out.size()) {
+        ssize_t n = write(fd, conn.out.data() + conn.out_offset, conn.out.size() - conn.out_offset);
+        if (n > 0) {
+            conn.out_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+
+    bool pending = conn.out_offset < conn.out.size();
+    if (!pending) {
+        conn.out.clear();
+        conn.out_offset = 0;
+    } else if (conn.out_offset >= kMaxPendingOutput) {
+        // 丢弃已写出的前缀，避免输出缓冲区只增不减
+        conn.out.erase(conn.out.begin(), conn.out.begin() + static_cast<std::ptrdiff_t>(conn.out_offset));
+        conn.out_offset = 0;
+    }
+    // 只有在输出未写完时才关注 EPOLLOUT，避免空转；未写出的响应超过上限时停止读取请求
+    uint32_t events = 0;
+    if (conn.out.size() - conn.out_offset < kMaxPendingOutput) {
+        events |= EPOLLIN;
+    }
+    if (pending) {
+        events |= EPOLLOUT;
+    }
+    if (events != conn.events) {
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+        conn.events = events;
+    }
+    return true;
+}
+
+void JobServer::closeConnection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+}
+
+void JobServer::process(const Request& request, std::vector<uint8_t>& out) {
+    JobQueue& queue = JobQueue::getInstance();
+    Response response{request.opcode, ResultCode::Ok, request.request_id, 0};
+
+    switch (request.opcode) {
+        case JobOpcode::Enqueue:
+        {
+            if (request.job_id.empty()) {
+                response.result = ResultCode::BadRequest;
+                break;
+            }
+            JobInfo info{.status = request.status, .job_id = request.job_id, .content_key = request.content_key};
+            response.value = static_cast<uint8_t>(queue.enqueue(JobManager(info)));
+            break;
+        }
+        case JobOpcode::DequeueByJobId:
+        {
+            if (!queue.dequeueByJobId(request.job_id)) {
+                response.result = ResultCode::NotFound;
+            }
+            break;
+        }
+        case JobOpcode::Status:
+        {
+            auto status = queue.queryStatus(request.job_id);
+            if (status) {
+                response.value = static_cast<uint8_t>(*status);
+            } else {
+                response.result = ResultCode::NotFound;
+            }
+            break;
+        }
+        case JobOpcode::Cancel:
+        {
+            if (!queue.cancel(request.job_id)) {
+                response.result = ResultCode::NotFound;
+            }
+            break;
+        }
+        default:
+            response.result = ResultCode::BadRequest;
+            break;
+    }
+    encodeResponse(response, out);
+}
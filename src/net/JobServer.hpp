@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/NonCopyable.hpp"
+#include "JobProtocol.hpp"
+
+/**
+ * @brief 基于 Unix 域套接字的任务提交服务端。
+ *
+ * 其他进程中的客户端通过本地套接字向 JobQueue::getInstance() 提交任务，
+ * 取代“每个任务启动一次辅助进程”的方式。
+ *
+ * - 单线程 epoll 事件循环，所有套接字均为非阻塞；
+ * - 支持请求流水线：一次 read 读到的所有完整帧会被依次处理，响应累积后一次性写出；
+ * - 背压：某个连接未写出的响应超过 kMaxPendingOutput 时暂停处理其请求并停止关注 EPOLLIN，
+ *   客户端只发请求不读响应时服务端内存不会无限增长，响应写出后恢复；
+ * - 支持的操作：Enqueue、DequeueByJobId、Status、Cancel（帧格式见 JobProtocol.hpp）。
+ *
+ * 使用示例：
+ * @code
+ * JobServer server("/tmp/job.sock");
+ * if (server.start()) {
+ *     Thread thread([&server] { server.loop(); });
+ *     thread.start();
+ *     // ...
+ *     server.stop();
+ * }
+ * @endcode
+ */
+class JobServer
+: NonCopyable
+{
+public:
+    static constexpr size_t kMaxPendingOutput = 1 << 20; ///< 每个连接未写出响应的上限（字节）
+
+    /**
+     * @brief 构造函数（此时不会创建套接字）。
+     *
+     * @param socket_path Unix 域套接字路径，已存在的同名文件会在 start() 时被删除。
+     */
+    explicit JobServer(const std::string& socket_path);
+
+    /**
+     * @brief 析构函数，关闭所有连接和套接字，并删除套接字文件。
+     */
+    ~JobServer();
+
+    /**
+     * @brief 创建监听套接字和 epoll 实例。
+     *
+     * @return bool 成功返回 true，失败时已通过 perror 输出原因。
+     */
+    bool start();
+
+    /**
+     * @brief 运行事件循环，直到 stop() 被调用。
+     */
+    void loop();
+
+    /**
+     * @brief 停止事件循环（线程安全，可在其他线程调用）。
+     */
+    void stop();
+
+    /**
+     * @brief 已处理的请求总数。
+     *
+     * @return uint64_t 请求数。
+     */
+    uint64_t requestsServed() const { return served_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief 每个客户端连接的读写缓冲区。
+     */
+    struct Connection {
+        std::vector<uint8_t> in;   ///< 已读取但尚未处理的数据
+        std::vector<uint8_t> out;  ///< 待写出的响应
+        size_t out_offset = 0;     ///< out 中已写出的字节数
+        uint32_t events = 0;       ///< 已注册的 epoll 事件
+    };
+
+    void handleAccept();
+    void handleRead(int fd, Connection& conn);
+
+    /**
+     * @brief 处理 in 中的完整帧，直到没有完整帧或未写出的响应达到 kMaxPendingOutput，然后写出响应；
+     * 因达到上限暂停而输出随即全部写出时，继续处理剩余的帧。
+     *
+     * @param peer_closed 对端已关闭，写出后关闭连接。
+     */
+    void processInput(int fd, Connection& conn, bool peer_closed);
+
+    /**
+     * @brief 写出响应，并按输出是否写完、是否超过上限更新关注的事件。
+     *
+     * @return bool 写出失败时返回 false。
+     */
+    bool flushOutput(int fd, Connection& conn);
+    void closeConnection(int fd);
+
+    /**
+     * @brief 处理一个请求，并将响应追加到输出缓冲区。
+     */
+    void process(const job_protocol::Request& request, std::vector<uint8_t>& out);
+
+    std::string socket_path_;                         ///< 套接字路径
+    int listen_fd_;                                   ///< 监听套接字
+    int epoll_fd_;                                    ///< epoll 实例
+    int wakeup_fd_;                                   ///< 用于 stop() 唤醒事件循环的 eventfd
+    std::atomic<bool> running_;                       ///< 事件循环是否运行中
+    std::atomic<uint64_t> served_;                    ///< 已处理的请求数
+    std::unordered_map<int, Connection> connections_; ///< fd -> 连接
+};
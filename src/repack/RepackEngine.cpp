@@ -0,0 +1,370 @@
+#include "RepackEngine.hpp"
+#include "TapeDrivesQueue.hpp"
+
+#include <algorithm>
+
+namespace {
+
+    constexpr uint64_t kFirstReadId = 1ULL << 62;   ///< 重打包读操作的 ID 起点
+    const std::string kRepackJob = "repack";
+
+    ReadCoalescer::Config readerConfig(const RepackEngine::Config& config) {
+        ReadCoalescer::Config reader;
+        reader.block_size = config.block_size;
+        reader.first_operation_id = kFirstReadId;
+        reader.member_reads = true;
+        return reader;
+    }
+
+    WriteAggregator::Config writerConfig(const RepackEngine::Config& config) {
+        WriteAggregator::Config writer;
+        writer.target_size = config.target_size;
+        writer.tape_id = config.target_tape;
+        writer.first_aggregate_id = config.first_aggregate_id;
+        writer.self_describing = true;
+        return writer;
+    }
+
+}
+
+RepackEngine::RepackEngine(const Config& config, CatalogIndex& catalog, Sink sink)
+: config_(config)
+, catalog_(catalog)
+, sink_(std::move(sink))
+, reads_outstanding_(0)
+, reader_(readerConfig(config), [this](const TapeDrivesOperation& op) { emit(op); })
+, writer_(writerConfig(config), [this](const TapeDrivesOperation& op) { emit(op); })
+{
+}
+
+RepackEngine::~RepackEngine()
+{
+}
+
+void RepackEngine::recordAggregate(const std::string& tape_id, uint64_t block_position, const AggregateInfo& aggregate)
+{
+    AggregateRecord record;
+    record.location.tape_id = tape_id;
+    record.location.aggregate_id = aggregate.aggregate_id;
+    record.location.block_position = block_position;
+    record.location.length = aggregate.payload ? aggregate.payload->size() : 0;
+    record.location.checksum = aggregate.checksum;
+    record.location.compressed = aggregate.compressed;
+    record.members = aggregate.members;
+
+    MutexLockGuard autoLock(mutex_);
+    TapeRecord& tape = ledger_[tape_id];
+    tape.written_bytes += record.location.length;
+    tape.aggregates[aggregate.aggregate_id] = std::move(record);
+}
+
+std::vector<RepackEngine::Candidate> RepackEngine::candidates() const
+{
+    std::vector<Candidate> result = scan(nullptr);
+    result.erase(std::remove_if(result.begin(), result.end(),
+                                [this](const Candidate& c) { return c.reclaimable() < config_.min_reclaimable; }),
+                 result.end());
+    std::stable_sort(result.begin(), result.end(), [](const Candidate& a, const Candidate& b) {
+        return a.reclaimable() > b.reclaimable();
+    });
+    return result;
+}
+
+std::vector<RepackEngine::Candidate> RepackEngine::scan(std::map<std::string, std::vector<LiveMember>>* live) const
+{
+    // 在锁内复制账本，目录查找在锁外进行
+    std::vector<std::pair<std::string, TapeRecord>> tapes;
+    {
+        MutexLockGuard autoLock(mutex_);
+        for (const auto& tape : ledger_) {
+            if (active_.count(tape.first) == 0) {
+                tapes.emplace_back(tape.first, tape.second);
+            }
+        }
+    }
+
+    std::vector<Candidate> result;
+    for (const auto& tape : tapes) {
+        std::vector<std::string> keys;
+        std::vector<std::pair<const AggregateRecord*, const AggregateMember*>> members;
+        for (const auto& aggregate : tape.second.aggregates) {
+            for (const auto& member : aggregate.second.members) {
+                keys.push_back(member.object_key);
+                members.emplace_back(&aggregate.second, &member);
+            }
+        }
+        auto entries = catalog_.lookupBatch(keys);
+
+        Candidate candidate;
+        candidate.tape_id = tape.first;
+        candidate.written_bytes = tape.second.written_bytes;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const AggregateRecord& aggregate = *members[i].first;
+            const AggregateMember& member = *members[i].second;
+            // 目录仍指向这盘磁带上的这个聚合时成员才存活，被删除或重写到别处的都是死空间
+            if (!entries[i] || entries[i]->tape_id != tape.first ||
+                entries[i]->aggregate_id != aggregate.location.aggregate_id) {
+                continue;
+            }
+            ++candidate.live_members;
+            candidate.live_bytes += member.length;
+            if (live) {
+                (*live)[tape.first].push_back(LiveMember{aggregate.location, member});
+            }
+        }
+        result.push_back(std::move(candidate));
+    }
+    return result;
+}
+
+size_t RepackEngine::start()
+{
+    std::map<std::string, std::vector<LiveMember>> live;
+    std::vector<Candidate> list = scan(&live);
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [this](const Candidate& c) { return c.reclaimable() < config_.min_reclaimable; }),
+               list.end());
+    std::stable_sort(list.begin(), list.end(), [](const Candidate& a, const Candidate& b) {
+        return a.reclaimable() > b.reclaimable();
+    });
+
+    std::vector<LiveMember> requests;
+    size_t started = 0;
+    {
+        MutexLockGuard autoLock(mutex_);
+        for (const auto& candidate : list) {
+            if (active_.size() >= config_.max_active_tapes) {
+                break;
+            }
+            if (active_.count(candidate.tape_id) > 0 || ledger_.count(candidate.tape_id) == 0) {
+                continue;
+            }
+            if (active_.empty()) {
+                active_since_ = std::chrono::steady_clock::now();
+            }
+            Progress progress;
+            progress.tape_id = candidate.tape_id;
+            progress.written_bytes = candidate.written_bytes;
+            progress.live_members = candidate.live_members;
+            progress.live_bytes = candidate.live_bytes;
+            active_[candidate.tape_id] = progress_.size();
+            progress_.push_back(progress);
+            outstanding_[candidate.tape_id] = candidate.live_members;
+            ++stats_.tapes_selected;
+            ++started;
+
+            auto& members = live[candidate.tape_id];
+            reads_outstanding_ += members.size();
+            requests.insert(requests.end(), members.begin(), members.end());
+            if (members.empty()) {
+                settleLocked(candidate.tape_id); // 没有存活成员，直接回收
+            }
+        }
+    }
+
+    for (const auto& request : requests) {
+        const std::string tape_id = request.location.tape_id;
+        const std::string object_key = request.member.object_key;
+        const uint64_t aggregate_id = request.location.aggregate_id;
+        reader_.read(kRepackJob, request.location, request.member.offset, request.member.length,
+                     [this, tape_id, object_key, aggregate_id](bool ok, const uint8_t* data, size_t length) {
+                         if (ok) {
+                             {
+                                 MutexLockGuard autoLock(mutex_);
+                                 copying_[object_key] = Source{tape_id, aggregate_id, length};
+                             }
+                             writer_.add(kRepackJob, object_key, data, length);
+                         }
+                         delivered(tape_id, ok);
+                     }, request.member.checksum);
+    }
+    if (!requests.empty()) {
+        reader_.flush();
+    }
+    return started;
+}
+
+void RepackEngine::delivered(const std::string& tape_id, bool ok)
+{
+    bool last = false;
+    {
+        MutexLockGuard autoLock(mutex_);
+        last = --reads_outstanding_ == 0;
+        if (!ok) {
+            auto it = active_.find(tape_id);
+            if (it != active_.end()) {
+                ++progress_[it->second].failed_members;
+                ++stats_.members_failed;
+                settleLocked(tape_id);
+            }
+        }
+    }
+    if (last) {
+        writer_.flush(); // 所有成员都已读到，封口最后一个新聚合
+    }
+}
+
+bool RepackEngine::complete(const TapeDrivesOperation& op, const uint8_t* data, size_t length)
+{
+    return reader_.complete(op.getOperationId(), data, length);
+}
+
+bool RepackEngine::fail(const TapeDrivesOperation& op)
+{
+    return reader_.fail(op.getOperationId());
+}
+
+bool RepackEngine::written(const TapeDrivesOperation& op, const std::string& tape_id, uint64_t block_position)
+{
+    auto aggregate = op.getAggregate();
+    if (!aggregate || aggregate->aggregate_id < config_.first_aggregate_id) {
+        return false;
+    }
+    std::vector<Source> sources;
+    std::vector<std::string> keys;
+    {
+        MutexLockGuard autoLock(mutex_);
+        for (const auto& member : aggregate->members) {
+            auto it = copying_.find(member.object_key);
+            sources.push_back(it != copying_.end() ? it->second : Source{std::string(), 0, 0});
+            keys.push_back(member.object_key);
+        }
+    }
+
+    // 只提交目录仍指向源聚合的成员：复制期间被删除或重写的对象不能被旧数据覆盖
+    auto entries = catalog_.lookupBatch(keys);
+    AggregateInfo committed = *aggregate;
+    committed.members.clear();
+    std::vector<bool> kept(keys.size(), false);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (entries[i] && entries[i]->tape_id == sources[i].tape_id &&
+            entries[i]->aggregate_id == sources[i].aggregate_id) {
+            committed.members.push_back(aggregate->members[i]);
+            kept[i] = true;
+        }
+    }
+    if (!committed.members.empty()) {
+        catalog_.insertAggregate(tape_id, block_position, committed);
+    }
+    recordAggregate(tape_id, block_position, *aggregate);
+
+    MutexLockGuard autoLock(mutex_);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        copying_.erase(keys[i]);
+        auto it = active_.find(sources[i].tape_id);
+        if (it == active_.end()) {
+            continue;
+        }
+        Progress& progress = progress_[it->second];
+        if (kept[i]) {
+            ++progress.copied_members;
+            progress.copied_bytes += sources[i].length;
+            ++stats_.members_copied;
+            stats_.bytes_copied += sources[i].length;
+        } else {
+            ++progress.dropped_members;
+            ++stats_.members_dropped;
+        }
+        settleLocked(sources[i].tape_id);
+    }
+    return true;
+}
+
+bool RepackEngine::writeFailed(const TapeDrivesOperation& op)
+{
+    auto aggregate = op.getAggregate();
+    if (!aggregate || aggregate->aggregate_id < config_.first_aggregate_id) {
+        return false;
+    }
+    MutexLockGuard autoLock(mutex_);
+    ++stats_.writes_failed;
+    for (const auto& member : aggregate->members) {
+        auto source = copying_.find(member.object_key);
+        if (source == copying_.end()) {
+            continue;
+        }
+        const std::string tape_id = source->second.tape_id;
+        copying_.erase(source);
+        auto it = active_.find(tape_id);
+        if (it == active_.end()) {
+            continue;
+        }
+        ++progress_[it->second].failed_members;
+        ++stats_.members_failed;
+        settleLocked(tape_id);
+    }
+    return true;
+}
+
+void RepackEngine::settleLocked(const std::string& tape_id)
+{
+    auto remaining = outstanding_.find(tape_id);
+    if (remaining == outstanding_.end()) {
+        return;
+    }
+    if (remaining->second > 0) {
+        --remaining->second;
+    }
+    if (remaining->second > 0) {
+        return;
+    }
+    // 所有成员都已处理：没有失败时整盘回收
+    Progress& progress = progress_[active_[tape_id]];
+    progress.finished = true;
+    progress.reclaimed = progress.failed_members == 0;
+    if (progress.reclaimed) {
+        ++stats_.tapes_reclaimed;
+        stats_.bytes_reclaimed += progress.written_bytes;
+        ledger_.erase(tape_id);
+    } else {
+        ++stats_.tapes_failed;
+    }
+    outstanding_.erase(remaining);
+    active_.erase(tape_id);
+    if (active_.empty()) {
+        stats_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - active_since_).count();
+    }
+}
+
+bool RepackEngine::idle() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return active_.empty();
+}
+
+std::vector<RepackEngine::Progress> RepackEngine::progress() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return progress_;
+}
+
+RepackEngine::Stats RepackEngine::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    Stats stats = stats_;
+    if (!active_.empty()) {
+        stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - active_since_).count();
+    }
+    return stats;
+}
+
+void RepackEngine::emit(TapeDrivesOperation op)
+{
+    op.setBackground(true);
+    {
+        MutexLockGuard autoLock(mutex_);
+        if (op.getTypeOperation() == TypeOperation::READ_AGGR) {
+            ++stats_.reads_issued;
+            stats_.bytes_read += op.getLength();
+        } else if (op.getTypeOperation() == TypeOperation::WRITE_AGGR) {
+            auto aggregate = op.getAggregate();
+            ++stats_.writes_issued;
+            stats_.bytes_written += aggregate && aggregate->payload ? aggregate->payload->size() : 0;
+        }
+    }
+    if (sink_) {
+        sink_(op);
+    } else {
+        TapeDrivesQueue::getInstance().push_back(op);
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "CatalogIndex.hpp"
+#include "ReadCoalescer.hpp"
+#include "TapeDrivesOperation.hpp"
+#include "WriteAggregator.hpp"
+
+/**
+ * @brief 磁带回收（重打包）引擎：把可回收空间比例高的磁带上仍然存活的成员复制到新磁带，整盘磁带随后可以重新使用。
+ *
+ * 对象被删除（CatalogIndex::erase()）或重写到其他位置后，旧聚合中的数据成为死空间。RepackEngine 的做法：
+ * - 账本：recordAggregate() 记录每盘磁带上的聚合及其成员（通常与 CatalogIndex::insertAggregate() 一起调用）；
+ * - 选带：candidates() 用目录批量查找判断成员是否存活（目录仍指向该磁带上的该聚合），
+ *   按可回收比例（1 - 存活字节 / 聚合总长度）从高到低排列，低于 min_reclaimable 的磁带不参与；
+ * - 复制：start() 为选中的磁带通过 ReadCoalescer 只读存活成员所在的块，读到的成员交给 WriteAggregator
+ *   打包成新聚合写到 target_tape。生成的 READ_AGGR/WRITE_AGGR 都标记为后台操作，
+ *   由驱动器调度器按后台份额限制（见 DrivePool::setBackgroundShare()），不会挤占用户 I/O；
+ * - 提交：written() 在新聚合写完后更新目录。复制期间被删除或重写的成员（目录已不指向源聚合）不会被覆盖回去；
+ *   源磁带的成员全部处理完、且没有读取或写入失败时，该磁带被回收：从账本中移除，计入 bytes_reclaimed。
+ *
+ * 执行方的用法与 ReadCoalescer 相同：sink 收到操作后交给驱动器执行，READ_AGGR 完成后调用 complete()/fail()，
+ * WRITE_AGGR 完成后调用 written()，失败时调用 writeFailed()。重打包读操作的 operation_id 从 2^62 开始，
+ * 不会与用户读操作冲突。失败的成员在目录中仍指向源磁带，源磁带不会被回收，之后可以重新 start()。
+ *
+ * 账本只在内存中，不会持久化。进程重启后账本为空，candidates() 选不出任何磁带，
+ * 需要调用方按目录和磁带上的聚合索引（AggregateFormat）逐个 recordAggregate() 重建。
+ * 重启时正在进行的重打包随之丢失：目录只在 written() 中更新，源磁带的数据不受影响，重建账本后重新 start() 即可；
+ * 已写到目标磁带但尚未提交目录的新聚合成为死空间，由之后对目标磁带的回收处理。
+ * 删除与同一对象的 written() 之间没有原子的比较并写入，调用方应把二者串行化。
+ */
+class RepackEngine
+: NonCopyable
+{
+public:
+    using Sink = std::function<void(const TapeDrivesOperation& op)>;
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        double min_reclaimable = 0.5;               ///< 可回收比例达到该值的磁带才会被选中
+        size_t max_active_tapes = 1;                ///< 同时重打包的源磁带数
+        std::string target_tape;                    ///< 新聚合写入的磁带，为空时由调度器决定
+        uint64_t target_size = 1ULL << 30;          ///< 新聚合的目标大小（字节）
+        uint64_t first_aggregate_id = 1ULL << 62;   ///< 新聚合的 ID 起点，与用户写入的聚合 ID 区间分开
+        uint64_t block_size = 256 * 1024;           ///< 磁带块大小（字节）
+    };
+
+    /**
+     * @brief 一盘磁带的空间使用情况。
+     */
+    struct Candidate {
+        std::string tape_id;
+        uint64_t written_bytes = 0;     ///< 磁带上聚合的总长度
+        uint64_t live_bytes = 0;        ///< 仍被目录引用的成员字节数
+        uint64_t live_members = 0;      ///< 仍被目录引用的成员数
+
+        double reclaimable() const {
+            return written_bytes == 0 ? 0.0 : 1.0 - static_cast<double>(live_bytes) / static_cast<double>(written_bytes);
+        }
+    };
+
+    /**
+     * @brief 一盘正在（或已经）重打包的磁带的进度。
+     */
+    struct Progress {
+        std::string tape_id;
+        uint64_t written_bytes = 0;     ///< 磁带上聚合的总长度
+        uint64_t live_members = 0;      ///< 开始时的存活成员数
+        uint64_t live_bytes = 0;
+        uint64_t copied_members = 0;    ///< 已写入新聚合并更新目录的成员数
+        uint64_t copied_bytes = 0;
+        uint64_t dropped_members = 0;   ///< 复制期间被删除或重写、不再需要的成员数
+        uint64_t failed_members = 0;    ///< 读取、校验或写入失败的成员数
+        bool finished = false;          ///< 所有成员都已处理
+        bool reclaimed = false;         ///< 已回收（finished 且没有失败）
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t tapes_selected = 0;    ///< 开始重打包的磁带数
+        uint64_t tapes_reclaimed = 0;   ///< 已回收的磁带数
+        uint64_t tapes_failed = 0;      ///< 有成员读取失败、未能回收的磁带数
+        uint64_t reads_issued = 0;      ///< 发出的 READ_AGGR 数
+        uint64_t bytes_read = 0;        ///< READ_AGGR 读取的字节数
+        uint64_t writes_issued = 0;     ///< 发出的 WRITE_AGGR 数
+        uint64_t bytes_written = 0;     ///< WRITE_AGGR 写入的字节数
+        uint64_t writes_failed = 0;     ///< 失败的 WRITE_AGGR 数
+        uint64_t members_copied = 0;
+        uint64_t bytes_copied = 0;
+        uint64_t members_dropped = 0;
+        uint64_t members_failed = 0;
+        uint64_t bytes_reclaimed = 0;   ///< 已回收磁带上聚合的总长度
+        double seconds = 0.0;           ///< 有磁带在重打包的累计时间（秒）
+
+        /**
+         * @brief 复制吞吐量（字节/秒）。
+         */
+        double throughput() const { return seconds > 0.0 ? static_cast<double>(bytes_copied) / seconds : 0.0; }
+    };
+
+    /**
+     * @brief 构造函数。
+     *
+     * @param config 配置项。
+     * @param catalog 目录索引，用于判断成员是否存活和提交新位置。
+     * @param sink 发出后台 READ_AGGR/WRITE_AGGR 的回调，为空时放入 TapeDrivesQueue::getInstance()。
+     */
+    RepackEngine(const Config& config, CatalogIndex& catalog, Sink sink = Sink());
+
+    /**
+     * @brief 析构函数，发出尚未封口的新聚合。未完成的读不会再回调。
+     */
+    ~RepackEngine();
+
+    /**
+     * @brief 记录写入磁带的聚合。
+     *
+     * @param tape_id 磁带 ID。
+     * @param block_position 聚合的起始块号。
+     * @param aggregate 聚合（成员索引和数据长度）。
+     */
+    void recordAggregate(const std::string& tape_id, uint64_t block_position, const AggregateInfo& aggregate);
+
+    /**
+     * @brief 可回收比例不低于 min_reclaimable 的磁带，按可回收比例从高到低排列（不含正在重打包的磁带）。
+     */
+    std::vector<Candidate> candidates() const;
+
+    /**
+     * @brief 按 candidates() 的顺序开始重打包，直到正在重打包的磁带数达到 max_active_tapes。
+     *
+     * @return size_t 新开始的磁带数。
+     */
+    size_t start();
+
+    /**
+     * @brief 重打包的 READ_AGGR 完成。
+     *
+     * @return bool 不是本引擎发出的操作时返回 false。
+     */
+    bool complete(const TapeDrivesOperation& op, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 重打包的 READ_AGGR 失败，涉及的磁带不会被回收。
+     */
+    bool fail(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 重打包的 WRITE_AGGR 完成：更新目录，记录新聚合，推进源磁带的进度。
+     *
+     * @param op WRITE_AGGR 操作。
+     * @param tape_id 实际写入的磁带。
+     * @param block_position 聚合的起始块号。
+     * @return bool 不是本引擎发出的操作时返回 false。
+     */
+    bool written(const TapeDrivesOperation& op, const std::string& tape_id, uint64_t block_position);
+
+    /**
+     * @brief 重打包的 WRITE_AGGR 失败：其中的成员计为失败，目录不变，涉及的源磁带不会被回收。
+     *
+     * @param op WRITE_AGGR 操作。
+     * @return bool 不是本引擎发出的操作时返回 false。
+     */
+    bool writeFailed(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 没有正在重打包的磁带。
+     */
+    bool idle() const;
+
+    /**
+     * @brief 正在重打包和已结束的磁带的进度（按开始顺序）。
+     */
+    std::vector<Progress> progress() const;
+
+    Stats stats() const;
+
+private:
+    /**
+     * @brief 账本中的一个聚合。
+     */
+    struct AggregateRecord {
+        AggregateLocation location;
+        std::vector<AggregateMember> members;
+    };
+
+    /**
+     * @brief 账本中的一盘磁带。
+     */
+    struct TapeRecord {
+        uint64_t written_bytes = 0;
+        std::map<uint64_t, AggregateRecord> aggregates; ///< aggregate_id -> 聚合
+    };
+
+    /**
+     * @brief 一个存活的成员及其所在的聚合。
+     */
+    struct LiveMember {
+        AggregateLocation location;
+        AggregateMember member;
+    };
+
+    /**
+     * @brief 已读到、等待写入新聚合的成员的来源。
+     */
+    struct Source {
+        std::string tape_id;
+        uint64_t aggregate_id;
+        uint64_t length;
+    };
+
+    /**
+     * @brief 扫描账本中不在重打包的磁带，统计存活成员。
+     *
+     * @param live 不为空时输出每盘磁带的存活成员。
+     */
+    std::vector<Candidate> scan(std::map<std::string, std::vector<LiveMember>>* live) const;
+
+    /**
+     * @brief 成员读取结束（成功时已交给 WriteAggregator）。
+     */
+    void delivered(const std::string& tape_id, bool ok);
+
+    /**
+     * @brief 源磁带的一个成员处理完毕，全部处理完时结束该磁带。
+     */
+    void settleLocked(const std::string& tape_id);
+
+    void emit(TapeDrivesOperation op);
+
+    const Config config_;
+    CatalogIndex& catalog_;
+    Sink sink_;
+    mutable MutexLock mutex_;
+    std::map<std::string, TapeRecord> ledger_;          ///< 磁带 ID -> 磁带上的聚合
+    std::map<std::string, size_t> active_;              ///< 正在重打包的磁带 -> progress_ 下标
+    std::map<std::string, uint64_t> outstanding_;       ///< 正在重打包的磁带 -> 尚未处理完的成员数
+    std::vector<Progress> progress_;                    ///< 所有开始过的磁带的进度
+    std::map<std::string, Source> copying_;             ///< 已读到、等待写入的成员
+    uint64_t reads_outstanding_;                        ///< 已请求、尚未读到的成员数
+    std::chrono::steady_clock::time_point active_since_; ///< 本轮开始重打包的时间
+    Stats stats_;
+    ReadCoalescer reader_;      ///< 只读存活成员所在的块
+    WriteAggregator writer_;    ///< 把存活成员打包成新聚合（最先析构，发出未封口的聚合时其他成员仍然有效）
+};
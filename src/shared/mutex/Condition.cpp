@@ -0,0 +1,57 @@
+#include "Condition.hpp"
+#include <stdio.h>
+#include <time.h>
+
+Condition::Condition(MutexLock &mutex)
+: mutex_(mutex)
+{
+    int ret = pthread_cond_init(&cond_, nullptr);
+    if (ret != 0) {
+        perror("pthread_cond_init");
+    }
+}
+
+Condition::~Condition()
+{
+    int ret = pthread_cond_destroy(&cond_);
+    if (ret != 0) {
+        perror("pthread_cond_destroy");
+    }
+}
+
+void Condition::wait()
+{
+    int ret = pthread_cond_wait(&cond_, mutex_.getMutexLockPtr());
+    if (ret != 0) {
+        perror("pthread_cond_wait");
+    }
+}
+
+bool Condition::waitForSeconds(double seconds)
+{
+    struct timespec abstime;
+    clock_gettime(CLOCK_REALTIME, &abstime);
+
+    const long long kNanoSecondsPerSecond = 1000000000LL;
+    long long nanoseconds = static_cast<long long>(seconds * kNanoSecondsPerSecond);
+    abstime.tv_sec += static_cast<time_t>((abstime.tv_nsec + nanoseconds) / kNanoSecondsPerSecond);
+    abstime.tv_nsec = static_cast<long>((abstime.tv_nsec + nanoseconds) % kNanoSecondsPerSecond);
+
+    return ETIMEDOUT == pthread_cond_timedwait(&cond_, mutex_.getMutexLockPtr(), &abstime);
+}
+
+void Condition::notify()
+{
+    int ret = pthread_cond_signal(&cond_);
+    if (ret != 0) {
+        perror("pthread_cond_signal");
+    }
+}
+
+void Condition::notifyAll()
+{
+    int ret = pthread_cond_broadcast(&cond_);
+    if (ret != 0) {
+        perror("pthread_cond_broadcast");
+    }
+}
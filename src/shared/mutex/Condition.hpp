@@ -0,0 +1,58 @@
+#pragma once
+
+#include "NonCopyable.hpp"
+#include "MutexLock.hpp"
+#include <pthread.h>
+
+/**
+ * @brief 条件变量类，配合 MutexLock 实现线程间的等待/通知。
+ *
+ * Condition 类封装了 pthread_cond_t，必须与一个 MutexLock 绑定使用：
+ * 调用 wait() 之前，调用方必须已经持有该互斥锁（通常通过 MutexLockGuard）。
+ * 由于存在虚假唤醒，wait() 应始终放在 while 循环中检查等待条件。
+ */
+class Condition
+: NonCopyable
+{
+public:
+    /**
+     * @brief 构造函数，初始化条件变量。
+     *
+     * @param mutex 与条件变量绑定的互斥锁。
+     */
+    explicit Condition(MutexLock &mutex);
+
+    /**
+     * @brief 析构函数，销毁条件变量。
+     */
+    ~Condition();
+
+    /**
+     * @brief 阻塞等待，直到被 notify() 或 notifyAll() 唤醒。
+     *
+     * 调用前必须持有绑定的互斥锁，返回时仍持有该锁。
+     */
+    void wait();
+
+    /**
+     * @brief 带超时的等待。
+     *
+     * @param seconds 最长等待的秒数。
+     * @return bool 超时返回 true，被唤醒返回 false。
+     */
+    bool waitForSeconds(double seconds);
+
+    /**
+     * @brief 唤醒一个等待中的线程。
+     */
+    void notify();
+
+    /**
+     * @brief 唤醒所有等待中的线程。
+     */
+    void notifyAll();
+
+private:
+    MutexLock &mutex_;     ///< 绑定的互斥锁。
+    pthread_cond_t cond_;  ///< 内部使用的 POSIX 条件变量。
+};
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../mutex/NonCopyable.hpp"
+
+/**
+ * @brief 放置在 POSIX 共享内存段中的跨进程双向链表队列。
+ *
+ * 与 BaseQueue 不同，共享内存在不同进程中映射到不同的地址，因此：
+ * - 节点之间使用槽位下标（相对段起始的偏移）链接，而不是 std::unique_ptr / 裸指针；
+ * - 节点从段内固定容量的槽位数组中分配，空闲槽位组成空闲链表；
+ * - 使用进程间共享（PTHREAD_PROCESS_SHARED）的健壮互斥锁保护链表，
+ *   无竞争时加解锁完全在用户态完成，快速路径上没有系统调用；
+ * - 持锁进程崩溃时链表可能只改了一半。每个槽位另外记录状态（空闲/使用中）和入队序号，
+ *   下一个加锁者收到 EOWNERDEAD 后按槽位状态重建链表、空闲链表和计数，再将锁标记为一致。
+ *   槽位在数据写完后才标记为使用中，崩溃进程未完成的入队不会留下半条记录；
+ * - 段在初始化完成后才写入 magic，打开方等到段大小和 magic 都就绪才会映射整个段。
+ *
+ * 元素类型 T 必须是可平凡拷贝的（不能包含 std::string 等持有堆内存的成员）。
+ *
+ * 段布局：| Header | Slot[0] | Slot[1] | ... | Slot[capacity - 1] |
+ */
+template<typename T>
+class ShmQueue : NonCopyable {
+    static_assert(std::is_trivially_copyable<T>::value, "ShmQueue element must be trivially copyable");
+
+public:
+    /**
+     * @brief 创建或打开共享内存队列。
+     *
+     * - create 为 true 时创建（或重建）段并初始化队列。重建时先删除旧对象再创建新对象，
+     *   已映射旧段的进程不受影响；
+     * - create 为 false 时打开已存在的段，capacity 会从段头读取。段尚未初始化完成时最多等待 kAttachTimeoutMs。
+     * 失败时抛出 std::runtime_error。
+     *
+     * @param name 共享内存对象名（如 "/job_queue"）。
+     * @param capacity 槽位数量（仅在创建时使用）。
+     * @param create 是否创建。
+     */
+    ShmQueue(const std::string& name, uint32_t capacity, bool create);
+
+    /**
+     * @brief 析构函数，解除映射（不会删除共享内存对象）。
+     */
+    ~ShmQueue();
+
+    /**
+     * @brief 删除共享内存对象。
+     *
+     * @param name 共享内存对象名。
+     */
+    static void unlink(const std::string& name) { shm_unlink(name.c_str()); }
+
+    /**
+     * @brief 在队列尾部插入一个新元素。
+     *
+     * @param value 要插入的新元素。
+     * @return bool 队列已满返回 false。
+     */
+    bool push_back(const T& value);
+
+    /**
+     * @brief 移除并返回队列头部的元素。
+     *
+     * @return std::optional<T> 队列为空时返回 std::nullopt。
+     */
+    std::optional<T> pop_front();
+
+    /**
+     * @brief 从头到尾查找第一个满足条件的元素，移除并返回。
+     *
+     * @param pred 判断条件，签名为 bool(const T&)。
+     * @return std::optional<T> 未找到返回 std::nullopt。
+     */
+    template<typename Pred>
+    std::optional<T> remove_if(Pred pred);
+
+    /**
+     * @brief 返回队列中元素的数量。
+     *
+     * 需要加锁：持锁进程崩溃后计数要等下一个加锁者重建链表后才正确。
+     */
+    size_t size() const;
+
+    /**
+     * @brief 返回队列容量（槽位数量）。
+     */
+    size_t capacity() const { return header_->capacity; }
+
+    /**
+     * @brief 持锁进程崩溃后重建链表的次数。
+     */
+    size_t recoveries() const { return header_->recoveries.load(std::memory_order_relaxed); }
+
+    static constexpr int kAttachTimeoutMs = 2000;   ///< 打开方等待段初始化完成的最长时间
+
+private:
+    static constexpr uint32_t kMagic = 0x32484D53;  ///< "SMH2"（版本 2：槽位带状态和序号）
+    static constexpr uint32_t kNil = 0xFFFFFFFFu;   ///< 空链接
+    static constexpr uint32_t kFree = 0;            ///< 槽位空闲
+    static constexpr uint32_t kUsed = 1;            ///< 槽位在队列中
+
+    /**
+     * @brief 段头。
+     */
+    struct Header {
+        std::atomic<uint32_t> magic;  ///< 初始化完成后才写入，打开方据此判断段是否可用
+        uint32_t capacity;
+        uint32_t slot_size;
+        uint32_t head;
+        uint32_t tail;
+        uint32_t free_head;
+        uint32_t count;
+        std::atomic<uint32_t> recoveries;
+        uint64_t next_sequence;       ///< 下一个入队元素的序号，重建时按序号恢复顺序
+        pthread_mutex_t mutex;
+    };
+
+    /**
+     * @brief 槽位：使用下标链接的双向链表节点。
+     */
+    struct Slot {
+        uint32_t next;
+        uint32_t prev;
+        std::atomic<uint32_t> state;  ///< kFree / kUsed，重建链表的依据
+        uint64_t sequence;            ///< 入队序号
+        T data;
+    };
+
+    /**
+     * @brief 进程间互斥锁的 RAII 管理器，处理持锁进程崩溃的情况。
+     */
+    class Guard {
+    public:
+        explicit Guard(ShmQueue* queue) : mutex_(&queue->header_->mutex) {
+            int rc = pthread_mutex_lock(mutex_);
+            if (rc == EOWNERDEAD) {
+                // 持锁进程已退出，链表可能只改了一半：按槽位状态重建后再将锁标记为一致
+                queue->rebuildLocked();
+                pthread_mutex_consistent(mutex_);
+            } else if (rc != 0) {
+                throw std::runtime_error("shared memory queue lock failed: " + std::string(strerror(rc)));
+            }
+        }
+        ~Guard() { pthread_mutex_unlock(mutex_); }
+    private:
+        pthread_mutex_t* mutex_;
+    };
+
+    Slot* slot(uint32_t index) { return &slots_[index]; }
+    void unlinkSlot(uint32_t index);
+
+    /**
+     * @brief 按槽位状态重建链表：使用中的槽位按入队序号串成队列，其余槽位串成空闲链表，并重新计数。
+     */
+    void rebuildLocked();
+
+    /**
+     * @brief 等待段初始化完成并返回其长度，超时或段不兼容时抛出 std::runtime_error。
+     */
+    static size_t attachLength(int fd, const std::string& name);
+
+    static size_t segmentSize(uint32_t capacity) { return sizeof(Header) + sizeof(Slot) * capacity; }
+
+    void* base_;       ///< 映射的起始地址
+    size_t length_;    ///< 映射长度
+    Header* header_;   ///< 段头
+    Slot* slots_;      ///< 槽位数组
+};
+
+template<typename T>
+ShmQueue<T>::ShmQueue(const std::string& name, uint32_t capacity, bool create)
+: base_(nullptr), length_(0), header_(nullptr), slots_(nullptr) {
+    if (create) {
+        // 删除旧对象后独占创建：已映射旧段的进程不会因截断而收到 SIGBUS，打开方也不会看到半初始化的旧段
+        shm_unlink(name.c_str());
+    }
+    int fd = shm_open(name.c_str(), create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open failed: " + name);
+    }
+
+    if (create) {
+        length_ = segmentSize(capacity);
+        if (ftruncate(fd, static_cast<off_t>(length_)) < 0) {
+            close(fd);
+            throw std::runtime_error("ftruncate failed: " + name);
+        }
+    } else {
+        try {
+            length_ = attachLength(fd, name);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+    }
+
+    base_ = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base_ == MAP_FAILED) {
+        throw std::runtime_error("mmap failed: " + name);
+    }
+    header_ = static_cast<Header*>(base_);
+    slots_ = reinterpret_cast<Slot*>(static_cast<char*>(base_) + sizeof(Header));
+
+    if (create) {
+        header_->capacity = capacity;
+        header_->slot_size = sizeof(Slot);
+        header_->head = kNil;
+        header_->tail = kNil;
+        header_->count = 0;
+        header_->recoveries.store(0, std::memory_order_relaxed);
+        header_->next_sequence = 0;
+        // 所有槽位串成空闲链表
+        header_->free_head = capacity == 0 ? kNil : 0;
+        for (uint32_t i = 0; i < capacity; ++i) {
+            slots_[i].next = i + 1 < capacity ? i + 1 : kNil;
+            slots_[i].prev = kNil;
+            slots_[i].state.store(kFree, std::memory_order_relaxed);
+            slots_[i].sequence = 0;
+        }
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header_->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+
+        header_->magic.store(kMagic, std::memory_order_release);
+    }
+}
+
+template<typename T>
+size_t ShmQueue<T>::attachLength(int fd, const std::string& name) {
+    // 创建方依次 ftruncate、初始化、写入 magic：段大小不足或 magic 未写入时说明尚未初始化完成，稍后重试
+    for (int waited = 0; ; ++waited) {
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            throw std::runtime_error("fstat failed: " + name);
+        }
+        if (static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+            void* head = mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+            if (head == MAP_FAILED) {
+                throw std::runtime_error("mmap failed: " + name);
+            }
+            const Header* h = static_cast<const Header*>(head);
+            const uint32_t magic = h->magic.load(std::memory_order_acquire);
+            const uint32_t slot_size = h->slot_size;
+            const size_t length = segmentSize(h->capacity);
+            munmap(head, sizeof(Header));
+            if (magic == kMagic) {
+                if (slot_size != sizeof(Slot) || static_cast<size_t>(st.st_size) < length) {
+                    throw std::runtime_error("shared memory queue incompatible: " + name);
+                }
+                return length;
+            }
+            if (magic != 0) {
+                throw std::runtime_error("shared memory queue incompatible: " + name);
+            }
+        }
+        if (waited >= kAttachTimeoutMs) {
+            throw std::runtime_error("shared memory queue not initialized: " + name);
+        }
+        usleep(1000);
+    }
+}
+
+template<typename T>
+ShmQueue<T>::~ShmQueue() {
+    if (base_ && base_ != MAP_FAILED) {
+        munmap(base_, length_);
+    }
+}
+
+template<typename T>
+bool ShmQueue<T>::push_back(const T& value) {
+    Guard guard(this);
+    uint32_t index = header_->free_head;
+    if (index == kNil) {
+        return false;
+    }
+    Slot* s = slot(index);
+    header_->free_head = s->next;
+
+    // 数据和序号写完后才标记为使用中：在此之前崩溃，重建时该槽位仍是空闲的
+    s->data = value;
+    s->sequence = header_->next_sequence++;
+    s->state.store(kUsed, std::memory_order_release);
+    s->next = kNil;
+    s->prev = header_->tail;
+    if (header_->tail == kNil) {
+        header_->head = index;
+    } else {
+        slot(header_->tail)->next = index;
+    }
+    header_->tail = index;
+    ++header_->count;
+    return true;
+}
+
+template<typename T>
+std::optional<T> ShmQueue<T>::pop_front() {
+    Guard guard(this);
+    uint32_t index = header_->head;
+    if (index == kNil) {
+        return std::nullopt;
+    }
+    T value = slot(index)->data;
+    unlinkSlot(index);
+    return value;
+}
+
+template<typename T>
+template<typename Pred>
+std::optional<T> ShmQueue<T>::remove_if(Pred pred) {
+    Guard guard(this);
+    for (uint32_t index = header_->head; index != kNil; index = slot(index)->next) {
+        if (pred(static_cast<const T&>(slot(index)->data))) {
+            T value = slot(index)->data;
+            unlinkSlot(index);
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+template<typename T>
+size_t ShmQueue<T>::size() const {
+    Guard guard(const_cast<ShmQueue*>(this));
+    return header_->count;
+}
+
+template<typename T>
+void ShmQueue<T>::unlinkSlot(uint32_t index) {
+    Slot* s = slot(index);
+    // 先标记为空闲：之后崩溃，重建时该元素视为已出队（调用方已取走数据）
+    s->state.store(kFree, std::memory_order_release);
+    if (s->prev == kNil) {
+        header_->head = s->next;
+    } else {
+        slot(s->prev)->next = s->next;
+    }
+    if (s->next == kNil) {
+        header_->tail = s->prev;
+    } else {
+        slot(s->next)->prev = s->prev;
+    }
+    // 归还到空闲链表
+    s->prev = kNil;
+    s->next = header_->free_head;
+    header_->free_head = index;
+    --header_->count;
+}
+
+template<typename T>
+void ShmQueue<T>::rebuildLocked() {
+    std::vector<std::pair<uint64_t, uint32_t>> used; // (序号, 槽位)
+    header_->free_head = kNil;
+    for (uint32_t i = header_->capacity; i-- > 0;) {
+        if (slots_[i].state.load(std::memory_order_acquire) == kUsed) {
+            used.emplace_back(slots_[i].sequence, i);
+        } else {
+            slots_[i].prev = kNil;
+            slots_[i].next = header_->free_head;
+            header_->free_head = i;
+        }
+    }
+    std::sort(used.begin(), used.end());
+
+    header_->head = kNil;
+    header_->tail = kNil;
+    for (const auto& entry : used) {
+        Slot* s = slot(entry.second);
+        s->next = kNil;
+        s->prev = header_->tail;
+        if (header_->tail == kNil) {
+            header_->head = entry.second;
+        } else {
+            slot(header_->tail)->next = entry.second;
+        }
+        header_->tail = entry.second;
+    }
+    header_->next_sequence = used.empty() ? header_->next_sequence : std::max(header_->next_sequence, used.back().first + 1);
+    header_->count = static_cast<uint32_t>(used.size());
+    header_->recoveries.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+#include "Thread.hpp"
+#include <stdio.h>
+
+Thread::Thread(ThreadFunc func)
+: thread_id_(0)
+, started_(false)
+, joined_(false)
+, func_(std::move(func))
+{
+
+}
+
+Thread::~Thread()
+{
+    if (started_ && !joined_) {
+        join();
+    }
+}
+
+void Thread::start()
+{
+    int ret = pthread_create(&thread_id_, nullptr, threadFunc, this);
+    if (ret != 0) {
+        perror("pthread_create");
+        return;
+    }
+    started_ = true;
+}
+
+void Thread::join()
+{
+    if (!started_ || joined_) {
+        return;
+    }
+    int ret = pthread_join(thread_id_, nullptr);
+    if (ret != 0) {
+        perror("pthread_join");
+    }
+    joined_ = true;
+}
+
+void *Thread::threadFunc(void *arg)
+{
+    Thread *thread = static_cast<Thread *>(arg);
+    if (thread->func_) {
+        thread->func_();
+    }
+    return nullptr;
+}
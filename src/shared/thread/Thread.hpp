@@ -0,0 +1,59 @@
+#pragma once
+
+#include "shared/mutex/NonCopyable.hpp"
+#include <pthread.h>
+#include <functional>
+
+/**
+ * @brief 线程类，封装 pthread 的创建与回收。
+ *
+ * Thread 类在 start() 时创建一个 POSIX 线程执行传入的回调函数。
+ * 如果线程已启动但未被 join()，析构时会自动 join，确保线程资源被回收。
+ * 它继承自 NonCopyable，线程对象不能被复制。
+ */
+class Thread
+: NonCopyable
+{
+public:
+    using ThreadFunc = std::function<void()>;
+
+    /**
+     * @brief 构造函数，保存线程要执行的回调函数（此时不会创建线程）。
+     *
+     * @param func 线程入口函数。
+     */
+    explicit Thread(ThreadFunc func);
+
+    /**
+     * @brief 析构函数，若线程仍在运行则等待其结束。
+     */
+    ~Thread();
+
+    /**
+     * @brief 创建线程并开始执行回调函数。
+     */
+    void start();
+
+    /**
+     * @brief 等待线程结束。
+     */
+    void join();
+
+    /**
+     * @brief 线程是否已启动。
+     *
+     * @return bool 已启动返回 true。
+     */
+    bool started() const { return started_; }
+
+private:
+    /**
+     * @brief pthread_create 的入口函数，转调 func_。
+     */
+    static void *threadFunc(void *arg);
+
+    pthread_t thread_id_; ///< 线程 ID。
+    bool started_;        ///< 是否已启动。
+    bool joined_;         ///< 是否已回收。
+    ThreadFunc func_;     ///< 线程执行的回调函数。
+};
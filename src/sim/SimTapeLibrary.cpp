@@ -0,0 +1,501 @@
+#include "SimTapeLibrary.hpp"
+#include "InventoryCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <limits>
+#include <unistd.h>
+
+SimTapeLibrary::SimTapeLibrary(const Config& config)
+: config_(config)
+, model_(config.locate)
+, drives_(config.drive_count)
+, changer_(config.changer)
+, now_(0.0)
+, next_operation_id_(1ULL << 48)
+{
+}
+
+SimTapeLibrary::~SimTapeLibrary()
+{
+    for (auto& entry : tapes_) {
+        if (entry.second.fd >= 0) {
+            close(entry.second.fd);
+        }
+    }
+}
+
+int SimTapeLibrary::driveOf(const std::string& tape_id) const
+{
+    auto it = tapes_.find(tape_id);
+    return it == tapes_.end() ? -1 : it->second.drive;
+}
+
+SimTapeLibrary::SimTape& SimTapeLibrary::tape(const std::string& tape_id)
+{
+    SimTape& tape = tapes_[tape_id];
+    if (tape.fd < 0 && !config_.directory.empty()) {
+        std::string path = config_.directory + "/" + tape_id + ".tape";
+        tape.fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+    return tape;
+}
+
+double SimTapeLibrary::ejectReady(SimDrive& drive, double start) const
+{
+    return start + model_.locateSeconds(drive.head, LocateModel::Position{0, 0}) + config_.unload_seconds;
+}
+
+void SimTapeLibrary::applyPlan(const ChangerScheduler::Plan& plan)
+{
+    const ChangerScheduler::Move& move = plan.move;
+    SimDrive& drive = drives_.at(move.drive_id);
+    if (move.type != ChangerScheduler::MoveType::Load) {
+        tape(move.unload_tape).drive = -1;
+        drive.tape.clear();
+        drive.free_at = plan.drive_done;
+    }
+    if (move.type != ChangerScheduler::MoveType::Unload) {
+        tape(move.load_tape).drive = move.drive_id;
+        drive.tape = move.load_tape;
+        drive.head = LocateModel::Position{0, 0};
+        drive.free_at = plan.drive_done + config_.load_seconds;
+    }
+    stats_.makespan = std::max(stats_.makespan, std::max(drive.free_at, plan.robot_free));
+}
+
+SimTapeLibrary::Stats SimTapeLibrary::stats() const
+{
+    Stats stats = stats_;
+    stats.changer = changer_.stats();
+    return stats;
+}
+
+double SimTapeLibrary::transferSeconds(uint64_t bytes) const
+{
+    return config_.bandwidth > 0.0 ? static_cast<double>(bytes) / config_.bandwidth : 0.0;
+}
+
+double SimTapeLibrary::streamWrite(StreamBuffer& buffer, double start, double ready, uint64_t bytes,
+                                   const uint8_t* payload, std::vector<uint8_t>* out)
+{
+    const uint64_t chunk = config_.block_size;
+    std::vector<uint8_t> block(chunk);
+    std::vector<uint8_t> zeros(payload ? 0 : chunk);
+    uint64_t produced = 0;
+    uint64_t consumed = 0;
+    uint64_t chunk_left = std::min(chunk, bytes);   // 暂存盘读到、还没放进缓冲区的字节数
+    double produce_at = start + static_cast<double>(chunk_left) / config_.staging_bandwidth;
+    double drive_at = ready;        // 驱动器下一次动作的时刻
+    bool started = false;
+    bool streaming = false;
+    bool parked = false;            // 驱动器在等待填充，暂存盘每读完一块再检查
+    buffer.reset();
+
+    // 驱动器在 t 时刻从缓冲区取一块写带
+    auto drain = [&](double t) {
+        const size_t n = buffer.tryRead(block.data(), std::min(chunk, bytes - consumed));
+        if (n == 0) {
+            return false;
+        }
+        if (out) {
+            memcpy(out->data() + consumed, block.data(), n);
+        }
+        consumed += n;
+        drive_at = t + transferSeconds(n);
+        return true;
+    };
+    // 驱动器在 t 时刻尝试开始写带，或在欠载后恢复
+    auto resume = [&](double t) {
+        if (!started) {
+            started = buffer.tryStart();
+            drive_at = started ? t : drive_at;
+            return started;
+        }
+        return drain(t);
+    };
+
+    while (consumed < bytes) {
+        if (!parked && (produced == bytes || drive_at <= produce_at)) {
+            if (!streaming) {
+                streaming = resume(drive_at);
+                parked = !streaming;
+            } else if (!drain(drive_at)) {
+                // 欠载：停带、倒回，等缓冲区重新填充到 resume_fill 再起步
+                streaming = false;
+                drive_at += config_.backhitch_seconds;
+                ++stats_.underruns;
+            }
+            continue;
+        }
+
+        // 暂存盘读完一块，放进缓冲区；放不下的部分等驱动器取走数据后再放
+        const double now = produce_at;
+        const size_t written = buffer.tryWrite(payload ? payload + produced : zeros.data(), chunk_left);
+        produced += written;
+        chunk_left -= written;
+        if (chunk_left > 0) {
+            produce_at = std::max(now, drive_at);
+        } else if (produced == bytes) {
+            buffer.close();
+            produce_at = std::numeric_limits<double>::infinity();
+        } else {
+            chunk_left = std::min(chunk, bytes - produced);
+            produce_at = now + static_cast<double>(chunk_left) / config_.staging_bandwidth;
+        }
+        if (parked) {
+            streaming = resume(now);
+            parked = !streaming;
+        }
+    }
+    return drive_at;
+}
+
+SimTapeLibrary::Result SimTapeLibrary::execute(size_t drive_id, const TapeDrivesOperation& op, StreamBuffer* buffer)
+{
+    SimDrive& drive = drives_.at(drive_id);
+    Result result;
+    result.start = std::max(now_, drive.free_at);
+    double t = result.start;
+    const uint64_t block_size = config_.block_size;
+
+    switch (op.getTypeOperation()) {
+        case TypeOperation::LOAD_TAPE: {
+            SimTape& target = tape(op.getTapeId());
+            if (!drive.tape.empty() || (target.drive >= 0 && target.drive != static_cast<int>(drive_id))) {
+                result.ok = false;
+                break;
+            }
+            if (target.drive < 0) {
+                ChangerScheduler::Move move;
+                move.type = ChangerScheduler::MoveType::Load;
+                move.drive_id = static_cast<int>(drive_id);
+                move.load_tape = op.getTapeId();
+                move.requested = move.load_requested = move.drive_ready = t;
+                changer_.submit(move);
+                while (auto plan = changer_.dispatch(t)) {
+                    applyPlan(*plan);
+                }
+                t = drive.free_at;
+            }
+            drive.tape = op.getTapeId();
+            ++stats_.loads;
+            break;
+        }
+        case TypeOperation::UNLOAD_TAPE: {
+            if (drive.tape.empty()) {
+                result.ok = false;
+                break;
+            }
+            // 倒带回 BOT 后退带，再由机械手送回槽位
+            ChangerScheduler::Move move;
+            move.type = ChangerScheduler::MoveType::Unload;
+            move.drive_id = static_cast<int>(drive_id);
+            move.unload_tape = drive.tape;
+            move.requested = t;
+            move.drive_ready = ejectReady(drive, t);
+            changer_.submit(move);
+            while (auto plan = changer_.dispatch(t)) {
+                applyPlan(*plan);
+            }
+            t = drive.free_at;
+            ++stats_.unloads;
+            break;
+        }
+        case TypeOperation::READ_AGGR:
+        case TypeOperation::WRITE_AGGR: {
+            const bool is_read = op.getTypeOperation() == TypeOperation::READ_AGGR;
+            if (drive.tape.empty() || (!op.getTapeId().empty() && op.getTapeId() != drive.tape)) {
+                result.ok = false;
+                break;
+            }
+            SimTape& mounted = tape(drive.tape);
+            auto aggregate = op.getAggregate();
+            result.bytes = !is_read && aggregate && aggregate->payload ? aggregate->payload->size() : op.getLength();
+            result.block_position = is_read ? op.getBlockPosition() : mounted.end_block;
+
+            LocateModel::Position target = is_read ? model_.positionOf(op) : model_.positionOf(result.block_position);
+            result.locate_seconds = model_.locateSeconds(drive.head, target);
+            const uint8_t* payload = aggregate && aggregate->payload ? aggregate->payload->data() : nullptr;
+            std::vector<uint8_t> streamed;
+            const bool stream = !is_read && buffer && config_.staging_bandwidth > 0.0 && result.bytes > 0 &&
+                                buffer->config().capacity > 0;
+            if (stream) {
+                // 写到磁带上的是从流式缓冲区读出的数据
+                streamed.resize(mounted.fd >= 0 && payload ? result.bytes : 0);
+                t = streamWrite(*buffer, t, t + result.locate_seconds, result.bytes, payload,
+                                streamed.empty() ? nullptr : &streamed);
+                payload = streamed.empty() ? payload : streamed.data();
+            } else {
+                t += result.locate_seconds + transferSeconds(result.bytes);
+            }
+            const uint64_t blocks = (result.bytes + block_size - 1) / block_size;
+            drive.head = model_.positionOf(result.block_position + blocks);
+            stats_.locate_seconds += result.locate_seconds;
+
+            const off_t offset = static_cast<off_t>(result.block_position * block_size);
+            if (is_read) {
+                if (mounted.fd >= 0) {
+                    result.data.resize(result.bytes);
+                    ssize_t n = pread(mounted.fd, result.data.data(), result.data.size(), offset);
+                    result.ok = n == static_cast<ssize_t>(result.data.size());
+                    result.data.resize(n > 0 ? static_cast<size_t>(n) : 0);
+                }
+                ++stats_.reads;
+                stats_.bytes_read += result.bytes;
+            } else {
+                if (mounted.fd >= 0 && payload) {
+                    result.ok = pwrite(mounted.fd, payload, result.bytes, offset) ==
+                                static_cast<ssize_t>(result.bytes);
+                }
+                mounted.end_block = result.block_position + blocks;
+                ++stats_.writes;
+                stats_.bytes_written += result.bytes;
+            }
+            break;
+        }
+        case TypeOperation::INVENTORY: {
+            const bool full = InventoryCache::frameOf(op) == InventoryCache::kFullScan || config_.frames == 0;
+            t = changer_.reserve(t, full ? config_.inventory_seconds
+                                         : config_.inventory_seconds / static_cast<double>(config_.frames));
+            break;
+        }
+        case TypeOperation::ROLL_TAPE:
+            if (drive.tape.empty()) {
+                result.ok = false;
+                break;
+            }
+            t += config_.roll_seconds;
+            drive.head = LocateModel::Position{0, 0};
+            break;
+    }
+
+    result.finish = t;
+    drive.free_at = t;
+    ++stats_.operations;
+    if (!result.ok) {
+        ++stats_.errors;
+    }
+    stats_.makespan = std::max(stats_.makespan, t);
+    return result;
+}
+
+SimTapeLibrary::Stats SimTapeLibrary::run(DrivePool& pool, std::vector<Arrival> arrivals, const CompletionHook& hook)
+{
+    std::stable_sort(arrivals.begin(), arrivals.end(),
+                     [](const Arrival& a, const Arrival& b) { return a.time < b.time; });
+    std::unordered_map<uint64_t, double> arrived; // operation_id -> 到达时间
+    const size_t drive_count = std::min(pool.size(), drives_.size());
+    std::vector<DriveRun> runs(drive_count);
+    size_t next_arrival = 0;
+    uint64_t unscheduled = 0;  // 没有在线驱动器、未能分派的到达操作
+    const double never = std::numeric_limits<double>::infinity();
+
+    // 驱动器没有任何待执行的操作（等待机械手的驱动器不算空闲）
+    auto idle = [&](size_t i) {
+        const TapeDrive& drive = pool.drive(i);
+        return !runs[i].waiting && !runs[i].ready && !runs[i].maintenance && drive.pendingCount() == 0 &&
+               drive.maintenanceCount() == 0 && drive.backgroundCount() == 0;
+    };
+
+    auto finish = [&](size_t drive_id, const TapeDrivesOperation& op, const Result& result) {
+        pool.drive(drive_id).complete(op, op.getTypeOperation() == TypeOperation::READ_AGGR ? result.locate_seconds
+                                                                                             : -1.0);
+        auto it = op.getOperationId() != 0 ? arrived.find(op.getOperationId()) : arrived.end();
+        if (TapeDrive::isMaintenance(op)) {
+            ++stats_.maintenance_completed;
+            if (it != arrived.end()) {
+                arrived.erase(it);
+            }
+        } else if (it != arrived.end()) {
+            const double latency = result.finish - it->second;
+            ++stats_.completed;
+            stats_.total_latency += latency;
+            stats_.max_latency = std::max(stats_.max_latency, latency);
+            arrived.erase(it);
+        }
+        if (hook) {
+            hook(drive_id, op, result);
+        }
+    };
+
+    // 磁带还在另一个驱动器中时，装带要等机械手把它取出后再提交；多个驱动器等待同一盘磁带时按先后顺序装载
+    std::unordered_map<std::string, std::deque<size_t>> awaiting; // 磁带 ID -> 等待该磁带的驱动器
+    auto requestLoad = [&](size_t drive_id, const TapeDrivesOperation& op) {
+        runs[drive_id].mounting = op;
+        if (driveOf(op.getTapeId()) >= 0) {
+            awaiting[op.getTapeId()].push_back(drive_id);
+            return;
+        }
+        ChangerScheduler::Move load;
+        load.type = ChangerScheduler::MoveType::Load;
+        load.drive_id = static_cast<int>(drive_id);
+        load.load_tape = op.getTapeId();
+        load.requested = load.load_requested = load.drive_ready = now_;
+        changer_.submit(load);
+    };
+
+    while (true) {
+        // 持有被等待磁带的驱动器已经空闲：让其卸带，否则等待的驱动器永远拿不到磁带
+        for (const auto& waiters : awaiting) {
+            const int holder = driveOf(waiters.first);
+            if (holder >= 0 && static_cast<size_t>(holder) < drive_count && idle(holder)) {
+                pool.drive(holder).submit(TapeDrivesOperation(TypeOperation::UNLOAD_TAPE, waiters.first));
+            }
+        }
+
+        // 空闲最早且有待执行操作的驱动器（离线或等待机械手的驱动器不参与）
+        size_t drive_id = drive_count;
+        double drive_time = never;
+        for (size_t i = 0; i < drive_count; ++i) {
+            if (runs[i].waiting || pool.drive(i).getState() == DriveState::Offline || idle(i)) {
+                continue;
+            }
+            if (std::max(now_, drives_[i].free_at) < drive_time) {
+                drive_time = std::max(now_, drives_[i].free_at);
+                drive_id = i;
+            }
+        }
+        const double robot_time = changer_.nextDispatchTime(now_);
+        const double arrival_time = next_arrival < arrivals.size() ? arrivals[next_arrival].time : never;
+        if (drive_time == never && robot_time == never && arrival_time == never) {
+            break;
+        }
+
+        // 1. 先提交在驱动器、机械手空闲之前到达的操作
+        if (arrival_time <= drive_time && arrival_time <= robot_time) {
+            Arrival& arrival = arrivals[next_arrival++];
+            now_ = std::max(now_, arrival.time);
+            if (arrival.op.getOperationId() == 0) {
+                arrival.op.setOperationId(next_operation_id_++);
+            }
+            arrived[arrival.op.getOperationId()] = arrival.time;
+            if (pool.schedule(arrival.op) < 0) {
+                ++unscheduled;
+            }
+            for (size_t i = 0; i < drive_count; ++i) {
+                // 用户操作到达正在卷带的驱动器：中止卷带，维护操作回到维护队列
+                DriveRun& run = runs[i];
+                if (run.maintenance && now_ < run.maintenance_result.finish && pool.drive(i).preemptRequested()) {
+                    pool.drive(i).preempt(*run.maintenance);
+                    run.maintenance.reset();
+                    drives_[i].free_at = now_ + config_.preempt_seconds;
+                    ++stats_.preemptions;
+                    // 卷带没有执行完，按各驱动器和机械手实际的空闲时刻重新计算 makespan
+                    stats_.makespan = changer_.robotFreeAt();
+                    for (const SimDrive& drive : drives_) {
+                        stats_.makespan = std::max(stats_.makespan, drive.free_at);
+                    }
+                }
+            }
+            continue;
+        }
+
+        // 2. 机械手空闲：执行下一次搬运，完成后驱动器继续
+        if (robot_time <= drive_time) {
+            now_ = robot_time;
+            auto plan = changer_.dispatch(now_);
+            applyPlan(*plan);
+            auto released = awaiting.find(plan->move.unload_tape);
+            if (plan->move.type != ChangerScheduler::MoveType::Load && released != awaiting.end()) {
+                // 磁带回到槽位：交给最早等待的驱动器，其余驱动器继续等待它下一次卸下
+                size_t waiting_drive = released->second.front();
+                released->second.pop_front();
+                if (released->second.empty()) {
+                    awaiting.erase(released);
+                }
+                requestLoad(waiting_drive, *runs[waiting_drive].mounting);
+            }
+            DriveRun& run = runs[plan->move.drive_id];
+            if (plan->move.type == ChangerScheduler::MoveType::Unload) {
+                // 只卸了带：如果还要装带，继续等待后续的装带搬运
+                run.waiting = run.mounting.has_value();
+            } else {
+                run.waiting = false;
+                Result result;
+                result.start = plan->move.load_requested;
+                result.finish = drives_[plan->move.drive_id].free_at;
+                ++stats_.loads;
+                ++stats_.operations;
+                finish(plan->move.drive_id, *run.mounting, result);
+                run.mounting.reset();
+            }
+            continue;
+        }
+
+        // 3. 驱动器空闲：执行下一个操作
+        now_ = drive_time;
+        DriveRun& run = runs[drive_id];
+        TapeDrive& drive = pool.drive(drive_id);
+        if (run.maintenance) {
+            // 维护操作未被抢占，执行完毕
+            finish(drive_id, *run.maintenance, run.maintenance_result);
+            run.maintenance.reset();
+            continue;
+        }
+        std::optional<TapeDrivesOperation> op;
+        if (run.ready) {
+            op.swap(run.ready);
+        } else {
+            op = drive.next();
+        }
+        if (!op) {
+            continue;
+        }
+
+        SimDrive& sim_drive = drives_[drive_id];
+        const TypeOperation type = op->getTypeOperation();
+        if (type == TypeOperation::UNLOAD_TAPE && !sim_drive.tape.empty()) {
+            // 驱动器倒带、退带；紧接着的 LOAD_TAPE 与卸带合并为一次交换提交给机械手
+            Result result;
+            result.start = now_;
+            result.finish = ejectReady(sim_drive, now_);
+            ++stats_.unloads;
+            ++stats_.operations;
+            finish(drive_id, *op, result);
+
+            ChangerScheduler::Move unload;
+            unload.type = ChangerScheduler::MoveType::Unload;
+            unload.drive_id = static_cast<int>(drive_id);
+            unload.unload_tape = sim_drive.tape;
+            unload.requested = now_;
+            unload.drive_ready = result.finish;
+            changer_.submit(unload);
+            sim_drive.free_at = result.finish;
+            run.waiting = true;
+
+            auto next = drive.next();
+            if (next && next->getTypeOperation() == TypeOperation::LOAD_TAPE) {
+                requestLoad(drive_id, *next);
+            } else {
+                run.ready = next;
+            }
+            continue;
+        }
+        if (type == TypeOperation::LOAD_TAPE && sim_drive.tape.empty()) {
+            run.waiting = true;
+            requestLoad(drive_id, *op);
+            continue;
+        }
+
+        Result result = execute(drive_id, *op, &drive.streamBuffer());
+        if (TapeDrive::isMaintenance(*op) && result.ok) {
+            // 维护操作完成前都可能被抢占，到完成时刻再回报
+            run.maintenance = op;
+            run.maintenance_result = result;
+            continue;
+        }
+        finish(drive_id, *op, result);
+    }
+
+    // 没有可执行的操作但仍有操作未完成（如驱动器离线、磁带一直拿不到），如实报告
+    stats_.stranded = unscheduled;
+    for (size_t i = 0; i < drive_count; ++i) {
+        const TapeDrive& drive = pool.drive(i);
+        stats_.stranded += drive.pendingCount() + drive.backgroundCount() + drive.maintenanceCount() +
+                           (runs[i].ready ? 1 : 0) + (runs[i].maintenance ? 1 : 0);
+    }
+    return stats();
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/NonCopyable.hpp"
+#include "ChangerScheduler.hpp"
+#include "DrivePool.hpp"
+#include "LocateModel.hpp"
+#include "TapeDrivesOperation.hpp"
+
+/**
+ * @brief 仿真磁带库：在虚拟时钟上执行 TapeDrivesOperation，用于在没有真实硬件时评估调度策略。
+ *
+ * 仿真内容：
+ * - 机械手：所有装卸带搬运和 INVENTORY 共用一个机械手，由 ChangerScheduler 排队、合并交换并计算行程；
+ * - 装载/卸载：LOAD_TAPE = 机械手搬运 + load_seconds；UNLOAD_TAPE = 倒带 + unload_seconds 后由机械手取出。
+ *   run() 中驱动器卸带后会立即取出下一个操作，如果是 LOAD_TAPE 则与卸带一起提交为交换，
+ *   机械手在驱动器倒带期间就去取新带；
+ * - 定位：使用 LocateModel 按磁头位置计算定位时间；
+ * - 传输：按 bandwidth 计算读写时间，WRITE_AGGR 追加在磁带数据末尾；
+ * - 写带流式缓冲：配置了 staging_bandwidth 且 execute() 传入驱动器的 StreamBuffer 时（run() 总是传入），
+ *   WRITE_AGGR 的数据按 staging_bandwidth 从暂存盘读入缓冲区，驱动器等 StreamBuffer::tryStart() 后才开始写带，
+ *   写带的数据从缓冲区读出。缓冲区读空即欠载：驱动器停带，花 backhitch_seconds 倒回，填充到 resume_fill 后再起步；
+ * - INVENTORY：占用机械手，整库扫描耗时 inventory_seconds，按 frame 扫描（见 InventoryCache）按比例缩短；
+ * - ROLL_TAPE：耗时 roll_seconds，结束后磁头回到 BOT。run() 中 ROLL_TAPE 作为维护操作只在驱动器空闲时执行，
+ *   执行期间有用户操作到达该驱动器时被抢占：preempt_seconds 后驱动器即可执行用户操作，卷带之后重新执行。
+ *
+ * 配置了 directory 时每盘磁带对应目录下的一个文件（<tape_id>.tape），写入的数据落盘，读取返回真实数据；
+ * 否则只计算时间。
+ *
+ * 所有时间都是虚拟时间（秒），与真实耗时无关，结果可复现。TapeDrive 的 max_wait 按真实时间计算，
+ * 在仿真中一般不会触发。该类不是线程安全的。
+ */
+class SimTapeLibrary
+: NonCopyable
+{
+public:
+    /**
+     * @brief 配置项（默认值接近 LTO-8 驱动器和中型磁带库）。
+     */
+    struct Config {
+        size_t drive_count = 4;                 ///< 驱动器数量
+        double load_seconds = 15.0;             ///< 磁带穿带、就绪时间
+        double unload_seconds = 20.0;           ///< 退带时间（不含倒带）
+        double inventory_seconds = 60.0;        ///< 一次整库 INVENTORY 扫描的时间
+        size_t frames = 10;                     ///< frame 数量，按 frame 的 INVENTORY 耗时为整库的 1/frames
+        double roll_seconds = 100.0;            ///< 一次 ROLL_TAPE 的时间
+        double preempt_seconds = 5.0;           ///< 中止 ROLL_TAPE、磁带停稳所需的时间
+        double bandwidth = 360e6;               ///< 流式读写带宽（字节/秒）
+        double staging_bandwidth = 0.0;         ///< WRITE_AGGR 数据源（暂存盘）的读取带宽（字节/秒），0 表示不模拟数据源
+        double backhitch_seconds = 2.5;         ///< 欠载停带后倒回、重新起步的时间
+        uint64_t block_size = 256 * 1024;       ///< 磁带块大小（字节）
+        LocateModel::Config locate;             ///< 定位时间模型参数
+        std::string directory;                  ///< 磁带数据文件所在目录，为空时不落盘
+        ChangerScheduler::Config changer;       ///< 机械手调度配置
+    };
+
+    /**
+     * @brief 单个操作的执行结果。
+     */
+    struct Result {
+        bool ok = true;                 ///< 是否成功
+        double start = 0.0;             ///< 开始时间（虚拟秒）
+        double finish = 0.0;            ///< 完成时间（虚拟秒）
+        double locate_seconds = 0.0;    ///< 定位时间
+        uint64_t block_position = 0;    ///< READ_AGGR/WRITE_AGGR 的起始块
+        uint64_t bytes = 0;             ///< 读写的字节数
+        std::vector<uint8_t> data;      ///< READ_AGGR 读到的数据（仅在配置了 directory 时填充）
+    };
+
+    /**
+     * @brief 到达事件：在 time 时刻提交到驱动器池的操作。
+     */
+    struct Arrival {
+        double time;
+        TapeDrivesOperation op;
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t operations = 0;        ///< 执行的操作数（含自动生成的装卸带）
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t loads = 0;
+        uint64_t unloads = 0;
+        uint64_t errors = 0;            ///< 执行失败的操作数
+        uint64_t bytes_read = 0;
+        uint64_t bytes_written = 0;
+        double locate_seconds = 0.0;    ///< 定位时间总和
+        uint64_t underruns = 0;         ///< WRITE_AGGR 流式缓冲区欠载（停带）次数
+        ChangerScheduler::Stats changer; ///< 机械手统计（搬运数、利用率、装载延迟）
+        double makespan = 0.0;          ///< 最后一个操作完成的时间
+        uint64_t completed = 0;         ///< run() 中完成的到达操作数（不含维护操作）
+        double total_latency = 0.0;     ///< 到达操作从到达到完成的时间总和
+        double max_latency = 0.0;       ///< 最大延迟
+        uint64_t maintenance_completed = 0; ///< run() 中完成的维护操作数
+        uint64_t preemptions = 0;       ///< 维护操作被用户操作抢占的次数
+        uint64_t stranded = 0;          ///< run() 结束时仍未执行的操作数（应为 0，否则仿真没有跑完）
+    };
+
+    /**
+     * @brief 操作完成回调。
+     */
+    using CompletionHook = std::function<void(size_t drive_id, const TapeDrivesOperation& op, const Result& result)>;
+
+    explicit SimTapeLibrary(const Config& config);
+    ~SimTapeLibrary();
+
+    const Config& config() const { return config_; }
+
+    /**
+     * @brief 当前虚拟时间（秒）。
+     */
+    double now() const { return now_; }
+
+    /**
+     * @brief 在指定驱动器上执行一个操作，从 max(now(), 驱动器空闲时刻) 开始。
+     *
+     * LOAD_TAPE 装载已在其他驱动器中的磁带、在空驱动器上读写或卷带等情况返回失败。
+     *
+     * @param drive_id 驱动器编号。
+     * @param op 磁带操作。
+     * @param buffer 驱动器的流式缓冲区，为空或未配置 staging_bandwidth 时 WRITE_AGGR 按 bandwidth 直接写带。
+     * @return Result 执行结果。
+     */
+    Result execute(size_t drive_id, const TapeDrivesOperation& op, StreamBuffer* buffer = nullptr);
+
+    /**
+     * @brief 用驱动器池驱动仿真，直到所有到达操作执行完毕。
+     *
+     * 到达操作按时间顺序交给 pool.schedule()；每个驱动器空闲时从 TapeDrive::next() 取下一个操作执行，
+     * 执行后调用 TapeDrive::complete()。没有 operation_id 的到达操作会被分配一个，用于统计延迟。
+     *
+     * 装带的磁带还在其他驱动器中时，驱动器排队等待（每盘磁带一个先进先出的等待队列），磁带卸下后依次装载。
+     * 持有磁带的驱动器已经没有待执行的操作时，为其提交 UNLOAD_TAPE，让出磁带。
+     * 没有可执行的操作时返回；此时仍留在驱动器队列中、或因没有在线驱动器而未能分派的操作数记入 Stats::stranded。
+     *
+     * @param pool 驱动器池，驱动器数量应与 config.drive_count 一致。
+     * @param arrivals 到达事件。
+     * @param hook 每个操作完成后的回调，可为空。
+     * @return Stats 统计信息。
+     */
+    Stats run(DrivePool& pool, std::vector<Arrival> arrivals, const CompletionHook& hook = CompletionHook());
+
+    /**
+     * @brief 获取统计信息。
+     */
+    Stats stats() const;
+
+    /**
+     * @brief 磁带当前所在的驱动器，-1 表示在槽位中。
+     */
+    int driveOf(const std::string& tape_id) const;
+
+private:
+    /**
+     * @brief 仿真驱动器状态。
+     */
+    struct SimDrive {
+        double free_at = 0.0;           ///< 空闲时刻
+        std::string tape;               ///< 已装载的磁带
+        LocateModel::Position head{0, 0}; ///< 磁头位置
+    };
+
+    /**
+     * @brief 仿真磁带状态。
+     */
+    struct SimTape {
+        uint64_t end_block = 0;         ///< 数据末尾块号（下一次写入的位置）
+        int drive = -1;                 ///< 所在驱动器，-1 表示在槽位中
+        int fd = -1;                    ///< 数据文件
+    };
+
+    /**
+     * @brief run() 中每个驱动器的状态。
+     */
+    struct DriveRun {
+        bool waiting = false;                          ///< 正在等待机械手
+        std::optional<TapeDrivesOperation> mounting;   ///< 由机械手完成的 LOAD_TAPE
+        std::optional<TapeDrivesOperation> ready;      ///< 机械手完成后下一个要执行的操作
+        std::optional<TapeDrivesOperation> maintenance; ///< 正在执行、可被抢占的维护操作
+        Result maintenance_result;                     ///< 维护操作按完整执行计算的结果
+    };
+
+    SimTape& tape(const std::string& tape_id);
+
+    /**
+     * @brief 驱动器倒带、退带完成的时刻。
+     */
+    double ejectReady(SimDrive& drive, double start) const;
+
+    /**
+     * @brief 按机械手的时间安排更新驱动器和磁带状态。
+     */
+    void applyPlan(const ChangerScheduler::Plan& plan);
+
+    double transferSeconds(uint64_t bytes) const;
+
+    /**
+     * @brief 在虚拟时钟上让 WRITE_AGGR 的数据经由流式缓冲区从暂存盘流向磁带。
+     *
+     * @param start 开始从暂存盘读取的时刻。
+     * @param ready 磁头定位完成、可以开始写带的时刻。
+     * @param payload 聚合数据，为空时以零填充。
+     * @param out 不为空时输出从缓冲区读出、写到磁带上的数据。
+     * @return double 写带完成的时刻。
+     */
+    double streamWrite(StreamBuffer& buffer, double start, double ready, uint64_t bytes, const uint8_t* payload,
+                       std::vector<uint8_t>* out);
+
+    const Config config_;
+    LocateModel model_;
+    std::vector<SimDrive> drives_;
+    std::map<std::string, SimTape> tapes_;
+    ChangerScheduler changer_;          ///< 机械手
+    double now_;                        ///< 虚拟时钟
+    uint64_t next_operation_id_;        ///< run() 分配的操作 ID
+    Stats stats_;
+};
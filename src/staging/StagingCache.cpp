@@ -0,0 +1,405 @@
+#include "StagingCache.hpp"
+#include "codec/ByteOrder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    constexpr char kMagic[4] = {'S', 'T', 'G', '1'};
+    constexpr size_t kFixedHeader = 16;     ///< magic(4) + key 长度(4) + cost(8)
+    constexpr char kCleanSuffix[] = ".stg";
+    constexpr char kDirtySuffix[] = ".dirty";
+    constexpr char kTmpSuffix[] = ".tmp";
+
+    bool hasSuffix(const std::string& name, const char* suffix) {
+        const size_t n = strlen(suffix);
+        return name.size() > n && name.compare(name.size() - n, n, suffix) == 0;
+    }
+
+    bool writeAll(int fd, const uint8_t* data, size_t length) {
+        while (length > 0) {
+            ssize_t n = ::write(fd, data, length);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool readAll(int fd, uint8_t* data, size_t length, off_t offset) {
+        while (length > 0) {
+            ssize_t n = pread(fd, data, length, offset);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+}
+
+StagingCache::StagingCache(const std::string& directory)
+: StagingCache(directory, Config())
+{
+}
+
+StagingCache::StagingCache(const std::string& directory, const Config& config)
+: directory_(directory)
+, config_(config)
+, inflation_(0.0)
+, next_file_(1)
+{
+    if (mkdir(directory_.c_str(), 0755) < 0 && errno != EEXIST) {
+        throw std::runtime_error("mkdir failed: " + directory_);
+    }
+    recover();
+}
+
+std::string StagingCache::aggregateKey(uint64_t aggregate_id)
+{
+    return "aggregate/" + std::to_string(aggregate_id);
+}
+
+bool StagingCache::put(const std::string& key, const uint8_t* data, size_t length, double cost_seconds, bool dirty)
+{
+    std::string path;
+    {
+        MutexLockGuard autoLock(mutex_);
+        if (length > config_.capacity) {
+            ++stats_.rejected;
+            return false;
+        }
+        path = dataPath(dirty);
+    }
+
+    // 文件在锁外写入：先写临时文件，脏数据 fsync 后再改名，崩溃后不会恢复出不完整的条目
+    std::vector<uint8_t> header(kFixedHeader + key.size());
+    memcpy(header.data(), kMagic, sizeof(kMagic));
+    byte_order::store<uint32_t>(header.data() + 4, static_cast<uint32_t>(key.size()));
+    uint64_t cost_bits;
+    memcpy(&cost_bits, &cost_seconds, sizeof(cost_bits));
+    byte_order::store<uint64_t>(header.data() + 8, cost_bits);
+    memcpy(header.data() + kFixedHeader, key.data(), key.size());
+
+    const std::string tmp = path + kTmpSuffix;
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeAll(fd, header.data(), header.size()) && writeAll(fd, data, length) && (!dirty || fsync(fd) == 0);
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) < 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+
+    // 先为新条目腾出空间（被替换的条目不参与淘汰，其空间计入可用），成功后才移除旧条目：
+    // 新条目被拒绝时旧条目（可能是尚未写带的脏数据）保持不变
+    MutexLockGuard autoLock(mutex_);
+    auto old = entries_.find(key);
+    const uint64_t replaced = old == entries_.end() ? 0 : old->second.length;
+    if (!makeRoomLocked(length > replaced ? length - replaced : 0, &key)) {
+        ::unlink(path.c_str());
+        ++stats_.rejected;
+        return false;
+    }
+    if (old != entries_.end()) {
+        removeLocked(old);
+    }
+    Entry& entry = entries_[key];
+    entry.path = path;
+    entry.length = length;
+    entry.header = static_cast<uint32_t>(header.size());
+    entry.cost = cost_seconds;
+    entry.dirty = dirty;
+    stats_.used_bytes += length;
+    ++stats_.puts;
+    if (dirty) {
+        stats_.dirty_bytes += length;
+    } else {
+        rankLocked(key, entry);
+    }
+    return true;
+}
+
+bool StagingCache::putAggregate(const AggregateInfo& aggregate, double cost_seconds, bool dirty)
+{
+    if (!aggregate.payload) {
+        return false;
+    }
+    return put(aggregateKey(aggregate.aggregate_id), aggregate.payload->data(), aggregate.payload->size(),
+               cost_seconds, dirty);
+}
+
+bool StagingCache::get(const std::string& key, std::vector<uint8_t>& out)
+{
+    return read(key, 0, UINT64_MAX, out);
+}
+
+bool StagingCache::read(const std::string& key, uint64_t offset, uint64_t length, std::vector<uint8_t>& out)
+{
+    uint64_t entry_length = 0;
+    uint32_t header = 0;
+    double cost = 0.0;
+    int fd = -1;
+    {
+        MutexLockGuard autoLock(mutex_);
+        fd = openLocked(key, entry_length, header, cost);
+        if (fd < 0 || offset > entry_length) {
+            ++stats_.misses;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return false;
+        }
+    }
+
+    // 读取在锁外进行；条目此时被淘汰也不影响已打开的文件
+    length = std::min(length, entry_length - offset);
+    out.resize(length);
+    bool ok = readAll(fd, out.data(), length, static_cast<off_t>(header + offset));
+    ::close(fd);
+
+    MutexLockGuard autoLock(mutex_);
+    if (ok) {
+        ++stats_.hits;
+        stats_.bytes_served += length;
+        stats_.saved_cost_seconds += cost;
+    } else {
+        ++stats_.misses;
+    }
+    return ok;
+}
+
+void StagingCache::markClean(const std::string& key)
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || !it->second.dirty) {
+        return;
+    }
+    Entry& entry = it->second;
+    std::string path = dataPath(false);
+    if (::rename(entry.path.c_str(), path.c_str()) == 0) {
+        entry.path = path;
+    }
+    entry.dirty = false;
+    stats_.dirty_bytes -= entry.length;
+    rankLocked(key, entry);
+}
+
+bool StagingCache::erase(const std::string& key)
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    removeLocked(it);
+    return true;
+}
+
+bool StagingCache::contains(const std::string& key) const
+{
+    MutexLockGuard autoLock(mutex_);
+    return entries_.count(key) > 0;
+}
+
+std::vector<std::string> StagingCache::dirtyKeys() const
+{
+    MutexLockGuard autoLock(mutex_);
+    std::vector<std::string> keys;
+    for (const auto& entry : entries_) {
+        if (entry.second.dirty) {
+            keys.push_back(entry.first);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+StagingCache::Stats StagingCache::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+int StagingCache::openLocked(const std::string& key, uint64_t& length, uint32_t& header, double& cost)
+{
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return -1;
+    }
+    int fd = ::open(it->second.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    length = it->second.length;
+    header = it->second.header;
+    cost = it->second.cost;
+    touchLocked(key, it->second);
+    return fd;
+}
+
+void StagingCache::touchLocked(const std::string& key, Entry& entry)
+{
+    ++entry.frequency;
+    if (!entry.dirty) {
+        unrankLocked(entry);
+        rankLocked(key, entry);
+    }
+}
+
+void StagingCache::rankLocked(const std::string& key, Entry& entry)
+{
+    const double gib = std::max(1.0, static_cast<double>(entry.length)) / static_cast<double>(1ULL << 30);
+    entry.priority = inflation_ + static_cast<double>(std::max<uint64_t>(1, entry.frequency)) * entry.cost / gib;
+    entry.lru = lru_.insert(lru_.end(), key);
+    entry.rank = ranks_.emplace(entry.priority, key);
+}
+
+void StagingCache::unrankLocked(Entry& entry)
+{
+    lru_.erase(entry.lru);
+    ranks_.erase(entry.rank);
+}
+
+bool StagingCache::makeRoomLocked(uint64_t length, const std::string* keep)
+{
+    while (stats_.used_bytes + length > config_.capacity) {
+        const std::string* victim = nullptr;
+        if (config_.policy == Policy::Lru) {
+            auto candidate = lru_.begin();
+            if (candidate != lru_.end() && keep && *candidate == *keep) {
+                ++candidate;
+            }
+            victim = candidate == lru_.end() ? nullptr : &*candidate;
+        } else {
+            auto candidate = ranks_.begin();
+            if (candidate != ranks_.end() && keep && candidate->second == *keep) {
+                ++candidate;
+            }
+            victim = candidate == ranks_.end() ? nullptr : &candidate->second;
+        }
+        if (!victim) {
+            return false; // 只剩脏条目（和要保留的条目）
+        }
+        auto it = entries_.find(*victim);
+        if (config_.policy == Policy::CostBased) {
+            inflation_ = it->second.priority;
+        }
+        ++stats_.evictions;
+        stats_.evicted_bytes += it->second.length;
+        removeLocked(it);
+    }
+    return true;
+}
+
+void StagingCache::removeLocked(std::unordered_map<std::string, Entry>::iterator it)
+{
+    Entry& entry = it->second;
+    if (entry.dirty) {
+        stats_.dirty_bytes -= entry.length;
+    } else {
+        unrankLocked(entry);
+    }
+    stats_.used_bytes -= entry.length;
+    ::unlink(entry.path.c_str());
+    entries_.erase(it);
+}
+
+void StagingCache::recover()
+{
+    DIR* dir = opendir(directory_.c_str());
+    if (!dir) {
+        throw std::runtime_error("opendir failed: " + directory_);
+    }
+    std::vector<std::string> names;
+    while (struct dirent* ent = readdir(dir)) {
+        names.emplace_back(ent->d_name);
+    }
+    closedir(dir);
+    // 文件名是递增的序号：按降序处理，同一键有多个文件时保留最新的。put() 先把新文件改名到位再删除旧文件，
+    // 在这之间崩溃会留下两个文件，旧文件可能是已被替换的数据，新文件可能是尚未写带的脏数据
+    std::sort(names.begin(), names.end(), std::greater<std::string>());
+
+    MutexLockGuard autoLock(mutex_);
+    for (const auto& name : names) {
+        const std::string path = directory_ + "/" + name;
+        const bool dirty = hasSuffix(name, kDirtySuffix);
+        if (hasSuffix(name, kTmpSuffix)) {
+            ::unlink(path.c_str()); // 写了一半的条目
+            continue;
+        }
+        if (!dirty && !hasSuffix(name, kCleanSuffix)) {
+            continue;
+        }
+        next_file_ = std::max<uint64_t>(next_file_, std::strtoull(name.c_str(), nullptr, 16) + 1);
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        uint8_t fixed[kFixedHeader];
+        bool ok = fd >= 0 && fstat(fd, &st) == 0 && readAll(fd, fixed, sizeof(fixed), 0) &&
+                  memcmp(fixed, kMagic, sizeof(kMagic)) == 0;
+        std::string key;
+        uint64_t header = 0;
+        if (ok) {
+            key.resize(byte_order::load<uint32_t>(fixed + 4));
+            header = kFixedHeader + key.size();
+            ok = static_cast<uint64_t>(st.st_size) >= header &&
+                 readAll(fd, reinterpret_cast<uint8_t*>(&key[0]), key.size(), kFixedHeader);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!ok || entries_.count(key)) {
+            ::unlink(path.c_str());
+            continue;
+        }
+        const uint64_t cost_bits = byte_order::load<uint64_t>(fixed + 8);
+        Entry& entry = entries_[key];
+        entry.path = path;
+        entry.length = static_cast<uint64_t>(st.st_size) - header;
+        entry.header = static_cast<uint32_t>(header);
+        memcpy(&entry.cost, &cost_bits, sizeof(entry.cost));
+        entry.dirty = dirty;
+        stats_.used_bytes += entry.length;
+        if (dirty) {
+            stats_.dirty_bytes += entry.length;
+        } else {
+            rankLocked(key, entry);
+        }
+    }
+    makeRoomLocked(0); // 容量调小后重新打开：淘汰超出的干净条目
+}
+
+std::string StagingCache::dataPath(bool dirty)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 "%s", next_file_++, dirty ? kDirtySuffix : kCleanSuffix);
+    return directory_ + "/" + name;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "Aggregate.hpp"
+
+/**
+ * @brief 本地暂存盘缓存：解耦磁带驱动器与客户端的速度。
+ *
+ * - 归档：客户端数据先写入暂存盘（put(..., dirty = true)），驱动器从暂存盘全速读取并执行 WRITE_AGGR，
+ *   写带完成后调用 markClean()。脏条目在此之前不会被淘汰；
+ * - 召回：READ_AGGR 的数据先落到暂存盘，再按客户端的速度交付；之后对同一聚合中对象的召回
+ *   直接通过 read() 从暂存盘读取，不再产生磁带操作。ReadCoalescer 配置 staging 后按这种方式使用本类；
+ *   归档一侧没有统一的写带完成回调，由执行 WRITE_AGGR 的一方调用 putAggregate(..., dirty = true) 和 markClean()。
+ *
+ * 每个条目对应目录下的一个文件（文件头保存键），已用空间按条目数据长度统计，不超过 capacity。
+ * 空间不足时按策略淘汰干净的条目：
+ * - Lru：最久未访问的条目；
+ * - CostBased：GreedyDual-Size-Frequency，条目优先级 = L + 访问次数 × cost_seconds / 长度（GiB），
+ *   淘汰优先级最低的条目，并把 L 提升到被淘汰条目的优先级。重新召回代价高（需要装带、长距离定位）、
+ *   访问频繁且体积小的条目更可能留下，长期不被访问的条目随 L 增长逐渐老化。
+ *
+ * 重新打开目录时恢复已有的条目：干净条目的访问历史清零；脏条目仍然受保护，
+ * 通过 dirtyKeys() 返回，调用方应重新发出对应的 WRITE_AGGR。
+ *
+ * 所有方法都是线程安全的，文件读写在锁外进行，被淘汰的条目在已经打开它的读者读完之前仍然可读。
+ */
+class StagingCache
+: NonCopyable
+{
+public:
+    /**
+     * @brief 淘汰策略。
+     */
+    enum class Policy : int {
+        Lru = 1,
+        CostBased = 2
+    };
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        uint64_t capacity = 64ULL << 30;        ///< 暂存空间上限（字节）
+        Policy policy = Policy::CostBased;      ///< 淘汰策略
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t hits = 0;              ///< 命中次数
+        uint64_t misses = 0;            ///< 未命中次数
+        uint64_t bytes_served = 0;      ///< 从暂存盘交付的字节数
+        uint64_t puts = 0;              ///< 写入的条目数
+        uint64_t rejected = 0;          ///< 因空间不足（脏条目占满）而拒绝的写入数
+        uint64_t evictions = 0;         ///< 淘汰的条目数
+        uint64_t evicted_bytes = 0;     ///< 淘汰的字节数
+        double saved_cost_seconds = 0;  ///< 命中节省的重新召回代价之和
+        uint64_t used_bytes = 0;        ///< 当前已用空间
+        uint64_t dirty_bytes = 0;       ///< 当前脏条目占用的空间
+        size_t entries = 0;             ///< 当前条目数
+    };
+
+    explicit StagingCache(const std::string& directory);
+
+    /**
+     * @brief 打开暂存目录（不存在时创建）并恢复已有条目，失败时抛出 std::runtime_error。
+     *
+     * @param directory 暂存目录。
+     * @param config 配置项。
+     */
+    StagingCache(const std::string& directory, const Config& config);
+
+    /**
+     * @brief 聚合在缓存中的键。聚合 ID 全局唯一，归档暂存和召回暂存使用同一个键。
+     */
+    static std::string aggregateKey(uint64_t aggregate_id);
+
+    /**
+     * @brief 写入（或替换）一个条目，必要时淘汰干净的条目腾出空间。
+     *
+     * 替换时先为新条目腾出空间，成功后才删除旧条目；写入被拒绝时旧条目保持不变。
+     *
+     * @param key 条目键。
+     * @param data 数据。
+     * @param length 数据长度。
+     * @param cost_seconds 条目被淘汰后重新获取的代价（如装带 + 定位 + 读取的秒数），仅 CostBased 使用。
+     * @param dirty 是否为尚未写到磁带的归档数据。
+     * @return bool 空间不足（其余条目都是脏的）或写文件失败时返回 false。
+     */
+    bool put(const std::string& key, const uint8_t* data, size_t length, double cost_seconds = 0.0,
+             bool dirty = false);
+
+    /**
+     * @brief 暂存一个聚合的数据（键为 aggregateKey(aggregate.aggregate_id)）。
+     */
+    bool putAggregate(const AggregateInfo& aggregate, double cost_seconds = 0.0, bool dirty = false);
+
+    /**
+     * @brief 读取整个条目。
+     *
+     * @return bool 未命中或读取失败时返回 false。
+     */
+    bool get(const std::string& key, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 读取条目中的一段（如聚合中的一个成员对象）。
+     *
+     * @return bool 未命中、区间越界或读取失败时返回 false。
+     */
+    bool read(const std::string& key, uint64_t offset, uint64_t length, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 脏条目已写到磁带，之后可以被淘汰。
+     */
+    void markClean(const std::string& key);
+
+    /**
+     * @brief 删除条目（包括脏条目）。
+     *
+     * @return bool 条目不存在时返回 false。
+     */
+    bool erase(const std::string& key);
+
+    bool contains(const std::string& key) const;
+
+    /**
+     * @brief 尚未写到磁带的条目。
+     */
+    std::vector<std::string> dirtyKeys() const;
+
+    Stats stats() const;
+
+private:
+    /**
+     * @brief 缓存条目。
+     */
+    struct Entry {
+        std::string path;           ///< 数据文件
+        uint64_t length = 0;        ///< 数据长度
+        uint32_t header = 0;        ///< 文件头长度（数据在文件中的偏移）
+        double cost = 0.0;          ///< 重新获取的代价
+        uint64_t frequency = 0;     ///< 访问次数
+        double priority = 0.0;      ///< CostBased 优先级
+        bool dirty = false;
+        std::list<std::string>::iterator lru;                   ///< 在 lru_ 中的位置
+        std::multimap<double, std::string>::iterator rank;      ///< 在 ranks_ 中的位置（仅干净条目）
+    };
+
+    /**
+     * @brief 打开条目数据文件，返回文件描述符和数据偏移，未命中返回 -1。
+     */
+    int openLocked(const std::string& key, uint64_t& length, uint32_t& header, double& cost);
+
+    void touchLocked(const std::string& key, Entry& entry);
+    void rankLocked(const std::string& key, Entry& entry);
+    void unrankLocked(Entry& entry);
+    /**
+     * @brief 淘汰干净的条目，直到还能放下 length 字节。
+     *
+     * @param keep 不参与淘汰的条目（被替换的旧条目），可为空。
+     * @return bool 只剩脏条目仍放不下时返回 false。
+     */
+    bool makeRoomLocked(uint64_t length, const std::string* keep = nullptr);
+    void removeLocked(std::unordered_map<std::string, Entry>::iterator it);
+    void recover();
+    std::string dataPath(bool dirty);
+
+    const std::string directory_;
+    const Config config_;
+    mutable MutexLock mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;                        ///< 干净条目，最近访问的在尾部
+    std::multimap<double, std::string> ranks_;          ///< 干净条目按 CostBased 优先级排序
+    double inflation_;                                  ///< GreedyDual 的 L
+    uint64_t next_file_;                                ///< 数据文件序号
+    Stats stats_;
+};
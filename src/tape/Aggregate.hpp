@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 聚合中的一个成员对象。
+ */
+struct AggregateMember {
+    std::string object_key;   ///< 对象键
+    std::string job_id;       ///< 提交该对象的任务 ID
+    uint64_t offset;          ///< 在聚合数据中的偏移（字节）
+    uint64_t length;          ///< 长度（字节）
+    std::optional<uint32_t> checksum; ///< 成员数据的 CRC32C，读取单个成员时无需读完整个聚合即可校验
+};
+
+/**
+ * @brief 一个聚合：多个小对象打包成的一段连续数据及其成员索引。
+ *
+ * WRITE_AGGR 操作通过 std::shared_ptr<const AggregateInfo> 携带聚合，拷贝操作时不会复制数据。
+ */
+struct AggregateInfo {
+    uint64_t aggregate_id;                              ///< 聚合 ID
+    std::vector<AggregateMember> members;               ///< 成员索引（按偏移升序）
+    std::shared_ptr<const std::vector<uint8_t>> payload; ///< 聚合数据
+    std::optional<uint32_t> checksum;                   ///< 整个聚合数据的 CRC32C
+    bool compressed = false;                            ///< payload 是分块压缩帧（BlockFrame），成员偏移和校验和仍指未压缩数据
+};
@@ -0,0 +1,267 @@
+#include "ChangerScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+double ChangerScheduler::Stats::utilization() const
+{
+    const double span = last_finish - std::max(first_request, 0.0);
+    return span > 0.0 ? busy_seconds / span : 0.0;
+}
+
+ChangerScheduler::ChangerScheduler()
+: ChangerScheduler(Config())
+{
+}
+
+ChangerScheduler::ChangerScheduler(const Config& config)
+: config_(config)
+, next_slot_(0)
+, next_id_(1)
+, position_(config.drive_base_position)
+, free_at_(0.0)
+{
+}
+
+uint64_t ChangerScheduler::submit(const Move& move)
+{
+    MutexLockGuard autoLock(mutex_);
+    if (stats_.first_request < 0.0 || move.requested < stats_.first_request) {
+        stats_.first_request = move.requested;
+    }
+    if (config_.pair_exchanges && move.type == MoveType::Load) {
+        // 同一驱动器排在最后、尚未执行的卸带：合并为先卸后装的交换。
+        // 先装后卸不能合并，交换会颠倒顺序，卸下一盘还没装进去的磁带
+        for (auto it = pending_.rbegin(); it != pending_.rend(); ++it) {
+            Move& queued = *it;
+            if (queued.drive_id != move.drive_id) {
+                continue;
+            }
+            if (queued.type == MoveType::Unload) {
+                queued.type = MoveType::Exchange;
+                queued.load_tape = move.load_tape;
+                queued.load_requested = move.load_requested;
+                queued.requested = std::min(queued.requested, move.requested);
+                return queued.id;
+            }
+            break;
+        }
+    }
+    Move queued = move;
+    queued.id = next_id_++;
+    pending_.push_back(queued);
+    return queued.id;
+}
+
+std::optional<ChangerScheduler::Plan> ChangerScheduler::dispatch(double now)
+{
+    MutexLockGuard autoLock(mutex_);
+    if (pending_.empty()) {
+        return std::nullopt;
+    }
+    const double earliest = std::max(now, free_at_);
+    auto chosen = pending_.begin();
+    if (config_.policy == Policy::ShortestTravel && earliest - chosen->requested < config_.max_wait_seconds) {
+        // 队首未超时：选机械手最快能完成第一次抓取的请求。
+        // 同一驱动器还有排在前面的请求时必须等它完成，同一驱动器的搬运按提交顺序执行
+        double best = std::numeric_limits<double>::infinity();
+        for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+            if (blockedByEarlier(it)) {
+                continue;
+            }
+            const double start = std::max(earliest, eligibleAt(*it));
+            const double pickup = start + pickupCost(*it, start);
+            if (pickup < best) {
+                best = pickup;
+                chosen = it;
+            }
+        }
+    }
+    Move move = *chosen;
+    pending_.erase(chosen);
+    return execute(move, std::max(earliest, eligibleAt(move)));
+}
+
+double ChangerScheduler::nextDispatchTime(double now) const
+{
+    MutexLockGuard autoLock(mutex_);
+    if (pending_.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double earliest = std::max(now, free_at_);
+    if (config_.policy == Policy::Fifo) {
+        return std::max(earliest, eligibleAt(pending_.front()));
+    }
+    double next = std::numeric_limits<double>::infinity();
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+        if (blockedByEarlier(it)) {
+            continue;
+        }
+        next = std::min(next, eligibleAt(*it));
+    }
+    return std::max(earliest, next);
+}
+
+double ChangerScheduler::reserve(double now, double seconds)
+{
+    MutexLockGuard autoLock(mutex_);
+    const double start = std::max(now, free_at_);
+    free_at_ = start + seconds;
+    stats_.busy_seconds += seconds;
+    stats_.last_finish = std::max(stats_.last_finish, free_at_);
+    return free_at_;
+}
+
+size_t ChangerScheduler::pendingCount() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return pending_.size();
+}
+
+double ChangerScheduler::robotFreeAt() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return free_at_;
+}
+
+void ChangerScheduler::setHomeSlot(const std::string& tape_id, size_t slot)
+{
+    MutexLockGuard autoLock(mutex_);
+    home_slots_[tape_id] = slot;
+    next_slot_ = std::max(next_slot_, slot + 1);
+}
+
+size_t ChangerScheduler::homeSlot(const std::string& tape_id)
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = home_slots_.find(tape_id);
+    if (it == home_slots_.end()) {
+        it = home_slots_.emplace(tape_id, next_slot_++).first;
+    }
+    return it->second;
+}
+
+ChangerScheduler::Stats ChangerScheduler::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return stats_;
+}
+
+double ChangerScheduler::slotPosition(const std::string& tape_id) const
+{
+    auto it = home_slots_.find(tape_id);
+    if (it == home_slots_.end()) {
+        it = home_slots_.emplace(tape_id, next_slot_++).first;
+    }
+    return config_.slot_base_position + static_cast<double>(it->second);
+}
+
+double ChangerScheduler::drivePosition(int drive_id) const
+{
+    return config_.drive_base_position + config_.drive_spacing * drive_id;
+}
+
+double ChangerScheduler::travel(double from, double to) const
+{
+    return std::fabs(from - to) * config_.seconds_per_position;
+}
+
+bool ChangerScheduler::blockedByEarlier(std::list<Move>::const_iterator move) const
+{
+    for (auto it = pending_.begin(); it != move; ++it) {
+        if (it->drive_id == move->drive_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double ChangerScheduler::eligibleAt(const Move& move) const
+{
+    // 卸带和交换不必提前出发：机械手到达驱动器时旧带恰好退出即可
+    const double drive = drivePosition(move.drive_id);
+    switch (move.type) {
+        case MoveType::Load:
+            return move.requested;
+        case MoveType::Unload:
+            return std::max(move.requested, move.drive_ready - travel(position_, drive));
+        case MoveType::Exchange: {
+            const double slot = slotPosition(move.load_tape);
+            const double fetch = travel(position_, slot) + config_.grip_seconds + travel(slot, drive);
+            return std::max(move.requested, move.drive_ready - fetch);
+        }
+    }
+    return move.requested;
+}
+
+double ChangerScheduler::pickupCost(const Move& move, double start) const
+{
+    switch (move.type) {
+        case MoveType::Unload:
+            return std::max(start + travel(position_, drivePosition(move.drive_id)), move.drive_ready) - start;
+        case MoveType::Load:
+        case MoveType::Exchange:
+            return travel(position_, slotPosition(move.load_tape));
+    }
+    return 0.0;
+}
+
+ChangerScheduler::Plan ChangerScheduler::execute(const Move& move, double start)
+{
+    const double grip = config_.grip_seconds;
+    const double drive = drivePosition(move.drive_id);
+    Plan plan;
+    plan.move = move;
+    plan.start = start;
+    double t = start;
+    double wait = 0.0; // 在驱动器前等待退带的时间
+
+    switch (move.type) {
+        case MoveType::Load: {
+            const double slot = slotPosition(move.load_tape);
+            t += travel(position_, slot) + grip;      // 从槽位取出新带
+            t += travel(slot, drive) + grip;          // 放入驱动器
+            plan.drive_done = t;
+            position_ = drive;
+            break;
+        }
+        case MoveType::Unload: {
+            const double slot = slotPosition(move.unload_tape);
+            t += travel(position_, drive);
+            wait = std::max(0.0, move.drive_ready - t);
+            t += wait + grip;                         // 等驱动器退带后取出旧带
+            plan.drive_done = t;
+            t += travel(drive, slot) + grip;          // 送回槽位
+            position_ = slot;
+            break;
+        }
+        case MoveType::Exchange: {
+            const double load_slot = slotPosition(move.load_tape);
+            const double unload_slot = slotPosition(move.unload_tape);
+            t += travel(position_, load_slot) + grip;  // 驱动器倒带、退带期间先取新带
+            t += travel(load_slot, drive);
+            wait = std::max(0.0, move.drive_ready - t);
+            t += wait + 2 * grip;                     // 取出旧带、放入新带
+            plan.drive_done = t;
+            t += travel(drive, unload_slot) + grip;   // 旧带送回槽位
+            position_ = unload_slot;
+            ++stats_.exchanges;
+            break;
+        }
+    }
+
+    plan.robot_free = t;
+    free_at_ = t;
+    ++stats_.moves;
+    stats_.busy_seconds += t - start - wait;
+    stats_.wait_seconds += wait;
+    stats_.last_finish = std::max(stats_.last_finish, t);
+    if (move.type != MoveType::Unload) {
+        const double latency = plan.drive_done - move.load_requested;
+        ++stats_.mounts;
+        stats_.total_mount_latency += latency;
+        stats_.max_mount_latency = std::max(stats_.max_mount_latency, latency);
+    }
+    return plan;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+
+/**
+ * @brief 磁带库机械手（changer）调度器：把装卸带搬运看作一个串行资源来排队、合并和重排。
+ *
+ * 所有驱动器的 LOAD_TAPE/UNLOAD_TAPE 共用一个机械手。调度器记录机械手位置和空闲时刻，
+ * 由调用方在机械手空闲时调用 dispatch() 取出下一次搬运及其时间安排：
+ * - 合并：同一驱动器先卸后装的两次搬运合并为一次交换（Exchange）。机械手先去槽位取新磁带，
+ *   与驱动器倒带、退带并行，到达驱动器后取出旧带、放入新带，再把旧带送回槽位（假定双抓手）；
+ * - 重排：ShortestTravel 策略下优先执行机械手最快能完成第一次抓取的请求（考虑行程和驱动器何时退带完成），
+ *   等待超过 max_wait_seconds 的请求优先执行，避免饥饿；Fifo 策略按请求顺序执行；
+ * - 重叠：卸带和交换按驱动器预计的退带时间倒推出发时间，机械手不会提前到驱动器前空等，
+ *   驱动器倒带期间机械手可以先服务其他请求；
+ * - 统计：机械手忙碌时间和利用率，装载延迟（从请求到磁带放入驱动器）。
+ *
+ * 几何模型：槽位 s 位于 slot_base_position + s，驱动器 d 位于 drive_base_position + d * drive_spacing，
+ * 行程时间 = 距离 * seconds_per_position，每次抓取或放下耗时 grip_seconds。
+ * 每盘磁带有一个固定的归属槽位，第一次出现时按顺序分配，也可以用 setHomeSlot() 指定。
+ *
+ * 时间由调用方传入（秒），可以是仿真的虚拟时钟，也可以是真实时钟。
+ */
+class ChangerScheduler
+: NonCopyable
+{
+public:
+    /**
+     * @brief 调度策略。
+     */
+    enum class Policy : int {
+        Fifo = 1,            ///< 按请求顺序
+        ShortestTravel = 2   ///< 机械手最快能开始搬运的请求优先
+    };
+
+    /**
+     * @brief 搬运类型。
+     */
+    enum class MoveType : int {
+        Load = 1,       ///< 槽位 -> 驱动器
+        Unload = 2,     ///< 驱动器 -> 槽位
+        Exchange = 3    ///< 同一驱动器先卸后装
+    };
+
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        Policy policy = Policy::ShortestTravel;
+        bool pair_exchanges = true;             ///< 是否把同一驱动器的卸带和装带合并为交换
+        double seconds_per_position = 0.02;     ///< 每个位置单位的行程时间
+        double grip_seconds = 2.5;              ///< 一次抓取或放下的时间
+        double max_wait_seconds = 300.0;        ///< 请求等待超过该时间后优先执行
+        double drive_base_position = 0.0;       ///< 第一个驱动器的位置
+        double drive_spacing = 1.0;             ///< 相邻驱动器的间距
+        double slot_base_position = 10.0;       ///< 第一个槽位的位置
+    };
+
+    /**
+     * @brief 一次搬运请求。
+     */
+    struct Move {
+        uint64_t id = 0;            ///< 由 submit() 分配
+        MoveType type = MoveType::Load;
+        int drive_id = -1;
+        std::string load_tape;      ///< 要装入的磁带（Load/Exchange）
+        std::string unload_tape;    ///< 要取出的磁带（Unload/Exchange）
+        double requested = 0.0;     ///< 请求时间
+        double load_requested = 0.0; ///< 装带请求时间（用于装载延迟统计）
+        double drive_ready = 0.0;   ///< 驱动器退带完成的时间（Unload/Exchange），在此之前无法取出旧带
+    };
+
+    /**
+     * @brief 一次搬运的时间安排。
+     */
+    struct Plan {
+        Move move;
+        double start = 0.0;         ///< 机械手开始执行的时间
+        double drive_done = 0.0;    ///< 驱动器侧完成的时间（新带已放入或旧带已取出）
+        double robot_free = 0.0;    ///< 机械手空闲的时间
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t moves = 0;             ///< 执行的搬运数（交换计一次）
+        uint64_t exchanges = 0;         ///< 其中的交换数
+        double busy_seconds = 0.0;      ///< 机械手忙碌时间
+        double wait_seconds = 0.0;      ///< 机械手在驱动器前等待退带的时间
+        double first_request = -1.0;    ///< 第一个请求的时间
+        double last_finish = 0.0;       ///< 最后一次搬运完成的时间
+        uint64_t mounts = 0;            ///< 完成的装带数
+        double total_mount_latency = 0.0; ///< 装载延迟总和
+        double max_mount_latency = 0.0; ///< 最大装载延迟
+
+        /**
+         * @brief 机械手利用率：忙碌时间 / (最后完成时间 - 第一个请求时间)。
+         */
+        double utilization() const;
+    };
+
+    ChangerScheduler();
+    explicit ChangerScheduler(const Config& config);
+
+    const Config& config() const { return config_; }
+
+    /**
+     * @brief 提交一次搬运请求。开启合并时，若装带之前同一驱动器最后一个尚未执行的请求是卸带，两者合并为交换；
+     * 先装后卸不合并，按提交顺序分别执行。
+     *
+     * @param move 搬运请求，id 和 type（合并时）由调度器设置。
+     * @return uint64_t 请求 ID（合并后为原请求的 ID）。
+     */
+    uint64_t submit(const Move& move);
+
+    /**
+     * @brief 在机械手空闲后取出下一次搬运并计算时间安排，机械手开始时间为 max(now, robotFreeAt())。
+     *
+     * @param now 当前时间。
+     * @return std::optional<Plan> 没有待执行的请求时返回 std::nullopt。
+     */
+    std::optional<Plan> dispatch(double now);
+
+    /**
+     * @brief dispatch(now) 会让机械手开始执行的时间，没有待执行的请求时返回无穷大。
+     *
+     * @param now 当前时间。
+     */
+    double nextDispatchTime(double now) const;
+
+    /**
+     * @brief 占用机械手执行搬运以外的工作（如 INVENTORY 扫描），从 max(now, robotFreeAt()) 开始。
+     *
+     * @param now 当前时间。
+     * @param seconds 占用时长。
+     * @return double 完成时间。
+     */
+    double reserve(double now, double seconds);
+
+    /**
+     * @brief 待执行的请求数。
+     */
+    size_t pendingCount() const;
+
+    /**
+     * @brief 机械手空闲的时刻。
+     */
+    double robotFreeAt() const;
+
+    /**
+     * @brief 指定磁带的归属槽位。
+     */
+    void setHomeSlot(const std::string& tape_id, size_t slot);
+
+    /**
+     * @brief 磁带的归属槽位，未出现过的磁带会分配一个新槽位。
+     */
+    size_t homeSlot(const std::string& tape_id);
+
+    Stats stats() const;
+
+private:
+    double slotPosition(const std::string& tape_id) const;
+    double drivePosition(int drive_id) const;
+    double travel(double from, double to) const;
+
+    /**
+     * @brief 请求之前是否还有同一驱动器的其他请求（同一驱动器的搬运按提交顺序执行）。
+     */
+    bool blockedByEarlier(std::list<Move>::const_iterator move) const;
+
+    /**
+     * @brief 从当前位置出发，机械手完成第一次抓取所需的时间（调度代价）。
+     */
+    double pickupCost(const Move& move, double start) const;
+
+    /**
+     * @brief 机械手最早需要出发执行该请求的时间。
+     */
+    double eligibleAt(const Move& move) const;
+
+    /**
+     * @brief 计算搬运的时间安排并更新机械手位置。
+     */
+    Plan execute(const Move& move, double start);
+
+    const Config config_;
+    mutable MutexLock mutex_;
+    std::list<Move> pending_;                               ///< 待执行的请求（按提交顺序）
+    mutable std::unordered_map<std::string, size_t> home_slots_; ///< 磁带 ID -> 归属槽位（首次查询时分配）
+    mutable size_t next_slot_;                              ///< 下一个分配的槽位
+    uint64_t next_id_;                                      ///< 下一个请求 ID
+    double position_;                                       ///< 机械手位置
+    double free_at_;                                        ///< 机械手空闲时刻
+    Stats stats_;
+};
@@ -0,0 +1,222 @@
+#include "DrivePool.hpp"
+
+#include <algorithm>
+#include <limits>
+
+DrivePool::DrivePool(size_t drive_count)
+: background_share_(0.0)
+{
+    drives_.reserve(drive_count);
+    for (size_t i = 0; i < drive_count; ++i) {
+        drives_.push_back(std::make_unique<TapeDrive>(static_cast<int>(i)));
+    }
+}
+
+int DrivePool::schedule(const TapeDrivesOperation& op)
+{
+    if (op.isBackground() && !op.getTapeId().empty()) {
+        // 后台访问不代表用户热度，不计入 MountCache
+        int drive_id = chooseBackgroundDrive(op);
+        if (drive_id >= 0) {
+            drives_[drive_id]->submit(op);
+        }
+        return drive_id;
+    }
+    bool hit = false;
+    bool evicted = false;
+    int drive_id = chooseDrive(op, hit, evicted);
+    if (drive_id >= 0) {
+        drives_[drive_id]->submit(op);
+        if (!op.getTapeId().empty() && !TapeDrive::isMaintenance(op)) {
+            // 维护操作不代表用户访问，不计入磁带热度
+            mount_cache_.touch(op.getTapeId(), hit, evicted);
+        }
+    }
+    return drive_id;
+}
+
+size_t DrivePool::dispatchFrom(TapeDrivesQueue& queue)
+{
+    size_t dispatched = 0;
+    while (!queue.empty()) {
+        TapeDrivesOperation op = queue.pop_front();
+        if (schedule(op) < 0) {
+            // 没有在线驱动器，放回队头等待下次分派
+            queue.push_front(op);
+            break;
+        }
+        ++dispatched;
+    }
+    return dispatched;
+}
+
+int DrivePool::chooseDrive(const TapeDrivesOperation& op, bool& hit, bool& evicted) const
+{
+    // 规则优先级：0 = 已装载/已排队目标磁带，1 = 空驱动器，2 = 其他在线驱动器（交给替换策略）
+    const std::string& tape_id = op.getTapeId();
+    int best = -1;
+    int best_rank = std::numeric_limits<int>::max();
+    size_t best_load = std::numeric_limits<size_t>::max();
+    std::vector<MountCache::Candidate> victims;
+
+    for (const auto& drive : drives_) {
+        DriveState state = drive->getState();
+        if (state == DriveState::Offline) {
+            continue;
+        }
+        int rank = 2;
+        std::string mounted = drive->getMountedTape();
+        if (!tape_id.empty()) {
+            if (drive->holdsTape(tape_id)) {
+                rank = 0;
+            } else if (state == DriveState::Empty) {
+                rank = 1;
+            }
+        }
+        // 正在执行的维护操作会被抢占，不计入负载
+        size_t load = drive->pendingCount() + (state == DriveState::Busy && !drive->maintenanceRunning() ? 1 : 0);
+        if (rank == 2 && !tape_id.empty()) {
+            victims.push_back(MountCache::Candidate{drive->getDriveId(), mounted, load,
+                                                    drive->pendingForTape(mounted),
+                                                    drive->pendingReadsForTape(mounted)});
+        }
+        if (rank < best_rank || (rank == best_rank && load < best_load)) {
+            best = drive->getDriveId();
+            best_rank = rank;
+            best_load = load;
+        }
+    }
+
+    if (best_rank == 2 && !victims.empty()) {
+        best = mount_cache_.chooseVictim(victims);
+    }
+    hit = best_rank == 0;
+    evicted = best_rank == 2 && !drives_[best]->getMountedTape().empty();
+    return best;
+}
+
+int DrivePool::chooseBackgroundDrive(const TapeDrivesOperation& op) const
+{
+    const std::string& tape_id = op.getTapeId();
+    size_t holding = 0;
+    int same_tape = -1;
+    int least_background = -1;      // 已持有后台操作的驱动器中后台队列最短的
+    size_t least_background_count = std::numeric_limits<size_t>::max();
+    int best_free = -1;             // 未持有后台操作的驱动器中最合适的
+    int best_free_rank = std::numeric_limits<int>::max();
+    size_t best_free_load = std::numeric_limits<size_t>::max();
+
+    for (const auto& drive : drives_) {
+        DriveState state = drive->getState();
+        if (state == DriveState::Offline) {
+            continue;
+        }
+        if (drive->holdsTape(tape_id)) {
+            // 磁带已装载或已在某个队列中：只能由该驱动器执行，否则两个驱动器会争抢同一盘磁带
+            same_tape = drive->getDriveId();
+        }
+        const size_t background = drive->backgroundCount();
+        if (background > 0 || drive->backgroundRunning()) {
+            ++holding;
+            if (background < least_background_count) {
+                least_background = drive->getDriveId();
+                least_background_count = background;
+            }
+            continue;
+        }
+        // 依次优先：已装载该磁带、空驱动器、用户负载最小
+        const std::string mounted = drive->getMountedTape();
+        const int rank = mounted == tape_id ? 0 : (state == DriveState::Empty ? 1 : 2);
+        const size_t load = drive->pendingCount() + (state == DriveState::Busy ? 1 : 0);
+        if (rank < best_free_rank || (rank == best_free_rank && load < best_free_load)) {
+            best_free = drive->getDriveId();
+            best_free_rank = rank;
+            best_free_load = load;
+        }
+    }
+
+    if (same_tape >= 0) {
+        return same_tape;
+    }
+    if (best_free >= 0 && holding < backgroundDriveLimit()) {
+        return best_free;
+    }
+    return least_background >= 0 ? least_background : best_free;
+}
+
+void DrivePool::setBackgroundShare(double share)
+{
+    background_share_ = share;
+    for (auto& drive : drives_) {
+        drive->setBackgroundShare(share);
+    }
+}
+
+void DrivePool::setBackgroundSwapBytes(uint64_t bytes)
+{
+    for (auto& drive : drives_) {
+        drive->setBackgroundSwapBytes(bytes);
+    }
+}
+
+size_t DrivePool::backgroundDriveLimit() const
+{
+    size_t online = 0;
+    for (const auto& drive : drives_) {
+        online += drive->getState() != DriveState::Offline ? 1 : 0;
+    }
+    return std::max<size_t>(1, static_cast<size_t>(background_share_ * static_cast<double>(online)));
+}
+
+TapeDrive::BackgroundStats DrivePool::backgroundStats() const
+{
+    TapeDrive::BackgroundStats total;
+    for (const auto& drive : drives_) {
+        TapeDrive::BackgroundStats stats = drive->backgroundStats();
+        total.dispatched += stats.dispatched;
+        total.completed += stats.completed;
+        total.bytes += stats.bytes;
+        total.contended += stats.contended;
+        total.contended_bytes += stats.contended_bytes;
+        total.user_bytes += stats.user_bytes;
+    }
+    return total;
+}
+
+void DrivePool::setMaxWait(std::chrono::milliseconds max_wait)
+{
+    for (auto& drive : drives_) {
+        drive->setMaxWait(max_wait);
+    }
+}
+
+uint64_t DrivePool::mountCount() const
+{
+    uint64_t mounts = 0;
+    for (const auto& drive : drives_) {
+        mounts += drive->mountCount();
+    }
+    return mounts;
+}
+
+void DrivePool::setStreamBuffer(const StreamBuffer::Config& config)
+{
+    for (auto& drive : drives_) {
+        drive->streamBuffer().configure(config);
+    }
+}
+
+void DrivePool::setEvictionPolicy(MountCache::Policy policy)
+{
+    mount_cache_.setPolicy(policy);
+}
+
+std::vector<StreamBuffer::Metrics> DrivePool::streamMetrics() const
+{
+    std::vector<StreamBuffer::Metrics> metrics;
+    metrics.reserve(drives_.size());
+    for (const auto& drive : drives_) {
+        metrics.push_back(drive->streamBuffer().metrics());
+    }
+    return metrics;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "shared/mutex/NonCopyable.hpp"
+#include "MountCache.hpp"
+#include "TapeDrive.hpp"
+#include "TapeDrivesQueue.hpp"
+
+/**
+ * @brief 驱动器池及其调度器。
+ *
+ * TapeDrivesQueue 是所有磁带操作的统一入口，DrivePool 将其中的操作分派到各驱动器自己的队列。
+ * 分派时根据以下规则选择驱动器（依次比较，同等条件下选负载最小的）：
+ * 1. 已装载目标磁带的驱动器，或任一队列（用户、后台、维护）中已有该磁带操作的驱动器（操作会在同一次装载中执行，
+ *    同一盘磁带不会被两个驱动器同时请求装载）；
+ * 2. 未装载磁带的空驱动器（只需 LOAD_TAPE，无需先 UNLOAD_TAPE）；
+ * 3. 其余在线驱动器中由 MountCache 按替换策略选出的驱动器（默认 CostBased，保留热门磁带）。
+ * 与具体磁带无关的操作（如 INVENTORY）直接分派给负载最小的驱动器。Offline 驱动器不参与调度。
+ * 负载只计算用户操作：排队的维护操作（ROLL_TAPE）和正在执行、可被抢占的维护操作都不计入。
+ *
+ * 后台操作（TapeDrivesOperation::isBackground()）受驱动器份额预算限制：目标磁带已装载或已排队在某个驱动器时
+ * （见 TapeDrive::holdsTape()），后台操作必须排到该驱动器，即使这会超出下面的上限；否则持有后台操作的驱动器最多 max(1, floor(share × 在线驱动器数)) 个，达到上限后新的后台操作排到其中后台队列最短的驱动器。
+ * 在每个驱动器内，后台操作在有用户操作等待时按同一 share 与用户操作分配字节（见 TapeDrive）。
+ *
+ * 调度只会短暂获取各驱动器自己的锁读取状态，不存在覆盖所有驱动器的全局锁。
+ * 同一磁带的操作被集中到同一驱动器后，由 TapeDrive 按磁带分组批量执行，减少换带次数。
+ */
+class DrivePool
+: NonCopyable
+{
+public:
+    /**
+     * @brief 构造函数，创建指定数量的驱动器（编号从 0 开始）。
+     *
+     * @param drive_count 驱动器数量。
+     */
+    explicit DrivePool(size_t drive_count);
+
+    /**
+     * @brief 驱动器数量。
+     */
+    size_t size() const { return drives_.size(); }
+
+    /**
+     * @brief 按编号获取驱动器。
+     *
+     * @param drive_id 驱动器编号。
+     * @return TapeDrive& 驱动器引用。
+     */
+    TapeDrive& drive(size_t drive_id) { return *drives_.at(drive_id); }
+
+    /**
+     * @brief 选择驱动器并将操作加入其队列。
+     *
+     * @param op 磁带操作。
+     * @return int 选中的驱动器编号；没有在线驱动器时返回 -1。
+     */
+    int schedule(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 将全局队列中的所有操作分派到各驱动器。
+     *
+     * 没有在线驱动器时，剩余操作保留在全局队列中。
+     *
+     * @param queue 全局操作队列（通常为 TapeDrivesQueue::getInstance()）。
+     * @return size_t 分派的操作数。
+     */
+    size_t dispatchFrom(TapeDrivesQueue& queue);
+
+    /**
+     * @brief 设置所有驱动器的操作等待时长上限（见 TapeDrive::setMaxWait）。
+     *
+     * @param max_wait 等待时长上限。
+     */
+    void setMaxWait(std::chrono::milliseconds max_wait);
+
+    /**
+     * @brief 所有驱动器的装载次数之和。
+     */
+    uint64_t mountCount() const;
+
+    /**
+     * @brief 设置所有驱动器的流式缓冲区配置，只能在没有写带进行时调用。
+     *
+     * @param config 缓冲区配置。
+     */
+    void setStreamBuffer(const StreamBuffer::Config& config);
+
+    /**
+     * @brief 各驱动器流式缓冲区的指标，下标为驱动器编号。
+     */
+    std::vector<StreamBuffer::Metrics> streamMetrics() const;
+
+    /**
+     * @brief 设置需要换带时的替换策略。
+     *
+     * @param policy 替换策略。
+     */
+    void setEvictionPolicy(MountCache::Policy policy);
+
+    /**
+     * @brief 设置后台操作的驱动器份额（0 ~ 1，默认 0：只占一个驱动器且只使用空闲时间）。
+     *
+     * @param share 后台份额。
+     */
+    void setBackgroundShare(double share);
+
+    /**
+     * @brief 设置所有驱动器上一次后台换带折算计入份额的字节数（见 TapeDrive::setBackgroundSwapBytes）。
+     *
+     * @param bytes 每次换带折算的字节数。
+     */
+    void setBackgroundSwapBytes(uint64_t bytes);
+
+    /**
+     * @brief 持有后台操作的驱动器数上限。
+     */
+    size_t backgroundDriveLimit() const;
+
+    /**
+     * @brief 各驱动器的后台操作统计之和。
+     */
+    TapeDrive::BackgroundStats backgroundStats() const;
+
+    /**
+     * @brief 已装载磁带缓存（访问历史与命中统计）。
+     */
+    const MountCache& mountCache() const { return mount_cache_; }
+
+private:
+    /**
+     * @brief 按调度规则选择驱动器。
+     *
+     * @param hit 输出目标磁带是否已在所选驱动器中（或其队列中）。
+     * @param evicted 输出是否需要替换所选驱动器中的其他磁带。
+     * @return int 驱动器编号，没有在线驱动器时返回 -1。
+     */
+    int chooseDrive(const TapeDrivesOperation& op, bool& hit, bool& evicted) const;
+
+    /**
+     * @brief 按后台份额预算为后台操作选择驱动器。
+     *
+     * @return int 驱动器编号，没有在线驱动器时返回 -1。
+     */
+    int chooseBackgroundDrive(const TapeDrivesOperation& op) const;
+
+    std::vector<std::unique_ptr<TapeDrive>> drives_; ///< 所有驱动器
+    MountCache mount_cache_;                          ///< 已装载磁带缓存
+    double background_share_;                         ///< 后台操作的驱动器份额
+};
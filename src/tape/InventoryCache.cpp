@@ -0,0 +1,224 @@
+#include "InventoryCache.hpp"
+
+#include <algorithm>
+
+InventoryCache::InventoryCache(size_t frames, size_t slots_per_frame, size_t drives)
+: frames_(frames)
+, slots_per_frame_(slots_per_frame)
+, slots_(frames * slots_per_frame)
+, drives_(drives)
+, dirty_(frames, true)
+, dirty_count_(frames)
+{
+}
+
+TapeDrivesOperation InventoryCache::makeInventory(uint64_t frame)
+{
+    TapeDrivesOperation op(TypeOperation::INVENTORY);
+    // 0 保留给整库扫描：未设置位置的 INVENTORY 仍按整库处理
+    op.setPosition(frame == kFullScan ? 0 : frame + 1);
+    return op;
+}
+
+uint64_t InventoryCache::frameOf(const TapeDrivesOperation& op)
+{
+    const uint64_t position = op.getBlockPosition();
+    return position == 0 ? kFullScan : position - 1;
+}
+
+void InventoryCache::onLoad(const std::string& tape_id, size_t drive_id)
+{
+    MutexLockGuard autoLock(mutex_);
+    ++stats_.updates;
+    auto it = locations_.find(tape_id);
+    if (it == locations_.end() || it->second.in_drive) {
+        // 缓存认为磁带不在槽位中：它来自哪个 frame 未知，所有 frame 都可能不一致
+        ++stats_.conflicts;
+        if (it != locations_.end() && drives_[it->second.index] == tape_id) {
+            drives_[it->second.index].clear();
+        }
+        for (size_t frame = 0; frame < frames_; ++frame) {
+            markDirtyLocked(frame);
+        }
+    } else {
+        home_slots_[tape_id] = it->second.index;
+        clearSlotLocked(it->second.index);
+    }
+    if (!drives_.at(drive_id).empty() && drives_[drive_id] != tape_id) {
+        // 驱动器里原本记录着另一盘磁带
+        ++stats_.conflicts;
+        locations_.erase(drives_[drive_id]);
+    }
+    drives_[drive_id] = tape_id;
+    locations_[tape_id] = Location{true, drive_id};
+}
+
+void InventoryCache::onUnload(const std::string& tape_id, size_t drive_id, std::optional<size_t> slot)
+{
+    MutexLockGuard autoLock(mutex_);
+    ++stats_.updates;
+    if (drives_.at(drive_id) == tape_id) {
+        drives_[drive_id].clear();
+    } else {
+        ++stats_.conflicts;
+    }
+    if (!slot) {
+        auto home = home_slots_.find(tape_id);
+        if (home == home_slots_.end()) {
+            // 不知道放回了哪里
+            ++stats_.conflicts;
+            locations_.erase(tape_id);
+            for (size_t frame = 0; frame < frames_; ++frame) {
+                markDirtyLocked(frame);
+            }
+            return;
+        }
+        slot = home->second;
+    }
+    if (!slots_.at(*slot).empty() && slots_[*slot] != tape_id) {
+        ++stats_.conflicts;
+        locations_.erase(slots_[*slot]);
+        markDirtyLocked(frameOfSlot(*slot));
+    }
+    placeInSlotLocked(tape_id, *slot);
+}
+
+void InventoryCache::onDoorOpened(uint64_t frame)
+{
+    MutexLockGuard autoLock(mutex_);
+    if (frame == kFullScan) {
+        for (size_t i = 0; i < frames_; ++i) {
+            markDirtyLocked(i);
+        }
+    } else if (frame < frames_) {
+        markDirtyLocked(frame);
+    }
+}
+
+std::vector<TapeDrivesOperation> InventoryCache::planInventory()
+{
+    MutexLockGuard autoLock(mutex_);
+    std::vector<TapeDrivesOperation> ops;
+    if (dirty_count_ == 0) {
+        ++stats_.scans_skipped;
+    } else if (dirty_count_ == frames_) {
+        ops.push_back(makeInventory(kFullScan));
+        ++stats_.full_scans;
+    } else {
+        for (size_t frame = 0; frame < frames_; ++frame) {
+            if (dirty_[frame]) {
+                ops.push_back(makeInventory(frame));
+                ++stats_.frame_scans;
+            }
+        }
+    }
+    return ops;
+}
+
+void InventoryCache::applyScan(size_t frame, const std::vector<std::pair<size_t, std::string>>& contents)
+{
+    MutexLockGuard autoLock(mutex_);
+    const size_t first = frame * slots_per_frame_;
+    for (size_t slot = first; slot < first + slots_per_frame_; ++slot) {
+        clearSlotLocked(slot);
+    }
+    for (const auto& entry : contents) {
+        if (frameOfSlot(entry.first) == frame) {
+            placeInSlotLocked(entry.second, entry.first);
+        }
+    }
+    if (dirty_.at(frame)) {
+        dirty_[frame] = false;
+        --dirty_count_;
+    }
+}
+
+void InventoryCache::applyFullScan(const std::vector<std::pair<size_t, std::string>>& slots,
+                                   const std::vector<std::pair<size_t, std::string>>& drives)
+{
+    MutexLockGuard autoLock(mutex_);
+    std::fill(slots_.begin(), slots_.end(), std::string());
+    std::fill(drives_.begin(), drives_.end(), std::string());
+    locations_.clear();
+    for (const auto& entry : slots) {
+        placeInSlotLocked(entry.second, entry.first);
+    }
+    for (const auto& entry : drives) {
+        drives_.at(entry.first) = entry.second;
+        locations_[entry.second] = Location{true, entry.first};
+    }
+    std::fill(dirty_.begin(), dirty_.end(), false);
+    dirty_count_ = 0;
+}
+
+std::optional<InventoryCache::Location> InventoryCache::locate(const std::string& tape_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = locations_.find(tape_id);
+    if (it == locations_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::string InventoryCache::slotContents(size_t slot) const
+{
+    MutexLockGuard autoLock(mutex_);
+    return slots_.at(slot);
+}
+
+std::string InventoryCache::driveContents(size_t drive_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    return drives_.at(drive_id);
+}
+
+bool InventoryCache::isDirty(size_t frame) const
+{
+    MutexLockGuard autoLock(mutex_);
+    return dirty_.at(frame);
+}
+
+size_t InventoryCache::dirtyFrameCount() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return dirty_count_;
+}
+
+InventoryCache::Stats InventoryCache::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return stats_;
+}
+
+void InventoryCache::markDirtyLocked(size_t frame)
+{
+    if (!dirty_[frame]) {
+        dirty_[frame] = true;
+        ++dirty_count_;
+    }
+}
+
+void InventoryCache::clearSlotLocked(size_t slot)
+{
+    std::string& tape_id = slots_.at(slot);
+    if (!tape_id.empty()) {
+        auto it = locations_.find(tape_id);
+        if (it != locations_.end() && !it->second.in_drive && it->second.index == slot) {
+            locations_.erase(it);
+        }
+        tape_id.clear();
+    }
+}
+
+void InventoryCache::placeInSlotLocked(const std::string& tape_id, size_t slot)
+{
+    // 磁带原来记录在其他槽位：清掉旧记录
+    auto it = locations_.find(tape_id);
+    if (it != locations_.end() && !it->second.in_drive && it->second.index != slot) {
+        slots_[it->second.index].clear();
+    }
+    slots_.at(slot) = tape_id;
+    locations_[tape_id] = Location{false, slot};
+    home_slots_[tape_id] = slot;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "TapeDrivesOperation.hpp"
+
+/**
+ * @brief 磁带库库存缓存：在内存中维护槽位 -> 磁带、驱动器 -> 磁带的映射，避免频繁整库扫描。
+ *
+ * 整库 INVENTORY 需要机械手逐个扫描所有槽位，大型磁带库上会长时间占用机械手。InventoryCache 的做法：
+ * - 由 LOAD_TAPE/UNLOAD_TAPE 的结果增量更新映射（onLoad()/onUnload()）；
+ * - 以 frame（机柜）为单位跟踪“脏”状态：映射与实际可能不一致的 frame 才需要重新扫描，
+ *   例如装卸带结果与缓存矛盾、某个 frame 的柜门被打开过；
+ * - planInventory() 只为脏 frame 生成按 frame 的增量 INVENTORY，全部 frame 都脏
+ *   （启动时或整库柜门打开后）才生成一次整库扫描；
+ * - 扫描结果通过 applyScan() 写回，对应 frame 变为干净。
+ *
+ * 按 frame 的 INVENTORY 复用操作的 block_position 字段保存 frame 编号加 1（见 makeInventory()/frameOf()），
+ * 0 表示整库扫描，因此未设置位置的 INVENTORY 仍是整库扫描。
+ */
+class InventoryCache
+: NonCopyable
+{
+public:
+    static constexpr uint64_t kFullScan = UINT64_MAX;
+
+    /**
+     * @brief 磁带的位置。
+     */
+    struct Location {
+        bool in_drive;      ///< true 表示在驱动器中，false 表示在槽位中
+        size_t index;       ///< 驱动器编号或槽位编号
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t full_scans = 0;        ///< 规划的整库扫描次数
+        uint64_t frame_scans = 0;       ///< 规划的按 frame 扫描次数
+        uint64_t scans_skipped = 0;     ///< 库存干净、无需扫描的规划次数
+        uint64_t updates = 0;           ///< 装卸带增量更新次数
+        uint64_t conflicts = 0;         ///< 装卸带结果与缓存矛盾、导致 frame 变脏的次数
+    };
+
+    /**
+     * @brief 构造函数，初始时所有 frame 都是脏的（需要一次整库扫描）。
+     *
+     * @param frames frame 数量。
+     * @param slots_per_frame 每个 frame 的槽位数，槽位 s 属于 frame s / slots_per_frame。
+     * @param drives 驱动器数量。
+     */
+    InventoryCache(size_t frames, size_t slots_per_frame, size_t drives);
+
+    /**
+     * @brief 生成扫描指定 frame 的 INVENTORY 操作。
+     *
+     * @param frame frame 编号，kFullScan 表示整库扫描。
+     */
+    static TapeDrivesOperation makeInventory(uint64_t frame);
+
+    /**
+     * @brief INVENTORY 操作扫描的 frame，整库扫描返回 kFullScan。
+     */
+    static uint64_t frameOf(const TapeDrivesOperation& op);
+
+    size_t frameCount() const { return frames_; }
+    size_t slotCount() const { return frames_ * slots_per_frame_; }
+    size_t frameOfSlot(size_t slot) const { return slot / slots_per_frame_; }
+
+    /**
+     * @brief 磁带已从槽位装入驱动器。
+     *
+     * @param tape_id 磁带 ID。
+     * @param drive_id 驱动器编号。
+     */
+    void onLoad(const std::string& tape_id, size_t drive_id);
+
+    /**
+     * @brief 磁带已从驱动器卸下并放回槽位。
+     *
+     * @param tape_id 磁带 ID。
+     * @param drive_id 驱动器编号。
+     * @param slot 放回的槽位，缺省时放回装带前所在的槽位。
+     */
+    void onUnload(const std::string& tape_id, size_t drive_id, std::optional<size_t> slot = std::nullopt);
+
+    /**
+     * @brief 柜门被打开过（人工放入、取出磁带），对应 frame 的内容不再可信。
+     *
+     * @param frame frame 编号，kFullScan 表示整库。
+     */
+    void onDoorOpened(uint64_t frame = kFullScan);
+
+    /**
+     * @brief 规划需要执行的 INVENTORY：没有脏 frame 时为空，全部 frame 都脏时为一次整库扫描，否则每个脏 frame 一个。
+     */
+    std::vector<TapeDrivesOperation> planInventory();
+
+    /**
+     * @brief 写回一个 frame 的扫描结果，该 frame 变为干净。
+     *
+     * @param frame frame 编号。
+     * @param contents 该 frame 中有磁带的槽位及其磁带 ID。
+     */
+    void applyScan(size_t frame, const std::vector<std::pair<size_t, std::string>>& contents);
+
+    /**
+     * @brief 写回整库扫描结果，所有 frame 变为干净。
+     *
+     * @param slots 有磁带的槽位及其磁带 ID。
+     * @param drives 有磁带的驱动器及其磁带 ID。
+     */
+    void applyFullScan(const std::vector<std::pair<size_t, std::string>>& slots,
+                       const std::vector<std::pair<size_t, std::string>>& drives);
+
+    /**
+     * @brief 查找磁带的位置，未知时返回 std::nullopt。
+     */
+    std::optional<Location> locate(const std::string& tape_id) const;
+
+    /**
+     * @brief 槽位中的磁带，空槽位返回空字符串。
+     */
+    std::string slotContents(size_t slot) const;
+
+    /**
+     * @brief 驱动器中的磁带，空驱动器返回空字符串。
+     */
+    std::string driveContents(size_t drive_id) const;
+
+    bool isDirty(size_t frame) const;
+    size_t dirtyFrameCount() const;
+
+    Stats stats() const;
+
+private:
+    void markDirtyLocked(size_t frame);
+    void clearSlotLocked(size_t slot);
+    void placeInSlotLocked(const std::string& tape_id, size_t slot);
+
+    const size_t frames_;
+    const size_t slots_per_frame_;
+    mutable MutexLock mutex_;
+    std::vector<std::string> slots_;                        ///< 槽位 -> 磁带 ID
+    std::vector<std::string> drives_;                       ///< 驱动器 -> 磁带 ID
+    std::unordered_map<std::string, Location> locations_;   ///< 磁带 ID -> 位置
+    std::unordered_map<std::string, size_t> home_slots_;    ///< 磁带 ID -> 装带前所在的槽位
+    std::vector<bool> dirty_;                               ///< frame 是否需要重新扫描
+    size_t dirty_count_;
+    Stats stats_;
+};
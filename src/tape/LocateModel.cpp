@@ -0,0 +1,120 @@
+#include "LocateModel.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+    constexpr size_t kMaxGreedyBatch = 2048;
+
+}
+
+LocateModel::LocateModel()
+: config_()
+{
+
+}
+
+LocateModel::LocateModel(const Config& config)
+: config_(config)
+{
+
+}
+
+LocateModel::Position LocateModel::positionOf(const TapeDrivesOperation& op) const
+{
+    return positionOf(op.getBlockPosition(), op.getWrap());
+}
+
+LocateModel::Position LocateModel::positionOf(uint64_t block_position, int wrap) const
+{
+    const uint64_t bpw = config_.blocks_per_wrap;
+    uint32_t w = wrap >= 0 ? static_cast<uint32_t>(wrap) : static_cast<uint32_t>(block_position / bpw);
+    uint64_t offset = block_position % bpw;
+    return Position{w, (w % 2 == 0) ? offset : bpw - 1 - offset};
+}
+
+double LocateModel::locateSeconds(const Position& from, const Position& to) const
+{
+    uint64_t distance = from.lpos > to.lpos ? from.lpos - to.lpos : to.lpos - from.lpos;
+    double seconds = static_cast<double>(distance) / static_cast<double>(config_.blocks_per_wrap) *
+                     config_.full_length_seconds;
+    if (from.wrap != to.wrap) {
+        seconds += config_.wrap_change_seconds;
+    }
+    return seconds;
+}
+
+double LocateModel::totalSeconds(const Position& head, const std::vector<TapeDrivesOperation>& ops) const
+{
+    double total = 0.0;
+    Position current = head;
+    for (const auto& op : ops) {
+        Position next = positionOf(op);
+        total += locateSeconds(current, next);
+        current = next;
+    }
+    return total;
+}
+
+double LocateModel::order(const Position& head, std::vector<TapeDrivesOperation>& ops) const
+{
+    if (ops.size() < 2) {
+        return totalSeconds(head, ops);
+    }
+
+    // 电梯顺序：纵向位置不小于磁头的部分升序，其余部分降序
+    std::vector<TapeDrivesOperation> scan(ops);
+    auto lposLess = [this](const TapeDrivesOperation& a, const TapeDrivesOperation& b) {
+        Position pa = positionOf(a);
+        Position pb = positionOf(b);
+        return pa.lpos != pb.lpos ? pa.lpos < pb.lpos : pa.wrap < pb.wrap;
+    };
+    auto ahead = std::partition(scan.begin(), scan.end(), [this, &head](const TapeDrivesOperation& op) {
+        return positionOf(op).lpos >= head.lpos;
+    });
+    std::sort(scan.begin(), ahead, lposLess);
+    std::sort(ahead, scan.end(), [&lposLess](const TapeDrivesOperation& a, const TapeDrivesOperation& b) {
+        return lposLess(b, a);
+    });
+    double best = totalSeconds(head, scan);
+    std::vector<TapeDrivesOperation>* chosen = &scan;
+
+    // 贪心最近邻顺序
+    std::vector<TapeDrivesOperation> greedy;
+    if (ops.size() <= kMaxGreedyBatch) {
+        std::vector<Position> positions;
+        positions.reserve(ops.size());
+        for (const auto& op : ops) {
+            positions.push_back(positionOf(op));
+        }
+        std::vector<bool> used(ops.size(), false);
+        greedy.reserve(ops.size());
+        Position current = head;
+        double total = 0.0;
+        for (size_t n = 0; n < ops.size(); ++n) {
+            size_t pick = 0;
+            double pick_cost = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < ops.size(); ++i) {
+                if (!used[i]) {
+                    double cost = locateSeconds(current, positions[i]);
+                    if (cost < pick_cost) {
+                        pick = i;
+                        pick_cost = cost;
+                    }
+                }
+            }
+            used[pick] = true;
+            total += pick_cost;
+            current = positions[pick];
+            greedy.push_back(ops[pick]);
+        }
+        if (total < best) {
+            best = total;
+            chosen = &greedy;
+        }
+    }
+
+    ops.swap(*chosen);
+    return best;
+}
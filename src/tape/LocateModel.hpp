@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "TapeDrivesOperation.hpp"
+
+/**
+ * @brief 蛇形（serpentine）磁带的定位时间模型与召回排序。
+ *
+ * LTO 等磁带按 wrap 来回记录：偶数 wrap 从 BOT 走向 EOT，奇数 wrap 从 EOT 走回 BOT，
+ * 逻辑块号沿这条蛇形路径单调递增。因此逻辑块号相邻不代表物理位置相邻，
+ * 定位时间主要取决于纵向（沿带长方向）距离，换 wrap 只需要少量的磁头移动时间。
+ *
+ * 模型：
+ * - wrap = 块号 / blocks_per_wrap（操作自带 wrap 信息时以其为准）；
+ * - 纵向位置 lpos：偶数 wrap 为 块号 % blocks_per_wrap，奇数 wrap 为 blocks_per_wrap - 1 - 块号 % blocks_per_wrap；
+ * - 定位时间 = |Δlpos| / blocks_per_wrap * full_length_seconds + (wrap 不同 ? wrap_change_seconds : 0)。
+ */
+class LocateModel {
+public:
+    /**
+     * @brief 模型参数（默认值接近 LTO-8）。
+     */
+    struct Config {
+        uint32_t wraps = 208;                   ///< wrap 数量
+        uint64_t blocks_per_wrap = 180000;      ///< 每个 wrap 的逻辑块数
+        double full_length_seconds = 50.0;      ///< 从 BOT 定位到 EOT 的时间
+        double wrap_change_seconds = 2.0;       ///< 切换 wrap 的额外时间
+    };
+
+    /**
+     * @brief 磁头位置。
+     */
+    struct Position {
+        uint32_t wrap;
+        uint64_t lpos;   ///< 纵向位置（0 为 BOT）
+    };
+
+    LocateModel();
+    explicit LocateModel(const Config& config);
+
+    const Config& config() const { return config_; }
+
+    /**
+     * @brief 将操作的逻辑位置换算为物理位置。
+     */
+    Position positionOf(const TapeDrivesOperation& op) const;
+
+    /**
+     * @brief 将逻辑块号（及可选的 wrap）换算为物理位置。
+     *
+     * @param block_position 逻辑块号。
+     * @param wrap wrap 编号，-1 表示按块号推算。
+     */
+    Position positionOf(uint64_t block_position, int wrap = -1) const;
+
+    /**
+     * @brief 估算两个位置之间的定位时间（秒）。
+     */
+    double locateSeconds(const Position& from, const Position& to) const;
+
+    /**
+     * @brief 对一批 READ_AGGR 操作排序，使从 head 出发的总定位时间尽量小。
+     *
+     * 分别计算两种候选顺序，取估算总时间较小者：
+     * - 电梯（SCAN）顺序：沿纵向先正向扫过 head 之后的操作，再反向扫回；
+     * - 贪心顺序：每次选择离当前位置定位时间最短的操作（批次超过 2048 个时跳过，避免 O(n²) 开销）。
+     *
+     * @param head 当前磁头位置。
+     * @param ops 待排序的操作，原地排序。
+     * @return double 排序后的估算总定位时间（秒）。
+     */
+    double order(const Position& head, std::vector<TapeDrivesOperation>& ops) const;
+
+    /**
+     * @brief 估算按给定顺序执行的总定位时间（秒）。
+     */
+    double totalSeconds(const Position& head, const std::vector<TapeDrivesOperation>& ops) const;
+
+private:
+    Config config_;
+};
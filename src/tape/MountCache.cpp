@@ -0,0 +1,106 @@
+#include "MountCache.hpp"
+
+#include <cmath>
+#include <tuple>
+
+MountCache::MountCache(Policy policy, std::chrono::milliseconds half_life)
+: policy_(policy)
+, half_life_seconds_(std::chrono::duration<double>(half_life).count())
+{
+}
+
+void MountCache::setPolicy(Policy policy)
+{
+    MutexLockGuard autoLock(mutex_);
+    policy_ = policy;
+}
+
+MountCache::Policy MountCache::policy() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return policy_;
+}
+
+void MountCache::touch(const std::string& tape_id, bool hit, bool evicted)
+{
+    MutexLockGuard autoLock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    double heat = heatLocked(tape_id, now);
+    Usage& usage = usage_[tape_id];
+    usage.heat = heat + 1.0;
+    usage.last_used = now;
+    if (hit) {
+        ++stats_.hits;
+    } else {
+        ++stats_.misses;
+        if (evicted) {
+            ++stats_.evictions;
+        }
+    }
+}
+
+int MountCache::chooseVictim(const std::vector<Candidate>& candidates) const
+{
+    MutexLockGuard autoLock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    const Candidate* best = nullptr;
+    // 各策略的比较键，越小越适合被替换
+    std::tuple<double, double, double> best_key;
+
+    for (const auto& candidate : candidates) {
+        double idle = 0.0; // 已装载磁带距上次访问的时间，越大越适合被替换
+        auto it = usage_.find(candidate.mounted_tape);
+        if (!candidate.mounted_tape.empty() && it != usage_.end()) {
+            idle = std::chrono::duration<double>(now - it->second.last_used).count();
+        } else {
+            idle = HUGE_VAL;
+        }
+        const double load = static_cast<double>(candidate.load);
+        std::tuple<double, double, double> key;
+        switch (policy_) {
+            case Policy::LeastLoaded:
+                key = std::make_tuple(load, 0.0, 0.0);
+                break;
+            case Policy::Lru:
+                key = std::make_tuple(-idle, load, 0.0);
+                break;
+            case Policy::PendingWork:
+                key = std::make_tuple(candidate.pending_for_mounted > 0 ? 1.0 : 0.0, load, -idle);
+                break;
+            case Policy::CostBased:
+                key = std::make_tuple(static_cast<double>(candidate.reads_for_mounted) +
+                                      heatLocked(candidate.mounted_tape, now), load, -idle);
+                break;
+        }
+        if (!best || key < best_key) {
+            best = &candidate;
+            best_key = key;
+        }
+    }
+    return best ? best->drive_id : -1;
+}
+
+double MountCache::heat(const std::string& tape_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    return heatLocked(tape_id, std::chrono::steady_clock::now());
+}
+
+MountCache::Stats MountCache::stats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return stats_;
+}
+
+double MountCache::heatLocked(const std::string& tape_id, std::chrono::steady_clock::time_point now) const
+{
+    auto it = usage_.find(tape_id);
+    if (it == usage_.end()) {
+        return 0.0;
+    }
+    if (half_life_seconds_ <= 0.0) {
+        return it->second.heat;
+    }
+    const double elapsed = std::chrono::duration<double>(now - it->second.last_used).count();
+    return it->second.heat * std::exp2(-elapsed / half_life_seconds_);
+}
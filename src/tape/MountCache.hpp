@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+
+/**
+ * @brief 已装载磁带缓存：把驱动器看作磁带的缓存，决定新的装载需求应替换哪个驱动器中的磁带。
+ *
+ * 驱动器中装载的是哪盘磁带以 TapeDrive 的状态为准，MountCache 记录每盘磁带的访问历史，
+ * 并在需要换带时按策略从候选驱动器中选出“牺牲者”：
+ * - LeastLoaded：队列最短的驱动器（不考虑已装载的磁带）；
+ * - Lru：已装载磁带最久未被访问的驱动器；
+ * - PendingWork：优先选已装载磁带没有待执行操作的驱动器，其次队列最短，再次最久未访问；
+ * - CostBased：替换代价最小的驱动器，代价 = 已装载磁带排队的 READ_AGGR 数 + 该磁带的访问热度
+ *   （按 half_life 指数衰减的访问次数），代价相同时选队列最短的。
+ *
+ * 热门磁带因此更可能留在驱动器中，减少装载次数。
+ */
+class MountCache
+: NonCopyable
+{
+public:
+    /**
+     * @brief 替换策略。
+     */
+    enum class Policy : int {
+        LeastLoaded = 1,
+        Lru = 2,
+        PendingWork = 3,
+        CostBased = 4
+    };
+
+    /**
+     * @brief 候选驱动器的信息，由 DrivePool 从各驱动器读取。
+     */
+    struct Candidate {
+        int drive_id;
+        std::string mounted_tape;       ///< 已装载（或将要装载）的磁带，为空表示没有
+        size_t load;                    ///< 队列长度（含正在执行的操作）
+        size_t pending_for_mounted;     ///< 已装载磁带的待执行操作数
+        size_t reads_for_mounted;       ///< 已装载磁带排队的 READ_AGGR 数
+    };
+
+    /**
+     * @brief 统计信息。
+     */
+    struct Stats {
+        uint64_t hits = 0;              ///< 操作分派到已装载/已排队目标磁带的驱动器
+        uint64_t misses = 0;            ///< 需要新装载
+        uint64_t evictions = 0;         ///< 新装载替换了其他磁带
+    };
+
+    explicit MountCache(Policy policy = Policy::CostBased,
+                        std::chrono::milliseconds half_life = std::chrono::minutes(10));
+
+    void setPolicy(Policy policy);
+    Policy policy() const;
+
+    /**
+     * @brief 记录一次对磁带的访问（分派了一个针对该磁带的操作）。
+     *
+     * @param tape_id 磁带 ID。
+     * @param hit 目标磁带是否已在某个驱动器中（或已在其队列中）。
+     * @param evicted 未命中时是否替换了其他磁带。
+     */
+    void touch(const std::string& tape_id, bool hit, bool evicted);
+
+    /**
+     * @brief 按策略从候选驱动器中选择要替换的驱动器。
+     *
+     * @param candidates 候选驱动器，不能为空。
+     * @return int 选中的驱动器编号。
+     */
+    int chooseVictim(const std::vector<Candidate>& candidates) const;
+
+    /**
+     * @brief 磁带当前的访问热度。
+     */
+    double heat(const std::string& tape_id) const;
+
+    Stats stats() const;
+
+private:
+    /**
+     * @brief 磁带的访问历史。
+     */
+    struct Usage {
+        std::chrono::steady_clock::time_point last_used;
+        double heat = 0.0;
+    };
+
+    /**
+     * @brief 在持锁状态下计算衰减到 now 的热度。
+     */
+    double heatLocked(const std::string& tape_id, std::chrono::steady_clock::time_point now) const;
+
+    mutable MutexLock mutex_;
+    Policy policy_;
+    const double half_life_seconds_;
+    std::unordered_map<std::string, Usage> usage_; ///< 磁带 ID -> 访问历史
+    Stats stats_;
+};
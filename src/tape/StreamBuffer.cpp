@@ -0,0 +1,213 @@
+#include "StreamBuffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
+
+StreamBuffer::StreamBuffer()
+: StreamBuffer(Config())
+{
+}
+
+StreamBuffer::StreamBuffer(const Config& config)
+: config_(config)
+, not_full_(mutex_)
+, filled_(mutex_)
+, head_(0)
+, fill_(0)
+, closed_(false)
+, waiting_for_(0)
+, stalled_(false)
+{
+    metrics_.capacity = config.capacity;
+}
+
+void StreamBuffer::configure(const Config& config)
+{
+    MutexLockGuard autoLock(mutex_);
+    config_ = config;
+    std::vector<uint8_t>().swap(buffer_);
+    head_ = 0;
+    fill_ = 0;
+    stalled_ = false;
+    metrics_.capacity = config.capacity;
+}
+
+void StreamBuffer::reset()
+{
+    MutexLockGuard autoLock(mutex_);
+    head_ = 0;
+    fill_ = 0;
+    closed_ = false;
+    stalled_ = false;
+    not_full_.notifyAll();
+}
+
+size_t StreamBuffer::write(const uint8_t* data, size_t length)
+{
+    MutexLockGuard autoLock(mutex_);
+    size_t written = 0;
+    while (written < length && !closed_ && config_.capacity > 0) {
+        if (fill_ == config_.capacity) {
+            auto start = std::chrono::steady_clock::now();
+            not_full_.wait();
+            metrics_.producer_wait_seconds += secondsSince(start);
+            continue;
+        }
+        written += writeLocked(data + written, length - written);
+    }
+    return written;
+}
+
+size_t StreamBuffer::tryWrite(const uint8_t* data, size_t length)
+{
+    MutexLockGuard autoLock(mutex_);
+    return closed_ ? 0 : writeLocked(data, length);
+}
+
+size_t StreamBuffer::writeLocked(const uint8_t* data, size_t length)
+{
+    if (buffer_.size() != config_.capacity) {
+        buffer_.resize(config_.capacity);
+    }
+    const size_t capacity = buffer_.size();
+    size_t written = 0;
+    while (written < length && fill_ < capacity) {
+        // 写入位置之后到缓冲区末尾的连续空间
+        const size_t tail = (head_ + fill_) % capacity;
+        const size_t chunk = std::min({length - written, capacity - fill_, capacity - tail});
+        memcpy(buffer_.data() + tail, data + written, chunk);
+        written += chunk;
+        fill_ += chunk;
+    }
+    metrics_.bytes_in += written;
+    metrics_.peak_fill = std::max(metrics_.peak_fill, fill_);
+    if (waiting_for_ != 0 && fill_ >= waiting_for_) {
+        filled_.notify();
+    }
+    return written;
+}
+
+void StreamBuffer::close()
+{
+    MutexLockGuard autoLock(mutex_);
+    closed_ = true;
+    filled_.notifyAll();
+    not_full_.notifyAll();
+}
+
+bool StreamBuffer::waitToStart()
+{
+    MutexLockGuard autoLock(mutex_);
+    waitForFillLocked(thresholdBytes(config_.start_fill));
+    if (fill_ == 0) {
+        return false;
+    }
+    ++metrics_.starts;
+    return true;
+}
+
+bool StreamBuffer::tryStart()
+{
+    MutexLockGuard autoLock(mutex_);
+    if (fill_ == 0 || (fill_ < std::max<size_t>(thresholdBytes(config_.start_fill), 1) && !closed_)) {
+        return false;
+    }
+    ++metrics_.starts;
+    return true;
+}
+
+size_t StreamBuffer::read(uint8_t* out, size_t max_length)
+{
+    MutexLockGuard autoLock(mutex_);
+    if (fill_ == 0 && !closed_) {
+        // 欠载：驱动器停带，等缓冲区重新填充到 resume_fill 再起步
+        ++metrics_.underruns;
+        waitForFillLocked(thresholdBytes(config_.resume_fill));
+    }
+    return readLocked(out, max_length);
+}
+
+size_t StreamBuffer::tryRead(uint8_t* out, size_t max_length)
+{
+    MutexLockGuard autoLock(mutex_);
+    if (stalled_) {
+        if (fill_ < std::max<size_t>(thresholdBytes(config_.resume_fill), 1) && !closed_) {
+            return 0;
+        }
+        stalled_ = false;
+    }
+    if (fill_ == 0 && !closed_) {
+        ++metrics_.underruns;
+        stalled_ = true;
+        return 0;
+    }
+    return readLocked(out, max_length);
+}
+
+size_t StreamBuffer::readLocked(uint8_t* out, size_t max_length)
+{
+    const size_t capacity = buffer_.size();
+    size_t copied = 0;
+    while (copied < max_length && fill_ > 0) {
+        const size_t chunk = std::min({max_length - copied, fill_, capacity - head_});
+        memcpy(out + copied, buffer_.data() + head_, chunk);
+        head_ = (head_ + chunk) % capacity;
+        fill_ -= chunk;
+        copied += chunk;
+    }
+    metrics_.bytes_out += copied;
+    if (copied > 0) {
+        not_full_.notify();
+    }
+    return copied;
+}
+
+StreamBuffer::Config StreamBuffer::config() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return config_;
+}
+
+double StreamBuffer::fillRatio() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return config_.capacity == 0 ? 0.0 : static_cast<double>(fill_) / static_cast<double>(config_.capacity);
+}
+
+StreamBuffer::Metrics StreamBuffer::metrics() const
+{
+    MutexLockGuard autoLock(mutex_);
+    Metrics metrics = metrics_;
+    metrics.fill = fill_;
+    return metrics;
+}
+
+void StreamBuffer::waitForFillLocked(size_t threshold)
+{
+    threshold = std::max<size_t>(threshold, 1);
+    if (fill_ >= threshold || closed_) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    waiting_for_ = threshold;
+    while (fill_ < threshold && !closed_) {
+        filled_.wait();
+    }
+    waiting_for_ = 0;
+    metrics_.consumer_wait_seconds += secondsSince(start);
+}
+
+size_t StreamBuffer::thresholdBytes(double ratio) const
+{
+    ratio = std::min(std::max(ratio, 0.0), 1.0);
+    return static_cast<size_t>(static_cast<double>(config_.capacity) * ratio);
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/Condition.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+
+/**
+ * @brief 驱动器写入路径上的流式环形缓冲区，防止磁带“擦鞋”（shoe-shining）。
+ *
+ * 数据源（暂存盘）跟不上驱动器的流式速度时，驱动器会停带、倒回、重新起步，吞吐急剧下降。
+ * StreamBuffer 位于暂存盘与驱动器写入之间：生产者（暂存读取线程）调用 write() 填充，
+ * 消费者（驱动器写线程）在 waitToStart() 返回后才开始 WRITE_AGGR，然后用 read() 取数据写带。
+ *
+ * - waitToStart()：等待缓冲区填充到 start_fill（占容量的比例），或生产者已 close()（剩余数据都已在缓冲区中）；
+ * - read()：缓冲区读空而生产者尚未结束时记一次欠载（underrun），并等待重新填充到 resume_fill 后再继续，
+ *   避免驱动器以很小的数据量反复起停；
+ * - write()：缓冲区满时阻塞，形成背压。
+ *
+ * 缓冲区在第一次 write() 时才分配，不写带的驱动器不占用内存。每个 WRITE_AGGR 开始前调用 reset()。
+ *
+ * 在单线程、虚拟时钟上驱动生产者和消费者的调用方（如 SimTapeLibrary）不能阻塞，改用 tryWrite()、tryStart()
+ * 和 tryRead()：语义与上面三个函数相同（包括开始、欠载和恢复的阈值及指标），只是条件不满足时立即返回。
+ */
+class StreamBuffer
+: NonCopyable
+{
+public:
+    /**
+     * @brief 配置项。
+     */
+    struct Config {
+        size_t capacity = 1ULL << 30;   ///< 缓冲区容量（字节）
+        double start_fill = 0.5;        ///< 开始写带所需的填充比例
+        double resume_fill = 0.25;      ///< 欠载后恢复写带所需的填充比例
+    };
+
+    /**
+     * @brief 缓冲区指标。
+     */
+    struct Metrics {
+        size_t capacity = 0;            ///< 容量（字节）
+        size_t fill = 0;                ///< 当前填充量（字节）
+        size_t peak_fill = 0;           ///< 峰值填充量（字节）
+        uint64_t bytes_in = 0;          ///< 累计写入字节数
+        uint64_t bytes_out = 0;         ///< 累计读出字节数
+        uint64_t starts = 0;            ///< 开始写带的次数
+        uint64_t underruns = 0;         ///< 欠载次数（每次对应一次停带）
+        double producer_wait_seconds = 0.0; ///< 生产者因缓冲区满等待的时间
+        double consumer_wait_seconds = 0.0; ///< 消费者等待填充的时间
+    };
+
+    StreamBuffer();
+    explicit StreamBuffer(const Config& config);
+
+    /**
+     * @brief 修改配置并释放缓冲区，只能在两次写带之间调用。
+     */
+    void configure(const Config& config);
+
+    /**
+     * @brief 开始一次新的写带：清空缓冲区并重新打开写入端，累计指标保留。
+     */
+    void reset();
+
+    /**
+     * @brief 写入数据，缓冲区满时阻塞。
+     *
+     * @param data 数据。
+     * @param length 长度。
+     * @return size_t 写入的字节数，写入端已关闭时可能小于 length。
+     */
+    size_t write(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 生产者结束写入。
+     */
+    void close();
+
+    /**
+     * @brief 等待缓冲区填充到可以开始写带的程度。
+     *
+     * @return true 有数据可写。
+     * @return false 写入端已关闭且缓冲区为空。
+     */
+    bool waitToStart();
+
+    /**
+     * @brief 读出数据，缓冲区为空时阻塞（见类说明中的欠载处理）。
+     *
+     * @param out 输出缓冲区。
+     * @param max_length 最多读出的字节数。
+     * @return size_t 读出的字节数，0 表示写入端已关闭且数据已读完。
+     */
+    size_t read(uint8_t* out, size_t max_length);
+
+    /**
+     * @brief 不阻塞的 write()：只写入当前放得下的部分。
+     *
+     * @return size_t 写入的字节数。
+     */
+    size_t tryWrite(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 不阻塞的 waitToStart()：填充量已达到 start_fill（或写入端已关闭且有数据）时记一次开始并返回 true。
+     */
+    bool tryStart();
+
+    /**
+     * @brief 不阻塞的 read()。
+     *
+     * 缓冲区读空而生产者尚未结束时记一次欠载，之后在填充量恢复到 resume_fill（或写入端关闭）之前都返回 0。
+     *
+     * @return size_t 读出的字节数，0 表示暂时没有可写带的数据或数据已读完。
+     */
+    size_t tryRead(uint8_t* out, size_t max_length);
+
+    /**
+     * @brief 获取配置。
+     */
+    Config config() const;
+
+    /**
+     * @brief 当前填充比例（0~1）。
+     */
+    double fillRatio() const;
+
+    /**
+     * @brief 获取指标。
+     */
+    Metrics metrics() const;
+
+private:
+    /**
+     * @brief 在持锁状态下等待填充量达到 threshold 或写入端关闭。
+     */
+    void waitForFillLocked(size_t threshold);
+
+    /**
+     * @brief 在持锁状态下写入当前放得下的部分，返回写入的字节数。
+     */
+    size_t writeLocked(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 在持锁状态下读出已有的数据，返回读出的字节数。
+     */
+    size_t readLocked(uint8_t* out, size_t max_length);
+
+    size_t thresholdBytes(double ratio) const;
+
+    Config config_;
+    mutable MutexLock mutex_;
+    Condition not_full_;            ///< 生产者等待空间
+    Condition filled_;              ///< 消费者等待填充
+    std::vector<uint8_t> buffer_;   ///< 环形缓冲区，首次写入时分配
+    size_t head_;                   ///< 读位置
+    size_t fill_;                   ///< 填充量
+    bool closed_;                   ///< 写入端是否已关闭
+    size_t waiting_for_;            ///< 消费者正在等待的填充量，0 表示未等待
+    bool stalled_;                  ///< tryRead() 欠载后尚未恢复
+    Metrics metrics_;
+};
@@ -0,0 +1,547 @@
+#include "TapeDrive.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+    constexpr std::chrono::milliseconds kDefaultMaxWait = std::chrono::minutes(30);
+
+    // 后台份额按最近的字节数计算：窗口内字节数超过该值时减半，较早的历史逐渐失去影响
+    constexpr uint64_t kShareWindowBytes = 64ULL << 30;
+
+    // 一次换带折算的字节数：约 25 秒的装载/卸载时间按 360 MB/s 的流式带宽计算
+    constexpr uint64_t kDefaultSwapBytes = 8ULL << 30;
+
+    // 每次位置排序最多处理的 READ_AGGR 数：贪心排序为 O(n²)，且在驱动器锁内执行
+    constexpr size_t kMaxReorderBatch = 256;
+
+}
+
+TapeDrive::TapeDrive(int drive_id)
+: drive_id_(drive_id)
+, state_(DriveState::Empty)
+, max_wait_(kDefaultMaxWait)
+, mounts_(0)
+, pending_(0)
+, maintenance_pending_(0)
+, maintenance_running_(false)
+, background_pending_(0)
+, background_running_(false)
+, background_share_(0.0)
+, window_user_bytes_(0)
+, window_background_bytes_(0)
+, swap_bytes_(kDefaultSwapBytes)
+, background_mount_(false)
+, head_{0, 0}
+{
+
+}
+
+DriveState TapeDrive::getState() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return state_;
+}
+
+void TapeDrive::setState(DriveState state)
+{
+    MutexLockGuard autoLock(mutex_);
+    state_ = state;
+}
+
+std::string TapeDrive::getMountedTape() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return mounted_tape_;
+}
+
+void TapeDrive::setMountedTape(const std::string& tape_id)
+{
+    MutexLockGuard autoLock(mutex_);
+    mounted_tape_ = tape_id;
+    background_mount_ = false;
+    if (state_ != DriveState::Offline && state_ != DriveState::Busy) {
+        state_ = tape_id.empty() ? DriveState::Empty : DriveState::Loaded;
+    }
+}
+
+void TapeDrive::submit(const TapeDrivesOperation& op)
+{
+    MutexLockGuard autoLock(mutex_);
+    TapeDrivesOperation stamped(op);
+    stamped.setSubmitTime(std::chrono::steady_clock::now());
+    if (stamped.isBackground() && isTapeBound(stamped)) {
+        auto& group = background_[stamped.getTapeId()];
+        if (!group) {
+            group = std::make_unique<DriveOperationQueue>();
+        }
+        group->push_back(stamped);
+        ++background_pending_;
+        return;
+    }
+    if (isMaintenance(stamped)) {
+        auto& group = maintenance_[stamped.getTapeId()];
+        if (!group) {
+            group = std::make_unique<DriveOperationQueue>();
+        }
+        group->push_back(stamped);
+        ++maintenance_pending_;
+        return;
+    }
+    if (isTapeBound(stamped)) {
+        auto& group = groups_[stamped.getTapeId()];
+        if (!group) {
+            group = std::make_unique<DriveOperationQueue>();
+        }
+        group->push_back(stamped);
+        if (stamped.getTypeOperation() == TypeOperation::READ_AGGR) {
+            unordered_groups_.insert(stamped.getTapeId());
+            ++pending_reads_[stamped.getTapeId()];
+        }
+    } else {
+        control_.push_back(stamped);
+    }
+    ++pending_;
+}
+
+std::optional<TapeDrivesOperation> TapeDrive::next()
+{
+    MutexLockGuard autoLock(mutex_);
+    if (state_ == DriveState::Offline) {
+        return std::nullopt;
+    }
+    if (background_pending_ > 0 && (pending_ == 0 || backgroundDueLocked())) {
+        return nextBackground();
+    }
+    if (pending_ == 0) {
+        return nextMaintenance();
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    auto mounted = mounted_tape_.empty() ? groups_.end() : groups_.find(mounted_tape_);
+
+    // 其他磁带组和控制队列中最早的操作
+    std::string other_tape;
+    DriveOperationQueue* other = oldestGroup(groups_, mounted_tape_, other_tape);
+    bool control_first = !control_.empty() &&
+                         (!other || control_.front().getSubmitTime() <= other->front().getSubmitTime());
+    auto oldest_time = control_first ? control_.front().getSubmitTime()
+                                     : (other ? other->front().getSubmitTime() : now);
+
+    DriveOperationQueue* chosen = nullptr;
+    std::string chosen_tape;
+    if (mounted != groups_.end() && (now - oldest_time < max_wait_ || (!other && control_.empty()) ||
+                                     mounted->second->front().getSubmitTime() <= oldest_time)) {
+        // 1. 继续执行已装载磁带的操作
+        chosen = mounted->second.get();
+        chosen_tape = mounted_tape_;
+    } else if (control_first) {
+        // 4. 控制队列中的操作最早
+        state_ = DriveState::Busy;
+        --pending_;
+        return control_.pop_front();
+    } else {
+        chosen = other;
+        chosen_tape = other_tape;
+    }
+
+    if (chosen_tape != mounted_tape_) {
+        // 3. 需要换带：先卸载当前磁带，complete() 之后的下一次调用再装载目标磁带
+        state_ = DriveState::Busy;
+        if (!mounted_tape_.empty()) {
+            if (background_mount_) {
+                // 卸载为后台装载的磁带是后台造成的开销
+                chargeWindowLocked(window_background_bytes_, swap_bytes_);
+            }
+            return TapeDrivesOperation(TypeOperation::UNLOAD_TAPE, mounted_tape_);
+        }
+        return TapeDrivesOperation(TypeOperation::LOAD_TAPE, chosen_tape);
+    }
+
+    auto deadline = age_deadlines_.find(chosen_tape);
+    const bool aged = deadline != age_deadlines_.end() && now >= deadline->second;
+    if (unordered_groups_.erase(chosen_tape) || aged) {
+        reorderGroup(chosen_tape, *chosen, now);
+    }
+    TapeDrivesOperation op = chosen->pop_front();
+    if (chosen->empty()) {
+        groups_.erase(chosen_tape);
+        age_deadlines_.erase(chosen_tape);
+    }
+    if (op.getTypeOperation() == TypeOperation::READ_AGGR) {
+        auto reads = pending_reads_.find(chosen_tape);
+        if (reads != pending_reads_.end() && --reads->second == 0) {
+            pending_reads_.erase(reads);
+        }
+        // 估算从当前磁头位置到该操作的定位时间，并假定读取后磁头停在该位置附近
+        LocateModel::Position target = locate_model_.positionOf(op);
+        op.setEstimatedLocateSeconds(locate_model_.locateSeconds(head_, target));
+        head_ = target;
+        ++locate_stats_.reads;
+        locate_stats_.estimated_seconds += op.getEstimatedLocateSeconds();
+    }
+    const uint64_t bytes = transferBytes(op);
+    background_stats_.user_bytes += bytes;
+    chargeWindowLocked(window_user_bytes_, bytes);
+    --pending_;
+    state_ = DriveState::Busy;
+    return op;
+}
+
+std::optional<TapeDrivesOperation> TapeDrive::nextMaintenance()
+{
+    if (maintenance_pending_ == 0) {
+        return std::nullopt;
+    }
+    auto mounted = mounted_tape_.empty() ? maintenance_.end() : maintenance_.find(mounted_tape_);
+    std::string tape_id = mounted_tape_;
+    DriveOperationQueue* chosen = mounted != maintenance_.end() ? mounted->second.get()
+                                                                : oldestGroup(maintenance_, mounted_tape_, tape_id);
+    state_ = DriveState::Busy;
+    if (tape_id != mounted_tape_) {
+        // 驱动器空闲，为维护换带；换带期间到达的用户操作会在下一次 next() 中优先
+        if (!mounted_tape_.empty()) {
+            return TapeDrivesOperation(TypeOperation::UNLOAD_TAPE, mounted_tape_);
+        }
+        return TapeDrivesOperation(TypeOperation::LOAD_TAPE, tape_id);
+    }
+    TapeDrivesOperation op = chosen->pop_front();
+    if (chosen->empty()) {
+        maintenance_.erase(tape_id);
+    }
+    --maintenance_pending_;
+    maintenance_running_ = true;
+    ++maintenance_stats_.dispatched;
+    return op;
+}
+
+std::optional<TapeDrivesOperation> TapeDrive::nextBackground()
+{
+    auto mounted = mounted_tape_.empty() ? background_.end() : background_.find(mounted_tape_);
+    std::string tape_id = mounted_tape_;
+    DriveOperationQueue* chosen = mounted != background_.end() ? mounted->second.get()
+                                                               : oldestGroup(background_, mounted_tape_, tape_id);
+    state_ = DriveState::Busy;
+    if (tape_id != mounted_tape_) {
+        if (!mounted_tape_.empty()) {
+            return backgroundSwapLocked(TypeOperation::UNLOAD_TAPE, mounted_tape_);
+        }
+        return backgroundSwapLocked(TypeOperation::LOAD_TAPE, tape_id);
+    }
+    TapeDrivesOperation op = chosen->pop_front();
+    if (chosen->empty()) {
+        background_.erase(tape_id);
+    }
+    --background_pending_;
+    background_running_ = true;
+    const uint64_t bytes = transferBytes(op);
+    ++background_stats_.dispatched;
+    background_stats_.bytes += bytes;
+    if (pending_ > 0) {
+        // 只有与用户操作竞争时出队的后台字节计入份额，空闲时间不受限制
+        ++background_stats_.contended;
+        background_stats_.contended_bytes += bytes;
+        chargeWindowLocked(window_background_bytes_, bytes);
+    }
+    return op;
+}
+
+TapeDrivesOperation TapeDrive::backgroundSwapLocked(TypeOperation type, const std::string& tape_id)
+{
+    if (pending_ > 0) {
+        chargeWindowLocked(window_background_bytes_, swap_bytes_);
+    }
+    // 标记为后台，complete() 据此记录已装载的磁带属于后台
+    TapeDrivesOperation op(type, tape_id);
+    op.setBackground(true);
+    return op;
+}
+
+void TapeDrive::chargeWindowLocked(uint64_t& window, uint64_t bytes)
+{
+    window += bytes;
+    if (window_user_bytes_ + window_background_bytes_ > kShareWindowBytes) {
+        window_user_bytes_ /= 2;
+        window_background_bytes_ /= 2;
+    }
+}
+
+bool TapeDrive::backgroundDueLocked() const
+{
+    return background_share_ > 0.0 &&
+           static_cast<double>(window_background_bytes_) <
+               background_share_ * static_cast<double>(window_background_bytes_ + window_user_bytes_);
+}
+
+uint64_t TapeDrive::transferBytes(const TapeDrivesOperation& op)
+{
+    switch (op.getTypeOperation()) {
+        case TypeOperation::READ_AGGR:
+            return op.getLength();
+        case TypeOperation::WRITE_AGGR: {
+            auto aggregate = op.getAggregate();
+            return aggregate && aggregate->payload ? aggregate->payload->size() : op.getLength();
+        }
+        default:
+            return 0;
+    }
+}
+
+void TapeDrive::preempt(const TapeDrivesOperation& op)
+{
+    MutexLockGuard autoLock(mutex_);
+    auto& group = maintenance_[op.getTapeId()];
+    if (!group) {
+        group = std::make_unique<DriveOperationQueue>();
+    }
+    group->push_front(op);
+    ++maintenance_pending_;
+    maintenance_running_ = false;
+    ++maintenance_stats_.preempted;
+    if (state_ != DriveState::Offline) {
+        state_ = mounted_tape_.empty() ? DriveState::Empty : DriveState::Loaded;
+    }
+}
+
+void TapeDrive::complete(const TapeDrivesOperation& op, double actual_locate_seconds)
+{
+    MutexLockGuard autoLock(mutex_);
+    if (maintenance_running_ && isMaintenance(op)) {
+        maintenance_running_ = false;
+        ++maintenance_stats_.completed;
+    }
+    if (background_running_ && op.isBackground()) {
+        background_running_ = false;
+        ++background_stats_.completed;
+    }
+    switch (op.getTypeOperation()) {
+        case TypeOperation::LOAD_TAPE:
+            mounted_tape_ = op.getTapeId();
+            background_mount_ = op.isBackground();
+            head_ = LocateModel::Position{0, 0}; // 装载后磁头位于 BOT
+            ++mounts_;
+            break;
+        case TypeOperation::UNLOAD_TAPE:
+            mounted_tape_.clear();
+            background_mount_ = false;
+            break;
+        case TypeOperation::READ_AGGR:
+            if (actual_locate_seconds >= 0.0) {
+                ++locate_stats_.measured;
+                locate_stats_.measured_estimated_seconds += op.getEstimatedLocateSeconds();
+                locate_stats_.measured_actual_seconds += actual_locate_seconds;
+            }
+            break;
+        default:
+            break;
+    }
+    if (state_ != DriveState::Offline) {
+        state_ = mounted_tape_.empty() ? DriveState::Empty : DriveState::Loaded;
+    }
+}
+
+size_t TapeDrive::pendingCount() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return pending_;
+}
+
+size_t TapeDrive::maintenanceCount() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return maintenance_pending_;
+}
+
+bool TapeDrive::maintenanceRunning() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return maintenance_running_;
+}
+
+bool TapeDrive::preemptRequested() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return maintenance_running_ && pending_ > 0;
+}
+
+size_t TapeDrive::backgroundCount() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return background_pending_;
+}
+
+bool TapeDrive::backgroundRunning() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return background_running_;
+}
+
+size_t TapeDrive::backgroundForTape(const std::string& tape_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = background_.find(tape_id);
+    return it == background_.end() ? 0 : it->second->size();
+}
+
+void TapeDrive::setBackgroundShare(double share)
+{
+    MutexLockGuard autoLock(mutex_);
+    background_share_ = share;
+}
+
+void TapeDrive::setBackgroundSwapBytes(uint64_t bytes)
+{
+    MutexLockGuard autoLock(mutex_);
+    swap_bytes_ = bytes;
+}
+
+bool TapeDrive::holdsTape(const std::string& tape_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    if (tape_id.empty()) {
+        return false;
+    }
+    return mounted_tape_ == tape_id || groups_.count(tape_id) > 0 || background_.count(tape_id) > 0 ||
+           maintenance_.count(tape_id) > 0;
+}
+
+size_t TapeDrive::pendingForTape(const std::string& tape_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = groups_.find(tape_id);
+    return it == groups_.end() ? 0 : it->second->size();
+}
+
+size_t TapeDrive::pendingReadsForTape(const std::string& tape_id) const
+{
+    MutexLockGuard autoLock(mutex_);
+    auto it = pending_reads_.find(tape_id);
+    return it == pending_reads_.end() ? 0 : it->second;
+}
+
+void TapeDrive::setMaxWait(std::chrono::milliseconds max_wait)
+{
+    MutexLockGuard autoLock(mutex_);
+    max_wait_ = max_wait;
+}
+
+uint64_t TapeDrive::mountCount() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return mounts_;
+}
+
+TapeDrive::LocateStats TapeDrive::locateStats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return locate_stats_;
+}
+
+TapeDrive::MaintenanceStats TapeDrive::maintenanceStats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return maintenance_stats_;
+}
+
+TapeDrive::BackgroundStats TapeDrive::backgroundStats() const
+{
+    MutexLockGuard autoLock(mutex_);
+    return background_stats_;
+}
+
+void TapeDrive::setLocateModel(const LocateModel& model)
+{
+    MutexLockGuard autoLock(mutex_);
+    locate_model_ = model;
+}
+
+void TapeDrive::reorderGroup(const std::string& tape_id, DriveOperationQueue& group,
+                             std::chrono::steady_clock::time_point now)
+{
+    std::vector<TapeDrivesOperation> aged;
+    std::vector<TapeDrivesOperation> reads;
+    std::vector<TapeDrivesOperation> others;
+    while (!group.empty()) {
+        TapeDrivesOperation op = group.pop_front();
+        if (now - op.getSubmitTime() >= max_wait_) {
+            aged.push_back(std::move(op));
+        } else if (op.getTypeOperation() == TypeOperation::READ_AGGR) {
+            reads.push_back(std::move(op));
+        } else {
+            others.push_back(std::move(op));
+        }
+    }
+
+    // 超过等待上限的操作按提交顺序最先执行，其余的读从这些操作之后的磁头位置开始排序
+    std::stable_sort(aged.begin(), aged.end(), [](const TapeDrivesOperation& a, const TapeDrivesOperation& b) {
+        return a.getSubmitTime() < b.getSubmitTime();
+    });
+    LocateModel::Position head = head_;
+    for (auto it = aged.rbegin(); it != aged.rend(); ++it) {
+        if (it->getTypeOperation() == TypeOperation::READ_AGGR) {
+            head = locate_model_.positionOf(*it);
+            break;
+        }
+    }
+    const size_t batch = std::min(reads.size(), kMaxReorderBatch);
+    std::vector<TapeDrivesOperation> window(reads.begin(), reads.begin() + batch);
+    locate_model_.order(head, window);
+
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    auto push = [&](const TapeDrivesOperation& op) {
+        group.push_back(op);
+        deadline = std::min(deadline, op.getSubmitTime() + max_wait_);
+    };
+    for (const auto& op : aged) {
+        group.push_back(op);
+    }
+    for (const auto& op : window) {
+        push(op);
+    }
+    for (size_t i = batch; i < reads.size(); ++i) {
+        push(reads[i]);
+    }
+    for (const auto& op : others) {
+        push(op);
+    }
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+        age_deadlines_.erase(tape_id);
+    } else {
+        age_deadlines_[tape_id] = deadline;
+    }
+}
+
+bool TapeDrive::isMaintenance(const TapeDrivesOperation& op)
+{
+    return op.getTypeOperation() == TypeOperation::ROLL_TAPE && !op.getTapeId().empty();
+}
+
+bool TapeDrive::isTapeBound(const TapeDrivesOperation& op)
+{
+    if (op.getTapeId().empty()) {
+        return false;
+    }
+    switch (op.getTypeOperation()) {
+        case TypeOperation::READ_AGGR:
+        case TypeOperation::WRITE_AGGR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+DriveOperationQueue* TapeDrive::oldestGroup(const GroupMap& groups, const std::string& exclude, std::string& tape_id)
+{
+    DriveOperationQueue* oldest = nullptr;
+    for (const auto& group : groups) {
+        if (group.first == exclude) {
+            continue;
+        }
+        if (!oldest || group.second->front().getSubmitTime() < oldest->front().getSubmitTime()) {
+            oldest = group.second.get();
+            tape_id = group.first;
+        }
+    }
+    return oldest;
+}
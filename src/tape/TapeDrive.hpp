@@ -0,0 +1,380 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "shared/queue/BaseQueue.hpp"
+#include "shared/mutex/MutexLock.hpp"
+#include "shared/mutex/NonCopyable.hpp"
+#include "TapeDrivesOperation.hpp"
+#include "LocateModel.hpp"
+#include "StreamBuffer.hpp"
+
+/**
+ * @brief 磁带驱动器状态。
+ */
+enum class DriveState : int {
+    Empty = 1,    ///< 空闲，未装载磁带
+    Loaded = 2,   ///< 已装载磁带，空闲
+    Busy = 3,     ///< 正在执行操作
+    Offline = 4   ///< 离线（故障或维护），不参与调度
+};
+
+/**
+ * @brief 单个驱动器的操作队列。
+ *
+ * BaseQueue 的构造函数是受保护的，驱动器需要一个可直接实例化的队列类型。
+ */
+class DriveOperationQueue : public BaseQueue<TapeDrivesOperation> {
+public:
+    DriveOperationQueue() = default;
+};
+
+/**
+ * @brief 物理磁带驱动器。
+ *
+ * 每个驱动器拥有自己的操作队列和互斥锁，不同驱动器上的操作不会竞争同一把锁。
+ * 驱动器还记录当前状态、已装载的磁带以及队列中每盘磁带的待执行操作数，供 DrivePool 调度时参考。
+ *
+ * 磁带亲和批处理：一次 LOAD_TAPE/UNLOAD_TAPE 需要数分钟，按提交顺序执行交错的多盘磁带召回会导致反复换带。
+ * 因此带有磁带 ID 的操作（READ_AGGR、WRITE_AGGR）按磁带分组排队，next() 的选择规则为：
+ * 1. 已装载磁带还有待执行的操作时，继续执行该磁带的操作，直到该组为空才换带；
+ * 2. 但如果其他组（或控制队列）中最早的操作已等待超过 max_wait，则优先切换，保证公平性；
+ * 3. 需要切换到其他磁带时，next() 自动生成 UNLOAD_TAPE（若已装载）和 LOAD_TAPE 操作；
+ * 4. 其余操作（显式的 LOAD_TAPE/UNLOAD_TAPE、INVENTORY 等）进入控制队列，与各磁带组按最早提交时间竞争。
+ *
+ * 位置排序：已装载磁带的组中有新的 READ_AGGR 到达后，下次取操作前按 LocateModel 从当前磁头位置重新排序
+ * （READ_AGGR 在前，其他操作保持原有相对顺序排在其后），减少蛇形磁带上的定位时间。
+ * 组内同样遵守 max_wait：已等待超过 max_wait 的操作按提交顺序排在最前面，不参与位置排序；
+ * 组内有操作到达等待上限时即使没有新的 READ_AGGR 也会重新排序，远处的读不会因为近处的读不断到达而饿死。
+ * 排序在驱动器锁内进行，每次只对队首最多 256 个 READ_AGGR 排序，更靠后的读保持原有顺序，限制每次的开销。
+ * 出队时估算每个 READ_AGGR 的定位时间，执行方可在 complete() 中回报实际定位时间，用于对比模型的准确性。
+ *
+ * 后台维护：ROLL_TAPE 属于低优先级的维护类操作，单独按磁带分组排队，不计入 pendingCount()。
+ * 只有驱动器没有任何用户操作、否则就会空闲时，next() 才取出维护操作（优先已装载磁带的维护，
+ * 必要时同样自动生成 UNLOAD_TAPE/LOAD_TAPE）。维护执行期间有用户操作到达时 preemptRequested() 变为 true，
+ * 执行方应尽快中止维护并调用 preempt()，被中止的操作回到维护队列队首，之后空闲时重新执行。
+ *
+ * 后台操作：标记为后台的 READ_AGGR/WRITE_AGGR（如回收空间的重打包，见 TapeDrivesOperation::isBackground()）
+ * 单独按磁带分组排队，不计入 pendingCount()，执行时不可抢占。驱动器没有用户操作时后台操作优先于维护操作执行；
+ * 有用户操作等待时，按后台份额（setBackgroundShare()）交替执行：最近一段时间内有用户操作等待时出队的后台字节数
+ * 不超过出队总字节数的 share 倍。份额为 0 时后台操作只使用空闲时间。后台操作引起的换带同样计入份额：
+ * 有用户操作等待时为后台生成的 UNLOAD_TAPE/LOAD_TAPE，以及之后为用户卸载后台装载的磁带，
+ * 每次按 setBackgroundSwapBytes() 折算的字节数计入后台，避免后台在用户磁带之间反复换带。
+ *
+ * 执行方的典型用法：
+ * @code
+ * while (auto op = drive.next()) {   // 取出操作，驱动器进入 Busy
+ *     if (execute(*op, [&] { return drive.preemptRequested(); })) {
+ *         drive.complete(*op);       // 根据操作结果更新已装载的磁带和状态
+ *     } else {
+ *         drive.preempt(*op);        // 维护操作被用户操作抢占
+ *     }
+ * }
+ * @endcode
+ */
+class TapeDrive
+: NonCopyable
+{
+public:
+    /**
+     * @brief 构造函数，驱动器初始为 Empty。
+     *
+     * @param drive_id 驱动器编号。
+     */
+    explicit TapeDrive(int drive_id);
+
+    /**
+     * @brief 获取驱动器编号。
+     */
+    int getDriveId() const { return drive_id_; }
+
+    /**
+     * @brief 获取驱动器状态。
+     */
+    DriveState getState() const;
+
+    /**
+     * @brief 设置驱动器状态（如置为 Offline）。
+     */
+    void setState(DriveState state);
+
+    /**
+     * @brief 获取已装载的磁带 ID，未装载时为空。
+     */
+    std::string getMountedTape() const;
+
+    /**
+     * @brief 直接设置已装载的磁带（用于启动时根据库存初始化）。
+     *
+     * @param tape_id 磁带 ID，为空表示未装载。
+     */
+    void setMountedTape(const std::string& tape_id);
+
+    /**
+     * @brief 将操作加入本驱动器的队列。
+     *
+     * @param op 磁带操作。
+     */
+    void submit(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 取出下一个待执行的操作，驱动器进入 Busy。
+     *
+     * @return std::optional<TapeDrivesOperation> 队列为空时返回 std::nullopt。
+     */
+    std::optional<TapeDrivesOperation> next();
+
+    /**
+     * @brief 操作执行完成后更新驱动器状态。
+     *
+     * LOAD_TAPE 完成后记录已装载的磁带，UNLOAD_TAPE 完成后清空；
+     * 驱动器随后回到 Loaded 或 Empty（Offline 保持不变）。
+     *
+     * @param op 已完成的操作。
+     * @param actual_locate_seconds READ_AGGR 实际的定位时间（秒），小于 0 表示未测量。
+     */
+    void complete(const TapeDrivesOperation& op, double actual_locate_seconds = -1.0);
+
+    /**
+     * @brief 维护操作被用户操作抢占，放回维护队列队首，驱动器回到 Loaded 或 Empty。
+     *
+     * @param op 被中止的维护操作（由 next() 取出）。
+     */
+    void preempt(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 队列中待执行的用户操作数（驱动器负载），不含维护操作。
+     */
+    size_t pendingCount() const;
+
+    /**
+     * @brief 队列中待执行的维护操作数。
+     */
+    size_t maintenanceCount() const;
+
+    /**
+     * @brief 驱动器是否正在执行维护操作（可被抢占，调度时视为空闲）。
+     */
+    bool maintenanceRunning() const;
+
+    /**
+     * @brief 正在执行的维护操作是否应让位于已到达的用户操作。
+     */
+    bool preemptRequested() const;
+
+    /**
+     * @brief 队列中待执行的后台操作数。
+     */
+    size_t backgroundCount() const;
+
+    /**
+     * @brief 驱动器是否正在执行后台操作。
+     */
+    bool backgroundRunning() const;
+
+    /**
+     * @brief 队列中针对指定磁带的后台操作数。
+     */
+    size_t backgroundForTape(const std::string& tape_id) const;
+
+    /**
+     * @brief 设置有用户操作等待时后台操作可占用的份额（按字节，0 ~ 1，默认 0）。
+     *
+     * @param share 后台份额。
+     */
+    void setBackgroundShare(double share);
+
+    /**
+     * @brief 设置一次后台引起的换带（UNLOAD_TAPE 或 LOAD_TAPE）折算计入后台份额的字节数（默认 8 GiB，约 25 秒的流式传输）。
+     *
+     * @param bytes 每次换带折算的字节数，0 表示换带不计入份额。
+     */
+    void setBackgroundSwapBytes(uint64_t bytes);
+
+    /**
+     * @brief 磁带是否已装载在本驱动器，或在本驱动器的任一队列（用户、后台、维护）中有待执行的操作。
+     *
+     * 同一盘磁带同一时刻只能在一个驱动器中，调度时必须把该磁带的所有操作集中到这样的驱动器。
+     *
+     * @param tape_id 磁带 ID。
+     */
+    bool holdsTape(const std::string& tape_id) const;
+
+    /**
+     * @brief 判断操作是否属于低优先级的维护类（目前为 ROLL_TAPE）。
+     */
+    static bool isMaintenance(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 队列中针对指定磁带的待执行操作数。
+     *
+     * @param tape_id 磁带 ID。
+     */
+    size_t pendingForTape(const std::string& tape_id) const;
+
+    /**
+     * @brief 队列中针对指定磁带的 READ_AGGR 数。
+     *
+     * @param tape_id 磁带 ID。
+     */
+    size_t pendingReadsForTape(const std::string& tape_id) const;
+
+    /**
+     * @brief 设置操作等待时长上限（默认 30 分钟）。
+     *
+     * 为 0 时退化为按最早提交时间执行，不再做批处理。
+     *
+     * @param max_wait 等待时长上限。
+     */
+    void setMaxWait(std::chrono::milliseconds max_wait);
+
+    /**
+     * @brief 已完成的 LOAD_TAPE 次数（装载次数）。
+     */
+    uint64_t mountCount() const;
+
+    /**
+     * @brief READ_AGGR 定位时间统计。
+     */
+    struct LocateStats {
+        uint64_t reads = 0;                      ///< 出队的 READ_AGGR 数
+        double estimated_seconds = 0.0;          ///< 所有 READ_AGGR 的估算定位时间之和
+        uint64_t measured = 0;                   ///< 回报了实际定位时间的 READ_AGGR 数
+        double measured_estimated_seconds = 0.0; ///< 上述操作的估算定位时间之和
+        double measured_actual_seconds = 0.0;    ///< 上述操作的实际定位时间之和
+    };
+
+    /**
+     * @brief 获取定位时间统计。
+     */
+    LocateStats locateStats() const;
+
+    /**
+     * @brief 维护操作统计。
+     */
+    struct MaintenanceStats {
+        uint64_t dispatched = 0;    ///< 出队执行的维护操作数（含被抢占后重新执行的）
+        uint64_t completed = 0;     ///< 完成的维护操作数
+        uint64_t preempted = 0;     ///< 被用户操作抢占的次数
+    };
+
+    /**
+     * @brief 获取维护操作统计。
+     */
+    MaintenanceStats maintenanceStats() const;
+
+    /**
+     * @brief 后台操作统计。
+     */
+    struct BackgroundStats {
+        uint64_t dispatched = 0;        ///< 出队的后台操作数
+        uint64_t completed = 0;         ///< 完成的后台操作数
+        uint64_t bytes = 0;             ///< 后台操作的字节数
+        uint64_t contended = 0;         ///< 有用户操作等待时出队的后台操作数
+        uint64_t contended_bytes = 0;   ///< 上述操作的字节数
+        uint64_t user_bytes = 0;        ///< 用户 READ_AGGR/WRITE_AGGR 的字节数
+    };
+
+    /**
+     * @brief 获取后台操作统计。
+     */
+    BackgroundStats backgroundStats() const;
+
+    /**
+     * @brief 设置定位时间模型（不同代际的磁带参数不同）。
+     *
+     * @param model 定位时间模型。
+     */
+    void setLocateModel(const LocateModel& model);
+
+    /**
+     * @brief 驱动器写入路径上的流式缓冲区（见 StreamBuffer），其自身有独立的锁。
+     */
+    StreamBuffer& streamBuffer() { return stream_buffer_; }
+    const StreamBuffer& streamBuffer() const { return stream_buffer_; }
+
+private:
+    using GroupMap = std::unordered_map<std::string, std::unique_ptr<DriveOperationQueue>>;
+
+    /**
+     * @brief 没有用户操作时取出下一个维护操作（或为其生成的换带操作）。
+     */
+    std::optional<TapeDrivesOperation> nextMaintenance();
+
+    /**
+     * @brief 取出下一个后台操作（或为其生成的换带操作）。
+     */
+    std::optional<TapeDrivesOperation> nextBackground();
+
+    /**
+     * @brief 有用户操作等待时，是否轮到后台操作。
+     */
+    bool backgroundDueLocked() const;
+
+    /**
+     * @brief 为后台操作生成换带操作；有用户操作等待时按 swap_bytes_ 计入后台份额。
+     */
+    TapeDrivesOperation backgroundSwapLocked(TypeOperation type, const std::string& tape_id);
+
+    /**
+     * @brief 把字节数计入份额窗口，窗口超过上限时减半。
+     */
+    void chargeWindowLocked(uint64_t& window, uint64_t bytes);
+
+    /**
+     * @brief READ_AGGR/WRITE_AGGR 传输的字节数。
+     */
+    static uint64_t transferBytes(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 按定位时间模型对磁带组中的操作重新排序（超过 max_wait 的操作排在最前面），并更新该组的 age_deadlines_。
+     */
+    void reorderGroup(const std::string& tape_id, DriveOperationQueue& group, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 判断操作是否按磁带分组排队。
+     */
+    static bool isTapeBound(const TapeDrivesOperation& op);
+
+    /**
+     * @brief 在 groups 中查找除 exclude 以外、队首操作最早提交的磁带组。
+     *
+     * @return DriveOperationQueue* 找到的组，tape_id 输出其磁带 ID；没有时返回 nullptr。
+     */
+    static DriveOperationQueue* oldestGroup(const GroupMap& groups, const std::string& exclude, std::string& tape_id);
+
+    const int drive_id_;                                  ///< 驱动器编号
+    mutable MutexLock mutex_;                             ///< 保护以下状态（各队列本身由 BaseQueue 的锁保护）
+    DriveState state_;                                    ///< 驱动器状态
+    std::string mounted_tape_;                            ///< 已装载的磁带 ID
+    std::chrono::milliseconds max_wait_;                  ///< 操作等待时长上限
+    uint64_t mounts_;                                     ///< 装载次数
+    size_t pending_;                                      ///< 所有队列中的操作总数
+    std::unordered_map<std::string, size_t> pending_reads_; ///< 磁带 ID -> 排队的 READ_AGGR 数
+    GroupMap groups_;                                     ///< 磁带 ID -> 该磁带的操作
+    DriveOperationQueue control_;                         ///< 与具体磁带组无关的操作
+    GroupMap maintenance_;                                ///< 磁带 ID -> 该磁带的维护操作
+    size_t maintenance_pending_;                          ///< 维护队列中的操作总数
+    bool maintenance_running_;                            ///< 正在执行维护操作
+    MaintenanceStats maintenance_stats_;                  ///< 维护操作统计
+    GroupMap background_;                                 ///< 磁带 ID -> 该磁带的后台操作
+    size_t background_pending_;                           ///< 后台队列中的操作总数
+    bool background_running_;                             ///< 正在执行后台操作
+    double background_share_;                             ///< 有用户操作等待时的后台份额
+    uint64_t window_user_bytes_;                          ///< 份额窗口内出队的用户字节数
+    uint64_t window_background_bytes_;                    ///< 份额窗口内有用户操作等待时出队的后台字节数（含换带折算）
+    uint64_t swap_bytes_;                                 ///< 一次后台换带折算的字节数
+    bool background_mount_;                               ///< 已装载的磁带是为后台操作装载的
+    BackgroundStats background_stats_;                   ///< 后台操作统计
+    std::unordered_set<std::string> unordered_groups_;    ///< 有新 READ_AGGR 到达、需要重新排序的磁带组
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> age_deadlines_; ///< 磁带组 -> 组内下一个操作到达等待上限的时刻
+    LocateModel locate_model_;                            ///< 定位时间模型
+    LocateModel::Position head_;                          ///< 当前磁头位置
+    LocateStats locate_stats_;                            ///< 定位时间统计
+    StreamBuffer stream_buffer_;                          ///< 写带流式缓冲区
+};
@@ -1,12 +1,19 @@
 #include "TapeDrivesOperation.hpp"
 
-TapeDrivesOperation::TapeDrivesOperation(TypeOperation op)
+TapeDrivesOperation::TapeDrivesOperation(TypeOperation op, const std::string& tape_id)
 : op_(op)
+, tape_id_(tape_id)
+, block_position_(0)
+, wrap_(-1)
+, estimated_locate_(0.0)
+, operation_id_(0)
+, length_(0)
+, background_(false)
 {
 
 }
 
-TypeOperation TapeDrivesOperation::getTypeOperation()
+TypeOperation TapeDrivesOperation::getTypeOperation() const
 {
     return op_;
 }
@@ -14,4 +21,90 @@ TypeOperation TapeDrivesOperation::getTypeOperation()
 void TapeDrivesOperation::setTypeOperation(TypeOperation op)
 {
     op_ = op;
+}
+
+const std::string& TapeDrivesOperation::getTapeId() const
+{
+    return tape_id_;
+}
+
+void TapeDrivesOperation::setTapeId(const std::string& tape_id)
+{
+    tape_id_ = tape_id;
+}
+
+std::chrono::steady_clock::time_point TapeDrivesOperation::getSubmitTime() const
+{
+    return submit_time_;
+}
+
+void TapeDrivesOperation::setSubmitTime(std::chrono::steady_clock::time_point submit_time)
+{
+    submit_time_ = submit_time;
+}
+
+uint64_t TapeDrivesOperation::getBlockPosition() const
+{
+    return block_position_;
+}
+
+int TapeDrivesOperation::getWrap() const
+{
+    return wrap_;
+}
+
+void TapeDrivesOperation::setPosition(uint64_t block_position, int wrap)
+{
+    block_position_ = block_position;
+    wrap_ = wrap;
+}
+
+double TapeDrivesOperation::getEstimatedLocateSeconds() const
+{
+    return estimated_locate_;
+}
+
+void TapeDrivesOperation::setEstimatedLocateSeconds(double seconds)
+{
+    estimated_locate_ = seconds;
+}
+
+std::shared_ptr<const AggregateInfo> TapeDrivesOperation::getAggregate() const
+{
+    return aggregate_;
+}
+
+void TapeDrivesOperation::setAggregate(std::shared_ptr<const AggregateInfo> aggregate)
+{
+    aggregate_ = std::move(aggregate);
+}
+
+uint64_t TapeDrivesOperation::getOperationId() const
+{
+    return operation_id_;
+}
+
+void TapeDrivesOperation::setOperationId(uint64_t operation_id)
+{
+    operation_id_ = operation_id;
+}
+
+uint64_t TapeDrivesOperation::getLength() const
+{
+    return length_;
+}
+
+void TapeDrivesOperation::setLength(uint64_t length)
+{
+    length_ = length;
+}
+
+bool TapeDrivesOperation::isBackground() const
+{
+    return background_;
+}
+
+void TapeDrivesOperation::setBackground(bool background)
+{
+    background_ = background;
 }
\ No newline at end of file
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Aggregate.hpp"
+
 /**
  * @brief 定义了磁带驱动器可能执行的各种操作。
  *
@@ -26,15 +33,16 @@ public:
      * @brief 构造函数，初始化 TapeDrivesOperation 对象。
      *
      * @param op 初始的操作类型。
+     * @param tape_id 操作针对的磁带（卷）ID，INVENTORY 等与具体磁带无关的操作可以为空。
      */
-    TapeDrivesOperation(TypeOperation op);
+    TapeDrivesOperation(TypeOperation op, const std::string& tape_id = "");
 
     /**
      * @brief 获取当前的操作类型。
      *
      * @return TypeOperation 当前的操作类型。
      */
-    TypeOperation getTypeOperation();
+    TypeOperation getTypeOperation() const;
 
     /**
      * @brief 设置新的操作类型。
@@ -43,7 +51,135 @@ public:
      */
     void setTypeOperation(TypeOperation op);
 
+    /**
+     * @brief 获取操作针对的磁带（卷）ID。
+     *
+     * @return const std::string& 磁带 ID，为空表示与具体磁带无关。
+     */
+    const std::string& getTapeId() const;
+
+    /**
+     * @brief 设置操作针对的磁带（卷）ID。
+     *
+     * @param tape_id 磁带 ID。
+     */
+    void setTapeId(const std::string& tape_id);
+
+    /**
+     * @brief 获取操作提交到驱动器队列的时间，用于调度时的等待时长上限判断。
+     *
+     * @return std::chrono::steady_clock::time_point 提交时间。
+     */
+    std::chrono::steady_clock::time_point getSubmitTime() const;
+
+    /**
+     * @brief 设置操作的提交时间（由驱动器在入队时设置）。
+     *
+     * @param submit_time 提交时间。
+     */
+    void setSubmitTime(std::chrono::steady_clock::time_point submit_time);
+
+    /**
+     * @brief 获取操作在磁带上的逻辑块位置（READ_AGGR 为聚合的起始块）。
+     *
+     * @return uint64_t 逻辑块号。
+     */
+    uint64_t getBlockPosition() const;
+
+    /**
+     * @brief 获取所在的 wrap（磁带来回走带的轨道组），-1 表示未知，由定位模型根据块号推算。
+     *
+     * @return int wrap 编号。
+     */
+    int getWrap() const;
+
+    /**
+     * @brief 设置操作在磁带上的位置。
+     *
+     * @param block_position 逻辑块号。
+     * @param wrap wrap 编号，未知时为 -1。
+     */
+    void setPosition(uint64_t block_position, int wrap = -1);
+
+    /**
+     * @brief 获取调度器估算的定位（locate）时间，单位为秒。
+     *
+     * @return double 估算时间，未估算时为 0。
+     */
+    double getEstimatedLocateSeconds() const;
+
+    /**
+     * @brief 设置调度器估算的定位时间（由驱动器在出队时设置）。
+     *
+     * @param seconds 估算时间（秒）。
+     */
+    void setEstimatedLocateSeconds(double seconds);
+
+    /**
+     * @brief 获取操作携带的聚合（WRITE_AGGR 为待写入的聚合及其成员索引）。
+     *
+     * @return std::shared_ptr<const AggregateInfo> 聚合，没有时为 nullptr。
+     */
+    std::shared_ptr<const AggregateInfo> getAggregate() const;
+
+    /**
+     * @brief 设置操作携带的聚合。
+     *
+     * @param aggregate 聚合。
+     */
+    void setAggregate(std::shared_ptr<const AggregateInfo> aggregate);
+
+    /**
+     * @brief 获取操作 ID，用于在操作完成时找到对应的等待方，0 表示未分配。
+     *
+     * @return uint64_t 操作 ID。
+     */
+    uint64_t getOperationId() const;
+
+    /**
+     * @brief 设置操作 ID。
+     *
+     * @param operation_id 操作 ID。
+     */
+    void setOperationId(uint64_t operation_id);
+
+    /**
+     * @brief 获取操作涉及的数据长度（READ_AGGR 为从 block_position 开始连续读取的字节数）。
+     *
+     * @return uint64_t 长度（字节）。
+     */
+    uint64_t getLength() const;
+
+    /**
+     * @brief 设置操作涉及的数据长度。
+     *
+     * @param length 长度（字节）。
+     */
+    void setLength(uint64_t length);
+
+    /**
+     * @brief 是否为后台操作（如回收空间的重打包读写），受驱动器的后台份额限制（见 TapeDrive）。
+     *
+     * @return bool 后台操作返回 true。
+     */
+    bool isBackground() const;
+
+    /**
+     * @brief 设置是否为后台操作。
+     *
+     * @param background 是否为后台操作。
+     */
+    void setBackground(bool background);
 
 private:
-    TypeOperation op_; ///< 存储当前的操作类型。
+    TypeOperation op_;     ///< 存储当前的操作类型。
+    std::string tape_id_;  ///< 操作针对的磁带（卷）ID。
+    std::chrono::steady_clock::time_point submit_time_; ///< 提交到驱动器队列的时间。
+    uint64_t block_position_;  ///< 逻辑块位置。
+    int wrap_;                 ///< wrap 编号，-1 表示未知。
+    double estimated_locate_;  ///< 估算的定位时间（秒）。
+    std::shared_ptr<const AggregateInfo> aggregate_; ///< 操作携带的聚合。
+    uint64_t operation_id_;    ///< 操作 ID。
+    uint64_t length_;          ///< 数据长度（字节）。
+    bool background_;          ///< 是否为后台操作。
 };
\ No newline at end of file
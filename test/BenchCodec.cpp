@@ -0,0 +1,171 @@
+#include "BinaryCodec.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * 二进制编码基准测试：定长记录批量编解码 vs. 逐字段编解码。
+ *
+ * 逐字段方式（naive）：每个字段单独 push_back，字符串使用长度前缀，解码时逐字段解析，
+ * 只能顺序访问。定长方式：批量一次性分配缓冲区，解码可以直接在缓冲区上通过视图读取。
+ *
+ * 用法：bench_codec [记录数]
+ */
+namespace {
+
+    void naiveEncode(const JobInfo& job, std::vector<uint8_t>& out) {
+        out.push_back(static_cast<uint8_t>(job.status));
+        for (size_t i = 0; i < 2; ++i) {
+            out.push_back(static_cast<uint8_t>(job.job_id.size() >> (8 * i)));
+        }
+        for (char c : job.job_id) {
+            out.push_back(static_cast<uint8_t>(c));
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            out.push_back(static_cast<uint8_t>(job.content_key.size() >> (8 * i)));
+        }
+        for (char c : job.content_key) {
+            out.push_back(static_cast<uint8_t>(c));
+        }
+    }
+
+    size_t naiveDecode(const uint8_t* p, JobInfo& job) {
+        const uint8_t* begin = p;
+        job.status = static_cast<JobStatus>(*p++);
+        size_t id_len = p[0] | (p[1] << 8);
+        p += 2;
+        job.job_id.assign(reinterpret_cast<const char*>(p), id_len);
+        p += id_len;
+        size_t key_len = p[0] | (p[1] << 8);
+        p += 2;
+        job.content_key.assign(reinterpret_cast<const char*>(p), key_len);
+        p += key_len;
+        return static_cast<size_t>(p - begin);
+    }
+
+    double elapsed(std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    void report(const char* name, size_t count, double seconds) {
+        std::cout << name << ": " << seconds * 1000 << " ms, "
+                  << static_cast<uint64_t>(count / seconds) << " records/s" << std::endl;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    std::vector<JobInfo> jobs;
+    jobs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        jobs.push_back(JobInfo{JobStatus::Queuing, "job-" + std::to_string(i),
+                               "tape" + std::to_string(i % 512) + ":/archive/object/" + std::to_string(i)});
+    }
+
+    // 编码缓冲区在热路径上会被复用，先各编码一轮预热缓冲区（排除首次缺页的开销），再计时
+    std::vector<uint8_t> naive;
+    std::vector<uint8_t> fixed;
+    for (const auto& job : jobs) {
+        naiveEncode(job, naive);
+    }
+    binary_codec::encodeJobInfos(jobs.data(), jobs.size(), fixed);
+
+    // 逐字段编码
+    naive.clear();
+    auto begin = std::chrono::steady_clock::now();
+    for (const auto& job : jobs) {
+        naiveEncode(job, naive);
+    }
+    report("naive encode", count, elapsed(begin));
+
+    // 定长批量编码
+    fixed.clear();
+    begin = std::chrono::steady_clock::now();
+    if (!binary_codec::encodeJobInfos(jobs.data(), jobs.size(), fixed)) {
+        std::cerr << "encode failed" << std::endl;
+        return 1;
+    }
+    report("fixed encode", count, elapsed(begin));
+
+    // 逐字段解码（与定长批量解码一样，输出到新的 vector）
+    std::vector<JobInfo> decoded;
+    begin = std::chrono::steady_clock::now();
+    decoded.reserve(count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        JobInfo job;
+        offset += naiveDecode(naive.data() + offset, job);
+        decoded.push_back(std::move(job));
+    }
+    report("naive decode", count, elapsed(begin));
+
+    // 定长批量解码（拷贝出 JobInfo）
+    std::vector<JobInfo> bulk;
+    begin = std::chrono::steady_clock::now();
+    if (!binary_codec::decodeJobInfos(fixed.data(), fixed.size(), bulk)) {
+        std::cerr << "decode failed" << std::endl;
+        return 1;
+    }
+    report("fixed decode", count, elapsed(begin));
+
+    // 零拷贝视图：只读取需要的字段
+    begin = std::chrono::steady_clock::now();
+    auto view = binary_codec::JobInfoArrayView::parse(fixed.data(), fixed.size());
+    size_t queuing = 0;
+    size_t id_bytes = 0;
+    for (size_t i = 0; i < view->size(); ++i) {
+        auto record = (*view)[i];
+        queuing += record.status() == JobStatus::Queuing;
+        id_bytes += record.jobId().size();
+    }
+    report("fixed view scan", count, elapsed(begin));
+
+    // 随机访问：定长记录 O(1) 定位，逐字段格式只能顺序解析
+    begin = std::chrono::steady_clock::now();
+    size_t probe = 0;
+    for (size_t i = 0; i < count; ++i) {
+        probe += (*view)[(i * 7919) % count].contentKey().size();
+    }
+    report("fixed view random access", count, elapsed(begin));
+
+    bool match = bulk.size() == decoded.size();
+    for (size_t i = 0; match && i < count; ++i) {
+        match = bulk[i].job_id == decoded[i].job_id && bulk[i].content_key == decoded[i].content_key;
+    }
+    std::cout << "bytes naive/fixed: " << naive.size() << "/" << fixed.size()
+              << ", queuing: " << queuing << ", id bytes: " << id_bytes << ", probe: " << probe
+              << ", round trip " << (match ? "ok" : "MISMATCH") << std::endl;
+
+    // TapeDrivesOperation 往返：所有编码字段（含后台标志）都要还原
+    std::vector<TapeDrivesOperation> ops;
+    for (size_t i = 0; i < 1000; ++i) {
+        TapeDrivesOperation op(i % 2 ? TypeOperation::READ_AGGR : TypeOperation::WRITE_AGGR,
+                               "T" + std::to_string(10000 + i % 97));
+        op.setPosition(i * 4096 + 17, static_cast<int>(i % 52) - 1);
+        op.setOperationId((1ULL << 62) + i);
+        op.setLength(i * 262144 + 5);
+        op.setBackground(i % 3 == 0);
+        ops.push_back(op);
+    }
+    std::vector<uint8_t> op_bytes;
+    std::vector<TapeDrivesOperation> op_decoded;
+    bool op_match = binary_codec::encodeTapeOperations(ops.data(), ops.size(), op_bytes) &&
+                    binary_codec::decodeTapeOperations(op_bytes.data(), op_bytes.size(), op_decoded) &&
+                    op_decoded.size() == ops.size();
+    for (size_t i = 0; op_match && i < ops.size(); ++i) {
+        const auto& a = ops[i];
+        const auto& b = op_decoded[i];
+        op_match = a.getTypeOperation() == b.getTypeOperation() && a.getTapeId() == b.getTapeId() &&
+                   a.getBlockPosition() == b.getBlockPosition() && a.getWrap() == b.getWrap() &&
+                   a.getOperationId() == b.getOperationId() && a.getLength() == b.getLength() &&
+                   a.isBackground() == b.isBackground();
+    }
+    std::cout << "tape operations: " << op_bytes.size() << " bytes, round trip " << (op_match ? "ok" : "MISMATCH")
+              << std::endl;
+    return match && op_match ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+#include "DataMover.hpp"
+#include "SpliceMover.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 聚合数据搬运基准测试：多路“暂存文件 -> 磁带文件”的复制，对比
+ * - blocking：每路一个线程，阻塞 pread/pwrite；
+ * - thread pool：DataMover + IoEngine 线程池后端；
+ * - io_uring：DataMover + IoEngine io_uring 后端（注册缓冲区、固定文件）；
+ * - io_uring O_DIRECT：同上，目标（磁带）一端使用 O_DIRECT；
+ * - splice：SpliceMover 经管道零拷贝，不经过用户态缓冲区。
+ * 每种方式完成后校验目标文件内容，并统计目标文件留在页缓存中的比例。
+ *
+ * 用法：bench_io [路数] [每路 MiB]
+ */
+namespace {
+
+    constexpr size_t kChunk = 1 << 20;
+
+    double elapsed(std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    std::string filePath(const std::string& dir, const char* kind, size_t stream) {
+        return dir + "/" + kind + "-" + std::to_string(stream);
+    }
+
+    std::vector<int> openAll(const std::string& dir, const char* kind, size_t streams, int flags) {
+        std::vector<int> fds;
+        for (size_t i = 0; i < streams; ++i) {
+            fds.push_back(open(filePath(dir, kind, i).c_str(), flags, 0644));
+        }
+        return fds;
+    }
+
+    void closeAll(const std::vector<int>& fds) {
+        for (int fd : fds) {
+            close(fd);
+        }
+    }
+
+    void blockingCopy(int src, int dst, uint64_t length) {
+        std::vector<uint8_t> buffer(kChunk);
+        for (uint64_t offset = 0; offset < length; offset += kChunk) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(kChunk, length - offset));
+            if (pread(src, buffer.data(), n, static_cast<off_t>(offset)) != static_cast<ssize_t>(n) ||
+                pwrite(dst, buffer.data(), n, static_cast<off_t>(offset)) != static_cast<ssize_t>(n)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * 目标文件驻留在页缓存中的比例。
+     */
+    double cachedFraction(const std::string& dir, size_t streams, uint64_t length) {
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t resident = 0, total = 0;
+        for (size_t i = 0; i < streams; ++i) {
+            int fd = open(filePath(dir, "tape", i).c_str(), O_RDONLY);
+            void* p = fd >= 0 ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+            if (p != MAP_FAILED) {
+                std::vector<unsigned char> pages((length + page - 1) / page);
+                if (mincore(p, length, pages.data()) == 0) {
+                    for (unsigned char v : pages) {
+                        resident += v & 1;
+                    }
+                }
+                total += pages.size();
+                munmap(p, length);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        return total > 0 ? static_cast<double>(resident) / total : 0.0;
+    }
+
+    bool verify(const std::string& dir, size_t streams, uint64_t length) {
+        std::vector<uint8_t> a(kChunk), b(kChunk);
+        for (size_t i = 0; i < streams; ++i) {
+            int src = open(filePath(dir, "staging", i).c_str(), O_RDONLY);
+            int dst = open(filePath(dir, "tape", i).c_str(), O_RDONLY);
+            bool same = src >= 0 && dst >= 0;
+            for (uint64_t offset = 0; same && offset < length; offset += kChunk) {
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(kChunk, length - offset));
+                same = pread(src, a.data(), n, static_cast<off_t>(offset)) == static_cast<ssize_t>(n) &&
+                       pread(dst, b.data(), n, static_cast<off_t>(offset)) == static_cast<ssize_t>(n) &&
+                       memcmp(a.data(), b.data(), n) == 0;
+            }
+            close(src);
+            close(dst);
+            unlink(filePath(dir, "tape", i).c_str());
+            if (!same) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool report(const char* name, const std::string& dir, size_t streams, uint64_t length, double seconds) {
+        const double cached = cachedFraction(dir, streams, length);
+        const bool ok = verify(dir, streams, length);
+        std::cout << name << ": " << seconds * 1000 << " ms, "
+                  << static_cast<uint64_t>(streams * length / seconds / (1 << 20)) << " MiB/s, "
+                  << static_cast<int>(cached * 100) << "% of output in page cache"
+                  << (ok ? "" : " (DATA MISMATCH)") << std::endl;
+        return ok;
+    }
+
+    bool runMover(const char* name, IoEngine::Backend backend, bool direct, const std::string& dir, size_t streams,
+                  uint64_t length) {
+        DataMover::Config config;
+        config.chunk_size = kChunk;
+        config.engine.backend = backend;
+        DataMover mover(config);
+        std::vector<int> src = openAll(dir, "staging", streams, O_RDONLY);
+        std::vector<int> dst = openAll(dir, "tape", streams, O_RDWR | O_CREAT | O_TRUNC);
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < streams; ++i) {
+            DataMover::Transfer transfer{src[i], 0, dst[i], 0, length, nullptr};
+            transfer.dst_direct = direct;
+            mover.add(std::move(transfer));
+        }
+        const bool ok = mover.run();
+        const double seconds = elapsed(begin);
+        closeAll(src);
+        closeAll(dst);
+        const bool verified = report(name, dir, streams, length, seconds);
+        auto engine = mover.engineStats();
+        std::cout << "  " << mover.stats().chunks << " chunks, " << engine.completed << " requests ("
+                  << mover.stats().direct_requests << " O_DIRECT), " << engine.enter_calls << " io_uring_enter calls"
+                  << std::endl;
+        return verified && ok;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    const size_t streams = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    const uint64_t length = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 32) << 20;
+
+    char dir_template[] = "/tmp/bench_io.XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        std::cerr << "mkdtemp failed" << std::endl;
+        return 1;
+    }
+    const std::string dir = dir_template;
+
+    // 准备暂存文件
+    std::vector<uint8_t> data(kChunk);
+    uint64_t state = 88172645463325252ULL;
+    std::vector<int> src = openAll(dir, "staging", streams, O_WRONLY | O_CREAT | O_TRUNC);
+    for (size_t i = 0; i < streams; ++i) {
+        for (uint64_t offset = 0; offset < length; offset += kChunk) {
+            for (size_t j = 0; j < data.size(); j += 8) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                memcpy(&data[j], &state, 8);
+            }
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(kChunk, length - offset));
+            if (pwrite(src[i], data.data(), n, static_cast<off_t>(offset)) != static_cast<ssize_t>(n)) {
+                std::cerr << "prepare failed" << std::endl;
+                return 1;
+            }
+        }
+    }
+    closeAll(src);
+    std::cout << streams << " streams x " << (length >> 20) << " MiB" << std::endl;
+
+    bool ok = true;
+    {
+        src = openAll(dir, "staging", streams, O_RDONLY);
+        std::vector<int> dst = openAll(dir, "tape", streams, O_RDWR | O_CREAT | O_TRUNC);
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < streams; ++i) {
+            threads.emplace_back(blockingCopy, src[i], dst[i], length);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const double seconds = elapsed(begin);
+        closeAll(src);
+        closeAll(dst);
+        ok = report("blocking, thread per stream", dir, streams, length, seconds) && ok;
+    }
+    ok = runMover("thread pool", IoEngine::Backend::ThreadPool, false, dir, streams, length) && ok;
+    {
+        DataMover probe;
+        if (probe.backend() == IoEngine::Backend::IoUring) {
+            ok = runMover("io_uring", IoEngine::Backend::IoUring, false, dir, streams, length) && ok;
+            ok = runMover("io_uring O_DIRECT", IoEngine::Backend::IoUring, true, dir, streams, length) && ok;
+        } else {
+            std::cout << "io_uring: not available" << std::endl;
+        }
+    }
+
+    {
+        SpliceMover mover;
+        src = openAll(dir, "staging", streams, O_RDONLY);
+        std::vector<int> dst = openAll(dir, "tape", streams, O_RDWR | O_CREAT | O_TRUNC);
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < streams; ++i) {
+            ok = mover.transfer(DataMover::Transfer{src[i], 0, dst[i], 0, length, nullptr}) ==
+                 static_cast<int64_t>(length) && ok;
+        }
+        const double seconds = elapsed(begin);
+        closeAll(src);
+        closeAll(dst);
+        ok = report("splice", dir, streams, length, seconds) && ok;
+        auto stats = mover.stats();
+        std::cout << "  " << stats.splice_calls << " splice calls, " << stats.fallback_bytes << " bytes copied"
+                  << std::endl;
+    }
+
+    for (size_t i = 0; i < streams; ++i) {
+        unlink(filePath(dir, "staging", i).c_str());
+    }
+    rmdir(dir.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "JobServer.hpp"
+#include "JobClient.hpp"
+#include "shared/thread/Thread.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace job_protocol;
+
+/**
+ * 任务提交服务端的负载生成器。
+ *
+ * 用法：bench_job_server [请求总数] [流水线深度] [套接字路径]
+ * - 未指定套接字路径时，在本进程内启动 JobServer；
+ * - 请求按 Enqueue -> Status -> Cancel 循环，覆盖入队、查询和取消路径。
+ */
+int main(int argc, char* argv[]) {
+    const size_t total = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300000;
+    const size_t depth = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 128;
+    const std::string path = argc > 3 ? argv[3] : "/tmp/bench_job_server.sock";
+    const bool embedded = argc <= 3;
+
+    JobServer server(path);
+    Thread serverThread([&server] { server.loop(); });
+    if (embedded) {
+        if (!server.start()) {
+            return 1;
+        }
+        serverThread.start();
+    }
+
+    JobClient client;
+    if (!client.connect(path)) {
+        return 1;
+    }
+
+    size_t sent = 0;
+    size_t received = 0;
+    size_t errors = 0;
+    Response response;
+    auto begin = std::chrono::steady_clock::now();
+
+    while (received < total) {
+        // 保持 depth 个请求在途
+        while (sent < total && sent - received < depth) {
+            const size_t job = sent / 3;
+            Request request;
+            request.request_id = static_cast<uint32_t>(sent);
+            request.job_id = "bench-" + std::to_string(job);
+            request.status = JobStatus::Queuing;
+            switch (sent % 3) {
+                case 0:
+                    request.opcode = JobOpcode::Enqueue;
+                    request.content_key = "tape" + std::to_string(job % 64) + ":/obj/" + std::to_string(job);
+                    break;
+                case 1:
+                    request.opcode = JobOpcode::Status;
+                    break;
+                default:
+                    request.opcode = JobOpcode::Cancel;
+                    break;
+            }
+            client.send(request);
+            ++sent;
+        }
+        if (!client.flush()) {
+            return 1;
+        }
+        // 读回一半在途请求的响应后再补发，保持流水线不断流
+        size_t target = received + (sent - received + 1) / 2;
+        while (received < target) {
+            if (!client.receive(response)) {
+                std::cerr << "connection closed" << std::endl;
+                return 1;
+            }
+            if (response.result != ResultCode::Ok) {
+                ++errors;
+            }
+            ++received;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    std::cout << "requests: " << total
+              << ", pipeline depth: " << depth
+              << ", errors: " << errors
+              << ", elapsed: " << seconds << " s"
+              << ", throughput: " << static_cast<uint64_t>(total / seconds) << " req/s" << std::endl;
+
+    if (embedded) {
+        server.stop();
+        serverThread.join();
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+#include "SimTapeLibrary.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 仿真磁带库基准测试：在虚拟时钟上重放同一份随机召回负载，比较不同驱动器数量下的吞吐和延迟。
+ *
+ * 随后在热点偏斜（Zipf）负载上比较各换带替换策略的装载次数，
+ * 并在 16 个驱动器、机械手成为瓶颈的负载上比较机械手调度策略，以及加入后台 ROLL_TAPE 维护后召回延迟是否受影响。
+ * 然后在暂存盘慢于驱动器的情况下连续写带，比较不同流式缓冲区配置下的停带次数和写带吞吐。
+ * 负载由固定种子生成，结果可复现。之后检查多个驱动器等待另一个空闲驱动器中的同一盘磁带时都能依次拿到，
+ * 并检查机械手调度器只把先卸后装合并为交换，最后用文件后端经由流式缓冲区写入一个聚合并读回，检查数据一致。
+ *
+ * 用法：bench_tape_library [召回数] [磁带数]
+ */
+namespace {
+
+    std::vector<SimTapeLibrary::Arrival> makeWorkload(size_t reads, size_t tapes, uint64_t read_length,
+                                                      double zipf = 0.0) {
+        std::mt19937_64 rng(42);
+        std::exponential_distribution<double> gap(1.0 / 5.0); // 平均每 5 秒到达一个召回
+        std::vector<double> weights;
+        for (size_t i = 0; i < tapes; ++i) {
+            weights.push_back(1.0 / std::pow(static_cast<double>(i + 1), zipf)); // zipf 为 0 时均匀分布
+        }
+        std::discrete_distribution<size_t> tape(weights.begin(), weights.end());
+        std::uniform_int_distribution<uint64_t> block(0, 208ULL * 180000 - 1);
+
+        std::vector<SimTapeLibrary::Arrival> arrivals;
+        double time = 0.0;
+        for (size_t i = 0; i < reads; ++i) {
+            time += gap(rng);
+            TapeDrivesOperation op(TypeOperation::READ_AGGR, "T" + std::to_string(10000 + tape(rng)));
+            op.setPosition(block(rng));
+            op.setLength(read_length);
+            arrivals.push_back(SimTapeLibrary::Arrival{time, op});
+        }
+        return arrivals;
+    }
+
+    void runScenario(size_t drives, const std::vector<SimTapeLibrary::Arrival>& arrivals) {
+        SimTapeLibrary::Config config;
+        config.drive_count = drives;
+        SimTapeLibrary library(config);
+        DrivePool pool(drives);
+        SimTapeLibrary::Stats stats = library.run(pool, arrivals);
+
+        const double hours = stats.makespan / 3600.0;
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(6) << drives
+                  << std::setw(12) << hours
+                  << std::setw(12) << stats.completed / hours
+                  << std::setw(12) << stats.total_latency / stats.completed
+                  << std::setw(12) << stats.max_latency
+                  << std::setw(8) << stats.loads
+                  << std::setw(12) << stats.locate_seconds / stats.reads
+                  << std::setw(10) << 100.0 * stats.changer.busy_seconds / stats.makespan << "%"
+                  << std::endl;
+    }
+
+    void runPolicy(const char* name, MountCache::Policy policy, const std::vector<SimTapeLibrary::Arrival>& arrivals) {
+        SimTapeLibrary::Config config;
+        SimTapeLibrary library(config);
+        DrivePool pool(config.drive_count);
+        pool.setEvictionPolicy(policy);
+        SimTapeLibrary::Stats stats = library.run(pool, arrivals);
+        MountCache::Stats cache = pool.mountCache().stats();
+
+        const double gib = static_cast<double>(stats.bytes_read) / (1ULL << 30);
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(12) << name
+                  << std::setw(8) << stats.loads
+                  << std::setw(12) << std::setprecision(3) << stats.loads / gib
+                  << std::setw(10) << std::setprecision(1) << 100.0 * cache.hits / (cache.hits + cache.misses) << "%"
+                  << std::setw(12) << stats.total_latency / stats.completed
+                  << std::setw(10) << stats.makespan / 3600.0
+                  << std::endl;
+    }
+
+    void runChanger(const char* name, ChangerScheduler::Policy policy, bool pair,
+                    const std::vector<SimTapeLibrary::Arrival>& arrivals) {
+        SimTapeLibrary::Config config;
+        config.drive_count = 16;
+        config.changer.policy = policy;
+        config.changer.pair_exchanges = pair;
+        SimTapeLibrary library(config);
+        DrivePool pool(config.drive_count);
+        pool.setEvictionPolicy(MountCache::Policy::LeastLoaded); // 只比较机械手调度
+        SimTapeLibrary::Stats stats = library.run(pool, arrivals);
+        const ChangerScheduler::Stats& changer = stats.changer;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(16) << name
+                  << std::setw(8) << changer.moves
+                  << std::setw(11) << changer.exchanges
+                  << std::setw(9) << 100.0 * changer.utilization() << "%"
+                  << std::setw(14) << changer.total_mount_latency / changer.mounts
+                  << std::setw(12) << changer.max_mount_latency
+                  << std::setw(12) << stats.total_latency / stats.completed
+                  << std::setw(10) << stats.makespan / 3600.0
+                  << std::endl;
+    }
+
+    void runMaintenance(const char* name, const std::vector<SimTapeLibrary::Arrival>& arrivals) {
+        SimTapeLibrary::Config config;
+        SimTapeLibrary library(config);
+        DrivePool pool(config.drive_count);
+        SimTapeLibrary::Stats stats = library.run(pool, arrivals);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(16) << name
+                  << std::setw(12) << stats.total_latency / stats.completed
+                  << std::setw(12) << stats.max_latency
+                  << std::setw(8) << stats.loads
+                  << std::setw(13) << stats.maintenance_completed
+                  << std::setw(13) << stats.preemptions
+                  << std::setw(10) << stats.makespan / 3600.0
+                  << std::endl;
+    }
+
+    /**
+     * 暂存盘以 staging 带宽向一个驱动器连续提供 1 GiB 的聚合，数据经由驱动器的流式缓冲区写带。
+     */
+    void runStreaming(const char* name, double staging, size_t capacity, double start_fill, double resume_fill) {
+        SimTapeLibrary::Config config;
+        config.drive_count = 1;
+        config.staging_bandwidth = staging;
+        SimTapeLibrary library(config);
+        DrivePool pool(config.drive_count);
+        StreamBuffer::Config buffer;
+        buffer.capacity = capacity;
+        buffer.start_fill = start_fill;
+        buffer.resume_fill = resume_fill;
+        pool.setStreamBuffer(buffer);
+
+        std::vector<SimTapeLibrary::Arrival> arrivals;
+        for (int i = 0; i < 16; ++i) {
+            TapeDrivesOperation write(TypeOperation::WRITE_AGGR, "W00001");
+            write.setLength(1ULL << 30);
+            arrivals.push_back(SimTapeLibrary::Arrival{0.0, write});
+        }
+        double writing = 0.0;
+        SimTapeLibrary::Stats stats = library.run(pool, arrivals, [&](size_t, const TapeDrivesOperation& op,
+                                                                      const SimTapeLibrary::Result& result) {
+            if (op.getTypeOperation() == TypeOperation::WRITE_AGGR) {
+                writing += result.finish - result.start;
+            }
+        });
+        const StreamBuffer::Metrics metrics = pool.streamMetrics().at(0);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(16) << name
+                  << std::setw(10) << std::setprecision(2) << static_cast<double>(capacity) / (1 << 20)
+                  << std::setw(8) << std::setprecision(1) << start_fill
+                  << std::setw(11) << stats.underruns
+                  << std::setw(8) << metrics.starts
+                  << std::setw(12) << static_cast<double>(stats.bytes_written) / writing / 1e6
+                  << std::endl;
+    }
+
+    /**
+     * 驱动器 0 装着 X00001 且没有其他操作，驱动器 1、2 的队列里都有 X00001 的读：
+     * 驱动器 0 让出磁带后驱动器 1、2 依次装载，run() 结束时没有剩余操作。
+     */
+    bool sharedTape() {
+        SimTapeLibrary::Config config;
+        config.drive_count = 3;
+        SimTapeLibrary library(config);
+        DrivePool pool(config.drive_count);
+        library.execute(0, TapeDrivesOperation(TypeOperation::LOAD_TAPE, "X00001"));
+        pool.drive(0).setMountedTape("X00001");
+        for (size_t drive_id : {1, 2}) {
+            TapeDrivesOperation read(TypeOperation::READ_AGGR, "X00001");
+            read.setLength(64ULL << 20);
+            pool.drive(drive_id).submit(read);
+        }
+        std::vector<size_t> readers;
+        SimTapeLibrary::Stats stats = library.run(pool, {}, [&](size_t drive_id, const TapeDrivesOperation& op,
+                                                                const SimTapeLibrary::Result&) {
+            if (op.getTypeOperation() == TypeOperation::READ_AGGR) {
+                readers.push_back(drive_id);
+            }
+        });
+        bool ok = stats.stranded == 0 && readers == std::vector<size_t>{1, 2};
+        std::cout << "shared tape: " << readers.size() << " reads on drives waiting for X00001, "
+                  << stats.stranded << " stranded" << (ok ? "" : " (FAILED)") << std::endl;
+        return ok;
+    }
+
+    /**
+     * 驱动器 0 先装后卸，驱动器 1 先卸后装：只有驱动器 1 的两次搬运合并为交换，
+     * 驱动器 0 的装带和卸带按提交顺序分别执行。
+     */
+    bool changerOrder() {
+        ChangerScheduler changer;
+        auto submit = [&](ChangerScheduler::MoveType type, int drive_id, const std::string& tape, double time) {
+            ChangerScheduler::Move move;
+            move.type = type;
+            move.drive_id = drive_id;
+            (type == ChangerScheduler::MoveType::Load ? move.load_tape : move.unload_tape) = tape;
+            move.requested = time;
+            move.load_requested = time;
+            move.drive_ready = time;
+            changer.submit(move);
+        };
+        submit(ChangerScheduler::MoveType::Load, 0, "C00001", 0.0);
+        submit(ChangerScheduler::MoveType::Unload, 0, "C00001", 1.0);
+        submit(ChangerScheduler::MoveType::Unload, 1, "C00002", 2.0);
+        submit(ChangerScheduler::MoveType::Load, 1, "C00003", 3.0);
+
+        std::vector<ChangerScheduler::MoveType> drive0;
+        std::vector<ChangerScheduler::MoveType> drive1;
+        while (auto plan = changer.dispatch(0.0)) {
+            (plan->move.drive_id == 0 ? drive0 : drive1).push_back(plan->move.type);
+        }
+        bool ok = drive0 == std::vector<ChangerScheduler::MoveType>{ChangerScheduler::MoveType::Load,
+                                                                    ChangerScheduler::MoveType::Unload} &&
+                  drive1 == std::vector<ChangerScheduler::MoveType>{ChangerScheduler::MoveType::Exchange};
+        std::cout << "changer order: load then unload kept as " << drive0.size() << " moves, unload then load as "
+                  << drive1.size() << " exchange" << (ok ? "" : " (FAILED)") << std::endl;
+        return ok;
+    }
+
+    bool fileBackedRoundTrip() {
+        char dir[] = "/tmp/sim_tape_XXXXXX";
+        if (!mkdtemp(dir)) {
+            return false;
+        }
+        SimTapeLibrary::Config config;
+        config.drive_count = 1;
+        config.directory = dir;
+        config.staging_bandwidth = 200e6;
+        SimTapeLibrary library(config);
+        StreamBuffer::Config buffer_config;
+        buffer_config.capacity = config.block_size; // 比聚合小，数据必须分多次经过缓冲区
+        StreamBuffer buffer(buffer_config);
+
+        auto aggregate = std::make_shared<AggregateInfo>();
+        aggregate->aggregate_id = 1;
+        auto payload = std::make_shared<std::vector<uint8_t>>(3 * config.block_size / 2);
+        for (size_t i = 0; i < payload->size(); ++i) {
+            (*payload)[i] = static_cast<uint8_t>(i * 7);
+        }
+        aggregate->payload = payload;
+        TapeDrivesOperation write(TypeOperation::WRITE_AGGR, "F00001");
+        write.setAggregate(aggregate);
+
+        library.execute(0, TapeDrivesOperation(TypeOperation::LOAD_TAPE, "F00001"));
+        library.execute(0, write, &buffer);
+        SimTapeLibrary::Result written = library.execute(0, write, &buffer); // 第二个聚合追加在第一个之后
+        TapeDrivesOperation read(TypeOperation::READ_AGGR, "F00001");
+        read.setPosition(written.block_position);
+        read.setLength(payload->size());
+        SimTapeLibrary::Result result = library.execute(0, read);
+        library.execute(0, TapeDrivesOperation(TypeOperation::UNLOAD_TAPE, "F00001"));
+
+        bool ok = result.ok && written.block_position == 2 && result.data == *payload &&
+                  buffer.metrics().bytes_out == 2 * payload->size();
+        std::cout << "file-backed round trip: aggregate at block " << written.block_position << ", "
+                  << (ok ? "data verified" : "MISMATCH") << ", finished at " << std::setprecision(1)
+                  << result.finish << "s (virtual)" << std::endl;
+        unlink((std::string(dir) + "/F00001.tape").c_str());
+        rmdir(dir);
+        return ok;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t reads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    size_t tapes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 40;
+    auto arrivals = makeWorkload(reads, tapes, 64ULL << 20);
+
+    std::cout << reads << " recalls of 64 MiB over " << tapes << " tapes" << std::endl;
+    std::cout << std::setw(6) << "drives" << std::setw(12) << "hours" << std::setw(12) << "recalls/h"
+              << std::setw(12) << "avg lat s" << std::setw(12) << "max lat s" << std::setw(8) << "mounts"
+              << std::setw(12) << "locate/rd s" << std::setw(11) << "robot" << std::endl;
+    for (size_t drives : {1, 2, 4, 8}) {
+        runScenario(drives, arrivals);
+    }
+
+    auto skewed = makeWorkload(reads, tapes, 64ULL << 20, 1.1);
+    std::cout << std::endl << "eviction policies, 4 drives, zipf(1.1) tape popularity" << std::endl;
+    std::cout << std::setw(12) << "policy" << std::setw(8) << "mounts" << std::setw(12) << "mounts/GiB"
+              << std::setw(11) << "hit rate" << std::setw(12) << "avg lat s" << std::setw(10) << "hours" << std::endl;
+    runPolicy("least-loaded", MountCache::Policy::LeastLoaded, skewed);
+    runPolicy("lru", MountCache::Policy::Lru, skewed);
+    runPolicy("pending", MountCache::Policy::PendingWork, skewed);
+    runPolicy("cost", MountCache::Policy::CostBased, skewed);
+
+    // 大量磁带、短召回：换带频繁，机械手成为瓶颈
+    auto mount_heavy = makeWorkload(reads, 400, 64ULL << 20);
+    std::cout << std::endl << "changer scheduling, 16 drives, 400 tapes" << std::endl;
+    std::cout << std::setw(16) << "changer" << std::setw(8) << "moves" << std::setw(11) << "exchanges"
+              << std::setw(10) << "robot" << std::setw(14) << "mount lat s" << std::setw(12) << "max mount"
+              << std::setw(12) << "avg lat s" << std::setw(10) << "hours" << std::endl;
+    runChanger("fifo", ChangerScheduler::Policy::Fifo, false, mount_heavy);
+    runChanger("shortest", ChangerScheduler::Policy::ShortestTravel, false, mount_heavy);
+    runChanger("fifo+exchange", ChangerScheduler::Policy::Fifo, true, mount_heavy);
+    runChanger("shortest+exch", ChangerScheduler::Policy::ShortestTravel, true, mount_heavy);
+
+    // 每盘磁带一次卷带维护，与召回同时开始提交
+    auto maintained = arrivals;
+    for (size_t i = 0; i < tapes; ++i) {
+        TapeDrivesOperation roll(TypeOperation::ROLL_TAPE, "T" + std::to_string(10000 + i));
+        maintained.push_back(SimTapeLibrary::Arrival{arrivals[i].time, roll});
+    }
+    std::cout << std::endl << "background ROLL_TAPE, 4 drives, one roll per tape" << std::endl;
+    std::cout << std::setw(16) << "workload" << std::setw(12) << "avg lat s" << std::setw(12) << "max lat s"
+              << std::setw(8) << "mounts" << std::setw(13) << "maintenance" << std::setw(13) << "preemptions"
+              << std::setw(10) << "hours" << std::endl;
+    runMaintenance("recalls only", arrivals);
+    runMaintenance("with rolls", maintained);
+
+    // 暂存盘 200 MB/s，驱动器 360 MB/s：不等填充就写带时几乎每块都停带
+    std::cout << std::endl << "streaming writes, 16 x 1 GiB, staging 200 MB/s, drive 360 MB/s" << std::endl;
+    std::cout << std::setw(16) << "buffer" << std::setw(10) << "MiB" << std::setw(8) << "start"
+              << std::setw(11) << "underruns" << std::setw(8) << "starts" << std::setw(12) << "MB/s" << std::endl;
+    runStreaming("source keeps up", 0.0, 64 << 20, 0.0, 0.0);
+    runStreaming("one block", 200e6, 256 << 10, 0.0, 0.0);
+    runStreaming("no threshold", 200e6, 64 << 20, 0.0, 0.0);
+    runStreaming("start at 50%", 200e6, 64 << 20, 0.5, 0.25);
+    runStreaming("256 MiB, 50%", 200e6, 256 << 20, 0.5, 0.25);
+
+    std::cout << std::endl;
+    bool ok = sharedTape();
+    ok = changerOrder() && ok;
+    ok = fileBackedRoundTrip() && ok;
+    return ok ? 0 : 1;
+}
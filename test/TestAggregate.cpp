@@ -0,0 +1,126 @@
+#include "WriteAggregator.hpp"
+#include "ReadCoalescer.hpp"
+#include "Thread.hpp"
+#include <iostream>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+    void print(const TapeDrivesOperation& op) {
+        auto aggregate = op.getAggregate();
+        std::cout << "WRITE_AGGR(" << op.getTapeId() << ") aggregate " << aggregate->aggregate_id
+                  << ", " << aggregate->payload->size() << " bytes:";
+        for (const auto& member : aggregate->members) {
+            std::cout << " " << member.object_key << "@" << member.offset << "+" << member.length;
+        }
+        std::cout << std::endl;
+    }
+
+}
+
+int main() {
+    // 写聚合：按目标大小封口，超时封口，超大对象单独成聚合
+    {
+        WriteAggregator::Config config;
+        config.target_size = 1000;
+        config.max_latency = std::chrono::milliseconds(50);
+        config.tape_id = "W00001";
+        WriteAggregator aggregator(config, print);
+
+        std::vector<uint8_t> data(300, 0xAB);
+        for (int i = 0; i < 5; ++i) {
+            aggregator.add("job-" + std::to_string(i % 2), "obj" + std::to_string(i), data.data(), data.size());
+        }
+        usleep(200 * 1000); // 等待定时线程封口剩余的对象
+
+        std::vector<uint8_t> big(2500, 0xCD);
+        aggregator.add("job-2", "big", big.data(), big.size());
+        aggregator.add("job-2", "tail", data.data(), 10);
+        std::cout << "emitted before destruction: " << aggregator.aggregatesEmitted() << std::endl;
+    }
+
+    // 多线程并发封口：sink 收到的聚合 ID 必须严格递增
+    {
+        WriteAggregator::Config config;
+        config.target_size = 64;
+        config.max_latency = std::chrono::milliseconds(1000);
+        config.tape_id = "W00002";
+        uint64_t last_id = 0;
+        size_t received = 0;
+        bool ordered = true;
+        WriteAggregator aggregator(config, [&](const TapeDrivesOperation& op) {
+            const uint64_t id = op.getAggregate()->aggregate_id;
+            ordered = ordered && (received == 0 || id > last_id);
+            last_id = id;
+            ++received;
+            usleep(10); // 拉长 sink，让其他线程在发出期间封口
+        });
+
+        std::vector<uint8_t> data(64, 0xEF);
+        std::vector<std::unique_ptr<Thread>> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back(new Thread([&aggregator, &data, t] {
+                for (int i = 0; i < 500; ++i) {
+                    aggregator.add("job-" + std::to_string(t), "o" + std::to_string(i), data.data(), data.size());
+                }
+            }));
+            threads.back()->start();
+        }
+        for (auto& thread : threads) {
+            thread->join();
+        }
+        aggregator.flush();
+        std::cout << "concurrent seals: " << received << " aggregates, "
+                  << (ordered ? "in order" : "OUT OF ORDER") << std::endl;
+        if (!ordered || received != 2000) {
+            return 1;
+        }
+    }
+
+    // 读合并：同一聚合与相邻聚合合并为一次读，已发出的读直接挂载新请求
+    {
+        std::vector<TapeDrivesOperation> reads;
+        ReadCoalescer::Config config;
+        config.block_size = 100;
+        config.window = std::chrono::milliseconds(10000);
+        ReadCoalescer coalescer(config, [&reads](const TapeDrivesOperation& op) { reads.push_back(op); });
+
+        auto deliver = [](const std::string& job_id) {
+            return [job_id](bool ok, const uint8_t* data, size_t length) {
+                std::cout << "  " << job_id << ": " << (ok ? "ok" : "failed");
+                if (ok) {
+                    std::cout << " " << length << " bytes, first=" << static_cast<int>(data[0]);
+                }
+                std::cout << std::endl;
+            };
+        };
+        AggregateLocation a{"R00001", 1, 10, 250, std::nullopt};  // 块 10~12
+        AggregateLocation b{"R00001", 2, 13, 100, std::nullopt};  // 块 13，与 a 相邻
+        AggregateLocation c{"R00001", 3, 40, 100, std::nullopt};  // 块 40，不相邻
+        coalescer.read("job-a1", a, 0, 50, deliver("job-a1"));
+        coalescer.read("job-a2", a, 200, 50, deliver("job-a2"));
+        coalescer.read("job-b", b, 10, 20, deliver("job-b"));
+        coalescer.read("job-c", c, 0, 100, deliver("job-c"));
+        coalescer.read("job-bad", c, 90, 20, deliver("job-bad"));
+        coalescer.flush();
+        coalescer.read("job-a3", a, 100, 10, deliver("job-a3")); // 挂到已发出的读上
+
+        for (const auto& op : reads) {
+            std::cout << "READ_AGGR(" << op.getTapeId() << ") #" << op.getOperationId() << " block "
+                      << op.getBlockPosition() << " length " << op.getLength() << std::endl;
+            // 模拟驱动器读取：每个字节填写其所在的块号
+            std::vector<uint8_t> data(op.getLength());
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = static_cast<uint8_t>(op.getBlockPosition() + i / config.block_size);
+            }
+            coalescer.complete(op.getOperationId(), data.data(), data.size());
+        }
+        auto stats = coalescer.stats();
+        std::cout << "requests " << stats.requests << ", reads " << stats.reads_issued
+                  << ", aggregates " << stats.aggregates_read << ", attached " << stats.attached_inflight << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include "AggregateFormat.hpp"
+#include "Crc32c.hpp"
+#include "ReadCoalescer.hpp"
+#include "SimTapeLibrary.hpp"
+#include "WriteAggregator.hpp"
+#include "TestUtil.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace test_util;
+
+/**
+ * 聚合磁带格式测试：自描述聚合的生成与解析、只读末尾即可找到成员索引、索引和聚合头损坏的检测、
+ * 超长对象键被拒绝；
+ * 在落盘的仿真磁带库上不借助目录从磁带恢复成员索引，并对比读取整个聚合与只读成员所在块的传输量和耗时。
+ */
+namespace {
+
+    constexpr uint64_t kBlockSize = 256 * 1024;
+
+    std::vector<uint8_t> objectBytes(size_t index) {
+        return randomBytes(1000 + (index * 7919) % (400 * 1024), index * 0x9E3779B97F4A7C15ULL + 1);
+    }
+
+    std::vector<TapeDrivesOperation> makeAggregates(uint32_t alignment, size_t objects, uint64_t target_size) {
+        std::vector<TapeDrivesOperation> writes;
+        WriteAggregator::Config config;
+        config.target_size = target_size;
+        config.tape_id = "F00001";
+        config.self_describing = true;
+        config.alignment = alignment;
+        WriteAggregator aggregator(config, [&writes](const TapeDrivesOperation& op) { writes.push_back(op); });
+        for (size_t i = 0; i < objects; ++i) {
+            auto object = objectBytes(i);
+            aggregator.add("job-" + std::to_string(i % 3), "obj" + std::to_string(i), object.data(), object.size());
+        }
+        aggregator.flush();
+        return writes;
+    }
+
+    bool sameMembers(const std::vector<AggregateMember>& a, const std::vector<AggregateMember>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].object_key != b[i].object_key || a[i].job_id != b[i].job_id || a[i].offset != b[i].offset ||
+                a[i].length != b[i].length || a[i].checksum != b[i].checksum) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool verifyFormat() {
+        bool ok = true;
+        auto writes = makeAggregates(4096, 200, 64ULL << 20);
+        ok = check(writes.size() == 1, "one aggregate") && ok;
+        auto aggregate = writes.at(0).getAggregate();
+        const std::vector<uint8_t>& image = *aggregate->payload;
+        uint64_t data_bytes = 0;
+        for (const auto& member : aggregate->members) {
+            data_bytes += member.length;
+            ok = check(member.offset % 4096 == 0, "member alignment") && ok;
+            ok = check(crc32c::value(image.data() + member.offset, member.length) == member.checksum,
+                       "member data") && ok;
+        }
+        ok = check(crc32c::value(image.data(), image.size()) == aggregate->checksum, "aggregate checksum") && ok;
+        std::cout << aggregate->members.size() << " members, " << data_bytes << " data bytes, image "
+                  << image.size() << " bytes (" << (image.size() - data_bytes) * 100.0 / data_bytes
+                  << "% header, padding and index)" << std::endl;
+
+        AggregateFormat::Header header;
+        std::vector<AggregateMember> members;
+        ok = check(AggregateFormat::parse(image.data(), image.size(), header, members) &&
+                   header.aggregate_id == aggregate->aggregate_id && header.alignment == 4096 &&
+                   sameMembers(members, aggregate->members), "parse image") && ok;
+
+        // 只读最后 4 KiB 找到索引
+        const size_t tail = 4096;
+        uint64_t index_offset, index_length;
+        uint32_t index_checksum;
+        ok = check(AggregateFormat::parseTrailer(image.data() + image.size() - tail, tail, index_offset, index_length,
+                                                 index_checksum) &&
+                   index_offset == header.index_offset && index_length == header.index_length, "trailer") && ok;
+        ok = check(AggregateFormat::parseIndex(image.data() + index_offset, index_length, index_checksum, members) &&
+                   sameMembers(members, aggregate->members), "index from trailer") && ok;
+
+        std::vector<uint8_t> broken(image.begin() + index_offset, image.begin() + index_offset + index_length);
+        broken[broken.size() / 2] ^= 0x10;
+        ok = check(!AggregateFormat::parseIndex(broken.data(), broken.size(), index_checksum, members),
+                   "corrupted index rejected") && ok;
+        broken.assign(image.begin(), image.begin() + AggregateFormat::kHeaderSize);
+        broken[20] ^= 0x01;
+        ok = check(!AggregateFormat::parseHeader(broken.data(), broken.size(), header), "corrupted header rejected") && ok;
+        return ok;
+    }
+
+    /**
+     * 执行 READ_AGGR 并把结果交给合并器，返回虚拟耗时。
+     */
+    double serve(SimTapeLibrary& library, ReadCoalescer& coalescer, const std::vector<TapeDrivesOperation>& reads) {
+        double seconds = 0.0;
+        for (const auto& op : reads) {
+            SimTapeLibrary::Result result = library.execute(0, op);
+            seconds += result.finish - result.start;
+            if (result.ok) {
+                coalescer.complete(op.getOperationId(), result.data.data(), result.data.size());
+            } else {
+                coalescer.fail(op.getOperationId());
+            }
+        }
+        return seconds;
+    }
+
+    /**
+     * 最长的对象键可以写入并解析；更长的键被 finish() 和 WriteAggregator::add() 拒绝，而不是截断长度字段。
+     */
+    bool verifyKeyLength() {
+        bool ok = true;
+        const std::vector<uint8_t> object = randomBytes(100, 3);
+        AggregateMember member;
+        member.object_key.assign(AggregateFormat::kMaxKeyLength, 'k');
+        member.job_id = "job";
+        member.length = object.size();
+
+        std::vector<uint8_t> image;
+        AggregateFormat::begin(image, 4096);
+        member.offset = AggregateFormat::append(image, 4096, object.data(), object.size());
+        AggregateFormat::finish(image, 1, 4096, {member});
+        AggregateFormat::Header header;
+        std::vector<AggregateMember> members;
+        ok = check(AggregateFormat::parse(image.data(), image.size(), header, members) && members.size() == 1 &&
+                   members[0].object_key == member.object_key && members[0].job_id == "job", "longest key") && ok;
+
+        member.object_key.push_back('k');
+        AggregateFormat::begin(image, 4096);
+        member.offset = AggregateFormat::append(image, 4096, object.data(), object.size());
+        const size_t size = image.size();
+        bool rejected = false;
+        try {
+            AggregateFormat::finish(image, 2, 4096, {member});
+        } catch (const std::length_error&) {
+            rejected = true;
+        }
+        ok = check(rejected && image.size() == size, "finish rejects a key longer than kMaxKeyLength") && ok;
+
+        size_t written = 0;
+        {
+            WriteAggregator::Config config;
+            config.self_describing = true;
+            WriteAggregator aggregator(config, [&written](const TapeDrivesOperation&) { ++written; });
+            rejected = false;
+            try {
+                aggregator.add("job", member.object_key, object.data(), object.size());
+            } catch (const std::length_error&) {
+                rejected = true;
+            }
+            aggregator.flush();
+        }
+        ok = check(rejected && written == 0, "add rejects a key longer than kMaxKeyLength") && ok;
+        return ok;
+    }
+
+    bool verifyOnTape() {
+        bool ok = true;
+        char dir[] = "/tmp/aggr_format_XXXXXX";
+        if (!mkdtemp(dir)) {
+            return check(false, "mkdtemp");
+        }
+        SimTapeLibrary::Config config;
+        config.drive_count = 1;
+        config.block_size = kBlockSize;
+        config.directory = dir;
+        SimTapeLibrary library(config);
+        library.execute(0, TapeDrivesOperation(TypeOperation::LOAD_TAPE, "F00001"));
+
+        // 成员按磁带块对齐的 4 个聚合
+        auto writes = makeAggregates(kBlockSize, 600, 32ULL << 20);
+        std::vector<AggregateLocation> locations;
+        for (const auto& op : writes) {
+            SimTapeLibrary::Result result = library.execute(0, op);
+            auto aggregate = op.getAggregate();
+            locations.push_back(AggregateLocation{"F00001", aggregate->aggregate_id, result.block_position,
+                                                  aggregate->payload->size(), aggregate->checksum});
+        }
+        std::cout << writes.size() << " aggregates written to a file-backed tape" << std::endl;
+
+        // 没有目录：读聚合头所在的块，再按聚合头读成员索引
+        {
+            const AggregateLocation& location = locations.back();
+            TapeDrivesOperation read(TypeOperation::READ_AGGR, "F00001");
+            read.setPosition(location.block_position);
+            read.setLength(AggregateFormat::kHeaderSize);
+            SimTapeLibrary::Result head = library.execute(0, read);
+            AggregateFormat::Header header;
+            ok = check(head.ok && AggregateFormat::parseHeader(head.data.data(), head.data.size(), header),
+                       "header from tape") && ok;
+            read.setPosition(location.block_position + header.index_offset / kBlockSize);
+            read.setLength(header.index_offset % kBlockSize + header.index_length + AggregateFormat::kTrailerSize);
+            SimTapeLibrary::Result index = library.execute(0, read);
+            uint64_t index_offset, index_length;
+            uint32_t index_checksum;
+            std::vector<AggregateMember> members;
+            ok = check(index.ok &&
+                       AggregateFormat::parseTrailer(index.data.data(), index.data.size(), index_offset, index_length,
+                                                     index_checksum) &&
+                       AggregateFormat::parseIndex(index.data.data() + header.index_offset % kBlockSize, index_length,
+                                                   index_checksum, members) &&
+                       sameMembers(members, writes.back().getAggregate()->members), "index from tape") && ok;
+            std::cout << "recovered " << members.size() << " members of aggregate " << header.aggregate_id
+                      << " from tape with " << head.bytes + index.bytes << " bytes read" << std::endl;
+        }
+
+        // 每个聚合读中间的一个成员，第一个聚合再读紧随其后的成员：整个聚合 vs 只读成员所在的块
+        for (bool member_reads : {false, true}) {
+            std::vector<TapeDrivesOperation> reads;
+            ReadCoalescer::Config coalescer_config;
+            coalescer_config.block_size = kBlockSize;
+            coalescer_config.window = std::chrono::milliseconds(10000);
+            coalescer_config.member_reads = member_reads;
+            ReadCoalescer coalescer(coalescer_config, [&reads](const TapeDrivesOperation& op) { reads.push_back(op); });
+            size_t delivered = 0;
+            size_t requested = 0;
+            for (size_t a = 0; a < writes.size(); ++a) {
+                const auto& members = writes[a].getAggregate()->members;
+                for (size_t pick = members.size() / 2; pick <= members.size() / 2 + (a == 0 ? 1 : 0); ++pick) {
+                    const AggregateMember& member = members[pick];
+                    const size_t index = std::stoul(member.object_key.substr(3));
+                    ++requested;
+                    coalescer.read("job", locations[a], member.offset, member.length,
+                                   [&delivered, index](bool result, const uint8_t* data, size_t length) {
+                                       auto expected = objectBytes(index);
+                                       delivered += result && length == expected.size() &&
+                                                    memcmp(data, expected.data(), length) == 0;
+                                   }, member.checksum);
+                }
+            }
+            coalescer.flush();
+            const double seconds = serve(library, coalescer, reads);
+            auto stats = coalescer.stats();
+            std::cout << (member_reads ? "member reads: " : "whole aggregates: ") << stats.reads_issued
+                      << " READ_AGGR, " << stats.bytes_read << " bytes, " << seconds << " s (virtual), delivered "
+                      << delivered << "/" << requested << std::endl;
+            ok = check(delivered == requested, "members delivered") && ok;
+        }
+
+        unlink((std::string(dir) + "/F00001.tape").c_str());
+        rmdir(dir);
+        return ok;
+    }
+
+}
+
+int main() {
+    bool ok = verifyFormat();
+    ok = verifyKeyLength() && ok;
+    ok = verifyOnTape() && ok;
+    std::cout << (ok ? "all checks passed" : "some checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
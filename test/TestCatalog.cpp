@@ -0,0 +1,167 @@
+#include "CatalogIndex.hpp"
+#include "JobIndexer.hpp"
+#include "JobQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 目录索引测试：按 WRITE_AGGR 完成的方式批量插入 20 万个对象（每个聚合 100 个成员），
+ * 期间多次写出段文件并触发归并；把部分对象重写到另一盘磁带，检查新位置覆盖旧位置；
+ * 重新打开目录后比较 1 万个键的逐个单点查找与批量查找的耗时和结果。
+ * 最后用 JobIndexer 并行索引一个 10 万对象的召回任务，检查计划按磁带分组、组内按位置排序，
+ * 任务转为 Queuing；含有缺失对象的任务转为 Failed。
+ */
+namespace {
+
+    constexpr size_t kObjects = 200000;
+    constexpr size_t kMembers = 100;
+
+    std::string objectKey(size_t i) {
+        return "bucket/object-" + std::to_string(1000000 + i);
+    }
+
+    uint32_t memberChecksum(size_t i) {
+        return static_cast<uint32_t>(i * 2654435761u);
+    }
+
+    AggregateInfo makeAggregate(uint64_t aggregate_id, size_t first) {
+        AggregateInfo aggregate;
+        aggregate.aggregate_id = aggregate_id;
+        for (size_t i = 0; i < kMembers; ++i) {
+            aggregate.members.push_back(AggregateMember{objectKey(first + i), "job", i * 4096, 4096,
+                                                        memberChecksum(first + i)});
+        }
+        return aggregate;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool verifyReopened(const std::string& dir) {
+        CatalogIndex catalog(dir);
+        bool ok = true;
+        std::mt19937_64 rng(7);
+        std::uniform_int_distribution<size_t> pick(0, kObjects + kObjects / 10); // 约 10% 不存在
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < 10000; ++i) {
+            keys.push_back(objectKey(pick(rng)));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::optional<CatalogEntry>> points;
+        for (const auto& key : keys) {
+            points.push_back(catalog.lookup(key));
+        }
+        const double point_seconds = seconds(start);
+        start = std::chrono::steady_clock::now();
+        auto batch = catalog.lookupBatch(keys);
+        const double batch_seconds = seconds(start);
+
+        size_t hits = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ok = ok && points[i].has_value() == batch[i].has_value() &&
+                 (!points[i] || (points[i]->tape_id == batch[i]->tape_id && points[i]->offset == batch[i]->offset));
+            hits += batch[i] ? 1 : 0;
+        }
+        auto moved = catalog.lookup(objectKey(42));
+        auto kept = catalog.lookup(objectKey(150042));
+        ok = ok && moved && moved->tape_id == "R00001" && moved->aggregate_id == 999999 && moved->offset == 42 * 4096;
+        ok = ok && kept && kept->tape_id == "T10007" && kept->block_position == 1500 * 16 &&
+             kept->aggregate_length == kMembers * 4096 && kept->length == 4096 &&
+             kept->checksum == memberChecksum(150042);
+
+        std::cout << "reopened with " << catalog.stats().segments << " segment(s), " << hits << "/" << keys.size()
+                  << " keys found" << std::endl;
+        std::cout << "10000 point lookups " << point_seconds * 1e3 << " ms, batched " << batch_seconds * 1e3 << " ms"
+                  << std::endl;
+        return ok;
+    }
+
+
+    bool verifyIndexing(const std::string& dir, size_t workers) {
+        CatalogIndex catalog(dir);
+        JobIndexer::Config config;
+        config.workers = workers;
+        JobIndexer indexer(catalog, config);
+        JobQueue& queue = JobQueue::getInstance();
+        const std::string job_id = "recall-" + std::to_string(workers);
+        queue.enqueue(JobManager(JobInfo{JobStatus::Starting, job_id, ""}));
+        queue.enqueue(JobManager(JobInfo{JobStatus::Starting, job_id + "-missing", ""}));
+
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < kObjects; i += 2) {
+            keys.push_back(objectKey(i));
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937_64(11));
+
+        auto start = std::chrono::steady_clock::now();
+        indexer.submit(job_id, keys);
+        indexer.submit(job_id + "-missing", {objectKey(1), "bucket/does-not-exist"});
+        indexer.waitIdle();
+        const double elapsed = seconds(start);
+
+        auto plan = indexer.takePlan(job_id);
+        auto failed = indexer.takePlan(job_id + "-missing");
+        bool ok = plan && failed && plan->status == JobStatus::Queuing && plan->objects == keys.size() &&
+                  plan->tapes.size() == 11 && queue.queryStatus(job_id) == JobStatus::Queuing &&
+                  failed->status == JobStatus::Failed && failed->missing.size() == 1 &&
+                  queue.queryStatus(job_id + "-missing") == JobStatus::Failed;
+        size_t operations = 0;
+        for (const auto& tape : plan ? plan->tapes : std::vector<JobIndexer::TapePlan>()) {
+            ok = ok && std::is_sorted(tape.reads.begin(), tape.reads.end(),
+                                      [](const JobIndexer::ObjectRead& a, const JobIndexer::ObjectRead& b) {
+                                          return a.location.block_position < b.location.block_position;
+                                      });
+            operations += tape.toOperations().size();
+        }
+        std::cout << "indexed " << keys.size() << " objects with " << workers << " worker(s) in " << elapsed * 1e3
+                  << " ms: " << (plan ? plan->tapes.size() : 0) << " tapes, " << operations << " READ_AGGR, "
+                  << indexer.stats().batches << " batches" << std::endl;
+        queue.dequeueByJobId(job_id);
+        queue.dequeueByJobId(job_id + "-missing");
+        return ok;
+    }
+
+}
+
+int main() {
+    char dir[] = "/tmp/catalog_XXXXXX";
+    if (!mkdtemp(dir)) {
+        return 1;
+    }
+    {
+        CatalogIndex::Config config;
+        config.memtable_limit = 25000;
+        config.max_segments = 4;
+        CatalogIndex catalog(dir, config);
+        for (size_t first = 0; first < kObjects; first += kMembers) {
+            catalog.insertAggregate("T" + std::to_string(10000 + first / 20000), first / kMembers * 16,
+                                    makeAggregate(first / kMembers + 1, first));
+        }
+        // 重新打包：前 100 个对象写到另一盘磁带
+        catalog.insertAggregate("R00001", 0, makeAggregate(999999, 0));
+        catalog.flush();
+        auto stats = catalog.stats();
+        std::cout << "inserted " << stats.inserts << ", flushes " << stats.flushes << ", compactions "
+                  << stats.compactions << ", segments " << stats.segments << std::endl;
+    }
+
+    bool ok = verifyReopened(dir);
+    ok = verifyIndexing(dir, 1) && ok;
+    ok = verifyIndexing(dir, 4) && ok;
+    std::cout << (ok ? "catalog verified" : "MISMATCH") << std::endl;
+
+    std::string cleanup = std::string("rm -rf ") + dir;
+    if (std::system(cleanup.c_str()) != 0) {
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include "Crc32c.hpp"
+#include "ReadCoalescer.hpp"
+#include "WriteAggregator.hpp"
+#include "TestUtil.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace test_util;
+
+/**
+ * CRC32C 测试：已知向量、硬件实现与查表实现一致、分段与拼接、吞吐量，
+ * 以及写聚合生成的成员校验和在读合并分发时发现数据损坏。
+ */
+namespace {
+
+    bool verifyImplementations() {
+        bool ok = true;
+        const char* digits = "123456789";
+        const auto* p = reinterpret_cast<const uint8_t*>(digits);
+        ok = check(crc32c::value(p, 9) == 0xE3069283, "known vector") && ok;
+        ok = check(crc32c::extendPortable(0, p, 9) == 0xE3069283, "known vector (portable)") && ok;
+
+        const std::vector<uint8_t> data = randomBytes(100000, 42);
+        for (size_t length : {0, 1, 7, 8, 9, 63, 4096, 12287, 12288, 12289, 40000, 99990}) {
+            for (size_t misalign = 0; misalign < 8; misalign += 3) {
+                const uint8_t* begin = data.data() + misalign;
+                const uint32_t crc = crc32c::value(begin, length);
+                ok = check(crc == crc32c::extendPortable(0, begin, length),
+                           "hardware == portable, length " + std::to_string(length)) && ok;
+                const size_t half = length / 3;
+                const uint32_t a = crc32c::value(begin, half);
+                const uint32_t b = crc32c::value(begin + half, length - half);
+                ok = check(crc32c::extend(a, begin + half, length - half) == crc, "extend") && ok;
+                ok = check(crc32c::combine(a, b, length - half) == crc, "combine") && ok;
+            }
+        }
+        return ok;
+    }
+
+    void throughput() {
+        const std::vector<uint8_t> data = randomBytes(64 << 20, 7);
+        auto measure = [&](uint32_t (*f)(uint32_t, const uint8_t*, size_t)) {
+            auto begin = std::chrono::steady_clock::now();
+            volatile uint32_t crc = f(0, data.data(), data.size());
+            (void)crc;
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            return data.size() / seconds / (1 << 30);
+        };
+        std::cout << "portable: " << measure(crc32c::extendPortable) << " GiB/s, " << crc32c::implementation()
+                  << ": " << measure(crc32c::extend) << " GiB/s" << std::endl;
+    }
+
+    bool verifyAggregates() {
+        bool ok = true;
+        std::vector<TapeDrivesOperation> writes;
+        {
+            WriteAggregator::Config config;
+            config.target_size = 1 << 20;
+            WriteAggregator aggregator(config, [&writes](const TapeDrivesOperation& op) { writes.push_back(op); });
+            for (size_t i = 0; i < 8; ++i) {
+                auto object = randomBytes(1000 + i * 313, i + 1);
+                aggregator.add("job", "obj" + std::to_string(i), object.data(), object.size());
+            }
+            aggregator.flush();
+        }
+        if (!check(writes.size() == 1, "one aggregate")) {
+            return false;
+        }
+        auto aggregate = writes[0].getAggregate();
+        const std::vector<uint8_t>& payload = *aggregate->payload;
+        ok = check(aggregate->checksum == crc32c::value(payload.data(), payload.size()), "aggregate checksum") && ok;
+        for (const auto& member : aggregate->members) {
+            ok = check(member.checksum == crc32c::value(payload.data() + member.offset, member.length),
+                       "member checksum " + member.object_key) && ok;
+        }
+
+        // 读回：成员 1 带成员校验和，成员 5 不带（依靠聚合校验和）；两次读取，第二次损坏成员 1 中的一个字节
+        for (int round = 0; round < 2; ++round) {
+            std::vector<TapeDrivesOperation> reads;
+            ReadCoalescer::Config config;
+            config.window = std::chrono::milliseconds(10000);
+            ReadCoalescer coalescer(config, [&reads](const TapeDrivesOperation& op) { reads.push_back(op); });
+            AggregateLocation location{"C00001", aggregate->aggregate_id, 0, payload.size(), aggregate->checksum};
+            const AggregateMember& m1 = aggregate->members[1];
+            const AggregateMember& m5 = aggregate->members[5];
+            int delivered = 0;
+            int failed = 0;
+            auto deliver = [&](bool result, const uint8_t*, size_t) { result ? ++delivered : ++failed; };
+            coalescer.read("job", location, m1.offset, m1.length, deliver, m1.checksum);
+            coalescer.read("job", location, m5.offset, m5.length, deliver);
+            coalescer.flush();
+
+            std::vector<uint8_t> data = payload;
+            if (round == 1) {
+                data[m1.offset + 17] ^= 0x01;
+            }
+            coalescer.complete(reads.at(0).getOperationId(), data.data(), data.size());
+            auto stats = coalescer.stats();
+            std::cout << (round == 0 ? "intact" : "corrupted") << ": delivered " << delivered << ", failed " << failed
+                      << ", verified " << stats.bytes_verified << " bytes, checksum errors " << stats.checksum_errors
+                      << std::endl;
+            if (round == 0) {
+                ok = check(delivered == 2 && stats.checksum_errors == 0, "intact read") && ok;
+            } else {
+                // 成员 5 需要校验整个聚合，聚合校验失败，其中的两个请求都以失败回调
+                ok = check(failed == 2 && stats.checksum_errors == 1, "corrupted read") && ok;
+            }
+        }
+        return ok;
+    }
+
+}
+
+int main() {
+    std::cout << "crc32c implementation: " << crc32c::implementation() << std::endl;
+    bool ok = verifyImplementations();
+    throughput();
+    ok = verifyAggregates() && ok;
+    std::cout << (ok ? "all checks passed" : "some checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
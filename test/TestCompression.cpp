@@ -0,0 +1,206 @@
+#include "BlockFrame.hpp"
+#include "CompressionPipeline.hpp"
+#include "Crc32c.hpp"
+#include "Lz.hpp"
+#include "ReadCoalescer.hpp"
+#include "WriteAggregator.hpp"
+#include "TestUtil.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace test_util;
+
+/**
+ * 压缩测试：LZ 块压缩往返与损坏输入、并行压缩阶段（顺序、不可压缩数据的抽样跳过、线程数对比），
+ * 以及读合并时只解压请求成员所在的块。
+ */
+namespace {
+
+    /**
+     * 类似日志的文本：从小词表中随机取词。
+     */
+    std::vector<uint8_t> textBytes(size_t length, uint64_t seed) {
+        static const char* words[] = {"tape", "drive", "mount", "aggregate", "READ_AGGR", "WRITE_AGGR", "job",
+                                      "status=ok", "block", "robot", "slot", "2026-10-18T09:00:00", "\n"};
+        XorShift rng{seed};
+        std::vector<uint8_t> data;
+        while (data.size() < length) {
+            const char* word = words[rng.next() % (sizeof(words) / sizeof(words[0]))];
+            data.insert(data.end(), word, word + strlen(word));
+            data.push_back(' ');
+        }
+        data.resize(length);
+        return data;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool roundTrip(const std::vector<uint8_t>& data, const std::string& name, bool print) {
+        std::vector<uint8_t> compressed(lz::bound(data.size()));
+        const size_t n = lz::compress(data.data(), data.size(), compressed.data(), compressed.size());
+        std::vector<uint8_t> restored(data.size());
+        const bool ok = n > 0 && lz::decompress(compressed.data(), n, restored.data(), restored.size()) &&
+                        restored == data;
+        if (print) {
+            std::cout << "lz " << name << ": " << data.size() << " -> " << n << " bytes" << std::endl;
+        }
+        return check(ok, "lz round trip " + name);
+    }
+
+    bool verifyLz() {
+        bool ok = true;
+        ok = roundTrip(std::vector<uint8_t>(1 << 20, 0), "zeros", true) && ok;
+        ok = roundTrip(textBytes(1 << 20, 1), "text", true) && ok;
+        ok = roundTrip(randomBytes(1 << 20, 2), "random", true) && ok;
+        for (size_t length = 0; length < 40; ++length) {
+            ok = roundTrip(textBytes(length, length + 3), "short " + std::to_string(length), false) && ok;
+        }
+        std::vector<uint8_t> periodic(100000);
+        for (size_t i = 0; i < periodic.size(); ++i) {
+            periodic[i] = static_cast<uint8_t>("abc"[i % 3]); // 匹配与输出重叠
+        }
+        ok = roundTrip(periodic, "periodic", false) && ok;
+
+        // 损坏的输入：不崩溃、不越界，多数返回 false
+        std::vector<uint8_t> text = textBytes(65536, 9);
+        std::vector<uint8_t> compressed(lz::bound(text.size()));
+        compressed.resize(lz::compress(text.data(), text.size(), compressed.data(), compressed.size()));
+        std::vector<uint8_t> out(text.size());
+        XorShift rng{11};
+        size_t rejected = 0;
+        for (int i = 0; i < 1000; ++i) {
+            std::vector<uint8_t> broken = compressed;
+            broken[rng.next() % broken.size()] ^= static_cast<uint8_t>(1 + rng.next() % 255);
+            rejected += lz::decompress(broken.data(), broken.size(), out.data(), out.size()) ? 0 : 1;
+        }
+        std::cout << "corrupted inputs rejected: " << rejected << "/1000" << std::endl;
+        return ok;
+    }
+
+    /**
+     * 写聚合 -> 并行压缩 -> 收集，返回耗时。
+     */
+    double runPipeline(size_t workers, bool random, std::vector<TapeDrivesOperation>& out,
+                       CompressionPipeline::Stats& stats) {
+        CompressionPipeline::Config config;
+        config.workers = workers;
+        CompressionPipeline pipeline(config, [&out](const TapeDrivesOperation& op) { out.push_back(op); });
+        WriteAggregator::Config aggregator_config;
+        aggregator_config.target_size = 8 << 20;
+        auto start = std::chrono::steady_clock::now();
+        {
+            WriteAggregator aggregator(aggregator_config,
+                                       [&pipeline](const TapeDrivesOperation& op) { pipeline.submit(op); });
+            for (size_t i = 0; i < 256; ++i) {
+                auto object = random ? randomBytes(128 * 1024, i + 1) : textBytes(128 * 1024, i + 1);
+                aggregator.add("job", "obj" + std::to_string(i), object.data(), object.size());
+            }
+        }
+        pipeline.flush();
+        stats = pipeline.stats();
+        return seconds(start);
+    }
+
+    bool verifyPipeline() {
+        bool ok = true;
+        for (bool random : {false, true}) {
+            for (size_t workers : {1, 4}) {
+                std::vector<TapeDrivesOperation> ops;
+                CompressionPipeline::Stats stats;
+                const double elapsed = runPipeline(workers, random, ops, stats);
+                std::cout << (random ? "random" : "text") << ", " << workers << " worker(s): " << elapsed * 1e3
+                          << " ms, " << stats.bytes_in << " -> " << stats.bytes_out << " bytes, " << stats.blocks
+                          << " blocks (" << stats.raw_blocks << " raw, " << stats.sampled_blocks << " sampled)"
+                          << std::endl;
+                uint64_t previous = 0;
+                for (const auto& op : ops) {
+                    auto aggregate = op.getAggregate();
+                    std::vector<uint8_t> decoded;
+                    ok = check(aggregate->compressed && aggregate->aggregate_id > previous, "order") && ok;
+                    ok = check(BlockFrame::decode(aggregate->payload->data(), aggregate->payload->size(), decoded) &&
+                               decoded.size() == aggregate->members.back().offset + aggregate->members.back().length,
+                               "frame decodes") && ok;
+                    ok = check(crc32c::value(decoded.data(), decoded.size()) == aggregate->checksum,
+                               "decoded checksum") && ok;
+                    previous = aggregate->aggregate_id;
+                }
+                if (random) {
+                    ok = check(stats.raw_blocks == stats.blocks && stats.sampled_blocks == stats.blocks,
+                               "random data skipped by sampling") && ok;
+                }
+            }
+        }
+        return ok;
+    }
+
+    bool verifyPartialRead() {
+        bool ok = true;
+        std::vector<TapeDrivesOperation> writes;
+        CompressionPipeline::Config config;
+        config.block_size = 64 * 1024;
+        {
+            CompressionPipeline pipeline(config, [&writes](const TapeDrivesOperation& op) { writes.push_back(op); });
+            WriteAggregator aggregator(WriteAggregator::Config(),
+                                       [&pipeline](const TapeDrivesOperation& op) { pipeline.submit(op); });
+            for (size_t i = 0; i < 16; ++i) {
+                auto object = textBytes(50000, i + 100);
+                aggregator.add("job", "obj" + std::to_string(i), object.data(), object.size());
+            }
+        }
+        auto aggregate = writes.at(0).getAggregate();
+        const std::vector<uint8_t>& frame = *aggregate->payload;
+        const AggregateMember& member = aggregate->members[9];  // 偏移 450000，落在块 6~7
+        std::vector<uint8_t> expected = textBytes(50000, 109);
+
+        uint64_t begin, end;
+        BlockFrame::storedRange(frame.data(), frame.size(), member.offset, member.length, begin, end);
+        std::cout << "member 9: frame bytes [" << begin << ", " << end << ") of " << frame.size() << std::endl;
+
+        // 损坏位置：不相关的块 0、成员所在的块
+        for (uint64_t corrupt : {uint64_t(0), begin + 10}) {
+            std::vector<TapeDrivesOperation> reads;
+            ReadCoalescer::Config coalescer_config;
+            coalescer_config.window = std::chrono::milliseconds(10000);
+            ReadCoalescer coalescer(coalescer_config, [&reads](const TapeDrivesOperation& op) { reads.push_back(op); });
+            AggregateLocation location{"C00001", aggregate->aggregate_id, 0, frame.size(), aggregate->checksum, true};
+            bool delivered = false;
+            bool same = false;
+            coalescer.read("job", location, member.offset, member.length,
+                           [&](bool result, const uint8_t* data, size_t length) {
+                               delivered = result;
+                               same = result && length == expected.size() &&
+                                      memcmp(data, expected.data(), length) == 0;
+                           }, member.checksum);
+            coalescer.flush();
+            std::vector<uint8_t> data = frame;
+            if (corrupt > 0) {
+                data[corrupt] ^= 0x40;
+            } else {
+                const size_t first_block = BlockFrame::indexSize(frame.data(), frame.size());
+                data[first_block + 5] ^= 0x40;
+            }
+            coalescer.complete(reads.at(0).getOperationId(), data.data(), data.size());
+            if (corrupt == 0) {
+                ok = check(delivered && same, "member read with unrelated block corrupted") && ok;
+            } else {
+                ok = check(!delivered && coalescer.stats().checksum_errors == 1, "corrupted member block") && ok;
+            }
+        }
+        return ok;
+    }
+
+}
+
+int main() {
+    bool ok = verifyLz();
+    ok = verifyPipeline() && ok;
+    ok = verifyPartialRead() && ok;
+    std::cout << (ok ? "all checks passed" : "some checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include "DrivePool.hpp"
+#include <iostream>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+    const char* name(TypeOperation op) {
+        switch (op) {
+            case TypeOperation::READ_AGGR: return "READ";
+            case TypeOperation::WRITE_AGGR: return "WRITE";
+            case TypeOperation::LOAD_TAPE: return "LOAD";
+            case TypeOperation::UNLOAD_TAPE: return "UNLOAD";
+            case TypeOperation::INVENTORY: return "INVENTORY";
+            case TypeOperation::ROLL_TAPE: return "ROLL";
+        }
+        return "?";
+    }
+
+    // 依次执行驱动器上的所有操作（模拟执行方），打印执行顺序
+    void drain(TapeDrive& drive) {
+        std::cout << "drive " << drive.getDriveId() << ":";
+        while (auto op = drive.next()) {
+            std::cout << " " << name(op->getTypeOperation()) << "(" << op->getTapeId() << ")";
+            drive.complete(*op);
+        }
+        std::cout << std::endl;
+    }
+
+}
+
+int main() {
+    // 交错提交两盘磁带的召回：按提交顺序执行需要 6 次装载，按磁带批处理只需 2 次
+    {
+        DrivePool pool(1);
+        TapeDrivesQueue& queue = TapeDrivesQueue::getInstance();
+        for (int i = 0; i < 6; ++i) {
+            queue.push_back(TapeDrivesOperation(TypeOperation::READ_AGGR, i % 2 == 0 ? "A00001" : "B00002"));
+        }
+        queue.push_back(TapeDrivesOperation(TypeOperation::INVENTORY));
+        pool.dispatchFrom(queue);
+        drain(pool.drive(0));
+        std::cout << "mounts: " << pool.mountCount() << std::endl;
+    }
+
+    // 等待上限为 0：每次都切换到最早提交的操作，退化为按提交顺序执行
+    {
+        DrivePool pool(1);
+        pool.setMaxWait(std::chrono::milliseconds(0));
+        for (int i = 0; i < 4; ++i) {
+            pool.schedule(TapeDrivesOperation(TypeOperation::READ_AGGR, i % 2 == 0 ? "A00001" : "B00002"));
+        }
+        drain(pool.drive(0));
+        std::cout << "mounts: " << pool.mountCount() << std::endl;
+    }
+
+    // 多驱动器：同一磁带的操作集中到同一驱动器，不同磁带分散到空驱动器
+    {
+        DrivePool pool(2);
+        pool.drive(1).setMountedTape("B00002");
+        for (int i = 0; i < 4; ++i) {
+            pool.schedule(TapeDrivesOperation(TypeOperation::WRITE_AGGR, i % 2 == 0 ? "A00001" : "B00002"));
+        }
+        drain(pool.drive(0));
+        drain(pool.drive(1));
+        std::cout << "mounts: " << pool.mountCount() << std::endl;
+    }
+
+    // 位置排序：同一磁带上随机分布的 200 个召回，对比按到达顺序与排序后的估算定位时间
+    {
+        DrivePool pool(1);
+        LocateModel model;
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<uint64_t> block(0, model.config().blocks_per_wrap * model.config().wraps - 1);
+        std::vector<TapeDrivesOperation> arrival;
+        for (int i = 0; i < 200; ++i) {
+            TapeDrivesOperation op(TypeOperation::READ_AGGR, "C00003");
+            op.setPosition(block(rng));
+            arrival.push_back(op);
+            pool.schedule(op);
+        }
+        TapeDrive& drive = pool.drive(0);
+        while (auto op = drive.next()) {
+            drive.complete(*op, op->getEstimatedLocateSeconds());
+        }
+        TapeDrive::LocateStats stats = drive.locateStats();
+        std::cout << "arrival order locate: " << static_cast<int>(model.totalSeconds({0, 0}, arrival)) << " s"
+                  << ", ordered locate: " << static_cast<int>(stats.estimated_seconds) << " s"
+                  << ", reads: " << stats.reads << ", measured: " << stats.measured << std::endl;
+    }
+
+    // 组内等待上限：近处的读不断到达时，远处的读等待超过 max_wait 后排到最前面，不会饿死
+    {
+        DrivePool pool(1);
+        pool.setMaxWait(std::chrono::milliseconds(50));
+        TapeDrive& drive = pool.drive(0);
+        drive.setMountedTape("D00004");
+        const uint64_t far_block = LocateModel().config().blocks_per_wrap - 1;
+        TapeDrivesOperation far(TypeOperation::READ_AGGR, "D00004");
+        far.setPosition(far_block);
+        pool.schedule(far);
+        int served = -1;
+        for (int i = 0; i < 40 && served < 0; ++i) {
+            TapeDrivesOperation near(TypeOperation::READ_AGGR, "D00004");
+            near.setPosition(static_cast<uint64_t>(i));
+            pool.schedule(near);
+            auto op = drive.next();
+            if (op->getBlockPosition() == far_block) {
+                served = i;
+            }
+            drive.complete(*op);
+            usleep(5000);
+        }
+        std::cout << "far read served after " << served << " near reads (max wait 50 ms, one read per 5 ms)"
+                  << std::endl;
+        if (served < 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
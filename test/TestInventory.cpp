@@ -0,0 +1,93 @@
+#include "InventoryCache.hpp"
+#include "SimTapeLibrary.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * 库存缓存测试：10 个 frame、每个 40 个槽位的磁带库运行 24 个周期，每个周期做 20 次装卸带，
+ * 周期末需要确认库存。对比每个周期都整库扫描与使用 InventoryCache（只在柜门打开后扫描脏 frame）的机械手耗时。
+ */
+namespace {
+
+    constexpr size_t kFrames = 10;
+    constexpr size_t kSlotsPerFrame = 40;
+    constexpr size_t kDrives = 4;
+    constexpr size_t kPeriods = 24;
+
+    std::string tapeName(size_t slot) {
+        return "L" + std::to_string(100000 + slot);
+    }
+
+    double inventoryRobotSeconds(bool cached) {
+        SimTapeLibrary::Config config;
+        config.drive_count = kDrives;
+        config.frames = kFrames;
+        SimTapeLibrary library(config);
+        InventoryCache cache(kFrames, kSlotsPerFrame, kDrives);
+
+        // 实际库存：所有槽位都有磁带
+        std::vector<std::pair<size_t, std::string>> contents;
+        for (size_t slot = 0; slot < kFrames * kSlotsPerFrame; ++slot) {
+            contents.emplace_back(slot, tapeName(slot));
+        }
+
+        double robot_seconds = 0.0;
+        auto runInventory = [&](const TapeDrivesOperation& op) {
+            SimTapeLibrary::Result result = library.execute(0, op);
+            robot_seconds += result.finish - result.start;
+            uint64_t frame = InventoryCache::frameOf(op);
+            if (frame == InventoryCache::kFullScan) {
+                cache.applyFullScan(contents, {});
+            } else {
+                std::vector<std::pair<size_t, std::string>> in_frame;
+                for (const auto& entry : contents) {
+                    if (cache.frameOfSlot(entry.first) == frame) {
+                        in_frame.push_back(entry);
+                    }
+                }
+                cache.applyScan(frame, in_frame);
+            }
+        };
+
+        for (size_t period = 0; period < kPeriods; ++period) {
+            for (size_t i = 0; i < 20; ++i) {
+                const size_t slot = (period * 37 + i * 53) % (kFrames * kSlotsPerFrame);
+                const size_t drive = i % kDrives;
+                cache.onLoad(tapeName(slot), drive);
+                cache.onUnload(tapeName(slot), drive);
+            }
+            if (period == 12) {
+                cache.onDoorOpened(3); // 运维打开了 frame 3 的柜门
+            }
+            if (cached) {
+                for (const auto& op : cache.planInventory()) {
+                    runInventory(op);
+                }
+            } else {
+                runInventory(InventoryCache::makeInventory(InventoryCache::kFullScan));
+            }
+        }
+
+        if (cached) {
+            auto stats = cache.stats();
+            std::cout << "cached: full scans " << stats.full_scans << ", frame scans " << stats.frame_scans
+                      << ", skipped " << stats.scans_skipped << ", updates " << stats.updates
+                      << ", conflicts " << stats.conflicts << std::endl;
+            auto location = cache.locate(tapeName(123));
+            std::cout << tapeName(123) << " in " << (location && !location->in_drive ? "slot " : "?")
+                      << (location ? location->index : 0) << std::endl;
+        }
+        return robot_seconds;
+    }
+
+}
+
+int main() {
+    double full = inventoryRobotSeconds(false);
+    double cached = inventoryRobotSeconds(true);
+    std::cout << "robot seconds on inventory: full scan every period " << full
+              << ", cached " << cached << std::endl;
+    return cached < full ? 0 : 1;
+}
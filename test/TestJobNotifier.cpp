@@ -0,0 +1,74 @@
+#include "JobQueue.hpp"
+#include "JobNotifier.hpp"
+#include <chrono>
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+
+int main() {
+    JobQueue& jobQueue = JobQueue::getInstance();
+    JobNotifier& notifier = JobNotifier::getInstance();
+
+    // 两次提交同一内容，第二次会被合并到第一次
+    JobInfo job1{.status = JobStatus::Queuing, .job_id = "21", .content_key = "tape02:/data/b.bin"};
+    JobInfo job2{.status = JobStatus::Queuing, .job_id = "22", .content_key = "tape02:/data/b.bin"};
+    jobQueue.enqueue(JobManager(job1));
+    jobQueue.enqueue(JobManager(job2));
+
+    // 回调：收到所有状态变化
+    notifier.subscribe("21", [](const std::string& job_id, JobStatus status) {
+        std::cout << "callback: job " << job_id << " -> " << static_cast<int>(status) << std::endl;
+    });
+
+    // future：只在终态就绪
+    std::future<JobStatus> future = notifier.subscribeFuture("22");
+
+    // eventfd：只在终态可读
+    int fd = notifier.subscribeEventFd("21");
+
+    auto job = jobQueue.dequeue();
+    notifier.publish(job->getJobId().value(), JobStatus::Running);
+    notifier.publish(job->getJobId().value(), JobStatus::Succeed);
+
+    std::cout << "future: job 22 -> " << static_cast<int>(future.get()) << std::endl;
+
+    struct pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, 1000) == 1) {
+        uint64_t value = 0;
+        if (read(fd, &value, sizeof(value)) == sizeof(value)) {
+            std::cout << "eventfd: job 21 -> " << value << std::endl;
+        }
+    } else {
+        std::cout << "eventfd: timeout" << std::endl;
+    }
+    close(fd);
+
+    // 排队中任务的状态变化由 JobQueue 发布：updateStatus 和 cancel 都会通知订阅方
+    JobInfo job3{.status = JobStatus::Queuing, .job_id = "23"};
+    JobInfo job4{.status = JobStatus::Queuing, .job_id = "24"};
+    jobQueue.enqueue(JobManager(job3));
+    jobQueue.enqueue(JobManager(job4));
+    std::future<JobStatus> failed = notifier.subscribeFuture("23");
+    std::future<JobStatus> cancelled = notifier.subscribeFuture("24");
+    jobQueue.updateStatus("23", JobStatus::Failed);
+    jobQueue.cancel("24");
+    JobStatus failed_status = failed.get();
+    JobStatus cancelled_status = cancelled.get();
+    std::cout << "queue: job 23 -> " << static_cast<int>(failed_status)
+              << ", job 24 -> " << static_cast<int>(cancelled_status) << std::endl;
+    bool ok = failed_status == JobStatus::Failed && cancelled_status == JobStatus::Cancelled;
+
+    // 已经处于终态的任务：订阅时立即得到终态（23 仍在队列中，21 已投递过终态）
+    std::future<JobStatus> late = notifier.subscribeFuture("23");
+    bool late_ready = late.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    int late_fd = notifier.subscribeEventFd("21");
+    uint64_t late_value = 0;
+    bool late_readable = read(late_fd, &late_value, sizeof(late_value)) == sizeof(late_value);
+    close(late_fd);
+    ok = ok && late_ready && late.get() == JobStatus::Failed && late_readable &&
+         late_value == static_cast<uint64_t>(JobStatus::Succeed);
+    std::cout << "late subscribe: future " << (late_ready ? "ready" : "not ready") << ", eventfd "
+              << (late_readable ? "readable" : "not readable") << (ok ? "" : " (FAILED)") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -5,9 +5,9 @@ int main() {
     JobQueue& jobQueue = JobQueue::getInstance();
 
     // 添加一些任务到队列中
-    JobInfo job1{.status = JobStatus::Queuing, .job_id = "1"};
-    JobInfo job2{.status = JobStatus::Suspending, .job_id = "2"};
-    JobInfo job3{.status = JobStatus::Retry, .job_id = "3"};
+    JobInfo job1{.status = JobStatus::Queuing, .job_id = "1", .content_key = ""};
+    JobInfo job2{.status = JobStatus::Suspending, .job_id = "2", .content_key = ""};
+    JobInfo job3{.status = JobStatus::Retry, .job_id = "3", .content_key = ""};
 
     jobQueue.enqueue(JobManager(job1));
     jobQueue.enqueue(JobManager(job2));
@@ -52,5 +52,44 @@ int main() {
 
     std::cout << "size: " << jobQueue.size() << std::endl;
 
+    // 重复提交去重：相同 job_id 直接忽略，相同内容键合并到已有任务
+    JobInfo recall1{.status = JobStatus::Queuing, .job_id = "10", .content_key = "tape01:/data/a.bin"};
+    JobInfo recall2{.status = JobStatus::Queuing, .job_id = "11", .content_key = "tape01:/data/a.bin"};
+
+    EnqueueResult r1 = jobQueue.enqueue(JobManager(recall1));
+    EnqueueResult r2 = jobQueue.enqueue(JobManager(recall1));
+    EnqueueResult r3 = jobQueue.enqueue(JobManager(recall2));
+    std::cout << "enqueue 10: " << (r1 == EnqueueResult::Enqueued ? "Enqueued" : "?") << std::endl;
+    std::cout << "enqueue 10 again: " << (r2 == EnqueueResult::DuplicateJobId ? "DuplicateJobId" : "?") << std::endl;
+    std::cout << "enqueue 11: " << (r3 == EnqueueResult::Coalesced ? "Coalesced" : "?") << std::endl;
+    std::cout << "11 resolves to: " << jobQueue.resolveJobId("11") << std::endl;
+    std::cout << "size: " << jobQueue.size() << std::endl;
+
+    // 取消主任务：被合并的 11 接替为主任务，继续排队
+    removedJob = jobQueue.dequeueByJobId("10");
+    std::cout << "Removed job with ID: " << removedJob->getJobId().value() << std::endl;
+    std::cout << "coalesced into 10 after removal: " << jobQueue.takeCoalescedJobIds("10").size() << std::endl;
+    std::cout << "11 resolves to: " << jobQueue.resolveJobId("11") << std::endl;
+    std::cout << "size: " << jobQueue.size() << std::endl;
+
+    // 取消被合并的提交：只解除该提交的合并，主任务不受影响，之后可以重新提交
+    JobInfo recall3{.status = JobStatus::Queuing, .job_id = "12", .content_key = "tape01:/data/a.bin"};
+    EnqueueResult r4 = jobQueue.enqueue(JobManager(recall3));
+    removedJob = jobQueue.dequeueByJobId("12");
+    std::cout << "enqueue 12: " << (r4 == EnqueueResult::Coalesced ? "Coalesced" : "?") << std::endl;
+    std::cout << "Removed job with ID: " << removedJob->getJobId().value() << std::endl;
+    std::cout << "11 status: " << (jobQueue.queryStatus("11") == JobStatus::Queuing ? "Queuing" : "?") << std::endl;
+    EnqueueResult r5 = jobQueue.enqueue(JobManager(recall3));
+    std::cout << "enqueue 12 again: " << (r5 == EnqueueResult::Coalesced ? "Coalesced" : "?") << std::endl;
+    for (const auto& id : jobQueue.takeCoalescedJobIds("11")) {
+        std::cout << "Notify coalesced job with ID: " << id << std::endl;
+    }
+
+    // 主任务出队后，相同内容键可以重新入队
+    jobQueue.dequeueByJobId("11");
+    EnqueueResult r6 = jobQueue.enqueue(JobManager(recall2));
+    std::cout << "enqueue 11 after removal: " << (r6 == EnqueueResult::Enqueued ? "Enqueued" : "?") << std::endl;
+    std::cout << "size: " << jobQueue.size() << std::endl;
+
     return 0;
 }
\ No newline at end of file
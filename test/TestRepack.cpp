@@ -0,0 +1,397 @@
+#include "CatalogIndex.hpp"
+#include "Crc32c.hpp"
+#include "DrivePool.hpp"
+#include "RepackEngine.hpp"
+#include "SimTapeLibrary.hpp"
+#include "WriteAggregator.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace test_util;
+
+/**
+ * 磁带回收测试：
+ * 1. 在落盘的仿真磁带库上写两盘磁带，分别删除 70% 和 20% 的对象，重打包引擎只选中前者，
+ *    把存活对象复制到新磁带并更新目录；复制期间删除的对象不会被写回目录；
+ *    新聚合写入失败时源磁带不被回收、目录不变，之后可以重新开始；
+ * 2. 在 4 个驱动器上同时回放用户召回和大量后台重打包读，比较不同后台份额下的用户延迟、
+ *    重打包完成时间和后台占用的驱动器数；
+ * 3. 同一磁带的用户、后台和维护操作无论到达顺序如何都排到同一驱动器。
+ */
+namespace {
+
+    constexpr uint64_t kBlockSize = 256 * 1024;
+
+    std::string objectKey(size_t index) {
+        return "obj" + std::to_string(100000 + index);
+    }
+
+    std::vector<uint8_t> objectBytes(size_t index) {
+        return randomBytes(20000 + (index * 7919) % (180 * 1024), index * 0x9E3779B97F4A7C15ULL + 7);
+    }
+
+    /**
+     * 单驱动器执行器：按需换带后在驱动器 0 上执行操作。
+     */
+    struct Executor {
+        SimTapeLibrary& library;
+        std::string mounted;
+
+        SimTapeLibrary::Result run(const TapeDrivesOperation& op, const std::string& tape_id) {
+            if (mounted != tape_id) {
+                if (!mounted.empty()) {
+                    library.execute(0, TapeDrivesOperation(TypeOperation::UNLOAD_TAPE, mounted));
+                }
+                library.execute(0, TapeDrivesOperation(TypeOperation::LOAD_TAPE, tape_id));
+                mounted = tape_id;
+            }
+            return library.execute(0, op);
+        }
+    };
+
+    bool verifyRepack() {
+        bool ok = true;
+        char dir[] = "/tmp/repack_XXXXXX";
+        if (!mkdtemp(dir)) {
+            return check(false, "mkdtemp");
+        }
+        const std::string root = dir;
+        SimTapeLibrary::Config config;
+        config.drive_count = 1;
+        config.block_size = kBlockSize;
+        config.directory = root;
+        SimTapeLibrary library(config);
+        Executor executor{library, ""};
+        CatalogIndex catalog(root + "/catalog");
+
+        std::deque<TapeDrivesOperation> queue; // 重打包引擎发出的操作
+        RepackEngine::Config repack_config;
+        repack_config.target_tape = "R00001";
+        repack_config.target_size = 8ULL << 20;
+        repack_config.block_size = kBlockSize;
+        RepackEngine engine(repack_config, catalog, [&queue](const TapeDrivesOperation& op) { queue.push_back(op); });
+
+        // 两盘磁带各 300 个对象
+        const size_t kObjects = 300;
+        for (size_t tape = 0; tape < 2; ++tape) {
+            const std::string tape_id = tape == 0 ? "A00001" : "A00002";
+            std::vector<TapeDrivesOperation> writes;
+            {
+                WriteAggregator::Config writer;
+                writer.target_size = 8ULL << 20;
+                writer.self_describing = true;
+                writer.first_aggregate_id = 1 + tape * 1000;
+                WriteAggregator aggregator(writer, [&writes](const TapeDrivesOperation& op) { writes.push_back(op); });
+                for (size_t i = tape * kObjects; i < (tape + 1) * kObjects; ++i) {
+                    auto data = objectBytes(i);
+                    aggregator.add("job", objectKey(i), data.data(), data.size());
+                }
+            }
+            for (const auto& op : writes) {
+                SimTapeLibrary::Result result = executor.run(op, tape_id);
+                catalog.insertAggregate(tape_id, result.block_position, *op.getAggregate());
+                engine.recordAggregate(tape_id, result.block_position, *op.getAggregate());
+            }
+        }
+
+        // A00001 删除 70%，A00002 删除 20%
+        std::set<size_t> deleted;
+        for (size_t i = 0; i < 2 * kObjects; ++i) {
+            if (i % 10 < (i < kObjects ? 7u : 2u)) {
+                catalog.erase(objectKey(i));
+                deleted.insert(i);
+            }
+        }
+        catalog.flush();
+
+        auto candidates = engine.candidates();
+        for (const auto& candidate : candidates) {
+            std::cout << "candidate " << candidate.tape_id << ": " << candidate.live_members << " live members, "
+                      << candidate.live_bytes << "/" << candidate.written_bytes << " bytes live, reclaimable "
+                      << std::setprecision(3) << candidate.reclaimable() << std::endl;
+        }
+        ok = check(candidates.size() == 1 && candidates[0].tape_id == "A00001", "only A00001 selected") && ok;
+
+        ok = check(engine.start() == 1, "start") && ok;
+        bool raced = false;
+        bool background = true;
+        while (!queue.empty()) {
+            TapeDrivesOperation op = queue.front();
+            queue.pop_front();
+            background = background && op.isBackground();
+            if (op.getTypeOperation() == TypeOperation::READ_AGGR) {
+                SimTapeLibrary::Result result = executor.run(op, op.getTapeId());
+                if (result.ok) {
+                    engine.complete(op, result.data.data(), result.data.size());
+                } else {
+                    engine.fail(op);
+                }
+            } else {
+                if (!raced) {
+                    // 复制期间删除第一个新聚合中的一个对象：提交时不能把它写回目录
+                    const std::string& key = op.getAggregate()->members.front().object_key;
+                    catalog.erase(key);
+                    deleted.insert(std::stoul(key.substr(3)) - 100000);
+                    raced = true;
+                }
+                SimTapeLibrary::Result result = executor.run(op, "R00001");
+                engine.written(op, "R00001", result.block_position);
+            }
+        }
+        ok = check(background, "repack operations are background") && ok;
+        ok = check(engine.idle(), "repack finished") && ok;
+
+        auto stats = engine.stats();
+        auto progress = engine.progress();
+        std::cout << "repacked " << progress.at(0).tape_id << ": copied " << progress[0].copied_members << " members ("
+                  << progress[0].copied_bytes << " bytes), dropped " << progress[0].dropped_members << ", failed "
+                  << progress[0].failed_members << ", " << (progress[0].reclaimed ? "reclaimed" : "NOT reclaimed")
+                  << std::endl;
+        std::cout << "stats: " << stats.reads_issued << " READ_AGGR (" << stats.bytes_read << " bytes), "
+                  << stats.writes_issued << " WRITE_AGGR (" << stats.bytes_written << " bytes), reclaimed "
+                  << stats.bytes_reclaimed << " bytes, throughput " << stats.throughput() / 1e6 << " MB/s (wall)"
+                  << std::endl;
+        ok = check(progress[0].reclaimed && progress[0].dropped_members == 1 &&
+                   progress[0].copied_members + 1 == progress[0].live_members, "progress") && ok;
+
+        // 目录：A00001 的存活对象都在 R00001 上且数据正确，删除的对象仍不存在，A00002 不受影响
+        size_t verified = 0;
+        for (size_t i = 0; i < 2 * kObjects; ++i) {
+            auto entry = catalog.lookup(objectKey(i));
+            if (deleted.count(i)) {
+                ok = check(!entry, "deleted " + objectKey(i)) && ok;
+                continue;
+            }
+            const std::string expected_tape = i < kObjects ? "R00001" : "A00002";
+            if (!check(entry && entry->tape_id == expected_tape, "location " + objectKey(i))) {
+                ok = false;
+                continue;
+            }
+            if (i < kObjects) {
+                TapeDrivesOperation read(TypeOperation::READ_AGGR, entry->tape_id);
+                read.setPosition(entry->block_position + entry->offset / kBlockSize);
+                read.setLength(entry->offset % kBlockSize + entry->length);
+                SimTapeLibrary::Result result = executor.run(read, entry->tape_id);
+                auto data = objectBytes(i);
+                ok = check(result.ok && crc32c::value(result.data.data() + entry->offset % kBlockSize, entry->length) ==
+                           crc32c::value(data.data(), data.size()), "data " + objectKey(i)) && ok;
+                ++verified;
+            }
+        }
+        std::cout << verified << " repacked objects read back and verified" << std::endl;
+        candidates = engine.candidates();
+        ok = check(candidates.empty(), "no more candidates") && ok;
+
+        executor.run(TapeDrivesOperation(TypeOperation::UNLOAD_TAPE, executor.mounted), "");
+        for (const char* tape : {"A00001", "A00002", "R00001"}) {
+            unlink((root + "/" + tape + ".tape").c_str());
+        }
+        return ok;
+    }
+
+    /**
+     * 重打包的 WRITE_AGGR 失败：writeFailed() 之后引擎空闲，源磁带未回收且仍是候选，重试后回收。
+     */
+    bool verifyWriteFailure() {
+        bool ok = true;
+        char dir[] = "/tmp/repack_fail_XXXXXX";
+        if (!mkdtemp(dir)) {
+            return check(false, "mkdtemp");
+        }
+        CatalogIndex catalog(std::string(dir) + "/catalog");
+        std::deque<TapeDrivesOperation> queue;
+        RepackEngine::Config repack_config;
+        repack_config.target_tape = "R00002";
+        repack_config.block_size = kBlockSize;
+        RepackEngine engine(repack_config, catalog, [&queue](const TapeDrivesOperation& op) { queue.push_back(op); });
+
+        // 一个 10 对象的聚合写在 F00001 的块 0，删除较大的 6 个
+        std::vector<TapeDrivesOperation> writes;
+        {
+            WriteAggregator::Config writer;
+            writer.self_describing = true;
+            WriteAggregator aggregator(writer, [&writes](const TapeDrivesOperation& op) { writes.push_back(op); });
+            for (size_t i = 0; i < 10; ++i) {
+                auto data = objectBytes(i);
+                aggregator.add("job", objectKey(i), data.data(), data.size());
+            }
+        }
+        const AggregateInfo& source = *writes.at(0).getAggregate();
+        catalog.insertAggregate("F00001", 0, source);
+        engine.recordAggregate("F00001", 0, source);
+        for (size_t i = 4; i < 10; ++i) {
+            catalog.erase(objectKey(i));
+        }
+        catalog.flush();
+
+        // 读直接从内存中的聚合返回；写按 fail 决定失败还是成功
+        auto drain = [&](bool fail) {
+            while (!queue.empty()) {
+                TapeDrivesOperation op = queue.front();
+                queue.pop_front();
+                if (op.getTypeOperation() == TypeOperation::READ_AGGR) {
+                    const size_t begin = std::min<size_t>(op.getBlockPosition() * kBlockSize, source.payload->size());
+                    const size_t end = std::min<size_t>(begin + op.getLength(), source.payload->size());
+                    engine.complete(op, source.payload->data() + begin, end - begin);
+                } else if (fail) {
+                    engine.writeFailed(op);
+                } else {
+                    engine.written(op, "R00002", 0);
+                }
+            }
+        };
+
+        ok = check(engine.start() == 1, "start before write failure") && ok;
+        drain(true);
+        auto progress = engine.progress();
+        ok = check(engine.idle(), "idle after write failure") && ok;
+        ok = check(progress.at(0).finished && !progress[0].reclaimed && progress[0].failed_members == 4,
+                   "write failure settles members as failed") && ok;
+        auto entry = catalog.lookup(objectKey(3));
+        ok = check(entry && entry->tape_id == "F00001", "catalog unchanged after write failure") && ok;
+        ok = check(engine.candidates().size() == 1, "failed tape is still a candidate") && ok;
+
+        ok = check(engine.start() == 1, "restart after write failure") && ok;
+        drain(false);
+        progress = engine.progress();
+        entry = catalog.lookup(objectKey(3));
+        ok = check(engine.idle() && progress.at(1).reclaimed && entry && entry->tape_id == "R00002",
+                   "reclaimed on retry") && ok;
+        auto stats = engine.stats();
+        std::cout << "write failure: " << stats.writes_failed << " WRITE_AGGR failed, " << stats.members_failed
+                  << " members failed, " << stats.tapes_failed << " tape not reclaimed, then "
+                  << stats.tapes_reclaimed << " reclaimed on retry" << std::endl;
+        return ok;
+    }
+
+    /**
+     * 用户召回与后台重打包读在 4 个驱动器上竞争。
+     *
+     * @return size_t 执行过后台操作的驱动器数。
+     */
+    size_t runShare(double share) {
+        std::mt19937_64 rng(7);
+        std::exponential_distribution<double> gap(1.0 / 30.0);
+        std::uniform_int_distribution<int> tape(0, 19);
+        std::uniform_int_distribution<uint64_t> block(0, 208ULL * 180000 - 1);
+
+        std::vector<SimTapeLibrary::Arrival> arrivals;
+        uint64_t next_id = 1;
+        double time = 0.0;
+        for (int i = 0; i < 300; ++i) {
+            time += gap(rng);
+            TapeDrivesOperation op(TypeOperation::READ_AGGR, "U" + std::to_string(10000 + tape(rng)));
+            op.setPosition(block(rng));
+            op.setLength(64ULL << 20);
+            op.setOperationId(next_id++);
+            arrivals.push_back(SimTapeLibrary::Arrival{time, op});
+        }
+        // 4 盘源磁带，每盘 60 个 1 GiB 的顺序读，开始时全部提交
+        for (int source = 0; source < 4; ++source) {
+            for (uint64_t i = 0; i < 60; ++i) {
+                TapeDrivesOperation op(TypeOperation::READ_AGGR, "S" + std::to_string(10000 + source));
+                op.setPosition(i * 4096);
+                op.setLength(1ULL << 30);
+                op.setOperationId(next_id++);
+                op.setBackground(true);
+                arrivals.push_back(SimTapeLibrary::Arrival{0.0, op});
+            }
+        }
+        std::unordered_map<uint64_t, double> arrived;
+        for (const auto& arrival : arrivals) {
+            arrived[arrival.op.getOperationId()] = arrival.time;
+        }
+
+        SimTapeLibrary::Config config;
+        config.drive_count = 4;
+        SimTapeLibrary library(config);
+        DrivePool pool(4);
+        pool.setBackgroundShare(share);
+        double user_latency = 0.0;
+        double user_max = 0.0;
+        size_t users = 0;
+        double background_done = 0.0;
+        std::set<size_t> background_drives;
+        library.run(pool, arrivals, [&](size_t drive_id, const TapeDrivesOperation& op,
+                                        const SimTapeLibrary::Result& result) {
+            if (op.getTypeOperation() != TypeOperation::READ_AGGR) {
+                return;
+            }
+            if (op.isBackground()) {
+                background_done = std::max(background_done, result.finish);
+                background_drives.insert(drive_id);
+            } else {
+                const double latency = result.finish - arrived[op.getOperationId()];
+                user_latency += latency;
+                user_max = std::max(user_max, latency);
+                ++users;
+            }
+        });
+        auto stats = pool.backgroundStats();
+        std::cout << std::fixed << std::setprecision(2) << std::setw(7) << share << std::setprecision(1)
+                  << std::setw(12) << user_latency / users << std::setw(12) << user_max
+                  << std::setw(14) << background_done / 3600.0 << std::setw(9) << background_drives.size()
+                  << std::setw(12) << stats.contended << std::setw(10) << stats.dispatched << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        return background_drives.size();
+    }
+
+    /**
+     * 同一磁带的操作必须排到同一驱动器，不论排队在哪一类队列中。
+     */
+    bool verifyPinning() {
+        auto read = [](const std::string& tape_id, bool background) {
+            TapeDrivesOperation op(TypeOperation::READ_AGGR, tape_id);
+            op.setLength(1 << 20);
+            op.setBackground(background);
+            return op;
+        };
+        DrivePool pool(4);
+        pool.setBackgroundShare(0.5);
+        bool ok = true;
+
+        // 用户读在前，后台读在后（以及反过来）
+        int user = pool.schedule(read("B00001", false));
+        ok = check(pool.schedule(read("B00001", true)) == user, "background pinned to user drive") && ok;
+        int background = pool.schedule(read("B00002", true));
+        ok = check(pool.schedule(read("B00002", false)) == background, "user pinned to background drive") && ok;
+
+        // 排队的 ROLL_TAPE 同样占住磁带
+        int roll = pool.schedule(TapeDrivesOperation(TypeOperation::ROLL_TAPE, "B00003"));
+        ok = check(pool.schedule(read("B00003", true)) == roll, "background pinned to maintenance drive") && ok;
+        ok = check(pool.schedule(read("B00003", false)) == roll, "user pinned to maintenance drive") && ok;
+
+        // 已装载的磁带
+        pool.drive(3).setMountedTape("B00004");
+        ok = check(pool.schedule(read("B00004", true)) == 3, "background pinned to mounted drive") && ok;
+        return ok;
+    }
+
+}
+
+int main() {
+    bool ok = verifyRepack();
+    ok = verifyWriteFailure() && ok;
+    ok = verifyPinning() && ok;
+
+    std::cout << "300 user recalls (64 MiB) vs 240 background repack reads (1 GiB) on 4 drives" << std::endl;
+    std::cout << std::setw(7) << "share" << std::setw(12) << "avg lat s" << std::setw(12) << "max lat s"
+              << std::setw(14) << "repack h" << std::setw(9) << "drives" << std::setw(12) << "contended"
+              << std::setw(10) << "bg ops" << std::endl;
+    for (double share : {0.0, 0.25, 0.5, 1.0}) {
+        const size_t limit = std::max<size_t>(1, static_cast<size_t>(share * 4));
+        ok = check(runShare(share) <= limit, "background drive limit") && ok;
+    }
+    std::cout << (ok ? "all checks passed" : "some checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include "ShmJobQueue.hpp"
+#include <iostream>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * 持锁进程崩溃后的恢复：
+ * 1. 子进程在 remove_if 的判断条件中退出（持锁期间死亡），父进程加锁时重建链表，内容和顺序不变；
+ * 2. 子进程反复入队/出队时被 SIGKILL，之后链表、空闲链表和计数仍然一致：能取出的元素数等于 size()，
+ *    取空后能重新放满全部槽位。
+ */
+static bool testOwnerDeath() {
+    const std::string name = "/test_shm_queue_recovery";
+    const uint32_t kCapacity = 256;
+    ShmQueue<uint64_t> queue(name, kCapacity, true);
+    for (uint64_t i = 0; i < 10; ++i) {
+        queue.push_back(i);
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        ShmQueue<uint64_t> child(name, 0, false);
+        child.remove_if([](const uint64_t& value) {
+            if (value == 5) {
+                _exit(0);
+            }
+            return false;
+        });
+        _exit(1);
+    }
+    waitpid(pid, nullptr, 0);
+    bool ok = true;
+    for (uint64_t i = 0; i < 10; ++i) {
+        auto value = queue.pop_front();
+        ok = ok && value && *value == i;
+    }
+    std::cout << "owner died in remove_if: recoveries " << queue.recoveries() << ", order "
+              << (ok ? "preserved" : "BROKEN") << std::endl;
+    ok = ok && queue.recoveries() == 1;
+
+    for (int round = 0; round < 20; ++round) {
+        pid = fork();
+        if (pid == 0) {
+            ShmQueue<uint64_t> child(name, 0, false);
+            for (uint64_t i = 0; ; ++i) {
+                if (!child.push_back(i) || i % 3 == 0) {
+                    child.pop_front();
+                }
+            }
+        }
+        usleep(2000 + round * 500);
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    size_t size = queue.size();
+    size_t drained = 0;
+    while (queue.pop_front()) {
+        ++drained;
+    }
+    size_t filled = 0;
+    while (queue.push_back(filled)) {
+        ++filled;
+    }
+    std::cout << "after 20 killed producers: recoveries " << queue.recoveries() << ", size " << size
+              << ", drained " << drained << ", refilled " << filled << "/" << kCapacity << std::endl;
+    ok = ok && drained == size && filled == kCapacity;
+    ShmQueue<uint64_t>::unlink(name);
+    return ok;
+}
+
+int main() {
+    const std::string name = "/test_shm_job_queue";
+    const int kProducers = 2;
+    const int kJobsPerProducer = 1000;
+
+    ShmJobQueue queue(name, 4096, true);
+
+    // 子进程作为生产者，通过共享内存段提交任务
+    for (int p = 0; p < kProducers; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            ShmJobQueue producer(name, 0, false);
+            for (int i = 0; i < kJobsPerProducer; ++i) {
+                JobInfo job{.status = JobStatus::Queuing,
+                            .job_id = std::to_string(p) + "-" + std::to_string(i),
+                            .content_key = "tape" + std::to_string(i % 8)};
+                while (!producer.enqueue(job)) {
+                    usleep(100);
+                }
+            }
+            _exit(0);
+        }
+    }
+    for (int p = 0; p < kProducers; ++p) {
+        wait(nullptr);
+    }
+
+    std::cout << "size: " << queue.size() << std::endl;
+
+    auto removed = queue.dequeueByJobId("1-500");
+    std::cout << "Removed job with ID: " << (removed ? removed->job_id : "空") << std::endl;
+
+    size_t consumed = 0;
+    while (auto job = queue.dequeue()) {
+        ++consumed;
+    }
+    std::cout << "consumed: " << consumed << ", size: " << queue.size() << std::endl;
+
+    ShmJobQueue::unlink(name);
+
+    bool ok = testOwnerDeath();
+    std::cout << (ok ? "all checks passed" : "some checks failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+#include "ReadCoalescer.hpp"
+#include "StagingCache.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * 暂存盘缓存测试：
+ * 1. 归档数据以脏条目暂存，空间被脏条目占满时拒绝写入而不是丢弃；写带完成（markClean）后才可淘汰；
+ * 2. 从暂存的聚合中按偏移读取成员对象；
+ * 3. 重新打开目录后恢复条目，未写带的脏条目通过 dirtyKeys() 返回；
+ *    替换条目被拒绝时旧条目（包括脏条目）保持不变；替换过程中崩溃、同一键留下两个文件时恢复较新的一个；
+ * 3'. ReadCoalescer 的召回路径：第一次请求从磁带读取，完整读到的聚合写入暂存盘，
+ *    之后对同一聚合的请求直接从暂存盘交付，不再产生 READ_AGGR；
+ * 4. 召回负载：热门聚合按 Zipf 分布反复召回，同时夹杂大量只召回一次的聚合，
+ *    重新召回的代价取决于聚合所在磁带（30~300 秒），比较 Lru 与 CostBased 的命中率和节省的磁带时间。
+ */
+namespace {
+
+    constexpr size_t kAggregateSize = 64 * 1024;
+
+    std::vector<uint8_t> makeData(uint64_t seed, size_t length) {
+        std::vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = static_cast<uint8_t>(seed * 31 + i * 7);
+        }
+        return data;
+    }
+
+    bool checkArchiveStaging(const std::string& dir) {
+        StagingCache::Config config;
+        config.capacity = 8 * kAggregateSize;
+        bool ok = true;
+        {
+            StagingCache cache(dir, config);
+            for (uint64_t id = 1; id <= 8; ++id) {
+                auto data = makeData(id, kAggregateSize);
+                ok = ok && cache.put(StagingCache::aggregateKey(id), data.data(), data.size(), 0.0, true);
+            }
+            auto extra = makeData(9, kAggregateSize);
+            ok = ok && !cache.put(StagingCache::aggregateKey(9), extra.data(), extra.size()); // 全是脏条目
+
+            std::vector<uint8_t> member;
+            auto expected = makeData(3, kAggregateSize);
+            ok = ok && cache.read(StagingCache::aggregateKey(3), 1000, 500, member) &&
+                 std::equal(member.begin(), member.end(), expected.begin() + 1000);
+
+            for (uint64_t id = 1; id <= 4; ++id) {
+                cache.markClean(StagingCache::aggregateKey(id)); // 前 4 个已写带
+            }
+            ok = ok && cache.put(StagingCache::aggregateKey(9), extra.data(), extra.size());
+            auto stats = cache.stats();
+            std::cout << "archive staging: rejected " << stats.rejected << ", evicted " << stats.evictions
+                      << ", dirty " << stats.dirty_bytes / kAggregateSize << " aggregates" << std::endl;
+            ok = ok && stats.rejected == 1 && stats.evictions == 1 && stats.dirty_bytes == 4 * kAggregateSize;
+        }
+
+        StagingCache reopened(dir, config);
+        auto dirty = reopened.dirtyKeys();
+        std::vector<uint8_t> data;
+        ok = ok && dirty.size() == 4 && reopened.stats().entries == 8 &&
+             reopened.get(StagingCache::aggregateKey(9), data) && data == makeData(9, kAggregateSize);
+        std::cout << "reopened: " << reopened.stats().entries << " entries, " << dirty.size()
+                  << " dirty to rewrite" << std::endl;
+        for (uint64_t id = 1; id <= 9; ++id) {
+            reopened.erase(StagingCache::aggregateKey(id));
+        }
+        return ok;
+    }
+
+    bool checkReplaceRejected(const std::string& dir) {
+        StagingCache::Config config;
+        config.capacity = 2 * kAggregateSize;
+        StagingCache cache(dir, config);
+        const auto first = makeData(1, kAggregateSize);
+        const auto second = makeData(2, kAggregateSize);
+        const auto larger = makeData(3, 2 * kAggregateSize);
+        bool ok = cache.put("a", first.data(), first.size(), 0.0, true) &&
+                  cache.put("b", second.data(), second.size(), 0.0, true);
+        // 替换 a 需要再腾出一个聚合的空间，但 b 是脏的：拒绝，a 的脏数据必须仍在
+        ok = ok && !cache.put("a", larger.data(), larger.size());
+        std::vector<uint8_t> data;
+        ok = ok && cache.get("a", data) && data == first && cache.dirtyKeys().size() == 2;
+        // 同样大小的替换不需要额外空间
+        ok = ok && cache.put("a", second.data(), second.size(), 0.0, true) && cache.get("a", data) && data == second;
+        std::cout << "rejected replacement keeps the old entry: " << (ok ? "yes" : "NO") << std::endl;
+        cache.erase("a");
+        cache.erase("b");
+        return ok;
+    }
+
+    std::vector<std::string> dataFiles(const std::string& dir) {
+        std::vector<std::string> names;
+        if (DIR* d = opendir(dir.c_str())) {
+            while (struct dirent* ent = readdir(d)) {
+                if (ent->d_name[0] != '.') {
+                    names.emplace_back(ent->d_name);
+                }
+            }
+            closedir(d);
+        }
+        return names;
+    }
+
+    bool checkCrashedReplace(const std::string& dir) {
+        StagingCache::Config config;
+        config.capacity = 4 * kAggregateSize;
+        const auto first = makeData(1, kAggregateSize);
+        const auto second = makeData(2, kAggregateSize);
+        std::string old_name;
+        std::string old_bytes;
+        {
+            StagingCache cache(dir, config);
+            bool ok = cache.put("k", first.data(), first.size(), 0.0, true);
+            auto names = dataFiles(dir);
+            if (!ok || names.size() != 1) {
+                return false;
+            }
+            old_name = names[0];
+            std::ifstream in(dir + "/" + old_name, std::ios::binary);
+            old_bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            if (!cache.put("k", second.data(), second.size(), 0.0, true)) {
+                return false;
+            }
+        }
+        // 模拟 put() 改名之后、删除旧文件之前崩溃：旧文件仍在
+        std::ofstream(dir + "/" + old_name, std::ios::binary) << old_bytes;
+
+        StagingCache reopened(dir, config);
+        std::vector<uint8_t> data;
+        bool ok = reopened.stats().entries == 1 && reopened.get("k", data) && data == second &&
+                  dataFiles(dir).size() == 1;
+        std::cout << "crash during replace recovers the newer entry: " << (ok ? "yes" : "NO") << std::endl;
+        reopened.erase("k");
+        return ok;
+    }
+
+    bool checkRecallPath(const std::string& dir) {
+        StagingCache::Config staging_config;
+        staging_config.capacity = 16 * kAggregateSize;
+        StagingCache cache(dir, staging_config);
+
+        std::vector<TapeDrivesOperation> ops;
+        ReadCoalescer::Config config;
+        config.block_size = 4096;
+        config.staging = &cache;
+        ReadCoalescer coalescer(config, [&ops](const TapeDrivesOperation& op) { ops.push_back(op); });
+
+        const auto aggregate = makeData(42, kAggregateSize);
+        AggregateLocation location{.tape_id = "T00001", .aggregate_id = 42, .block_position = 100,
+                                   .length = kAggregateSize, .checksum = std::nullopt, .compressed = false};
+        size_t delivered = 0;
+        auto expect = [&](uint64_t offset, uint64_t length) {
+            return [&delivered, &aggregate, offset, length](bool ok, const uint8_t* data, size_t size) {
+                if (ok && size == length && std::equal(data, data + size, aggregate.begin() + offset)) {
+                    ++delivered;
+                }
+            };
+        };
+
+        coalescer.read("job-1", location, 1000, 3000, expect(1000, 3000));
+        coalescer.flush();
+        bool ok = ops.size() == 1 && coalescer.complete(ops[0].getOperationId(), aggregate.data(), aggregate.size());
+        coalescer.read("job-2", location, 20000, 5000, expect(20000, 5000));
+        coalescer.read("job-3", location, 60000, kAggregateSize - 60000, expect(60000, kAggregateSize - 60000));
+        coalescer.flush();
+        auto stats = coalescer.stats();
+        std::cout << "recall path: " << ops.size() << " READ_AGGR for 3 requests, " << stats.staged_hits
+                  << " served from staging, " << stats.staged_aggregates << " aggregate staged" << std::endl;
+        ok = ok && ops.size() == 1 && delivered == 3 && stats.staged_hits == 2 && stats.staged_aggregates == 1;
+        cache.erase(StagingCache::aggregateKey(42));
+        return ok;
+    }
+
+    void runRecalls(const std::string& dir, const char* name, StagingCache::Policy policy) {
+        StagingCache::Config config;
+        config.capacity = 64 * kAggregateSize;
+        config.policy = policy;
+        StagingCache cache(dir, config);
+
+        std::mt19937_64 rng(5);
+        std::vector<double> weights;
+        for (size_t i = 0; i < 200; ++i) {
+            weights.push_back(1.0 / std::pow(static_cast<double>(i + 1), 0.9));
+        }
+        std::discrete_distribution<size_t> hot(weights.begin(), weights.end());
+        std::bernoulli_distribution one_off(0.5);
+        auto costOf = [](uint64_t id) { return 30.0 + static_cast<double>(id * 7919 % 10) * 30.0; };
+
+        const auto data = makeData(0, kAggregateSize);
+        std::vector<uint8_t> out;
+        double tape_seconds = 0.0;
+        uint64_t next_one_off = 1000000;
+        for (size_t i = 0; i < 20000; ++i) {
+            const uint64_t id = one_off(rng) ? next_one_off++ : hot(rng);
+            const std::string key = StagingCache::aggregateKey(id);
+            if (!cache.read(key, 0, 4096, out)) {
+                // 未命中：READ_AGGR 从磁带读取，数据落到暂存盘
+                tape_seconds += costOf(id);
+                cache.put(key, data.data(), data.size(), costOf(id));
+            }
+        }
+        auto stats = cache.stats();
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(10) << name
+                  << std::setw(10) << 100.0 * stats.hits / (stats.hits + stats.misses) << "%"
+                  << std::setw(12) << stats.evictions
+                  << std::setw(14) << stats.saved_cost_seconds / 3600.0
+                  << std::setw(14) << tape_seconds / 3600.0
+                  << std::endl;
+    }
+
+}
+
+int main() {
+    char dir[] = "/tmp/staging_XXXXXX";
+    if (!mkdtemp(dir)) {
+        return 1;
+    }
+    bool ok = checkArchiveStaging(dir);
+    ok = checkReplaceRejected(std::string(dir) + "/replace") && ok;
+    ok = checkCrashedReplace(std::string(dir) + "/crash") && ok;
+    ok = checkRecallPath(std::string(dir) + "/recall") && ok;
+
+    std::cout << std::endl << "recalls: 20000 requests, 50% hot (zipf 0.9 over 200), 50% one-off, "
+              << "cache holds 64 aggregates" << std::endl;
+    std::cout << std::setw(10) << "policy" << std::setw(11) << "hit rate" << std::setw(12) << "evictions"
+              << std::setw(14) << "saved tape h" << std::setw(14) << "tape h" << std::endl;
+    runRecalls(std::string(dir) + "/lru", "lru", StagingCache::Policy::Lru);
+    runRecalls(std::string(dir) + "/cost", "cost", StagingCache::Policy::CostBased);
+
+    std::string cleanup = std::string("rm -rf ") + dir;
+    if (std::system(cleanup.c_str()) != 0) {
+        return 1;
+    }
+    std::cout << (ok ? "staging cache verified" : "MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}
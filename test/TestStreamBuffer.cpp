@@ -0,0 +1,72 @@
+#include "DrivePool.hpp"
+#include "shared/thread/Thread.hpp"
+
+#include <iostream>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 流式缓冲区测试：暂存盘（生产者）速度约为驱动器（消费者）的一半。
+ * 驱动器 0 不等待填充、有数据就写，几乎每个块都会欠载停带；
+ * 驱动器 1 等缓冲区填充一半后才开始写带，欠载次数大幅减少。
+ */
+namespace {
+
+    constexpr size_t kChunk = 256 * 1024;
+    constexpr size_t kChunks = 32;
+
+    void writeAggregate(StreamBuffer& buffer) {
+        buffer.reset();
+        Thread producer([&buffer] {
+            std::vector<uint8_t> chunk(kChunk, 0x5A);
+            for (size_t i = 0; i < kChunks; ++i) {
+                usleep(6000); // 暂存盘读取一个块
+                buffer.write(chunk.data(), chunk.size());
+            }
+            buffer.close();
+        });
+        producer.start();
+
+        std::vector<uint8_t> block(kChunk);
+        size_t total = 0;
+        if (buffer.waitToStart()) {
+            while (size_t n = buffer.read(block.data(), block.size())) {
+                total += n;
+                usleep(3000); // 驱动器写一个块
+            }
+        }
+        producer.join();
+        std::cout << "  wrote " << total / kChunk << " chunks" << std::endl;
+    }
+
+}
+
+int main() {
+    DrivePool pool(2);
+
+    StreamBuffer::Config eager;
+    eager.capacity = kChunks * kChunk / 4;
+    eager.start_fill = 0.0;
+    eager.resume_fill = 0.0;
+    pool.drive(0).streamBuffer().configure(eager);
+
+    StreamBuffer::Config buffered;
+    buffered.capacity = kChunks * kChunk / 4;
+    buffered.start_fill = 0.5;
+    buffered.resume_fill = 0.25;
+    pool.drive(1).streamBuffer().configure(buffered);
+
+    for (size_t drive = 0; drive < pool.size(); ++drive) {
+        std::cout << "drive " << drive << ":" << std::endl;
+        writeAggregate(pool.drive(drive).streamBuffer());
+    }
+
+    auto metrics = pool.streamMetrics();
+    for (size_t drive = 0; drive < metrics.size(); ++drive) {
+        const auto& m = metrics[drive];
+        std::cout << "drive " << drive << ": starts " << m.starts << ", underruns " << m.underruns
+                  << ", peak fill " << 100 * m.peak_fill / m.capacity << "%"
+                  << ", bytes " << m.bytes_in << "/" << m.bytes_out << std::endl;
+    }
+    return metrics[1].underruns < metrics[0].underruns ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * 测试公用的断言和可复现的伪随机数据。
+ */
+namespace test_util {
+
+    /**
+     * @brief 检查条件，失败时打印说明。
+     *
+     * @return bool 原样返回 ok，便于 ok = check(...) && ok 连续检查。
+     */
+    inline bool check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cout << "FAILED: " << what << std::endl;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief xorshift64 伪随机数，种子相同时序列相同（种子不能为 0）。
+     */
+    struct XorShift {
+        uint64_t state;
+
+        uint64_t next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    /**
+     * @brief 由种子生成的不可压缩数据。
+     */
+    inline std::vector<uint8_t> randomBytes(size_t length, uint64_t seed) {
+        XorShift rng{seed};
+        std::vector<uint8_t> data(length);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(rng.next());
+        }
+        return data;
+    }
+
+}